@@ -0,0 +1,42 @@
+/*
+ * CRC.h
+ *
+ * CRC kernels shared by the applications. Both CRC16 flavours are the
+ * reflected CRC-16/CCITT (polynomial 0x8408) and only differ in the preset
+ * and the final complement, so they share one implementation:
+ *  - ISO14443-A CRC_A: preset 0x6363, no complement
+ *  - ISO15693 CRC: preset 0xFFFF, complemented
+ * The DESFire CRC32 is the reflected CRC-32 (polynomial 0xEDB88320) with a
+ * preset of 0xFFFFFFFF and without a final complement.
+ *
+ * All functions continue from the given checksum, so frames can be
+ * processed in parts.
+ */
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../Common.h"
+
+#define CRC_A_PRESET            0x6363
+#define CRC_ISO15693_PRESET     0xFFFF
+#define CRC32_DESFIRE_PRESET    0xFFFFFFFFUL
+
+uint16_t CRC16Update(uint16_t Checksum, const void *Buffer, uint16_t ByteCount);
+uint32_t CRC32Update(uint32_t Checksum, const void *Buffer, uint16_t ByteCount);
+
+INLINE uint16_t CRCACalc(const void *Buffer, uint16_t ByteCount) {
+    return CRC16Update(CRC_A_PRESET, Buffer, ByteCount);
+}
+
+INLINE uint16_t CRCISO15693Calc(const void *Buffer, uint16_t ByteCount) {
+    return ~CRC16Update(CRC_ISO15693_PRESET, Buffer, ByteCount);
+}
+
+INLINE uint32_t CRC32DESFireCalc(const void *Buffer, uint16_t ByteCount) {
+    return CRC32Update(CRC32_DESFIRE_PRESET, Buffer, ByteCount);
+}
+
+#endif /* CRC_H_ */
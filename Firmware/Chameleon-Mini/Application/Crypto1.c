@@ -5,6 +5,9 @@
 
 // uncomment if platform is not avr
 // #define NO_INLINE_ASM 1
+#ifdef HOST_BUILD
+#define NO_INLINE_ASM 1
+#endif
 
 #define PRNG_MASK        0x002D0000UL
 /* x^16 + x^14 + x^13 + x^11 + 1 */
@@ -296,6 +299,7 @@ static const uint8_t C1MEM TableC0[32] = {
     FC(1, 1, 1, 0, 0), FC(1, 1, 1, 0, 1), FC(1, 1, 1, 1, 0), FC(1, 1, 1, 1, 1)
 };
 
+#ifndef CRYPTO1_TABLE_ENGINE
 /* Special table for byte processing, feedback at bit 7 */
 static const uint8_t C1MEM TableC7[32] = {
     /* fc with Input {4,3,2,1,0} = (0,0,0,0,0) to (1,1,1,1,1) */
@@ -308,6 +312,7 @@ static const uint8_t C1MEM TableC7[32] = {
                       FC(1, 1, 0, 0, 0) << 7, FC(1, 1, 0, 0, 1) << 7, FC(1, 1, 0, 1, 0) << 7, FC(1, 1, 0, 1, 1) << 7,
                       FC(1, 1, 1, 0, 0) << 7, FC(1, 1, 1, 0, 1) << 7, FC(1, 1, 1, 1, 0) << 7, FC(1, 1, 1, 1, 1) << 7
 };
+#endif
 
 /* Special table for nibble processing (e.g. ack), feedback at bit 3 */
 static const uint8_t C1MEM TableC3[32] = {
@@ -382,6 +387,15 @@ void Crypto1GetState(uint8_t *pEven, uint8_t *pOdd) {
 
 }
 
+void Crypto1SetState(const uint8_t *pEven, const uint8_t *pOdd) {
+    State.Even[0] = pEven[0];
+    State.Even[1] = pEven[1];
+    State.Even[2] = pEven[2];
+    State.Odd[0] = pOdd[0];
+    State.Odd[1] = pOdd[1];
+    State.Odd[2] = pOdd[2];
+}
+
 /* Proceed LFSR by one clock cycle */
 /* Prototype to force inlining */
 static __inline__ uint8_t Crypto1LFSRbyteFeedback(uint8_t E0,
@@ -443,6 +457,9 @@ static void Crypto1LFSR(uint8_t In) {
     Feedback ^= Feedback >> 2;
     Feedback ^= Feedback >> 1;
 
+    /* Input bit, e.g. the plain reader nonce */
+    Feedback ^= In;
+
     /* Now the shifting of the Crypto1 state gets more complicated when
      * split up into even/odd parts. After some hard thinking, one can
      * see that after one LFSR clock cycle
@@ -465,6 +482,221 @@ uint8_t Crypto1FilterOutput(void) {
     return (CRYPTO1_FILTER_OUTPUT_B0_24(State.Odd[0], State.Odd[1], State.Odd[2]));
 }
 
+#ifdef CRYPTO1_TABLE_ENGINE
+/* Table driven engine, generating the keystream a byte at a time.
+ * The filter inputs are the odd state bits 4..23, taken as five nibbles
+ * that go through fa, fb, fb, fa and fb. Clocking the LFSR twice shifts
+ * the odd state by one bit, so the eight keystream bits of a byte are
+ * the filter output of the odd state shifted by 0..3 (clocks 0, 2, 4, 6)
+ * and of the even state shifted by 1..4 (clocks 1, 3, 5, 7).
+ * As long as no keystream is fed back into the LFSR, the state can be
+ * clocked for the whole byte first. Afterwards, every filter nibble of
+ * all eight clocks can be looked up in one go from a byte of the new
+ * state, and fc is evaluated for all clocks at once (bit-sliced). */
+
+/* fa/fb of the five nibbles in a byte: bit n holds the output for bits n..n+3 */
+static const uint8_t C1MEM WindowTableFA[256] = {
+    0x00, 0x01, 0x03, 0x03, 0x06, 0x06, 0x06, 0x07,
+    0x0C, 0x0C, 0x0D, 0x0C, 0x0D, 0x0D, 0x0E, 0x0F,
+    0x18, 0x19, 0x19, 0x19, 0x1A, 0x1A, 0x18, 0x19,
+    0x1A, 0x1A, 0x1B, 0x1A, 0x1D, 0x1D, 0x1E, 0x1F,
+    0x10, 0x11, 0x13, 0x13, 0x12, 0x12, 0x12, 0x13,
+    0x14, 0x14, 0x15, 0x14, 0x11, 0x11, 0x12, 0x13,
+    0x14, 0x15, 0x15, 0x15, 0x16, 0x16, 0x14, 0x15,
+    0x1A, 0x1A, 0x1B, 0x1A, 0x1D, 0x1D, 0x1E, 0x1F,
+    0x00, 0x01, 0x03, 0x03, 0x06, 0x06, 0x06, 0x07,
+    0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x09, 0x09, 0x0A, 0x0A, 0x08, 0x09,
+    0x02, 0x02, 0x03, 0x02, 0x05, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0B, 0x0B, 0x0A, 0x0A, 0x0A, 0x0B,
+    0x0C, 0x0C, 0x0D, 0x0C, 0x09, 0x09, 0x0A, 0x0B,
+    0x14, 0x15, 0x15, 0x15, 0x16, 0x16, 0x14, 0x15,
+    0x1A, 0x1A, 0x1B, 0x1A, 0x1D, 0x1D, 0x1E, 0x1F,
+    0x00, 0x01, 0x03, 0x03, 0x06, 0x06, 0x06, 0x07,
+    0x0C, 0x0C, 0x0D, 0x0C, 0x0D, 0x0D, 0x0E, 0x0F,
+    0x08, 0x09, 0x09, 0x09, 0x0A, 0x0A, 0x08, 0x09,
+    0x0A, 0x0A, 0x0B, 0x0A, 0x0D, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x13, 0x13, 0x12, 0x12, 0x12, 0x13,
+    0x14, 0x14, 0x15, 0x14, 0x11, 0x11, 0x12, 0x13,
+    0x04, 0x05, 0x05, 0x05, 0x06, 0x06, 0x04, 0x05,
+    0x0A, 0x0A, 0x0B, 0x0A, 0x0D, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x13, 0x13, 0x16, 0x16, 0x16, 0x17,
+    0x14, 0x14, 0x15, 0x14, 0x15, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x19, 0x19, 0x1A, 0x1A, 0x18, 0x19,
+    0x12, 0x12, 0x13, 0x12, 0x15, 0x15, 0x16, 0x17,
+    0x08, 0x09, 0x0B, 0x0B, 0x0A, 0x0A, 0x0A, 0x0B,
+    0x0C, 0x0C, 0x0D, 0x0C, 0x09, 0x09, 0x0A, 0x0B,
+    0x14, 0x15, 0x15, 0x15, 0x16, 0x16, 0x14, 0x15,
+    0x1A, 0x1A, 0x1B, 0x1A, 0x1D, 0x1D, 0x1E, 0x1F
+};
+
+static const uint8_t C1MEM WindowTableFB[256] = {
+    0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x02, 0x03,
+    0x02, 0x03, 0x01, 0x01, 0x05, 0x04, 0x06, 0x07,
+    0x04, 0x04, 0x06, 0x07, 0x03, 0x02, 0x02, 0x03,
+    0x0A, 0x0B, 0x09, 0x09, 0x0D, 0x0C, 0x0E, 0x0F,
+    0x08, 0x08, 0x08, 0x09, 0x0D, 0x0C, 0x0E, 0x0F,
+    0x06, 0x07, 0x05, 0x05, 0x05, 0x04, 0x06, 0x07,
+    0x14, 0x14, 0x16, 0x17, 0x13, 0x12, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x10, 0x10, 0x10, 0x11, 0x11, 0x10, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x0C, 0x0C, 0x0E, 0x0F, 0x0B, 0x0A, 0x0A, 0x0B,
+    0x0A, 0x0B, 0x09, 0x09, 0x0D, 0x0C, 0x0E, 0x0F,
+    0x08, 0x08, 0x08, 0x09, 0x0D, 0x0C, 0x0E, 0x0F,
+    0x06, 0x07, 0x05, 0x05, 0x05, 0x04, 0x06, 0x07,
+    0x14, 0x14, 0x16, 0x17, 0x13, 0x12, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x02, 0x03,
+    0x02, 0x03, 0x01, 0x01, 0x05, 0x04, 0x06, 0x07,
+    0x14, 0x14, 0x16, 0x17, 0x13, 0x12, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x18, 0x18, 0x18, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x16, 0x17, 0x15, 0x15, 0x15, 0x14, 0x16, 0x17,
+    0x14, 0x14, 0x16, 0x17, 0x13, 0x12, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x10, 0x10, 0x10, 0x11, 0x11, 0x10, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F,
+    0x0C, 0x0C, 0x0E, 0x0F, 0x0B, 0x0A, 0x0A, 0x0B,
+    0x0A, 0x0B, 0x09, 0x09, 0x0D, 0x0C, 0x0E, 0x0F,
+    0x08, 0x08, 0x08, 0x09, 0x0D, 0x0C, 0x0E, 0x0F,
+    0x06, 0x07, 0x05, 0x05, 0x05, 0x04, 0x06, 0x07,
+    0x14, 0x14, 0x16, 0x17, 0x13, 0x12, 0x12, 0x13,
+    0x1A, 0x1B, 0x19, 0x19, 0x1D, 0x1C, 0x1E, 0x1F
+};
+
+/* Moves the nibble bits 0..3 to the even bit positions 0, 2, 4 and 6 */
+static const uint8_t C1MEM SpreadTable[16] = {
+    0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15,
+    0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55
+};
+
+#ifdef DESFIRE_CRYPTO1_SAVE_SPACE
+#define CRYPTO1_TABLE_READ(__table, __index)    pgm_read_byte((__table) + (__index))
+#else
+#define CRYPTO1_TABLE_READ(__table, __index)    (__table)[__index]
+#endif
+
+/* CRYPTO1_BIT_PAIR_FEEDBACK selects the AVR variant of CRYPTO1_CLOCK_BYTE
+ * on other platforms too, so that the host build can check it */
+#if defined(NO_INLINE_ASM) && !defined(CRYPTO1_BIT_PAIR_FEEDBACK)
+/* On 32 bit platforms, the 8 feedback bits of a byte are computed at once.
+ * The n-th feedback bit of the even (odd) half of the state is the sum over
+ * the LFSR taps shifted by n. This only reads state bits 0..23 except for
+ * the last few clocks, which then depend on feedback bits of this byte and
+ * are corrected afterwards.
+ * Returns the feedback for the even half in bits 0..3 and for the odd half
+ * in bits 4..7, each in the order they are shifted in. */
+static __inline__ uint8_t Crypto1TableFeedback(uint32_t E, uint32_t O, uint8_t In) __attribute__((always_inline));
+static uint8_t Crypto1TableFeedback(uint32_t E, uint32_t O, uint8_t In) {
+    /* Taps at three consecutive state bits are combined once */
+    uint32_t A = O ^ (O >> 1) ^ (O >> 2);
+    uint32_t B = E ^ (E >> 1) ^ (E >> 2);
+    uint8_t InE = In & 0x55, InO = (In >> 1) & 0x55;
+    uint8_t FE, FO;
+
+    /* LFSR_MASK_EVEN = bits 0, 5..7, 12, 21 and
+     * LFSR_MASK_ODD = bits 2, 4, 7..9, 12..14, 17, 19..21 */
+    FE = E ^ (B >> 5) ^ (E >> 12) ^ (E >> 21) ^
+         (O >> 2) ^ (O >> 4) ^ (A >> 7) ^ (A >> 12) ^ (O >> 17) ^ (A >> 19);
+    FO = O ^ (A >> 5) ^ (O >> 12) ^ (O >> 21) ^
+         (E >> 3) ^ (E >> 5) ^ (B >> 8) ^ (B >> 13) ^ (E >> 18) ^ (B >> 20);
+
+    /* Input bits 0, 2, 4, 6 go to the even and 1, 3, 5, 7 to the odd half */
+    InE = (InE | (InE >> 1)) & 0x33;
+    InO = (InO | (InO >> 1)) & 0x33;
+    FE = (FE ^ InE ^ (InE >> 2)) & 0x0F;
+    FO = (FO ^ InO ^ (InO >> 2)) & 0x0F;
+
+    /* Taps 21 of both halves reach beyond bit 23 for the last clocks */
+    FE ^= ((FE ^ FO) & 0x01) << 3;
+    FO ^= ((FE & 0x01) << 2) ^ (((FO ^ FE ^ (FE >> 1)) & 0x01) << 3);
+
+    return FE | (FO << 4);
+}
+
+/* Clock the LFSR 8 times feeding in the bits of __in but no keystream */
+#define CRYPTO1_CLOCK_BYTE(__in) \
+    Feedback = Crypto1TableFeedback(Even0 | ((uint32_t) Even1 << 8) | ((uint32_t) Even2 << 16), \
+                                    Odd0 | ((uint32_t) Odd1 << 8) | ((uint32_t) Odd2 << 16), __in); \
+    Even0 = (Even0 >> 4) | (Even1 << 4); \
+    Even1 = (Even1 >> 4) | (Even2 << 4); \
+    Even2 = (Even2 >> 4) | (Feedback << 4); \
+    Odd0 = (Odd0 >> 4) | (Odd1 << 4); \
+    Odd1 = (Odd1 >> 4) | (Odd2 << 4); \
+    Odd2 = (Odd2 >> 4) | (Feedback & 0xF0)
+#else
+/* Clock the LFSR 8 times feeding in the bits of __in (which is consumed)
+ * but no keystream. On the AVR, the bitwise feedback is cheaper than
+ * shifting the state words around. */
+#define CRYPTO1_CLOCK_BYTE(__in) \
+    CRYPTO1_CLOCK_BIT_PAIR(__in); \
+    CRYPTO1_CLOCK_BIT_PAIR(__in); \
+    CRYPTO1_CLOCK_BIT_PAIR(__in); \
+    CRYPTO1_CLOCK_BIT_PAIR(__in)
+
+/* remember Odd/Even swap has been omitted! */
+#define CRYPTO1_CLOCK_BIT_PAIR(__in) \
+    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2); \
+    Feedback ^= __in; \
+    __in >>= 1; \
+    SHIFT24(Even0, Even1, Even2, Feedback); \
+    Feedback  = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2); \
+    Feedback ^= __in; \
+    __in >>= 1; \
+    SHIFT24(Odd0, Odd1, Odd2, Feedback)
+#endif
+
+/* Clock the LFSR once feeding in bit 0 of In and the keystream bit. This
+ * is taken from the fc outputs precomputed by Crypto1Auth() (Out0, and
+ * OutDiff to get the one for 1) according to filter nibble 4 of the other
+ * half of the state. */
+#define CRYPTO1_AUTH_BIT(__b0, __b1, __b2, __f0, __f1, __f2, __clock) \
+    Feedback  = -(CRYPTO1_TABLE_READ(WindowTableFB, __f2 >> 4) & 0x01); \
+    Feedback  = (Out0 ^ (OutDiff & Feedback)) >> (__clock); \
+    Feedback ^= Crypto1LFSRbyteFeedback(__b0, __b1, __b2, __f0, __f1, __f2); \
+    Feedback ^= In; \
+    In >>= 1; \
+    SHIFT24(__b0, __b1, __b2, Feedback)
+
+/* Look up one filter nibble in a byte of the odd and of the even state.
+ * The outputs for the odd state (shifted by 0..3) go to bits 0..3, those
+ * for the even state (shifted by 1..4) to bits 4..7. */
+#define CRYPTO1_TABLE_NIBBLE(__table, __odd, __even) \
+    ((CRYPTO1_TABLE_READ(__table, (uint8_t) (__odd)) & 0x0F) | \
+     ((CRYPTO1_TABLE_READ(__table, (uint8_t) (__even)) << 3) & 0xF0))
+
+/* Keystream of the byte which has just been clocked, in transmission order */
+static __inline__ uint8_t Crypto1TableKeyStream(uint8_t E0,
+                                                uint8_t E1,
+                                                uint8_t E2,
+                                                uint8_t O0,
+                                                uint8_t O1,
+                                                uint8_t O2) __attribute__((always_inline));
+static uint8_t Crypto1TableKeyStream(uint8_t E0,
+                                     uint8_t E1,
+                                     uint8_t E2,
+                                     uint8_t O0,
+                                     uint8_t O1,
+                                     uint8_t O2) {
+    uint8_t F0, F1, F2, F3, F4;
+    uint8_t Out;
+
+    /* The state has been shifted by four bits, so the filter
+     * nibbles now start at bits 0, 4, 8, 12 and 16 */
+    F0 = CRYPTO1_TABLE_NIBBLE(WindowTableFA, O0, E0);
+    F1 = CRYPTO1_TABLE_NIBBLE(WindowTableFB, (O0 >> 4) | (O1 << 4), (E0 >> 4) | (E1 << 4));
+    F2 = CRYPTO1_TABLE_NIBBLE(WindowTableFB, O1, E1);
+    F3 = CRYPTO1_TABLE_NIBBLE(WindowTableFA, (O1 >> 4) | (O2 << 4), (E1 >> 4) | (E2 << 4));
+    F4 = CRYPTO1_TABLE_NIBBLE(WindowTableFB, O2, E2);
+
+    /* fc for all 8 clocks at once */
+    Out = FC(F4, F3, F2, F1, F0);
+
+    return CRYPTO1_TABLE_READ(SpreadTable, Out & 0x0F) | (CRYPTO1_TABLE_READ(SpreadTable, Out >> 4) << 1);
+}
+#endif /* CRYPTO1_TABLE_ENGINE */
+
 /* Setup LFSR split into odd and even states, feed in uid ^nonce */
 /* Version for first (not nested) authentication.                 */
 void Crypto1Setup(uint8_t Key[6],
@@ -475,7 +707,9 @@ void Crypto1Setup(uint8_t Key[6],
     register uint8_t Odd0,  Odd1,  Odd2;
     uint8_t KeyStream;
     uint8_t Feedback;
+#ifndef CRYPTO1_TABLE_ENGINE
     uint8_t Out;
+#endif
     uint8_t In;
     uint8_t ByteCount;
 
@@ -495,6 +729,10 @@ void Crypto1Setup(uint8_t Key[6],
     for (ByteCount = 0; ByteCount < NONCE_SIZE; ByteCount++) {
         In = *CardNonce ^ *Uid++;
 
+#ifdef CRYPTO1_TABLE_ENGINE
+        CRYPTO1_CLOCK_BYTE(In);
+        KeyStream = Crypto1TableKeyStream(Even0, Even1, Even2, Odd0, Odd1, Odd2);
+#else
         Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
         SHIFT8(KeyStream, Out);
         Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
@@ -557,6 +795,7 @@ void Crypto1Setup(uint8_t Key[6],
         Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
         Feedback ^= In;
         SHIFT24(Odd0, Odd1, Odd2, Feedback);
+#endif
 
         /* Encrypt Nonce */
         *CardNonce++ ^= KeyStream; /* Encrypt byte   */
@@ -597,6 +836,35 @@ void Crypto1SetupNested(uint8_t Key[6], uint8_t Uid[4], uint8_t CardNonce[8], bo
     KeyStream = *Key++;
     SPLIT_BYTE(Even2, Odd2, KeyStream);
 
+#ifdef CRYPTO1_TABLE_ENGINE
+    /* The reader feeds the keystream back while decrypting,
+     * so only the tag side can use the byte wise keystream. */
+    if (!Decrypt) {
+        for (ByteCount = 0; ByteCount < NONCE_SIZE; ByteCount++) {
+            In = *CardNonce ^ *Uid++;
+            CRYPTO1_CLOCK_BYTE(In);
+            KeyStream = Crypto1TableKeyStream(Even0, Even1, Even2, Odd0, Odd1, Odd2);
+
+            /* Generate parity bit */
+            Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
+            In = *CardNonce;
+            Feedback = ODD_PARITY(In);
+            CardNonce[NONCE_SIZE] = Out ^ Feedback;  /* Encrypted parity at Offset 4*/
+
+            /* Encrypt byte   */
+            *CardNonce++ = In ^ KeyStream;
+        }
+        /* save state */
+        State.Even[0] = Even0;
+        State.Even[1] = Even1;
+        State.Even[2] = Even2;
+        State.Odd[0]  = Odd0;
+        State.Odd[1]  = Odd1;
+        State.Odd[2]  = Odd2;
+        return;
+    }
+#endif
+
     /* Get first filter output */
     Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
 
@@ -693,6 +961,10 @@ void Crypto1Auth(uint8_t EncryptedReaderNonce[NONCE_SIZE]) {
     uint8_t In;
     uint8_t Feedback;
     uint8_t i;
+#ifdef CRYPTO1_TABLE_ENGINE
+    uint8_t F0, F1, F2, F3;
+    uint8_t Out0, OutDiff;
+#endif
 
     /* read state */
     Even0 = State.Even[0];
@@ -702,6 +974,33 @@ void Crypto1Auth(uint8_t EncryptedReaderNonce[NONCE_SIZE]) {
     Odd1 = State.Odd[1];
     Odd2 = State.Odd[2];
 
+#ifdef CRYPTO1_TABLE_ENGINE
+    /* 4 Bytes */
+    for (i = 0; i < NONCE_SIZE; i++) {
+        In = EncryptedReaderNonce[i];
+
+        /* The keystream is fed back here, hence the LFSR has to be clocked
+         * bit by bit. However, filter nibbles 0..3 of all 8 clocks are
+         * already known from the current state. Only nibble 4 depends on the
+         * new feedback bits, so fc is precomputed for both of its values. */
+        F0 = CRYPTO1_TABLE_NIBBLE(WindowTableFA, (Odd0 >> 4) | (Odd1 << 4), (Even0 >> 4) | (Even1 << 4));
+        F1 = CRYPTO1_TABLE_NIBBLE(WindowTableFB, Odd1, Even1);
+        F2 = CRYPTO1_TABLE_NIBBLE(WindowTableFB, (Odd1 >> 4) | (Odd2 << 4), (Even1 >> 4) | (Even2 << 4));
+        F3 = CRYPTO1_TABLE_NIBBLE(WindowTableFA, Odd2, Even2);
+        Out0 = FC(0x00, F3, F2, F1, F0);
+        OutDiff = FC(0xFF, F3, F2, F1, F0) ^ Out0;
+
+        /* remember Odd/Even swap has been omitted! */
+        CRYPTO1_AUTH_BIT(Even0, Even1, Even2, Odd0, Odd1, Odd2, 0);
+        CRYPTO1_AUTH_BIT(Odd0, Odd1, Odd2, Even0, Even1, Even2, 4);
+        CRYPTO1_AUTH_BIT(Even0, Even1, Even2, Odd0, Odd1, Odd2, 1);
+        CRYPTO1_AUTH_BIT(Odd0, Odd1, Odd2, Even0, Even1, Even2, 5);
+        CRYPTO1_AUTH_BIT(Even0, Even1, Even2, Odd0, Odd1, Odd2, 2);
+        CRYPTO1_AUTH_BIT(Odd0, Odd1, Odd2, Even0, Even1, Even2, 6);
+        CRYPTO1_AUTH_BIT(Even0, Even1, Even2, Odd0, Odd1, Odd2, 3);
+        CRYPTO1_AUTH_BIT(Odd0, Odd1, Odd2, Even0, Even1, Even2, 7);
+    }
+#else
     /* 4 Bytes */
     for (i = 0; i < NONCE_SIZE; i++) {
         In = EncryptedReaderNonce[i];
@@ -770,6 +1069,7 @@ void Crypto1Auth(uint8_t EncryptedReaderNonce[NONCE_SIZE]) {
                    ^ In;
         SHIFT24(Odd0, Odd1, Odd2, Feedback);
     }
+#endif
     /* save state */
     State.Even[0] = Even0;
     State.Even[1] = Even1;
@@ -841,7 +1141,11 @@ void Crypto1ByteArray(uint8_t *Buffer, uint8_t Count) {
     register uint8_t Odd0,  Odd1,  Odd2;
     uint8_t KeyStream = 0;
     uint8_t Feedback;
+#ifdef CRYPTO1_TABLE_ENGINE
+    uint8_t In;
+#else
     uint8_t Out;
+#endif
 
     /* read state */
     Even0 = State.Even[0];
@@ -852,6 +1156,11 @@ void Crypto1ByteArray(uint8_t *Buffer, uint8_t Count) {
     Odd2 = State.Odd[2];
 
     while (Count--) {
+#ifdef CRYPTO1_TABLE_ENGINE
+        In = 0;
+        CRYPTO1_CLOCK_BYTE(In);
+        KeyStream = Crypto1TableKeyStream(Even0, Even1, Even2, Odd0, Odd1, Odd2);
+#else
         /* Bit 0, initialise keystream */
         KeyStream = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
         Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
@@ -902,6 +1211,7 @@ void Crypto1ByteArray(uint8_t *Buffer, uint8_t Count) {
         KeyStream = (KeyStream >> 1) | Out;
         Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
         SHIFT24(Odd0, Odd1, Odd2, Feedback);
+#endif
 
         /* Transcrypt and increment buffer address */
         *Buffer++ ^= KeyStream;
@@ -929,6 +1239,9 @@ void Crypto1ByteArrayWithParity(uint8_t *Buffer, uint8_t Count) {
     uint8_t KeyStream = 0;
     uint8_t Feedback;
     uint8_t Out;
+#ifdef CRYPTO1_TABLE_ENGINE
+    uint8_t In;
+#endif
 
     /* read state */
     Even0 = State.Even[0];
@@ -938,10 +1251,17 @@ void Crypto1ByteArrayWithParity(uint8_t *Buffer, uint8_t Count) {
     Odd1 = State.Odd[1];
     Odd2 = State.Odd[2];
 
+#ifndef CRYPTO1_TABLE_ENGINE
     /* First pass needs output, next pass uses parity bit! */
     Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
+#endif
 
     while (Count--) {
+#ifdef CRYPTO1_TABLE_ENGINE
+        In = 0;
+        CRYPTO1_CLOCK_BYTE(In);
+        KeyStream = Crypto1TableKeyStream(Even0, Even1, Even2, Odd0, Odd1, Odd2);
+#else
         /* Bit 0, initialise keystream from parity */
         SHIFT8(KeyStream, Out);
         Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
@@ -992,6 +1312,7 @@ void Crypto1ByteArrayWithParity(uint8_t *Buffer, uint8_t Count) {
         KeyStream = (KeyStream >> 1) | Out;
         Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
         SHIFT24(Odd0, Odd1, Odd2, Feedback);
+#endif
 
         /* Next bit encodes parity */
         Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
@@ -5,6 +5,7 @@
 #include <stdbool.h>
 
 void Crypto1GetState(uint8_t *pEven, uint8_t *pOdd);
+void Crypto1SetState(const uint8_t *pEven, const uint8_t *pOdd);
 
 /* Gets the current keystream-bit, without shifting the internal LFSR */
 uint8_t Crypto1FilterOutput(void);
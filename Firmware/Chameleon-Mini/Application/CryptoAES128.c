@@ -35,6 +35,7 @@
 #include <avr/interrupt.h>
 
 #include "CryptoAES128.h"
+#include "CRC.h"
 
 #include "MifareDESFire.h"
 #include "DESFire/DESFireLogging.h"
@@ -50,6 +51,9 @@ static CryptoAESBlock_t __CryptoAES_IVData = { 0 };
 /* Set the last operation mode (ECB or CBC) init for the context */
 uint8_t __CryptoAESOpMode = CRYPTO_AES_ECB_MODE;
 
+/* The host build replaces the accessors of the AES peripheral
+ * by a software model, see Host/HostAES.c */
+#ifndef HOST_BUILD
 void aes_start(void) {
     AES.CTRL |= AES_START_bm;
 }
@@ -77,6 +81,7 @@ void aes_clear_error_flag(void) {
 void aes_configure(CryptoAESDec_t op_mode, CryptoAESAuto_t auto_start, CryptoAESXor_t xor_mode) {
     AES.CTRL = ((uint8_t) op_mode | (uint8_t) auto_start | (uint8_t) xor_mode);
 }
+#endif /* HOST_BUILD */
 
 void aes_configure_encrypt(CryptoAESAuto_t auto_start, CryptoAESXor_t xor_mode) {
     aes_configure(AES_ENCRYPT, auto_start, xor_mode);
@@ -86,6 +91,7 @@ void aes_configure_decrypt(CryptoAESAuto_t auto_start, CryptoAESXor_t xor_mode)
     aes_configure(AES_DECRYPT, auto_start, xor_mode);
 }
 
+#ifndef HOST_BUILD
 void aes_set_key(uint8_t *key_in) {
     uint8_t i;
     uint8_t *temp_key = key_in;
@@ -101,6 +107,7 @@ void aes_get_key(uint8_t *key_out) {
         *(temp_key++) = AES.KEY;
     }
 }
+#endif /* HOST_BUILD */
 
 static void CryptoAESEncryptBlock(uint8_t *Plaintext, uint8_t *Ciphertext, const uint8_t *Key, bool XorModeOn);
 static void CryptoAESDecryptBlock(uint8_t *Plaintext, uint8_t *Ciphertext, const uint8_t *Key);
@@ -128,6 +135,7 @@ static bool aes_lastsubkey_generate(uint8_t *key, uint8_t *last_sub_key) {
     return keygen_ok;
 }
 
+#ifndef HOST_BUILD
 void aes_write_inputdata(uint8_t *data_in) {
     uint8_t i;
     uint8_t *temp_state = data_in;
@@ -143,6 +151,7 @@ void aes_read_outputdata(uint8_t *data_out) {
         *(temp_state++) = AES.STATE;
     }
 }
+#endif /* HOST_BUILD */
 
 void aes_isr_configure(CryptoAESIntlvl_t intlvl) {
     /* Remove pending AES interrupts. */
@@ -183,6 +192,7 @@ void CryptoAESInitContext(CryptoAESConfig_t *ctx) {
     }
     aes_software_reset();
     memset(__CryptoAES_IVData, 0x00, CRYPTO_AES_BLOCK_SIZE);
+    CryptoAESInvalidateKeyCache();
     aes_configure(ctx->ProcessingMode, ctx->StartMode, ctx->XorMode);
     aes_set_callback(&int_callback_aes);
 }
@@ -196,110 +206,127 @@ static uint16_t CryptoAESGetPaddedBufferSize(uint16_t bufSize) {
     return bufSize + CRYPTO_AES_BLOCK_SIZE - spareBytes;
 }
 
-static void CryptoAESEncryptBlock(uint8_t *Plaintext, uint8_t *Ciphertext, const uint8_t *Key, bool XorModeOn) {
+static void CryptoAESResetPeripheral(void) {
     aes_software_reset();
     AES.CTRL = AES_RESET_bm;
     NOP();
     AES.CTRL = 0;
-    aes_configure_encrypt(AES_MANUAL, XorModeOn ? AES_XOR_ON : AES_XOR_OFF);
+}
+
+/* Resets and configures the peripheral once for a run of blocks. Between
+ * the blocks of a run, only the key has to be reloaded, since the key
+ * register holds the last round key after an encryption and the original
+ * key after a decryption. */
+static void CryptoAESStreamBegin(CryptoAESDec_t Direction, CryptoAESXor_t XorMode) {
+    CryptoAESResetPeripheral();
+    aes_configure(Direction, AES_MANUAL, XorMode);
     aes_isr_configure(AES_INTLVL_OFF);
-    aes_set_key(Key);
-    for (uint8_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; i++) {
-        AES.STATE = 0x00;
-    }
-    aes_write_inputdata(Plaintext);
+}
+
+static void CryptoAESStreamBlock(const uint8_t *RoundKey, uint8_t *Input, uint8_t *Output) {
+    aes_set_key((uint8_t *) RoundKey);
+    aes_write_inputdata(Input);
     aes_start();
     do {
         /* Wait until AES is finished or an error occurs. */
     } while (aes_is_busy());
-    aes_read_outputdata(Ciphertext);
+    aes_read_outputdata(Output);
     aes_clear_interrupt_flag();
 }
 
+static void CryptoAESEncryptBlock(uint8_t *Plaintext, uint8_t *Ciphertext, const uint8_t *Key, bool XorModeOn) {
+    CryptoAESStreamBegin(AES_ENCRYPT, XorModeOn ? AES_XOR_ON : AES_XOR_OFF);
+    CryptoAESStreamBlock(Key, Plaintext, Ciphertext);
+}
+
+/* The CBC helpers below chain in software, so the block function they take
+ * runs with the XOR of the peripheral off */
+static void CryptoAESEncryptBlockNoXor(uint8_t *Plaintext, uint8_t *Ciphertext, const uint8_t *Key) {
+    CryptoAESEncryptBlock(Plaintext, Ciphertext, Key, false);
+}
+
+/* The peripheral decrypts with the last round key, whose derivation costs a
+ * full block encryption. It is cached for the most recently used key, which
+ * during a DESFire session is the session key. */
+static struct {
+    CryptoAESKey_t Key;
+    CryptoAESKey_t LastSubKey;
+    bool Valid;
+} CryptoAESKeyCache = { 0 };
+
+static const uint8_t *CryptoAESGetLastSubKey(const uint8_t *Key) {
+    if (!CryptoAESKeyCache.Valid || memcmp(CryptoAESKeyCache.Key, Key, CRYPTO_AES_KEY_SIZE) != 0) {
+        memcpy(CryptoAESKeyCache.Key, Key, CRYPTO_AES_KEY_SIZE);
+        CryptoAESKeyCache.Valid = aes_lastsubkey_generate(CryptoAESKeyCache.Key, CryptoAESKeyCache.LastSubKey);
+    }
+    return CryptoAESKeyCache.LastSubKey;
+}
+
+void CryptoAESInvalidateKeyCache(void) {
+    memset(&CryptoAESKeyCache, 0x00, sizeof(CryptoAESKeyCache));
+}
+
 static void CryptoAESDecryptBlock(uint8_t *Plaintext, uint8_t *Ciphertext, const uint8_t *Key) {
-    AES.CTRL = AES_RESET_bm;
-    NOP();
-    AES.CTRL = 0;
-    uint8_t lastSubKey[CRYPTO_AES_KEY_SIZE];
-    aes_lastsubkey_generate(Key, lastSubKey);
-    AES.CTRL = AES_RESET_bm;
-    NOP();
-    AES.CTRL = 0;
-    aes_configure_decrypt(AES_MANUAL, AES_XOR_OFF);
-    aes_isr_configure(AES_INTLVL_OFF);
-    aes_set_key(lastSubKey);
-    for (uint8_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; i++) {
-        AES.STATE = 0x00;
+    const uint8_t *LastSubKey = CryptoAESGetLastSubKey(Key);
+    CryptoAESStreamBegin(AES_DECRYPT, AES_XOR_OFF);
+    CryptoAESStreamBlock(LastSubKey, Ciphertext, Plaintext);
+}
+
+static int CryptoAESGetExitStatus(bool UnevenBlockSize) {
+    if (aes_is_error()) {
+        aes_clear_error_flag();
+        return AES.STATUS & AES_ERROR_bm;
+    } else if (UnevenBlockSize) {
+        return CRYPTO_AES_EXIT_UNEVEN_BLOCKS;
+    } else {
+        return CRYPTO_AES_EXIT_SUCCESS;
     }
-    aes_write_inputdata(Ciphertext);
-    aes_start();
-    do {
-        /* Wait until AES is finished or an error occurs. */
-    } while (aes_is_busy());
-    aes_read_outputdata(Plaintext);
-    aes_clear_interrupt_flag();
 }
 
+/* CBC encryption as one run on the peripheral: in XOR mode, the state still
+ * holds the previous ciphertext block when the next plaintext block is
+ * written, so the chaining is done by the hardware. An uneven last block is
+ * padded with zeros, so Ciphertext has to hold whole blocks. */
 int CryptoAESEncryptBuffer(uint16_t Count, uint8_t *Plaintext, uint8_t *Ciphertext,
                            uint8_t *IVIn, const uint8_t *Key) {
     uint8_t *IV = IVIn;
-    if ((Count % CRYPTO_AES_BLOCK_SIZE) != 0) {
-        return 0xBE;
-    }
     if (IVIn == NULL) {
         memset(__CryptoAES_IVData, 0x00, CRYPTO_AES_BLOCK_SIZE);
         IV = &__CryptoAES_IVData[0];
     }
-    CryptoAESBlock_t inputBlock;
-    size_t bufBlocks = (Count + CRYPTO_AES_BLOCK_SIZE - 1) / CRYPTO_AES_BLOCK_SIZE;
+    uint16_t bufBlocks = CryptoAESBytesToBlocks(Count);
     bool unevenBlockSize = (Count % CRYPTO_AES_BLOCK_SIZE) != 0;
-    for (int blk = 0; blk < bufBlocks; blk++) {
-        if (__CryptoAESOpMode == CRYPTO_AES_CBC_MODE) {
-            if (blk + 1 != bufBlocks || !unevenBlockSize) {
-                if (blk == 0) {
-                    memcpy(inputBlock, &Plaintext[0], CRYPTO_AES_BLOCK_SIZE);
-                    CryptoMemoryXOR(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                } else {
-                    memcpy(inputBlock, &Ciphertext[(blk - 1) * CRYPTO_AES_BLOCK_SIZE], CRYPTO_AES_BLOCK_SIZE);
-                    CryptoMemoryXOR(&Plaintext[blk * CRYPTO_AES_BLOCK_SIZE], inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                }
-            } else {
-                uint8_t numInputUnevenBytes = Count % CRYPTO_AES_BLOCK_SIZE;
-                memcpy(inputBlock, &Plaintext[blk * CRYPTO_AES_BLOCK_SIZE], numInputUnevenBytes);
-                memset(&inputBlock[numInputUnevenBytes], 0x00, CRYPTO_AES_BLOCK_SIZE - numInputUnevenBytes);
-                if (blk == 0) {
-                    CryptoMemoryXOR(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                } else {
-                    CryptoMemoryXOR(&Ciphertext[(blk - 1) * CRYPTO_AES_BLOCK_SIZE], inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                }
-            }
-            CryptoAESEncryptBlock(inputBlock, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, Key, true);
-            if (blk + 1 == bufBlocks) {
-                memcpy(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-            }
-        } else {
-            if (blk + 1 != bufBlocks || !unevenBlockSize) {
-                memcpy(inputBlock, Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-            } else {
-                uint8_t numInputUnevenBytes = Count % CRYPTO_AES_BLOCK_SIZE;
-                memcpy(inputBlock, &Plaintext[blk * CRYPTO_AES_BLOCK_SIZE], numInputUnevenBytes);
-                memset(&inputBlock[numInputUnevenBytes], 0x00, CRYPTO_AES_BLOCK_SIZE - numInputUnevenBytes);
-            }
-            CryptoMemoryXOR(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-            CryptoAESEncryptBlock(inputBlock, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, Key, true);
-            memcpy(IV, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
+    if (bufBlocks == 0) {
+        return CRYPTO_AES_EXIT_SUCCESS;
+    }
+    CryptoAESBlock_t inputBlock, paddedBlock;
+    CryptoAESStreamBegin(AES_ENCRYPT, AES_XOR_ON);
+    aes_write_inputdata(IV);
+    for (uint16_t blk = 0; blk < bufBlocks; blk++) {
+        uint8_t *ptBlock = Plaintext + blk * CRYPTO_AES_BLOCK_SIZE;
+        uint8_t *ctBlock = Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE;
+        if (blk + 1 == bufBlocks && unevenBlockSize) {
+            memset(paddedBlock, 0x00, CRYPTO_AES_BLOCK_SIZE);
+            memcpy(paddedBlock, ptBlock, Count % CRYPTO_AES_BLOCK_SIZE);
+            ptBlock = paddedBlock;
+        }
+        if (blk + 1 == bufBlocks && __CryptoAESOpMode == CRYPTO_AES_CBC_MODE) {
+            /* This mode leaves the last cipher input in the IV */
+            memcpy(inputBlock, ptBlock, CRYPTO_AES_BLOCK_SIZE);
+            CryptoMemoryXOR((blk == 0) ? IV : ctBlock - CRYPTO_AES_BLOCK_SIZE, inputBlock, CRYPTO_AES_BLOCK_SIZE);
         }
+        CryptoAESStreamBlock(Key, ptBlock, ctBlock);
     }
-    if (aes_is_error()) {
-        aes_clear_error_flag();
-        return AES.STATUS & AES_ERROR_bm;
-    } else if (unevenBlockSize) {
-        return CRYPTO_AES_EXIT_UNEVEN_BLOCKS;
+    if (__CryptoAESOpMode == CRYPTO_AES_CBC_MODE) {
+        memcpy(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
     } else {
-        return CRYPTO_AES_EXIT_SUCCESS;
+        memcpy(IV, Ciphertext + (bufBlocks - 1) * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
     }
+    return CryptoAESGetExitStatus(unevenBlockSize);
 }
 
+/* CBC decryption as one run on the peripheral with the cached last round
+ * key. An uneven last block is padded with zeros. */
 int CryptoAESDecryptBuffer(uint16_t Count, uint8_t *Plaintext, uint8_t *Ciphertext,
                            uint8_t *IVIn, const uint8_t *Key) {
     uint8_t *IV = IVIn;
@@ -307,62 +334,33 @@ int CryptoAESDecryptBuffer(uint16_t Count, uint8_t *Plaintext, uint8_t *Cipherte
         memset(__CryptoAES_IVData, 0x00, CRYPTO_AES_BLOCK_SIZE);
         IV = &__CryptoAES_IVData[0];
     }
-    CryptoAESBlock_t inputBlock;
-    size_t bufBlocks = (Count + CRYPTO_AES_BLOCK_SIZE - 1) / CRYPTO_AES_BLOCK_SIZE;
+    uint16_t bufBlocks = CryptoAESBytesToBlocks(Count);
     bool unevenBlockSize = (Count % CRYPTO_AES_BLOCK_SIZE) != 0;
-    for (int blk = 0; blk < bufBlocks; blk++) {
-        if (__CryptoAESOpMode == CRYPTO_AES_CBC_MODE) {
-            if (blk + 1 != bufBlocks || !unevenBlockSize) {
-                CryptoAESDecryptBlock(inputBlock, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, Key);
-                if (blk == 0) {
-                    memcpy(Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                    CryptoMemoryXOR(IV, Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-                } else {
-                    memcpy(Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                    CryptoMemoryXOR(&Ciphertext[(blk - 1) * CRYPTO_AES_BLOCK_SIZE],
-                                    Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-                }
-            } else {
-                uint8_t numInputUnevenBytes = Count % CRYPTO_AES_BLOCK_SIZE;
-                CryptoAESBlock_t inputBlockTemp;
-                memset(inputBlockTemp, 0x00, CRYPTO_AES_BLOCK_SIZE);
-                memcpy(inputBlockTemp, &Ciphertext[blk * CRYPTO_AES_BLOCK_SIZE], numInputUnevenBytes);
-                CryptoAESDecryptBlock(inputBlock, inputBlockTemp, Key);
-                if (blk == 0) {
-                    memcpy(Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                    CryptoMemoryXOR(IV, Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-                } else {
-                    memcpy(Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-                    CryptoMemoryXOR(&Ciphertext[(blk - 1) * CRYPTO_AES_BLOCK_SIZE],
-                                    Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-                }
-            }
-            if (blk + 1 == bufBlocks) {
-                memcpy(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-            }
-        } else {
-            if (blk + 1 != bufBlocks || !unevenBlockSize) {
-                CryptoAESDecryptBlock(Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, Key);
-                CryptoMemoryXOR(IV, Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-                memcpy(IV, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-            } else {
-                uint8_t numInputUnevenBytes = Count % CRYPTO_AES_BLOCK_SIZE;
-                memset(inputBlock, 0x00, CRYPTO_AES_BLOCK_SIZE);
-                memcpy(inputBlock, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, numInputUnevenBytes);
-                CryptoAESDecryptBlock(Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, inputBlock, Key);
-                CryptoMemoryXOR(IV, Plaintext + blk * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
-                memcpy(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
-            }
+    if (bufBlocks == 0) {
+        return CRYPTO_AES_EXIT_SUCCESS;
+    }
+    CryptoAESBlock_t inputBlock, outputBlock;
+    const uint8_t *LastSubKey = CryptoAESGetLastSubKey(Key);
+    CryptoAESStreamBegin(AES_DECRYPT, AES_XOR_OFF);
+    for (uint16_t blk = 0; blk < bufBlocks; blk++) {
+        uint8_t *ptBlock = Plaintext + blk * CRYPTO_AES_BLOCK_SIZE;
+        uint8_t inputBytes = CRYPTO_AES_BLOCK_SIZE;
+        if (blk + 1 == bufBlocks && unevenBlockSize) {
+            inputBytes = Count % CRYPTO_AES_BLOCK_SIZE;
+            memset(inputBlock, 0x00, CRYPTO_AES_BLOCK_SIZE);
         }
+        /* Copying the input first also keeps an in-place decryption intact */
+        memcpy(inputBlock, Ciphertext + blk * CRYPTO_AES_BLOCK_SIZE, inputBytes);
+        CryptoAESStreamBlock(LastSubKey, inputBlock, outputBlock);
+        memcpy(ptBlock, outputBlock, CRYPTO_AES_BLOCK_SIZE);
+        CryptoMemoryXOR(IV, ptBlock, CRYPTO_AES_BLOCK_SIZE);
+        memcpy(IV, inputBlock, CRYPTO_AES_BLOCK_SIZE);
     }
-    if (aes_is_error()) {
-        aes_clear_error_flag();
-        return AES.STATUS & AES_ERROR_bm;
-    } else if (unevenBlockSize) {
-        return CRYPTO_AES_EXIT_UNEVEN_BLOCKS;
-    } else {
-        return CRYPTO_AES_EXIT_SUCCESS;
+    if (__CryptoAESOpMode == CRYPTO_AES_CBC_MODE) {
+        /* This mode leaves the last cipher output in the IV */
+        memcpy(IV, outputBlock, CRYPTO_AES_BLOCK_SIZE);
     }
+    return CryptoAESGetExitStatus(unevenBlockSize);
 }
 
 // This routine performs the CBC "send" mode chaining: C = E(P ^ IV); IV = C
@@ -442,7 +440,7 @@ void CryptoAESDecrypt_CBCReceive(uint16_t Count, uint8_t *PlainText, uint8_t *Ci
 void CryptoAESEncrypt_CBCSend(uint16_t Count, uint8_t *PlainText, uint8_t *CipherText,
                               uint8_t *Key, uint8_t *IV) {
     CryptoAES_CBCSpec_t CryptoSpec = {
-        .cryptFunc   = &CryptoAESEncryptBlock,
+        .cryptFunc   = &CryptoAESEncryptBlockNoXor,
         .blockSize   = CRYPTO_AES_BLOCK_SIZE
     };
     CryptoAES_CBCSend(Count, PlainText, CipherText, IV, Key, CryptoSpec);
@@ -451,32 +449,14 @@ void CryptoAESEncrypt_CBCSend(uint16_t Count, uint8_t *PlainText, uint8_t *Ciphe
 void CryptoAESEncrypt_CBCReceive(uint16_t Count, uint8_t *PlainText, uint8_t *CipherText,
                                  uint8_t *Key, uint8_t *IV) {
     CryptoAES_CBCSpec_t CryptoSpec = {
-        .cryptFunc   = &CryptoAESEncryptBlock,
+        .cryptFunc   = &CryptoAESEncryptBlockNoXor,
         .blockSize   = CRYPTO_AES_BLOCK_SIZE
     };
     CryptoAES_CBCRecv(Count, PlainText, CipherText, IV, Key, CryptoSpec);
 }
 
-//Taken from the Proxmark DESFire lib
-static void desfire_crc32_byte(uint32_t *crc, const uint8_t value) {
-    /* x32 + x26 + x23 + x22 + x16 + x12 + x11 + x10 + x8 + x7 + x5 + x4 + x2 + x + 1 */
-    const uint32_t poly = 0xEDB88320;
-
-    *crc ^= value;
-    for (int current_bit = 7; current_bit >= 0; current_bit--) {
-        int bit_out = (*crc) & 0x00000001;
-        *crc >>= 1;
-        if (bit_out)
-            *crc ^= poly;
-    }
-}
-
-//Taken from the Proxmark DESFire lib
 void desfire_crc32(const uint8_t *data, const uint16_t len, uint8_t *crc) {
-    uint32_t desfire_crc = 0xFFFFFFFF;
-    for (uint16_t i = 0; i < len; i++) {
-        desfire_crc32_byte(&desfire_crc, data[i]);
-    }
+    uint32_t desfire_crc = CRC32DESFireCalc(data, len);
 
     *((uint32_t *)(crc)) = (desfire_crc);
 }
@@ -143,13 +143,14 @@ void aes_set_callback(const aes_callback_t callback);
 
 void CryptoAESGetConfigDefaults(CryptoAESConfig_t *ctx);
 void CryptoAESInitContext(CryptoAESConfig_t *ctx);
+void CryptoAESInvalidateKeyCache(void);
 
 int CryptoAESEncryptBuffer(uint16_t Count, uint8_t *Plaintext, uint8_t *Ciphertext,
                            uint8_t *IV, const uint8_t *Key);
 int CryptoAESDecryptBuffer(uint16_t Count, uint8_t *Plaintext, uint8_t *Ciphertext,
                            uint8_t *IV, const uint8_t *Key);
 
-typedef uint8_t (*CryptoAESFuncType)(uint8_t *, uint8_t *, uint8_t *);
+typedef void (*CryptoAESFuncType)(uint8_t *, uint8_t *, const uint8_t *);
 typedef struct {
     CryptoAESFuncType  cryptFunc;
     uint16_t           blockSize;
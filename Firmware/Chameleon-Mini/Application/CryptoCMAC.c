@@ -205,6 +205,19 @@ bool DesfireCryptoCMAC(uint8_t cryptoType, const uint8_t *keyData, uint8_t *buff
 
 //Taken from https://github.com/RfidResearchGroup/proxmark3/blob/master/client/src/mifare/desfirecrypto.c
 bool DesfireCryptoCMACEx(uint8_t cryptoType, const uint8_t *keyData, uint8_t *bufferDataIn, uint16_t bufferSize, uint8_t *IV, uint8_t *cmac, uint16_t minlen) {
+    uint8_t sk1[24] = {0};
+    uint8_t sk2[24] = {0};
+
+    if (!DesfireCMACGenerateSubkeys(cryptoType, keyData, sk1, sk2)) {
+        return false;
+    }
+    return DesfireCryptoCMACSubkeys(cryptoType, keyData, sk1, sk2, bufferDataIn, bufferSize, IV, cmac, minlen);
+}
+
+/* Same as DesfireCryptoCMACEx, but with the subkeys K1 and K2 precomputed by
+ * DesfireCMACGenerateSubkeys, which saves one block encryption per call. */
+bool DesfireCryptoCMACSubkeys(uint8_t cryptoType, const uint8_t *keyData, const uint8_t *sk1, const uint8_t *sk2,
+                              uint8_t *bufferDataIn, uint16_t bufferSize, uint8_t *IV, uint8_t *cmac, uint16_t minlen) {
     uint8_t kbs;
     uint8_t len = bufferSize;
     uint8_t * bufferData = bufferDataIn + bufferSize;
@@ -221,12 +234,6 @@ bool DesfireCryptoCMACEx(uint8_t cryptoType, const uint8_t *keyData, uint8_t *bu
             return false;
     }
 
-
-    uint8_t sk1[24] = {0};
-    uint8_t sk2[24] = {0};
-
-    DesfireCMACGenerateSubkeys(cryptoType, keyData, sk1, sk2);
-
     if ((!len) || (len % kbs) || (len < minlen)) {
         bufferData[len++] = 0x80;
         while (len % kbs || len < minlen) {
@@ -44,5 +44,8 @@ bool checkBufferCMAC(uint8_t *bufferData, uint16_t bufferSize, uint16_t checksum
 
 bool DesfireCryptoCMAC(uint8_t cryptoType, const uint8_t *keyData, uint8_t *bufferDataIn, uint16_t bufferSize, uint8_t *IV, uint8_t *cmac);
 bool DesfireCryptoCMACEx(uint8_t cryptoType, const uint8_t *keyData, uint8_t *bufferDataIn, uint16_t bufferSize, uint8_t *IV, uint8_t *cmac, uint16_t minlen);
+bool DesfireCryptoCMACSubkeys(uint8_t cryptoType, const uint8_t *keyData, const uint8_t *sk1, const uint8_t *sk2,
+                              uint8_t *bufferDataIn, uint16_t bufferSize, uint8_t *IV, uint8_t *cmac, uint16_t minlen);
+bool DesfireCMACGenerateSubkeys(uint8_t cryptoType, const uint8_t *keyData, uint8_t *sk1, uint8_t *sk2);
 
 #endif
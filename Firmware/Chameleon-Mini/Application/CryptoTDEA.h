@@ -53,8 +53,8 @@ typedef uint8_t Crypto3KTDEAKeyType[CRYPTO_3KTDEA_KEY_SIZE];
 typedef void (*CryptoTDEACBCFuncType)(uint16_t Count, const void *Plaintext, void *Ciphertext, void *IV, const uint8_t *Keys);
 typedef void (*CryptoTDEAFuncType)(const void *PlainText, void *Ciphertext, const uint8_t *Keys);
 
-void CryptoEncryptDES(void *Plaintext, void *Ciphertext, const uint8_t *Keys);
-void CryptoDecryptDES(void *Plaintext, void *Ciphertext, const uint8_t *Keys);
+void CryptoEncryptDES(const void *Plaintext, void *Ciphertext, const uint8_t *Keys);
+void CryptoDecryptDES(const void *Plaintext, void *Ciphertext, const uint8_t *Keys);
 int EncryptDESBuffer(uint16_t Count, const void *Plaintext, void *Ciphertext, const uint8_t *IV, const uint8_t *Keys);
 int DecryptDESBuffer(uint16_t Count, void *Plaintext, const void *Ciphertext, const uint8_t *IV, const uint8_t *Keys);
 
@@ -69,8 +69,8 @@ void CryptoDecrypt2KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t
 int Encrypt2K3DESBuffer(uint16_t Count, const void *Plaintext, void *Ciphertext, const uint8_t *IV, const uint8_t *Keys);
 int Decrypt2K3DESBuffer(uint16_t Count, void *Plaintext, const void *Ciphertext, const uint8_t *IV, const uint8_t *Keys);
 
-void CryptoEncrypt3KTDEA(void *Plaintext, void *Ciphertext, const uint8_t *Keys);
-void CryptoDecrypt3KTDEA(void *Plaintext, void *Ciphertext, const uint8_t *Keys);
+void CryptoEncrypt3KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t *Keys);
+void CryptoDecrypt3KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t *Keys);
 int Encrypt3DESBuffer(uint16_t Count, const void *Plaintext, void *Ciphertext, const uint8_t *IV, const uint8_t *Keys);
 int Decrypt3DESBuffer(uint16_t Count, void *Plaintext, const void *Ciphertext, const uint8_t *IV, const uint8_t *Keys);
 
@@ -44,6 +44,136 @@ void SynchronizeAppDir(void) {
     WriteBlockBytes(&AppDir, DESFIRE_APP_DIR_BLOCK_ID, sizeof(DESFireAppDirType));
 }
 
+/*
+ * Application metadata cache: every command looks up the application
+ * structure and one or more of its arrays, which are kept here so that
+ * they are read from FRAM only once after the application is selected.
+ * The cache is write-through, FRAM always holds the current data.
+ */
+
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+
+#define APP_CACHE_INVALID_SLOT              (0xff)
+#define APP_CACHE_KEY_SETTINGS_LOADED       (0x01)
+#define APP_CACHE_FILE_NUMBERS_LOADED       (0x02)
+#define APP_CACHE_ACCESS_RIGHTS_LOADED      (0x04)
+
+typedef struct {
+    uint8_t Slot;
+    uint8_t Loaded;
+    SelectedAppCacheType AppData;
+    BYTE KeySettings[DESFIRE_MAX_KEYS];
+    BYTE FileNumbers[DESFIRE_MAX_FILES];
+    SIZET FileAccessRights[DESFIRE_MAX_FILES];
+} AppCacheEntryType;
+
+static AppCacheEntryType AppCache[DESFIRE_APP_CACHE_ENTRIES];
+static uint8_t AppCacheNextVictim = 0;
+
+static AppCacheEntryType *FindAppCacheEntry(uint8_t AppSlot) {
+    for (uint8_t i = 0; i < DESFIRE_APP_CACHE_ENTRIES; i++) {
+        if (AppCache[i].Slot == AppSlot) {
+            return &AppCache[i];
+        }
+    }
+    return NULL;
+}
+
+static AppCacheEntryType *LoadAppCacheEntry(uint8_t AppSlot) {
+    if (AppSlot >= DESFIRE_MAX_SLOTS || AppDir.AppCacheStructBlockOffset[AppSlot] == 0) {
+        return NULL;
+    }
+    AppCacheEntryType *Entry = FindAppCacheEntry(AppSlot);
+    if (Entry != NULL) {
+        return Entry;
+    }
+    /* Prefer free entries, and never evict the selected application */
+    Entry = FindAppCacheEntry(APP_CACHE_INVALID_SLOT);
+    if (Entry == NULL) {
+        Entry = &AppCache[AppCacheNextVictim];
+        if (Entry->Slot == SelectedApp.Slot && DESFIRE_APP_CACHE_ENTRIES > 1) {
+            AppCacheNextVictim = (AppCacheNextVictim + 1) % DESFIRE_APP_CACHE_ENTRIES;
+            Entry = &AppCache[AppCacheNextVictim];
+        }
+        AppCacheNextVictim = (AppCacheNextVictim + 1) % DESFIRE_APP_CACHE_ENTRIES;
+    }
+    ReadBlockBytes(&(Entry->AppData), AppDir.AppCacheStructBlockOffset[AppSlot], sizeof(SelectedAppCacheType));
+    Entry->Slot = AppSlot;
+    Entry->Loaded = 0;
+    return Entry;
+}
+
+/* Returns the cached copy of one of the application arrays along with the
+ * flag telling whether it has been read from FRAM yet, or NULL for the
+ * arrays which are not cached */
+static void *GetAppCacheArray(AppCacheEntryType *Entry, DesfireCardLayout propId, uint8_t *LoadedFlag) {
+    switch (propId) {
+        case DESFIRE_APP_KEY_SETTINGS_BLOCK_ID:
+            *LoadedFlag = APP_CACHE_KEY_SETTINGS_LOADED;
+            return Entry->KeySettings;
+        case DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID:
+            *LoadedFlag = APP_CACHE_FILE_NUMBERS_LOADED;
+            return Entry->FileNumbers;
+        case DESFIRE_APP_FILE_ACCESS_RIGHTS_BLOCK_ID:
+            *LoadedFlag = APP_CACHE_ACCESS_RIGHTS_LOADED;
+            return Entry->FileAccessRights;
+        default:
+            return NULL;
+    }
+}
+
+#endif /* DESFIRE_APP_CACHE_ENTRIES */
+
+static void InvalidateAppCacheSlot(uint8_t AppSlot) {
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    AppCacheEntryType *Entry = FindAppCacheEntry(AppSlot);
+    if (Entry != NULL) {
+        Entry->Slot = APP_CACHE_INVALID_SLOT;
+    }
+#endif
+}
+
+void InvalidateAppCache(void) {
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    for (uint8_t i = 0; i < DESFIRE_APP_CACHE_ENTRIES; i++) {
+        AppCache[i].Slot = APP_CACHE_INVALID_SLOT;
+    }
+    AppCacheNextVictim = 0;
+#endif
+}
+
+/* Reads (or writes through) one of the per application arrays, whose block
+ * offset is stored in the application structure under propId */
+static void ReadAppArray(uint8_t AppSlot, DesfireCardLayout propId, void *Buffer, SIZET ByteCount) {
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    AppCacheEntryType *Entry = LoadAppCacheEntry(AppSlot);
+    uint8_t LoadedFlag;
+    void *CachedArray = (Entry != NULL) ? GetAppCacheArray(Entry, propId, &LoadedFlag) : NULL;
+    if (CachedArray != NULL) {
+        if (!(Entry->Loaded & LoadedFlag)) {
+            ReadBlockBytes(CachedArray, GetAppProperty(propId, AppSlot), ByteCount);
+            Entry->Loaded |= LoadedFlag;
+        }
+        memcpy(Buffer, CachedArray, ByteCount);
+        return;
+    }
+#endif
+    ReadBlockBytes(Buffer, GetAppProperty(propId, AppSlot), ByteCount);
+}
+
+static void WriteAppArray(uint8_t AppSlot, DesfireCardLayout propId, const void *Buffer, SIZET ByteCount) {
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    AppCacheEntryType *Entry = LoadAppCacheEntry(AppSlot);
+    uint8_t LoadedFlag;
+    void *CachedArray = (Entry != NULL) ? GetAppCacheArray(Entry, propId, &LoadedFlag) : NULL;
+    if (CachedArray != NULL) {
+        memcpy(CachedArray, Buffer, ByteCount);
+        Entry->Loaded |= LoadedFlag;
+    }
+#endif
+    WriteBlockBytes(Buffer, GetAppProperty(propId, AppSlot), ByteCount);
+}
+
 BYTE PMKConfigurationChangeable(void) {
     BYTE pmkSettings = ReadKeySettings(DESFIRE_PICC_APP_SLOT, DESFIRE_MASTER_KEY_ID);
     BYTE pmkPropMask = (0x01 << 3);
@@ -121,11 +251,15 @@ BYTE AMKAllKeysFrozen(void) {
 }
 
 SIZET GetAppProperty(DesfireCardLayout propId, BYTE AppSlot) {
-    if (AppSlot >= AppDir.FirstFreeSlot || AppSlot >= DESFIRE_MAX_SLOTS) {
+    if (AppSlot >= DESFIRE_MAX_SLOTS || AppDir.AppCacheStructBlockOffset[AppSlot] == 0) {
         return 0x00;
     }
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    SelectedAppCacheType appCache = LoadAppCacheEntry(AppSlot)->AppData;
+#else
     SelectedAppCacheType appCache;
     ReadBlockBytes(&appCache, AppDir.AppCacheStructBlockOffset[AppSlot], sizeof(SelectedAppCacheType));
+#endif
     switch (propId) {
         case DESFIRE_APP_KEY_COUNT:
             return appCache.KeyCount;
@@ -157,11 +291,16 @@ SIZET GetAppProperty(DesfireCardLayout propId, BYTE AppSlot) {
 }
 
 void SetAppProperty(DesfireCardLayout propId, BYTE AppSlot, SIZET Value) {
-    if (AppSlot >= AppDir.FirstFreeSlot || AppSlot >= DESFIRE_MAX_SLOTS) {
+    if (AppSlot >= DESFIRE_MAX_SLOTS || AppDir.AppCacheStructBlockOffset[AppSlot] == 0) {
         return;
     }
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    AppCacheEntryType *Entry = LoadAppCacheEntry(AppSlot);
+    SelectedAppCacheType appCache = Entry->AppData;
+#else
     SelectedAppCacheType appCache;
     ReadBlockBytes(&appCache, AppDir.AppCacheStructBlockOffset[AppSlot], sizeof(SelectedAppCacheType));
+#endif
     switch (propId) {
         case DESFIRE_APP_KEY_COUNT:
             appCache.KeyCount = ExtractLSBBE(Value);
@@ -199,6 +338,14 @@ void SetAppProperty(DesfireCardLayout propId, BYTE AppSlot, SIZET Value) {
         default:
             return;
     }
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    Entry->AppData = appCache;
+    if (propId != DESFIRE_APP_KEY_COUNT && propId != DESFIRE_APP_FILE_COUNT &&
+            propId != DESFIRE_APP_CRYPTO_COMM_STANDARD) {
+        /* One of the arrays has moved */
+        Entry->Loaded = 0;
+    }
+#endif
     WriteBlockBytes(&appCache, AppDir.AppCacheStructBlockOffset[AppSlot], sizeof(SelectedAppCacheType));
 }
 
@@ -231,9 +378,8 @@ BYTE ReadKeySettings(uint8_t AppSlot, uint8_t KeyId) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || KeyId >= DESFIRE_MAX_KEYS) {
         return 0x00;
     }
-    SIZET keySettingsBlockId = GetAppProperty(DESFIRE_APP_KEY_SETTINGS_BLOCK_ID, AppSlot);
     BYTE keySettingsArray[DESFIRE_MAX_KEYS];
-    ReadBlockBytes(keySettingsArray, keySettingsBlockId, DESFIRE_MAX_KEYS);
+    ReadAppArray(AppSlot, DESFIRE_APP_KEY_SETTINGS_BLOCK_ID, keySettingsArray, DESFIRE_MAX_KEYS);
     return keySettingsArray[KeyId];
 }
 
@@ -241,20 +387,18 @@ void WriteKeySettings(uint8_t AppSlot, uint8_t KeyId, BYTE Value) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || KeyId >= DESFIRE_MAX_KEYS) {
         return;
     }
-    SIZET keySettingsBlockId = GetAppProperty(DESFIRE_APP_KEY_SETTINGS_BLOCK_ID, AppSlot);
     BYTE keySettingsArray[DESFIRE_MAX_KEYS];
-    ReadBlockBytes(keySettingsArray, keySettingsBlockId, DESFIRE_MAX_KEYS);
+    ReadAppArray(AppSlot, DESFIRE_APP_KEY_SETTINGS_BLOCK_ID, keySettingsArray, DESFIRE_MAX_KEYS);
     keySettingsArray[KeyId] = Value;
-    WriteBlockBytes(keySettingsArray, keySettingsBlockId, DESFIRE_MAX_KEYS);
+    WriteAppArray(AppSlot, DESFIRE_APP_KEY_SETTINGS_BLOCK_ID, keySettingsArray, DESFIRE_MAX_KEYS);
 }
 
 BYTE ReadKeyVersion(uint8_t AppSlot, uint8_t KeyId) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || KeyId >= DESFIRE_MAX_KEYS) {
         return 0x00;
     }
-    SIZET keyVersionsBlockId = GetAppProperty(DESFIRE_APP_KEY_VERSIONS_ARRAY_BLOCK_ID, AppSlot);
     BYTE keyVersionsArray[DESFIRE_MAX_KEYS];
-    ReadBlockBytes(keyVersionsArray, keyVersionsBlockId, DESFIRE_MAX_KEYS);
+    ReadAppArray(AppSlot, DESFIRE_APP_KEY_VERSIONS_ARRAY_BLOCK_ID, keyVersionsArray, DESFIRE_MAX_KEYS);
     return keyVersionsArray[KeyId];
 }
 
@@ -262,20 +406,18 @@ void WriteKeyVersion(uint8_t AppSlot, uint8_t KeyId, BYTE Value) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || KeyId >= DESFIRE_MAX_KEYS) {
         return;
     }
-    SIZET keyVersionsBlockId = GetAppProperty(DESFIRE_APP_KEY_VERSIONS_ARRAY_BLOCK_ID, AppSlot);
     BYTE keyVersionsArray[DESFIRE_MAX_KEYS];
-    ReadBlockBytes(keyVersionsArray, keyVersionsBlockId, DESFIRE_MAX_KEYS);
+    ReadAppArray(AppSlot, DESFIRE_APP_KEY_VERSIONS_ARRAY_BLOCK_ID, keyVersionsArray, DESFIRE_MAX_KEYS);
     keyVersionsArray[KeyId] = Value;
-    WriteBlockBytes(keyVersionsArray, keyVersionsBlockId, DESFIRE_MAX_KEYS);
+    WriteAppArray(AppSlot, DESFIRE_APP_KEY_VERSIONS_ARRAY_BLOCK_ID, keyVersionsArray, DESFIRE_MAX_KEYS);
 }
 
 BYTE ReadKeyCryptoType(uint8_t AppSlot, uint8_t KeyId) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || !KeyIdValid(AppSlot, KeyId)) {
         return 0x00;
     }
-    SIZET keyTypesBlockId = GetAppProperty(DESFIRE_APP_KEY_TYPES_ARRAY_BLOCK_ID, AppSlot);
     BYTE keyTypesArray[DESFIRE_MAX_KEYS];
-    ReadBlockBytes(keyTypesArray, keyTypesBlockId, DESFIRE_MAX_KEYS);
+    ReadAppArray(AppSlot, DESFIRE_APP_KEY_TYPES_ARRAY_BLOCK_ID, keyTypesArray, DESFIRE_MAX_KEYS);
     return keyTypesArray[KeyId];
 }
 
@@ -283,11 +425,10 @@ void WriteKeyCryptoType(uint8_t AppSlot, uint8_t KeyId, BYTE Value) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || !KeyIdValid(AppSlot, KeyId)) {
         return 0x00;
     }
-    SIZET keyTypesBlockId = GetAppProperty(DESFIRE_APP_KEY_TYPES_ARRAY_BLOCK_ID, AppSlot);
     BYTE keyTypesArray[DESFIRE_MAX_KEYS];
-    ReadBlockBytes(keyTypesArray, keyTypesBlockId, DESFIRE_MAX_KEYS);
+    ReadAppArray(AppSlot, DESFIRE_APP_KEY_TYPES_ARRAY_BLOCK_ID, keyTypesArray, DESFIRE_MAX_KEYS);
     keyTypesArray[KeyId] = Value;
-    WriteBlockBytes(keyTypesArray, keyTypesBlockId, DESFIRE_MAX_KEYS);
+    WriteAppArray(AppSlot, DESFIRE_APP_KEY_TYPES_ARRAY_BLOCK_ID, keyTypesArray, DESFIRE_MAX_KEYS);
 }
 
 SIZET ReadKeyStorageAddress(uint8_t AppSlot) {
@@ -342,9 +483,8 @@ BYTE LookupFileNumberIndex(uint8_t AppSlot, BYTE FileNumber) {
     if (AppSlot >= DESFIRE_MAX_SLOTS) {
         return DESFIRE_MAX_FILES;
     }
-    SIZET fileNumbersHashmapBlockId = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, AppSlot);
     BYTE fileNumbersHashmap[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileNumbersHashmap, fileNumbersHashmapBlockId, DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, fileNumbersHashmap, DESFIRE_MAX_FILES);
     BYTE fileIndex;
     for (fileIndex = 0; fileIndex < DESFIRE_MAX_FILES; fileIndex++) {
         if (fileNumbersHashmap[fileIndex] == FileNumber) {
@@ -360,9 +500,8 @@ BYTE LookupFileNumberByIndex(uint8_t AppSlot, BYTE FileIndex) {
     } else if (FileIndex >= DESFIRE_MAX_FILES) {
         return DESFIRE_MAX_FILES;
     }
-    SIZET fileNumbersHashmapBlockId = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, AppSlot);
     BYTE fileNumbersHashmap[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileNumbersHashmap, fileNumbersHashmapBlockId, DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, fileNumbersHashmap, DESFIRE_MAX_FILES);
     return fileNumbersHashmap[FileIndex];
 }
 
@@ -370,9 +509,8 @@ BYTE LookupNextFreeFileSlot(uint8_t AppSlot) {
     if (AppSlot >= DESFIRE_MAX_SLOTS) {
         return;
     }
-    SIZET fileNumbersHashmapBlockId = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, AppSlot);
     BYTE fileNumbersHashmap[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileNumbersHashmap, fileNumbersHashmapBlockId, DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, fileNumbersHashmap, DESFIRE_MAX_FILES);
     uint8_t nextFreeSlot;
     for (nextFreeSlot = 0; nextFreeSlot < DESFIRE_MAX_FILES; ++nextFreeSlot) {
         if (fileNumbersHashmap[nextFreeSlot] == DESFIRE_FILE_NOFILE_INDEX) {
@@ -382,15 +520,18 @@ BYTE LookupNextFreeFileSlot(uint8_t AppSlot) {
     return nextFreeSlot;
 }
 
+void ReadFileNumbersArray(uint8_t AppSlot, BYTE *FileNumbers) {
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, FileNumbers, DESFIRE_MAX_FILES);
+}
+
 void WriteFileNumberAtIndex(uint8_t AppSlot, uint8_t FileIndex, BYTE FileNumber) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || FileIndex >= DESFIRE_MAX_FILES) {
         return;
     }
-    SIZET fileNumbersHashmapBlockId = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, AppSlot);
     BYTE fileNumbersHashmap[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileNumbersHashmap, fileNumbersHashmapBlockId, DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, fileNumbersHashmap, DESFIRE_MAX_FILES);
     fileNumbersHashmap[FileIndex] = FileNumber;
-    WriteBlockBytes(fileNumbersHashmap, fileNumbersHashmapBlockId, DESFIRE_MAX_FILES);
+    WriteAppArray(AppSlot, DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, fileNumbersHashmap, DESFIRE_MAX_FILES);
 }
 
 SIZET ReadFileDataStructAddress(uint8_t AppSlot, uint8_t FileIndex) {
@@ -427,9 +568,8 @@ BYTE ReadFileCommSettings(uint8_t AppSlot, uint8_t FileIndex) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || FileIndex >= DESFIRE_MAX_FILES) {
         return 0x00;
     }
-    SIZET fileCommSettingsBlockId = GetAppProperty(DESFIRE_APP_FILE_COMM_SETTINGS_BLOCK_ID, AppSlot);
     BYTE fileCommSettingsArray[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileCommSettingsArray, fileCommSettingsBlockId, DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_COMM_SETTINGS_BLOCK_ID, fileCommSettingsArray, DESFIRE_MAX_FILES);
     return fileCommSettingsArray[FileIndex];
 }
 
@@ -437,20 +577,18 @@ void WriteFileCommSettings(uint8_t AppSlot, uint8_t FileIndex, BYTE CommSettings
     if (AppSlot >= DESFIRE_MAX_SLOTS || FileIndex >= DESFIRE_MAX_FILES) {
         return;
     }
-    SIZET fileCommSettingsBlockId = GetAppProperty(DESFIRE_APP_FILE_COMM_SETTINGS_BLOCK_ID, AppSlot);
     BYTE fileCommSettingsArray[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileCommSettingsArray, fileCommSettingsBlockId, DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_COMM_SETTINGS_BLOCK_ID, fileCommSettingsArray, DESFIRE_MAX_FILES);
     fileCommSettingsArray[FileIndex] = CommSettings;
-    WriteBlockBytes(fileCommSettingsArray, fileCommSettingsBlockId, DESFIRE_MAX_FILES);
+    WriteAppArray(AppSlot, DESFIRE_APP_FILE_COMM_SETTINGS_BLOCK_ID, fileCommSettingsArray, DESFIRE_MAX_FILES);
 }
 
 SIZET ReadFileAccessRights(uint8_t AppSlot, uint8_t FileIndex) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || FileIndex >= DESFIRE_MAX_FILES) {
         return 0x0000;
     }
-    SIZET fileAccessRightsBlockId = GetAppProperty(DESFIRE_APP_FILE_ACCESS_RIGHTS_BLOCK_ID, AppSlot);
     SIZET fileAccessRightsArray[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileAccessRightsArray, fileAccessRightsBlockId, 2 * DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_ACCESS_RIGHTS_BLOCK_ID, fileAccessRightsArray, 2 * DESFIRE_MAX_FILES);
     return fileAccessRightsArray[FileIndex];
 }
 
@@ -458,11 +596,10 @@ void WriteFileAccessRights(uint8_t AppSlot, uint8_t FileIndex, SIZET AccessRight
     if (AppSlot >= DESFIRE_MAX_SLOTS || FileIndex >= DESFIRE_MAX_FILES) {
         return;
     }
-    SIZET fileAccessRightsBlockId = GetAppProperty(DESFIRE_APP_FILE_ACCESS_RIGHTS_BLOCK_ID, AppSlot);
     SIZET fileAccessRightsArray[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileAccessRightsArray, fileAccessRightsBlockId, 2 * DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILE_ACCESS_RIGHTS_BLOCK_ID, fileAccessRightsArray, 2 * DESFIRE_MAX_FILES);
     fileAccessRightsArray[FileIndex] = AccessRights;
-    WriteBlockBytes(fileAccessRightsArray, fileAccessRightsBlockId, 2 * DESFIRE_MAX_FILES);
+    WriteAppArray(AppSlot, DESFIRE_APP_FILE_ACCESS_RIGHTS_BLOCK_ID, fileAccessRightsArray, 2 * DESFIRE_MAX_FILES);
 }
 
 DESFireFileTypeSettings ReadFileSettings(uint8_t AppSlot, uint8_t FileIndex) {
@@ -470,9 +607,8 @@ DESFireFileTypeSettings ReadFileSettings(uint8_t AppSlot, uint8_t FileIndex) {
     if (AppSlot >= DESFIRE_MAX_SLOTS || FileIndex >= DESFIRE_MAX_FILES) {
         return fileTypeSettings;
     }
-    SIZET fileTypeSettingsBlockId = GetAppProperty(DESFIRE_APP_FILES_PTR_BLOCK_ID, AppSlot);
     SIZET fileTypeSettingsAddresses[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileTypeSettingsAddresses, fileTypeSettingsBlockId, 2 * DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILES_PTR_BLOCK_ID, fileTypeSettingsAddresses, 2 * DESFIRE_MAX_FILES);
     ReadBlockBytes(&fileTypeSettings, fileTypeSettingsAddresses[FileIndex], sizeof(DESFireFileTypeSettings));
     return fileTypeSettings;
 }
@@ -483,9 +619,8 @@ void WriteFileSettings(uint8_t AppSlot, uint8_t FileIndex, DESFireFileTypeSettin
     } else if (FileSettings == NULL) {
         return;
     }
-    SIZET fileTypeSettingsBlockId = GetAppProperty(DESFIRE_APP_FILES_PTR_BLOCK_ID, AppSlot);
     SIZET fileTypeSettingsAddresses[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileTypeSettingsAddresses, fileTypeSettingsBlockId, 2 * DESFIRE_MAX_FILES);
+    ReadAppArray(AppSlot, DESFIRE_APP_FILES_PTR_BLOCK_ID, fileTypeSettingsAddresses, 2 * DESFIRE_MAX_FILES);
     WriteBlockBytes(FileSettings, fileTypeSettingsAddresses[FileIndex], sizeof(DESFireFileTypeSettings));
     memcpy(&(SelectedFile.File), FileSettings, sizeof(DESFireFileTypeSettings));
 }
@@ -515,8 +650,24 @@ void SelectAppBySlot(uint8_t AppSlot) {
     if (SelectedApp.Slot != (uint8_t) -1) {
         SIZET prevAppCacheSelectedBlockId = AppDir.AppCacheStructBlockOffset[SelectedApp.Slot];
         WriteBlockBytes(&SelectedApp, prevAppCacheSelectedBlockId, sizeof(SelectedAppCacheType));
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+        AppCacheEntryType *PrevEntry = FindAppCacheEntry(SelectedApp.Slot);
+        if (PrevEntry != NULL && memcmp(&(PrevEntry->AppData), &SelectedApp, sizeof(SelectedAppCacheType))) {
+            PrevEntry->AppData = SelectedApp;
+            PrevEntry->Loaded = 0;
+        }
+#endif
+    }
+#if DESFIRE_APP_CACHE_ENTRIES > 0
+    AppCacheEntryType *Entry = LoadAppCacheEntry(AppSlot);
+    if (Entry != NULL) {
+        SelectedApp = Entry->AppData;
+    } else {
+        ReadBlockBytes(&SelectedApp, appCacheSelectedBlockId, sizeof(SelectedAppCacheType));
     }
+#else
     ReadBlockBytes(&SelectedApp, appCacheSelectedBlockId, sizeof(SelectedAppCacheType));
+#endif
     SelectedApp.Slot = AppSlot;
     SynchronizeAppDir();
 }
@@ -586,6 +737,8 @@ uint16_t CreateApp(const DESFireAidType Aid, uint8_t KeyCount, uint8_t KeySettin
             break;
     }
 
+    /* The slot may hold the cached metadata of a deleted application */
+    InvalidateAppCacheSlot(Slot);
     /* Allocate storage for the application structure itself */
     AppDir.AppCacheStructBlockOffset[Slot] = AllocateBlocks(SELECTED_APP_CACHE_TYPE_BLOCK_SIZE);
     if (AppDir.AppCacheStructBlockOffset[Slot] == 0) {
@@ -696,6 +849,49 @@ uint16_t CreateApp(const DESFireAidType Aid, uint8_t KeyCount, uint8_t KeySettin
     return STATUS_OPERATION_OK;
 }
 
+/* Returns the blocks of an application, latest allocations first. Freeing
+ * may compact the storage, which fixes up the block ids of every linked
+ * application and file, so each file is unlinked before it is freed and
+ * the block ids are read again for the next one. */
+static void FreeAppStorage(uint8_t Slot) {
+    SelectedAppCacheType appData;
+    SIZET fileAddresses[DESFIRE_MAX_FILES];
+    for (uint8_t fidx = DESFIRE_MAX_FILES; fidx > 0; fidx--) {
+        if (!GetAppData(Slot, &appData)) {
+            return;
+        }
+        ReadBlockBytes(fileAddresses, appData.FilesAddress, sizeof(SIZET) * DESFIRE_MAX_FILES);
+        SIZET fileStructBlockId = fileAddresses[fidx - 1];
+        if (fileStructBlockId == 0) {
+            continue;
+        }
+        fileAddresses[fidx - 1] = 0;
+        WriteBlockBytes(fileAddresses, appData.FilesAddress, sizeof(SIZET) * DESFIRE_MAX_FILES);
+        FreeFileStorage(fileStructBlockId);
+    }
+    if (!GetAppData(Slot, &appData)) {
+        return;
+    }
+    SIZET keyAddresses[DESFIRE_MAX_KEYS];
+    ReadBlockBytes(keyAddresses, appData.KeyAddress, sizeof(SIZET) * DESFIRE_MAX_KEYS);
+    DESFireFreeExtentType Extents[DESFIRE_MAX_KEYS + 9];
+    uint8_t ExtentCount = 0;
+    for (uint8_t kidx = DESFIRE_MAX_KEYS; kidx > 0; kidx--) {
+        Extents[ExtentCount++] = (DESFireFreeExtentType) { keyAddresses[kidx - 1], APP_CACHE_MAX_KEY_BLOCK_SIZE };
+    }
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.KeyAddress, APP_CACHE_KEY_BLOCKIDS_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.FilesAddress, APP_CACHE_FILE_BLOCKIDS_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.KeyTypesArray, APP_CACHE_KEY_TYPES_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.KeyVersionsArray, APP_CACHE_KEY_VERSIONS_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.FileAccessRights, APP_CACHE_FILE_ACCESS_RIGHTS_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.FileCommSettings, APP_CACHE_FILE_COMM_SETTINGS_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.FileNumbersArrayMap, APP_CACHE_FILE_NUMBERS_HASHMAP_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { appData.KeySettings, APP_CACHE_KEY_SETTINGS_ARRAY_BLOCK_SIZE };
+    Extents[ExtentCount++] = (DESFireFreeExtentType) { AppDir.AppCacheStructBlockOffset[Slot], SELECTED_APP_CACHE_TYPE_BLOCK_SIZE };
+    AppDir.AppCacheStructBlockOffset[Slot] = 0;
+    FreeBlockExtents(Extents, ExtentCount);
+}
+
 uint16_t DeleteApp(const DESFireAidType Aid) {
     uint8_t Slot;
     /* Search for the app slot */
@@ -709,10 +905,14 @@ uint16_t DeleteApp(const DESFireAidType Aid) {
     }
     AppDir.FirstFreeSlot = MIN(Slot, AppDir.FirstFreeSlot);
     SynchronizeAppDir();
+    InvalidateAppCacheSlot(Slot);
     if (!IsPiccAppSelected()) {
         InvalidateAuthState(0);
     }
     SelectAppBySlot(DESFIRE_PICC_APP_SLOT);
+    /* Only now, selecting the PICC app may have written back the deleted one */
+    FreeAppStorage(Slot);
+    SynchronizeAppDir();
     return STATUS_OPERATION_OK;
 }
 
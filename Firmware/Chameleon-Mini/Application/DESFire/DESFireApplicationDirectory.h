@@ -67,6 +67,19 @@ This notice must be retained at the top of all source files where indicated.
 #endif
 #endif
 
+/* Number of applications whose metadata (the application structure, the key
+ * settings, the file number map and the file access rights) is kept in SRAM.
+ * Two entries hold the selected application and the PICC master application.
+ * Each entry takes 23 + DESFIRE_MAX_KEYS + 3 * DESFIRE_MAX_FILES bytes;
+ * define it to 0 to always go to FRAM. */
+#ifndef DESFIRE_APP_CACHE_ENTRIES
+#ifdef MEMORY_LIMITED_TESTING
+#define DESFIRE_APP_CACHE_ENTRIES              (1)
+#else
+#define DESFIRE_APP_CACHE_ENTRIES              (2)
+#endif
+#endif
+
 /* Mifare DESFire EV1 Application crypto operations */
 #define APPLICATION_CRYPTO_DES    0x00
 #define APPLICATION_CRYPTO_3K3DES 0x40
@@ -143,6 +156,7 @@ BYTE AMKAllKeysFrozen(void);
 /* Application data management */
 SIZET GetAppProperty(DesfireCardLayout propId, BYTE AppSlot);
 void SetAppProperty(DesfireCardLayout propId, BYTE AppSlot, SIZET Value);
+void InvalidateAppCache(void);
 
 /* Application key management */
 bool KeyIdValid(uint8_t AppSlot, uint8_t KeyId);
@@ -166,6 +180,7 @@ void WriteFileCount(uint8_t AppSlot, BYTE FileCount);
 BYTE LookupFileNumberIndex(uint8_t AppSlot, BYTE FileNumber);
 BYTE LookupFileNumberByIndex(uint8_t AppSlot, BYTE FileIndex);
 BYTE LookupNextFreeFileSlot(uint8_t AppSlot);
+void ReadFileNumbersArray(uint8_t AppSlot, BYTE *FileNumbers);
 void WriteFileNumberAtIndex(uint8_t AppSlot, uint8_t FileIndex, BYTE FileNumber);
 SIZET ReadFileDataStructAddress(uint8_t AppSlot, uint8_t FileIndex);
 uint8_t ReadFileType(uint8_t AppSlot, uint8_t FileIndex);
@@ -42,6 +42,9 @@ This notice must be retained at the top of all source files where indicated.
 CryptoKeyBufferType SessionKey = { 0 };
 CryptoIVBufferType SessionIV = { 0 };
 BYTE SessionIVByteSize = 0;
+CryptoIVBufferType SessionCMACSubKey1 = { 0 };
+CryptoIVBufferType SessionCMACSubKey2 = { 0 };
+uint8_t SessionCMACSubKeysType = CRYPTO_TYPE_ANY;
 BYTE DesfireCommMode = DESFIRE_DEFAULT_COMMS_STANDARD;
 
 uint16_t AESCryptoKeySizeBytes = 0;
@@ -61,6 +64,7 @@ void InvalidateAuthState(BYTE keepPICCAuthData) {
 
     memset(&SessionIV[0], 0x00, CRYPTO_MAX_BLOCK_SIZE);
     SessionIVByteSize = 0;
+    InvalidateSessionCMACSubKeys();
 
     Authenticated = false;
     AuthenticatedWithKey = DESFIRE_NOT_AUTHENTICATED;
@@ -134,6 +138,30 @@ bool generateSessionKey(uint8_t *sessionKey, uint8_t *rndA, uint8_t *rndB, uint1
     return true;
 }
 
+/* The CMAC subkeys only depend on the session key, so they are derived once
+ * per authentication instead of once per secure messaging frame. */
+void GenerateSessionCMACSubKeys(uint8_t cryptoType) {
+    if (DesfireCMACGenerateSubkeys(cryptoType, SessionKey, SessionCMACSubKey1, SessionCMACSubKey2)) {
+        SessionCMACSubKeysType = cryptoType;
+    } else {
+        InvalidateSessionCMACSubKeys();
+    }
+}
+
+void InvalidateSessionCMACSubKeys(void) {
+    memset(&SessionCMACSubKey1[0], 0x00, CRYPTO_MAX_BLOCK_SIZE);
+    memset(&SessionCMACSubKey2[0], 0x00, CRYPTO_MAX_BLOCK_SIZE);
+    SessionCMACSubKeysType = CRYPTO_TYPE_ANY;
+}
+
+bool DesfireSessionCMAC(uint8_t cryptoType, uint8_t *bufferData, uint16_t bufferSize, uint8_t *cmac) {
+    if (SessionCMACSubKeysType != cryptoType) {
+        GenerateSessionCMACSubKeys(cryptoType);
+    }
+    return DesfireCryptoCMACSubkeys(cryptoType, SessionKey, SessionCMACSubKey1, SessionCMACSubKey2,
+                                    bufferData, bufferSize, SessionIV, cmac, 0);
+}
+
 BYTE GetCryptoKeyTypeFromAuthenticateMethod(BYTE authCmdMethod) {
     switch (authCmdMethod) {
         case CMD_AUTHENTICATE_AES:
@@ -153,6 +181,7 @@ BYTE GetCryptoKeyTypeFromAuthenticateMethod(BYTE authCmdMethod) {
 void InitAESCryptoKeyData(void) {
     memset(&SessionKey[0], 0x00, CRYPTO_MAX_KEY_SIZE);
     memset(&SessionIV[0], 0x00, CRYPTO_MAX_BLOCK_SIZE);
+    InvalidateSessionCMACSubKeys();
 }
 
 #endif /* CONFIG_MF_DESFIRE_SUPPORT */
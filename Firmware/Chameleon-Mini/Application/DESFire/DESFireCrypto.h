@@ -76,6 +76,12 @@ extern CryptoKeyBufferType SessionKey;
 extern CryptoIVBufferType SessionIV;
 extern BYTE SessionIVByteSize;
 
+/* CMAC subkeys K1 and K2 of the session key, valid for the crypto type in
+ * SessionCMACSubKeysType (CRYPTO_TYPE_ANY if not derived) */
+extern CryptoIVBufferType SessionCMACSubKey1;
+extern CryptoIVBufferType SessionCMACSubKey2;
+extern uint8_t SessionCMACSubKeysType;
+
 extern bool    Authenticated;
 extern uint8_t AuthenticatedWithKey;
 extern bool    AuthenticatedWithPICCMasterKey;
@@ -95,6 +101,10 @@ BYTE GetCryptoMethodCommSettings(uint8_t cryptoType);
 
 bool generateSessionKey(uint8_t *sessionKey, uint8_t *rndA, uint8_t *rndB, uint16_t cryptoType);
 
+void GenerateSessionCMACSubKeys(uint8_t cryptoType);
+void InvalidateSessionCMACSubKeys(void);
+bool DesfireSessionCMAC(uint8_t cryptoType, uint8_t *bufferData, uint16_t bufferSize, uint8_t *cmac);
+
 #define DESFIRE_MAC_LENGTH          4
 #define DESFIRE_CMAC_LENGTH         8    // in bytes
 
@@ -35,6 +35,7 @@ This notice must be retained at the top of all source files where indicated.
 #include "DESFireMemoryOperations.h"
 #include "DESFireInstructions.h"
 #include "DESFireApplicationDirectory.h"
+#include "DESFireTransactionJournal.h"
 
 uint16_t GetFileSizeFromFileType(DESFireFileTypeSettings *File) {
     if (File == NULL) {
@@ -56,6 +57,16 @@ uint16_t GetFileSizeFromFileType(DESFireFileTypeSettings *File) {
     return 0x0000;
 }
 
+/* Backup files keep the data written in a transaction in a second copy
+ * behind the committed one */
+uint16_t GetFileDataBlockCount(DESFireFileTypeSettings *File) {
+    uint16_t BlockCount = DESFIRE_BYTES_TO_BLOCKS(File->FileSize);
+    if (File->FileType == DESFIRE_FILE_BACKUP_DATA) {
+        BlockCount *= 2;
+    }
+    return BlockCount;
+}
+
 /*
  * File management: creation, deletion, and misc routines
  */
@@ -66,7 +77,7 @@ uint16_t GetFileDataAreaBlockId(uint8_t fileIndex) {
         return 0;
     }
     DESFireFileTypeSettings FileData;
-    MemoryReadBlock(&FileData, fileStructAddr, sizeof(DESFireFileTypeSettings));
+    ReadBlockBytes(&FileData, fileStructAddr, sizeof(DESFireFileTypeSettings));
     return FileData.FileDataAddress;
 }
 
@@ -124,7 +135,7 @@ uint8_t CreateFileHeaderData(uint8_t FileNum, uint8_t CommSettings,
         return STATUS_OUT_OF_EEPROM_ERROR;
     } else {
         if (File->FileSize > 0) {
-            File->FileDataAddress = AllocateBlocks(DESFIRE_BYTES_TO_BLOCKS(File->FileSize));
+            File->FileDataAddress = AllocateBlocks(GetFileDataBlockCount(File));
             if (File->FileDataAddress == 0) {
                 return STATUS_OUT_OF_EEPROM_ERROR;
             }
@@ -233,11 +244,28 @@ uint8_t CreateRecordFile(uint8_t FileType, uint8_t FileNum, uint8_t CommSettings
     return STATUS_OPERATION_OK;
 }
 
+void FreeFileStorage(SIZET FileStructBlockId) {
+    if (FileStructBlockId == 0) {
+        return;
+    }
+    DESFireFileTypeSettings FileData;
+    ReadBlockBytes(&FileData, FileStructBlockId, sizeof(DESFireFileTypeSettings));
+    DESFireFreeExtentType Extents[] = {
+        { FileData.FileDataAddress, GetFileDataBlockCount(&FileData) },
+        { FileStructBlockId, DESFIRE_BYTES_TO_BLOCKS(sizeof(DESFireFileTypeSettings)) },
+    };
+    FreeBlockExtents(Extents, ARRAY_COUNT(Extents));
+}
+
 uint8_t DeleteFile(uint8_t fileIndex) {
     if (fileIndex >= DESFIRE_MAX_FILES) {
         return STATUS_FILE_NOT_FOUND;
     } else if (SelectedApp.FileCount == 0x00) {
         return STATUS_APP_COUNT_ERROR;
+    } else if (TransactionJournal.State == DESFIRE_JOURNAL_OPEN) {
+        /* The journal holds byte addresses into the files of the
+         * application, which freeing and compacting would move */
+        return STATUS_PERMISSION_DENIED;
     }
     WriteFileNumberAtIndex(SelectedApp.Slot, fileIndex, DESFIRE_FILE_NOFILE_INDEX);
     WriteFileCommSettings(SelectedApp.Slot, fileIndex, 0x00);
@@ -245,9 +273,12 @@ uint8_t DeleteFile(uint8_t fileIndex) {
     SIZET fileAddressArray[DESFIRE_MAX_FILES];
     SIZET fileAddressBlockId = GetAppProperty(DESFIRE_APP_FILES_PTR_BLOCK_ID, SelectedApp.Slot);
     ReadBlockBytes(fileAddressArray, fileAddressBlockId, 2 * DESFIRE_MAX_FILES);
+    SIZET fileStructBlockId = fileAddressArray[fileIndex];
     fileAddressArray[fileIndex] = 0;
     WriteBlockBytes(fileAddressArray, fileAddressBlockId, 2 * DESFIRE_MAX_FILES);
     WriteFileCount(SelectedApp.Slot, --(SelectedApp.FileCount));
+    /* Freeing may compact the storage, which moves the blocks above */
+    FreeFileStorage(fileStructBlockId);
     return STATUS_OPERATION_OK;
 }
 
@@ -263,6 +294,7 @@ uint8_t WriteDataFileTransfer(uint8_t *Buffer, uint8_t ByteCount) {
 
 uint8_t ReadDataFileSetup(uint8_t FileIndex, uint8_t CommSettings, uint16_t Offset, uint16_t Length) {
     memset(&TransferState, PICC_EMPTY_BYTE, sizeof(TransferState));
+    InvalidateTransferPrefetch();
     uint16_t fileSize = ReadDataFileSize(SelectedApp.Slot, FileIndex);
     /* Setup data source */
     TransferState.ReadData.Source.Func = &ReadDataEEPROMSource;
@@ -272,7 +304,7 @@ uint8_t ReadDataFileSetup(uint8_t FileIndex, uint8_t CommSettings, uint16_t Offs
         TransferState.ReadData.BytesLeft = Length;
     }
     /* Clean data is always located in the beginning of data area */
-    TransferState.ReadData.Source.Pointer = GetFileDataAreaBlockId(FileIndex);
+    TransferState.ReadData.Source.Pointer = GetFileDataAreaBlockId(FileIndex) * DESFIRE_BLOCK_SIZE + Offset;
     /* Setup data filter */
     return ReadDataFilterSetup(CommSettings);
 }
@@ -284,10 +316,19 @@ uint8_t WriteDataFileSetup(uint8_t FileIndex, uint8_t FileType, uint8_t CommSett
     if (Offset + Length > fileSize) {
         return STATUS_BOUNDARY_ERROR;
     }
-    /* Setup data sink */
-    TransferState.WriteData.BytesLeft = Length;
-    TransferState.WriteData.Sink.Func = &WriteDataEEPROMSink;
-    TransferState.WriteData.Sink.Pointer = GetFileDataAreaBlockId(FileIndex);
+    /* Setup data sink, backup files are only written on commit */
+    uint16_t DataAddress = GetFileDataAreaBlockId(FileIndex) * DESFIRE_BLOCK_SIZE + Offset;
+    if (FileType == DESFIRE_FILE_BACKUP_DATA) {
+        uint16_t CopyAddress = DataAddress + DESFIRE_BYTES_TO_BLOCKS(fileSize) * DESFIRE_BLOCK_SIZE;
+        uint8_t Status = JournalDataWriteSetup(DataAddress, CopyAddress, Length);
+        if (Status != STATUS_OPERATION_OK) {
+            return Status;
+        }
+    } else {
+        TransferState.WriteData.BytesLeft = Length;
+        TransferState.WriteData.Sink.Func = &WriteDataEEPROMSink;
+        TransferState.WriteData.Sink.Pointer = DataAddress;
+    }
     /* Setup data filter */
     return WriteDataFilterSetup(CommSettings);
 }
@@ -85,6 +85,7 @@ typedef struct DESFIRE_FIRMWARE_PACKING DESFIRE_FIRMWARE_ALIGNAT {
 } DESFireFileTypeSettings;
 
 uint16_t GetFileSizeFromFileType(DESFireFileTypeSettings *File);
+uint16_t GetFileDataBlockCount(DESFireFileTypeSettings *File);
 
 typedef struct DESFIRE_FIRMWARE_PACKING DESFIRE_FIRMWARE_ALIGNAT {
     BYTE Num;
@@ -109,6 +110,7 @@ uint8_t CreateValueFile(uint8_t FileNum, uint8_t CommSettings, uint16_t AccessRi
                         int32_t LowerLimit, int32_t UpperLimit, int32_t Value, bool LimitedCreditEnabled);
 uint8_t CreateRecordFile(uint8_t FileType, uint8_t FileNum, uint8_t CommSettings, uint16_t AccessRights,
                          uint8_t *RecordSize, uint8_t *MaxRecordSize);
+void FreeFileStorage(SIZET FileStructBlockId);
 uint8_t DeleteFile(uint8_t FileIndex);
 
 /* Transactions */
@@ -286,14 +286,9 @@ uint16_t ISO144434ProcessBlock(uint8_t *Buffer, uint16_t ByteCount, uint16_t Bit
  * ISO/IEC 14443-3A implementation
  */
 
-#include <util/crc16.h>
 uint16_t ISO14443AUpdateCRCA(const uint8_t *Buffer, uint16_t ByteCount, uint16_t InitCRCA) {
-    uint16_t Checksum = InitCRCA;
-    uint8_t *DataPtr = (uint8_t *) Buffer;
-    while (ByteCount--) {
-        uint8_t Byte = *DataPtr++;
-        Checksum = _crc_ccitt_update(Checksum, Byte);
-    }
+    uint16_t Checksum = CRC16Update(InitCRCA, Buffer, ByteCount);
+    uint8_t *DataPtr = (uint8_t *) Buffer + ByteCount;
     DataPtr[1] = (Checksum >> 8) & 0x00FF;
     DataPtr[0] = Checksum & 0x00FF;
     return Checksum;
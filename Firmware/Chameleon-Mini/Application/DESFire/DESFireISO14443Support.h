@@ -145,7 +145,7 @@ uint16_t ISO144434ProcessBlock(uint8_t *Buffer, uint16_t ByteCount, uint16_t Bit
 /*
  * ISO/IEC 14443-3A implementation
  */
-#define ISO14443A_CRCA_INIT                 ((uint16_t) 0x6363)
+#define ISO14443A_CRCA_INIT                 ((uint16_t) CRC_A_PRESET)
 uint16_t ISO14443AUpdateCRCA(const uint8_t *Buffer, uint16_t ByteCount, uint16_t InitCRCA);
 
 #define GetAndSetBufferCRCA(Buffer, ByteCount)     ({                                \
@@ -42,6 +42,7 @@ This notice must be retained at the top of all source files where indicated.
 #include "DESFireLogging.h"
 #include "DESFireUtils.h"
 #include "DESFireMemoryOperations.h"
+#include "DESFireTransactionJournal.h"
 #include "../MifareDESFire.h"
 
 DesfireSavedCommandStateType DesfireCommandState = { 0 };
@@ -105,210 +106,59 @@ static uint16_t ISO7816CmdUpdateBinary(uint8_t *Buffer, uint16_t ByteCount);
 static uint16_t ISO7816CmdReadRecords(uint8_t *Buffer, uint16_t ByteCount);
 static uint16_t ISO7816CmdAppendRecord(uint8_t *Buffer, uint16_t ByteCount);
 
-/* NOTE: The order of the structures in this buffer MUST be kept in
- *       ascending sorted order by the INS code. This property of the
- *       array has to be maintained as new commands and functions are
- *       added to keep CallInstructionHandler(uint8_t*, uint16_t)
- *       operating correctly. The instruction handler performs a
- *       binary search on the array to save time locating the correct
- *       C function to call to execute the command -- and this speedup
- *       helps keep timing issues at bay. DO NOT just append new command
- *       handlers to the end of the array, or insert them haphazardly in
- *       the middle !!!
- */
-static const DESFireCommand DESFireCommandSet[] = {
-    {
-        .insCode = CMD_AUTHENTICATE,
-        .insFunc = &EV0CmdAuthenticateLegacy1
-    },
-    {
-        .insCode = CMD_CREDIT,
-        .insFunc = &EV0CmdCredit
-    },
-    {
-        .insCode = CMD_AUTHENTICATE_ISO,
-        .insFunc = &DesfireCmdAuthenticate3KTDEA1
-    },
-    {
-        .insCode = CMD_LIMITED_CREDIT,
-        .insFunc = &EV0CmdLimitedCredit
-    },
-    {
-        .insCode = CMD_WRITE_RECORD,
-        .insFunc = &EV0CmdWriteRecord
-    },
-    {
-        .insCode = CMD_WRITE_DATA,
-        .insFunc = &EV0CmdWriteData
-    },
-    {
-        .insCode = CMD_GET_KEY_SETTINGS,
-        .insFunc = &EV0CmdGetKeySettings
-    },
-    {
-        .insCode = CMD_GET_CARD_UID,
-        .insFunc = &DesfireCmdGetCardUID
-    },
-    {
-        .insCode = CMD_CHANGE_KEY_SETTINGS,
-        .insFunc = &EV0CmdChangeKeySettings
-    },
-    {
-        .insCode = CMD_SELECT_APPLICATION,
-        .insFunc = &EV0CmdSelectApplication
-    },
-    {
-        .insCode = CMD_SET_CONFIGURATION,
-        .insFunc = NULL
-    },
-    {
-        .insCode = CMD_CHANGE_FILE_SETTINGS,
-        .insFunc = &EV0CmdChangeFileSettings
-    },
-    {
-        .insCode = CMD_GET_VERSION,
-        .insFunc = &EV0CmdGetVersion1
-    },
-    {
-        .insCode = CMD_GET_ISO_FILE_IDS,
-        .insFunc = &EV0CmdGetFileIds
-    },
-    {
-        .insCode = CMD_GET_KEY_VERSION,
-        .insFunc = &DesfireCmdGetKeyVersion
-    },
-    {
-        .insCode = CMD_GET_APPLICATION_IDS,
-        .insFunc = &EV0CmdGetApplicationIds1
-    },
-    {
-        .insCode = CMD_GET_VALUE,
-        .insFunc = &EV0CmdGetValue
-    },
-    {
-        .insCode = CMD_GET_DF_NAMES,
-        .insFunc = &DesfireCmdGetDFNames
-    },
-    {
-        .insCode = CMD_FREE_MEMORY,
-        .insFunc = &DesfireCmdFreeMemory
-    },
-    {
-        .insCode = CMD_GET_FILE_IDS,
-        .insFunc = &EV0CmdGetFileIds
-    },
-    {
-        .insCode = CMD_AUTHENTICATE_EV2_FIRST,
-        .insFunc = NULL
-    },
-    {
-        .insCode = CMD_AUTHENTICATE_EV2_NONFIRST,
-        .insFunc = NULL
-    },
-    {
-        .insCode = CMD_ISO7816_EXTERNAL_AUTHENTICATE,
-        .insFunc = &ISO7816CmdExternalAuthenticate
-    },
-    {
-        .insCode = CMD_ISO7816_GET_CHALLENGE,
-        .insFunc = &ISO7816CmdGetChallenge
-    },
-    {
-        .insCode = CMD_ISO7816_SELECT,
-        .insFunc = &ISO7816CmdSelect
-    },
-    {
-        .insCode = CMD_ISO7816_INTERNAL_AUTHENTICATE,
-        .insFunc = &ISO7816CmdInternalAuthenticate
-    },
-    {
-        .insCode = CMD_ABORT_TRANSACTION,
-        .insFunc = &EV0CmdAbortTransaction
-    },
-    {
-        .insCode = CMD_AUTHENTICATE_AES,
-        .insFunc = &DesfireCmdAuthenticateAES1
-    },
-    {
-        .insCode = CMD_ISO7816_READ_BINARY,
-        .insFunc = &ISO7816CmdReadBinary
-    },
-    {
-        .insCode = CMD_ISO7816_READ_RECORDS,
-        .insFunc = &ISO7816CmdReadRecords
-    },
-    {
-        .insCode = CMD_READ_RECORDS,
-        .insFunc = &EV0CmdReadRecords
-    },
-    {
-        .insCode = CMD_READ_DATA,
-        .insFunc = &EV0CmdReadData
-    },
-    {
-        .insCode = CMD_CREATE_CYCLIC_RECORD_FILE,
-        .insFunc = &EV0CmdCreateCyclicRecordFile
-    },
-    {
-        .insCode = CMD_CREATE_LINEAR_RECORD_FILE,
-        .insFunc = &EV0CmdCreateLinearRecordFile
-    },
-    {
-        .insCode = CMD_CHANGE_KEY,
-        .insFunc = &EV0CmdChangeKey
-    },
-    {
-        .insCode = CMD_CREATE_APPLICATION,
-        .insFunc = &EV0CmdCreateApplication
-    },
-    {
-        .insCode = CMD_CREATE_BACKUPDATA_FILE,
-        .insFunc = &EV0CmdCreateBackupDataFile
-    },
-    {
-        .insCode = CMD_CREATE_VALUE_FILE,
-        .insFunc = &EV0CmdCreateValueFile
-    },
-    {
-        .insCode = CMD_CREATE_STDDATA_FILE,
-        .insFunc = &EV0CmdCreateStandardDataFile
-    },
-    {
-        .insCode = CMD_COMMIT_TRANSACTION,
-        .insFunc = &EV0CmdCommitTransaction
-    },
-    {
-        .insCode = CMD_ISO7816_UPDATE_BINARY,
-        .insFunc = &ISO7816CmdUpdateBinary
-    },
-    {
-        .insCode = CMD_DELETE_APPLICATION,
-        .insFunc = &EV0CmdDeleteApplication
-    },
-    {
-        .insCode = CMD_DEBIT,
-        .insFunc = &EV0CmdDebit
-    },
-    {
-        .insCode = CMD_DELETE_FILE,
-        .insFunc = &EV0CmdDeleteFile
-    },
-    {
-        .insCode = CMD_ISO7816_APPEND_RECORD,
-        .insFunc = &ISO7816CmdAppendRecord
-    },
-    {
-        .insCode = CMD_CLEAR_RECORD_FILE,
-        .insFunc = &EV0CmdClearRecords
-    },
-    {
-        .insCode = CMD_FORMAT_PICC,
-        .insFunc = &EV0CmdFormatPicc
-    },
-    {
-        .insCode = CMD_GET_FILE_SETTINGS,
-        .insFunc = &EV0CmdGetFileSettings
-    },
+/* Dispatch table indexed by the instruction byte, native and ISO7816 codes
+ * share the same space. Codes without an entry get no response, commands
+ * which are known but not supported map to CmdNotImplemented. GCC warns
+ * about an instruction code listed twice with -Woverride-init. */
+static const InsCodeHandlerFunc DESFireCommandTable[256] PROGMEM = {
+    [CMD_AUTHENTICATE]                  = &EV0CmdAuthenticateLegacy1,
+    [CMD_CREDIT]                        = &EV0CmdCredit,
+    [CMD_AUTHENTICATE_ISO]              = &DesfireCmdAuthenticate3KTDEA1,
+    [CMD_LIMITED_CREDIT]                = &EV0CmdLimitedCredit,
+    [CMD_WRITE_RECORD]                  = &EV0CmdWriteRecord,
+    [CMD_WRITE_DATA]                    = &EV0CmdWriteData,
+    [CMD_GET_KEY_SETTINGS]              = &EV0CmdGetKeySettings,
+    [CMD_GET_CARD_UID]                  = &DesfireCmdGetCardUID,
+    [CMD_CHANGE_KEY_SETTINGS]           = &EV0CmdChangeKeySettings,
+    [CMD_SELECT_APPLICATION]            = &EV0CmdSelectApplication,
+    [CMD_SET_CONFIGURATION]             = &CmdNotImplemented,
+    [CMD_CHANGE_FILE_SETTINGS]          = &EV0CmdChangeFileSettings,
+    [CMD_GET_VERSION]                   = &EV0CmdGetVersion1,
+    [CMD_GET_ISO_FILE_IDS]              = &EV0CmdGetFileIds,
+    [CMD_GET_KEY_VERSION]               = &DesfireCmdGetKeyVersion,
+    [CMD_GET_APPLICATION_IDS]           = &EV0CmdGetApplicationIds1,
+    [CMD_GET_VALUE]                     = &EV0CmdGetValue,
+    [CMD_GET_DF_NAMES]                  = &DesfireCmdGetDFNames,
+    [CMD_FREE_MEMORY]                   = &DesfireCmdFreeMemory,
+    [CMD_GET_FILE_IDS]                  = &EV0CmdGetFileIds,
+    [CMD_AUTHENTICATE_EV2_FIRST]        = &CmdNotImplemented,
+    [CMD_AUTHENTICATE_EV2_NONFIRST]     = &CmdNotImplemented,
+    [CMD_ISO7816_EXTERNAL_AUTHENTICATE] = &ISO7816CmdExternalAuthenticate,
+    [CMD_ISO7816_GET_CHALLENGE]         = &ISO7816CmdGetChallenge,
+    [CMD_ISO7816_SELECT]                = &ISO7816CmdSelect,
+    [CMD_ISO7816_INTERNAL_AUTHENTICATE] = &ISO7816CmdInternalAuthenticate,
+    [CMD_ABORT_TRANSACTION]             = &EV0CmdAbortTransaction,
+    [CMD_AUTHENTICATE_AES]              = &DesfireCmdAuthenticateAES1,
+    [CMD_ISO7816_READ_BINARY]           = &ISO7816CmdReadBinary,
+    [CMD_ISO7816_READ_RECORDS]          = &ISO7816CmdReadRecords,
+    [CMD_READ_RECORDS]                  = &EV0CmdReadRecords,
+    [CMD_READ_DATA]                     = &EV0CmdReadData,
+    [CMD_CREATE_CYCLIC_RECORD_FILE]     = &EV0CmdCreateCyclicRecordFile,
+    [CMD_CREATE_LINEAR_RECORD_FILE]     = &EV0CmdCreateLinearRecordFile,
+    [CMD_CHANGE_KEY]                    = &EV0CmdChangeKey,
+    [CMD_CREATE_APPLICATION]            = &EV0CmdCreateApplication,
+    [CMD_CREATE_BACKUPDATA_FILE]        = &EV0CmdCreateBackupDataFile,
+    [CMD_CREATE_VALUE_FILE]             = &EV0CmdCreateValueFile,
+    [CMD_CREATE_STDDATA_FILE]           = &EV0CmdCreateStandardDataFile,
+    [CMD_COMMIT_TRANSACTION]            = &EV0CmdCommitTransaction,
+    [CMD_ISO7816_UPDATE_BINARY]         = &ISO7816CmdUpdateBinary,
+    [CMD_DELETE_APPLICATION]            = &EV0CmdDeleteApplication,
+    [CMD_DEBIT]                         = &EV0CmdDebit,
+    [CMD_DELETE_FILE]                   = &EV0CmdDeleteFile,
+    [CMD_ISO7816_APPEND_RECORD]         = &ISO7816CmdAppendRecord,
+    [CMD_CLEAR_RECORD_FILE]             = &EV0CmdClearRecords,
+    [CMD_FORMAT_PICC]                   = &EV0CmdFormatPicc,
+    [CMD_GET_FILE_SETTINGS]             = &EV0CmdGetFileSettings,
 };
 
 //Sets the key number to a real key number after deriving the crypto type from it
@@ -330,7 +180,7 @@ uint8_t ProcessKeyNumber(uint8_t * KeyNumber) {
 void UpdateIVIfNeeded(uint8_t *Buffer, uint16_t ByteCount) {
     if (ActiveCommMode == DESFIRE_COMMS_PLAINTEXT && Authenticated && ReadKeyCryptoType(SelectedApp.Slot, AuthenticatedWithKey)== CRYPTO_TYPE_AES128) {
         uint8_t cmac[32];
-        DesfireCryptoCMAC(CRYPTO_TYPE_AES128, SessionKey, Buffer, ByteCount, SessionIV, cmac);
+        DesfireSessionCMAC(CRYPTO_TYPE_AES128, Buffer, ByteCount, cmac);
     }
 }
 
@@ -339,25 +189,11 @@ uint16_t CallInstructionHandler(uint8_t *Buffer, uint16_t ByteCount) {
         Buffer[0] = STATUS_PARAMETER_ERROR;
         return DESFIRE_STATUS_RESPONSE_SIZE;
     }
-    uint8_t insCode = Buffer[0];
-    uint16_t curInsLower = 0, curInsUpper = sizeof(DESFireCommandSet) / sizeof(DESFireCommand) - 1;
-    uint16_t curInsIndex;
-    DESFireCommand dfCmd;
-    while (curInsUpper >= curInsLower) {
-        curInsIndex = (curInsLower + curInsUpper) / 2;
-        dfCmd = DESFireCommandSet[curInsIndex];
-        if (dfCmd.insCode == insCode) {
-            if (dfCmd.insFunc == NULL) {
-                return CmdNotImplemented(Buffer, ByteCount);
-            }
-            return dfCmd.insFunc(Buffer, ByteCount);
-        } else if (dfCmd.insCode < insCode) {
-            curInsLower = curInsIndex + 1;
-        } else {
-            curInsUpper = curInsIndex - 1;
-        }
+    InsCodeHandlerFunc insFunc = (InsCodeHandlerFunc) pgm_read_ptr(&DESFireCommandTable[Buffer[0]]);
+    if (insFunc == NULL) {
+        return ISO14443A_APP_NO_RESPONSE;
     }
-    return ISO14443A_APP_NO_RESPONSE;
+    return insFunc(Buffer, ByteCount);
 }
 
 uint16_t ExitWithStatus(uint8_t *Buffer, uint8_t StatusCode, uint16_t DefaultReturnValue) {
@@ -447,14 +283,13 @@ uint16_t DesfireCmdFreeMemory(uint8_t *Buffer, uint16_t ByteCount) {
     // Returns the amount of free space left on the tag in bytes
     // Note that this does not account for overhead needed to store
     // file structures, so that if N bytes are reported, the actual
-    // practical working space is less than N:
-    uint16_t cardCapacityBlocks = GetCardCapacityBlocks();
-    cardCapacityBlocks -= Picc.FirstFreeBlock;
-    uint16_t freeMemoryBytes = cardCapacityBlocks * DESFIRE_BLOCK_SIZE;
-    Buffer[0] = (uint8_t)(freeMemoryBytes >> 8);
+    // practical working space is less than N. The size is sent LSB first.
+    uint32_t freeMemoryBytes = (uint32_t) GetFreeBlockCount() * DESFIRE_BLOCK_SIZE;
+    Buffer[0] = STATUS_OPERATION_OK;
     Buffer[1] = (uint8_t)(freeMemoryBytes >> 0);
-    Buffer[2] = STATUS_OPERATION_OK;
-    return DESFIRE_STATUS_RESPONSE_SIZE + 2;
+    Buffer[2] = (uint8_t)(freeMemoryBytes >> 8);
+    Buffer[3] = (uint8_t)(freeMemoryBytes >> 16);
+    return DESFIRE_STATUS_RESPONSE_SIZE + 3;
 }
 
 /*
@@ -893,13 +728,17 @@ uint16_t EV0CmdDeleteApplication(uint8_t *Buffer, uint16_t ByteCount) {
         }
         SelectPiccApp();
     }
-    /* Done */
+    /* The PICC application is selected afterwards, which ends the pending
+     * transaction before the blocks of its files are freed */
+    AbortTransactionJournal();
     Status = DeleteApp(Aid);
     return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
 }
 
 uint16_t EV0CmdSelectApplication(uint8_t *Buffer, uint16_t ByteCount) {
     InvalidateAuthState(true);
+    /* Selecting an application ends the pending transaction */
+    AbortTransactionJournal();
     /* Handle a special case with EV1:
      * See https://stackoverflow.com/questions/38232695/m4m-mifare-desfire-ev1-which-mifare-aid-needs-to-be-added-to-nfc-routing-table
      */
@@ -1114,8 +953,7 @@ uint16_t EV0CmdGetFileIds(uint8_t *Buffer, uint16_t ByteCount) {
         return DESFIRE_STATUS_RESPONSE_SIZE;
     }
     uint8_t fileIDs[DESFIRE_MAX_FILES];
-    SIZET fileNumbersArrayMapBlockId = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, SelectedApp.Slot);
-    ReadBlockBytes(fileIDs, fileNumbersArrayMapBlockId, DESFIRE_MAX_FILES);
+    ReadFileNumbersArray(SelectedApp.Slot, fileIDs);
     uint8_t *outputBufPtr = &Buffer[1];
     uint8_t activeFilesCount = 0x00;
     for (uint8_t slotNum = 0; slotNum < DESFIRE_MAX_FILES; slotNum++) {
@@ -1359,25 +1197,11 @@ uint16_t EV0CmdWriteData(uint8_t *Buffer, uint16_t ByteCount) {
     if ((Offset >= fileSize) || ((fileSize - Offset) < Length)) {
         Status = STATUS_BOUNDARY_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
-    } else if (Length + Offset >= TERMINAL_BUFFER_SIZE) {
-        Status = STATUS_PICC_INTEGRITY_ERROR;
-        return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
-    /* Shift the initial memory by an offset so we are not off when writing along
-     * blocks to FRAM memory:
-     */
+    /* The data sink starts at the byte offset, no need to rewrite the
+     * file data in front of it */
     uint16_t dataWriteSize = ByteCount - 8;
-
     uint8_t *dataWriteBuffer = &Buffer[8];
-    if (Offset > 0) {
-        uint8_t precursorFileData[Offset];
-        uint16_t fileDataStartAddr = GetFileDataAreaBlockId(fileIndex);
-        ReadBlockBytes(precursorFileData, fileDataStartAddr, Offset);
-        memmove(&Buffer[1] + Offset, &Buffer[8], dataWriteSize);
-        memcpy(&Buffer[1], precursorFileData, Offset);
-        dataWriteSize += Offset;
-        dataWriteBuffer = &Buffer[1];
-    }
 
     /* Setup and start the transfer */
     Status = WriteDataFileSetup(fileIndex, fileType, CommSettings, (uint16_t) Offset, (uint16_t) Length);
@@ -1504,6 +1328,10 @@ uint16_t EV0CmdCredit(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_BOUNDARY_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
+    Status = JournalValueUpdate(ReadFileDataStructAddress(SelectedApp.Slot, fileIndex), nextValueAmount);
+    if (Status != STATUS_OPERATION_OK) {
+        return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
+    }
     fileData.ValueFile.DirtyValue = nextValueAmount;
     Status = WriteFileControlBlock(fileNumber, &fileData);
     return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
@@ -1555,6 +1383,10 @@ uint16_t EV0CmdDebit(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_BOUNDARY_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
+    Status = JournalValueUpdate(ReadFileDataStructAddress(SelectedApp.Slot, fileIndex), nextValueAmount);
+    if (Status != STATUS_OPERATION_OK) {
+        return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
+    }
     fileData.ValueFile.DirtyValue = nextValueAmount;
     fileData.ValueFile.PreviousDebit -= debitAmount;
     Status = WriteFileControlBlock(fileNumber, &fileData);
@@ -1602,6 +1434,10 @@ uint16_t EV0CmdLimitedCredit(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_BOUNDARY_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
+    Status = JournalValueUpdate(ReadFileDataStructAddress(SelectedApp.Slot, fileIndex), nextValueAmount);
+    if (Status != STATUS_OPERATION_OK) {
+        return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
+    }
     fileData.ValueFile.DirtyValue = nextValueAmount;
     Status = WriteFileControlBlock(fileNumber, &fileData);
     return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
@@ -1649,9 +1485,7 @@ uint16_t EV0CmdReadRecords(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_BOUNDARY_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
-    /* We are only able to read chunks of data starting at a round block offset */
-    uint8_t blockReadOffset = DESFIRE_BYTES_TO_BLOCKS(Offset);
-    Status = ReadDataFileSetup(fileIndex, CommSettings, (uint16_t) blockReadOffset, (uint16_t) Length);
+    Status = ReadDataFileSetup(fileIndex, CommSettings, (uint16_t) Offset, (uint16_t) Length);
     if (Status != STATUS_OPERATION_OK) {
         const char *logMsg = PSTR("ReadDataFileSetup -- ERROR!");
         DEBUG_PRINT_P(logMsg);
@@ -1703,24 +1537,11 @@ uint16_t EV0CmdWriteRecord(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_BOUNDARY_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
-    /* We are only able to read chunks of data starting at a round block offset */
+    /* Write the record data in one burst at its byte offset */
     DesfireState = DESFIRE_WRITE_DATA_FILE;
-    uint16_t offsetBlocks = DESFIRE_BYTES_TO_BLOCKS(Offset);
-    if (offsetBlocks > 0) {
-        --offsetBlocks;
-    }
-    uint16_t effectiveOffset = Offset % DESFIRE_BLOCK_SIZE;
-    uint8_t dataWriteAddr = GetFileDataAreaBlockId(fileIndex) + offsetBlocks;
-    memmove(&Buffer[effectiveOffset], &Buffer[8], dataXferLength);
-    if (effectiveOffset > 0) {
-        uint8_t priorFileData[effectiveOffset];
-        ReadBlockBytes(priorFileData, dataWriteAddr, effectiveOffset);
-        memcpy(&Buffer[0], priorFileData, effectiveOffset);
-    }
-    dataXferLength += effectiveOffset;
-    WriteBlockBytes(&Buffer[0], dataWriteAddr, dataXferLength);
     TransferState.WriteData.Sink.Func = &WriteDataEEPROMSink;
-    TransferState.WriteData.Sink.Pointer = dataWriteAddr + DESFIRE_BYTES_TO_BLOCKS(dataXferLength);
+    TransferState.WriteData.Sink.Pointer = GetFileDataAreaBlockId(fileIndex) * DESFIRE_BLOCK_SIZE + Offset;
+    WriteDataEEPROMSink(&Buffer[8], dataXferLength);
     Status = STATUS_OPERATION_OK;
     return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
 }
@@ -1745,34 +1566,10 @@ uint16_t EV0CmdCommitTransaction(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_LENGTH_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
-    /* Loop over all of the value files (backup files?) in the currently
-     * selected application, and update the uncommitted credit/debit
-     * changes made since the last transaction was resolved.
-     */
-    uint16_t fileNumsArrayAddr = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, SelectedApp.Slot);
-    uint8_t fileNumsByIndexArray[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileNumsByIndexArray, fileNumsArrayAddr, DESFIRE_MAX_FILES);
+    /* The credit/debit changes and the backup file writes made since the
+     * last transaction was resolved are all recorded in the journal */
+    CommitTransactionJournal();
     Status = STATUS_OPERATION_OK;
-    for (uint8_t fileIdx = 0; fileIdx < DESFIRE_MAX_FILES; ++fileIdx) {
-        if (fileNumsByIndexArray[fileIdx] == DESFIRE_FILE_NOFILE_INDEX) {
-            continue;
-        } else if (ReadFileType(SelectedApp.Slot, fileIdx) != DESFIRE_FILE_VALUE_DATA) {
-            continue;
-        }
-        DESFireFileTypeSettings fileData;
-        Status = ReadFileControlBlock(fileNumsByIndexArray[fileIdx], &fileData);
-        if (Status != STATUS_OPERATION_OK) {
-            break;
-        }
-        fileData.ValueFile.CleanValue = fileData.ValueFile.DirtyValue;
-        fileData.ValueFile.PreviousDebit = 0;
-        Status = WriteFileControlBlock(fileNumsByIndexArray[fileIdx], &fileData);
-        if (Status != STATUS_OPERATION_OK) {
-            break;
-        }
-    }
-    Picc.TransactionStarted = 0x00;
-    SynchronizePICCInfo();
     return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
 }
 
@@ -1782,34 +1579,8 @@ uint16_t EV0CmdAbortTransaction(uint8_t *Buffer, uint16_t ByteCount) {
         Status = STATUS_LENGTH_ERROR;
         return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
     }
-    /* Loop over all of the value files (backup files?) in the currently
-     * selected application, and remove/abort the uncommitted credit/debit
-     * changes made since the last transaction was resolved.
-     */
-    uint16_t fileNumsArrayAddr = GetAppProperty(DESFIRE_APP_FILE_NUMBER_ARRAY_MAP_BLOCK_ID, SelectedApp.Slot);
-    uint8_t fileNumsByIndexArray[DESFIRE_MAX_FILES];
-    ReadBlockBytes(fileNumsByIndexArray, fileNumsArrayAddr, DESFIRE_MAX_FILES);
+    AbortTransactionJournal();
     Status = STATUS_OPERATION_OK;
-    for (uint8_t fileIdx = 0; fileIdx < DESFIRE_MAX_FILES; ++fileIdx) {
-        if (fileNumsByIndexArray[fileIdx] == DESFIRE_FILE_NOFILE_INDEX) {
-            continue;
-        } else if (ReadFileType(SelectedApp.Slot, fileIdx) != DESFIRE_FILE_VALUE_DATA) {
-            continue;
-        }
-        DESFireFileTypeSettings fileData;
-        Status = ReadFileControlBlock(fileNumsByIndexArray[fileIdx], &fileData);
-        if (Status != STATUS_OPERATION_OK) {
-            break;
-        }
-        fileData.ValueFile.DirtyValue = fileData.ValueFile.CleanValue;
-        fileData.ValueFile.PreviousDebit = 0;
-        Status = WriteFileControlBlock(fileNumsByIndexArray[fileIdx], &fileData);
-        if (Status != STATUS_OPERATION_OK) {
-            break;
-        }
-    }
-    Picc.TransactionStarted = 0x00;
-    SynchronizePICCInfo();
     return ExitWithStatus(Buffer, Status, DESFIRE_STATUS_RESPONSE_SIZE);
 }
 
@@ -1985,6 +1756,9 @@ uint16_t DesfireCmdAuthenticate3KTDEA2(uint8_t *Buffer, uint16_t ByteCount) {
 
     /* Create the session key based on the previous exchange */
     generateSessionKey(SessionKey, challengeRndA, challengeRndB, cryptoKeyType);
+    if (cryptoKeyType == CRYPTO_TYPE_3K3DES) {
+        GenerateSessionCMACSubKeys(cryptoKeyType);
+    }
 
     /* Now that we have auth'ed with the legacy command, a ChangeKey command will
      * allow for subsequent authentication with the ISO or AES routines
@@ -2152,6 +1926,7 @@ uint16_t DesfireCmdAuthenticateAES2(uint8_t *Buffer, uint16_t ByteCount) {
 
     /* Create the session key based on the previous exchange */
     generateSessionKey(SessionKey, challengeRndA, challengeRndB, CRYPTO_TYPE_AES128);
+    GenerateSessionCMACSubKeys(CRYPTO_TYPE_AES128);
 
     /* Now that we have auth'ed with the legacy command, a ChangeKey command will
      * allow for subsequent authentication with the ISO or AES routines
@@ -2265,6 +2040,46 @@ uint16_t ISO7816CmdInternalAuthenticate(uint8_t *Buffer, uint16_t ByteCount) {
     return CmdNotImplemented(Buffer, ByteCount);
 }
 
+/* The file data area starts on a block boundary. An offset inside a block
+ * skips the first bytes of its start block, the rest of the data starts on
+ * the next block. */
+static void ISO7816ReadFileBytes(uint8_t *Buffer, uint16_t FileDataAddress, uint16_t Offset, uint16_t Count) {
+    uint16_t fileDataReadAddr = FileDataAddress + Offset / DESFIRE_BLOCK_SIZE;
+    uint8_t blockPriorByteCount = Offset % DESFIRE_BLOCK_SIZE;
+    if (blockPriorByteCount != 0) {
+        uint8_t blockData[DESFIRE_BLOCK_SIZE];
+        uint8_t blockBytesToCopy = MIN(DESFIRE_BLOCK_SIZE - blockPriorByteCount, Count);
+        ReadBlockBytes(blockData, fileDataReadAddr, DESFIRE_BLOCK_SIZE);
+        memcpy(Buffer, blockData + blockPriorByteCount, blockBytesToCopy);
+        fileDataReadAddr += 1;
+        Buffer += blockBytesToCopy;
+        Count -= blockBytesToCopy;
+    }
+    if (Count > 0) {
+        ReadBlockBytes(Buffer, fileDataReadAddr, Count);
+    }
+}
+
+/* Same as ISO7816ReadFileBytes(): the bytes in front of the offset and
+ * behind the data in its start block are written back unchanged */
+static void ISO7816WriteFileBytes(const uint8_t *Buffer, uint16_t FileDataAddress, uint16_t Offset, uint16_t Count) {
+    uint16_t fileDataWriteAddr = FileDataAddress + Offset / DESFIRE_BLOCK_SIZE;
+    uint8_t blockPriorByteCount = Offset % DESFIRE_BLOCK_SIZE;
+    if (blockPriorByteCount != 0) {
+        uint8_t blockData[DESFIRE_BLOCK_SIZE];
+        uint8_t blockBytesToCopy = MIN(DESFIRE_BLOCK_SIZE - blockPriorByteCount, Count);
+        ReadBlockBytes(blockData, fileDataWriteAddr, DESFIRE_BLOCK_SIZE);
+        memcpy(blockData + blockPriorByteCount, Buffer, blockBytesToCopy);
+        WriteBlockBytes(blockData, fileDataWriteAddr, DESFIRE_BLOCK_SIZE);
+        fileDataWriteAddr += 1;
+        Buffer += blockBytesToCopy;
+        Count -= blockBytesToCopy;
+    }
+    if (Count > 0) {
+        WriteBlockBytes(Buffer, fileDataWriteAddr, Count);
+    }
+}
+
 uint16_t ISO7816CmdReadBinary(uint8_t *Buffer, uint16_t ByteCount) {
     if (ByteCount == 0) {
         Buffer[0] = ISO7816_ERROR_SW1;
@@ -2312,8 +2127,8 @@ uint16_t ISO7816CmdReadBinary(uint8_t *Buffer, uint16_t ByteCount) {
         case VALIDATED_ACCESS_GRANTED:
             break;
     }
-    if (SelectedFile.File.FileType == DESFIRE_FILE_STANDARD_DATA ||
-            SelectedFile.File.FileType == DESFIRE_FILE_BACKUP_DATA) {
+    if (SelectedFile.File.FileType != DESFIRE_FILE_STANDARD_DATA &&
+            SelectedFile.File.FileType != DESFIRE_FILE_BACKUP_DATA) {
         Buffer[0] = ISO7816_ERROR_SW1_ACCESS;
         Buffer[1] = ISO7816_ERROR_SW2_INCOMPATFS;
         return ISO7816_STATUS_RESPONSE_SIZE;
@@ -2334,22 +2149,7 @@ uint16_t ISO7816CmdReadBinary(uint8_t *Buffer, uint16_t ByteCount) {
     if (maxBytesToRead == ISO7816_READ_ALL_BYTES_SIZE) {
         maxBytesToRead = SelectedFile.File.FileSize - Iso7816FileOffset;
     }
-    /* Handle fetching bits in the cases where the file offset is not a multiple of
-     * DESFIRE_BLOCK_SIZE, which is required to address the data read out of the
-     * file using ReadBlockBytes
-     */
-    uint8_t fileDataReadAddr = SelectedFile.File.FileDataAddress + MIN(0, DESFIRE_BYTES_TO_BLOCKS(Iso7816FileOffset) - 1);
-    uint8_t *storeDataBufStart = &Buffer[2];
-    if ((Iso7816FileOffset % DESFIRE_BLOCK_SIZE) != 0) {
-        uint8_t blockPriorByteCount = Iso7816FileOffset % DESFIRE_BLOCK_SIZE;
-        uint8_t blockData[DESFIRE_BLOCK_SIZE];
-        ReadBlockBytes(blockData, fileDataReadAddr, DESFIRE_BLOCK_SIZE);
-        memcpy(storeDataBufStart + blockPriorByteCount, blockData, DESFIRE_BLOCK_SIZE);
-        fileDataReadAddr += 1;
-        storeDataBufStart += DESFIRE_BLOCK_SIZE - blockPriorByteCount;
-        maxBytesToRead -= DESFIRE_BLOCK_SIZE - blockPriorByteCount;
-    }
-    ReadBlockBytes(storeDataBufStart, fileDataReadAddr, maxBytesToRead);
+    ISO7816ReadFileBytes(&Buffer[2], SelectedFile.File.FileDataAddress, Iso7816FileOffset, maxBytesToRead);
     Buffer[0] = ISO7816_CMD_NO_ERROR;
     Buffer[1] = ISO7816_CMD_NO_ERROR;
     return ISO7816_STATUS_RESPONSE_SIZE + maxBytesToRead;
@@ -2424,26 +2224,10 @@ uint16_t ISO7816CmdUpdateBinary(uint8_t *Buffer, uint16_t ByteCount) {
     if (maxBytesToRead == ISO7816_READ_ALL_BYTES_SIZE) {
         maxBytesToRead = SelectedFile.File.FileSize - Iso7816FileOffset;
     }
-    /* Handle fetching bits in the cases where the file offset is not a multiple of
-     * DESFIRE_BLOCK_SIZE, which is required to address the data read out of the
-     * file using ReadBlockBytes
-     */
-    uint8_t fileDataWriteAddr = SelectedFile.File.FileDataAddress + MIN(0, DESFIRE_BYTES_TO_BLOCKS(Iso7816FileOffset) - 1);
-    uint8_t *updateDataBufStart = &Buffer[1];
-    if ((Iso7816FileOffset % DESFIRE_BLOCK_SIZE) != 0) {
-        uint8_t blockPriorByteCount = Iso7816FileOffset % DESFIRE_BLOCK_SIZE;
-        uint8_t blockData[DESFIRE_BLOCK_SIZE];
-        ReadBlockBytes(blockData, fileDataWriteAddr, blockPriorByteCount);
-        memcpy(blockData + blockPriorByteCount, updateDataBufStart, DESFIRE_BLOCK_SIZE - blockPriorByteCount);
-        WriteBlockBytes(blockData, fileDataWriteAddr, DESFIRE_BLOCK_SIZE);
-        fileDataWriteAddr += 1;
-        updateDataBufStart += DESFIRE_BLOCK_SIZE - blockPriorByteCount;
-        maxBytesToRead -= DESFIRE_BLOCK_SIZE - blockPriorByteCount;
-    }
-    WriteBlockBytes(updateDataBufStart, fileDataWriteAddr, maxBytesToRead);
+    ISO7816WriteFileBytes(&Buffer[1], SelectedFile.File.FileDataAddress, Iso7816FileOffset, maxBytesToRead);
     Buffer[0] = ISO7816_CMD_NO_ERROR;
     Buffer[1] = ISO7816_CMD_NO_ERROR;
-    return ISO7816_STATUS_RESPONSE_SIZE + maxBytesToRead;
+    return ISO7816_STATUS_RESPONSE_SIZE;
 }
 
 uint16_t ISO7816CmdReadRecords(uint8_t *Buffer, uint16_t ByteCount) {
@@ -2517,33 +2301,12 @@ uint16_t ISO7816CmdReadRecords(uint8_t *Buffer, uint16_t ByteCount) {
             (SelectedFile.File.FileSize - Iso7816FileOffset < maxBytesToRead)) {
         cyclicRecordOffsetDiff = maxBytesToRead + Iso7816FileOffset - SelectedFile.File.FileSize;
     }
-    /* Handle fetching bits in the cases where the file offset is not a multiple of
-     * DESFIRE_BLOCK_SIZE, which is required to address the data read out of the
-     * file using ReadBlockBytes
-     */
-    uint8_t initFileReadDataAddr = SelectedFile.File.FileDataAddress + MIN(0, DESFIRE_BYTES_TO_BLOCKS(Iso7816FileOffset) - 1);
-    uint8_t *storeDataBufStart = &Buffer[2];
-    if ((Iso7816FileOffset % DESFIRE_BLOCK_SIZE) != 0) {
-        uint8_t blockPriorByteCount = Iso7816FileOffset % DESFIRE_BLOCK_SIZE;
-        uint8_t blockData[DESFIRE_BLOCK_SIZE];
-        ReadBlockBytes(blockData, initFileReadDataAddr, DESFIRE_BLOCK_SIZE);
-        memcpy(storeDataBufStart + blockPriorByteCount, blockData, DESFIRE_BLOCK_SIZE);
-        initFileReadDataAddr += 1;
-        storeDataBufStart += DESFIRE_BLOCK_SIZE - blockPriorByteCount;
-        maxBytesToRead -= DESFIRE_BLOCK_SIZE - blockPriorByteCount;
-    }
-    /* Now, read the specified file contents into the Buffer:
-     * Cases to handle separately:
-     *      1) Cyclic record files with a non-zero offset difference;
-     *      2) Any other record file cases.
-     */
-    if ((SelectedFile.File.FileType == DESFIRE_FILE_CIRCULAR_RECORDS) &&
-            (cyclicRecordOffsetDiff > 0)) {
-        uint8_t initEOFReadLength = maxBytesToRead - cyclicRecordOffsetDiff;
-        ReadBlockBytes(&Buffer[2], initFileReadDataAddr, initEOFReadLength);
-        ReadBlockBytes(&Buffer[initEOFReadLength + 2], SelectedFile.File.FileDataAddress, cyclicRecordOffsetDiff);
-    } else {
-        ReadBlockBytes(&Buffer[2], initFileReadDataAddr, maxBytesToRead);
+    /* Now, read the specified file contents into the Buffer: the records of
+     * a cyclic file continue at the start of its data area */
+    uint8_t initEOFReadLength = maxBytesToRead - cyclicRecordOffsetDiff;
+    ISO7816ReadFileBytes(&Buffer[2], SelectedFile.File.FileDataAddress, Iso7816FileOffset, initEOFReadLength);
+    if (cyclicRecordOffsetDiff > 0) {
+        ISO7816ReadFileBytes(&Buffer[2 + initEOFReadLength], SelectedFile.File.FileDataAddress, 0, cyclicRecordOffsetDiff);
     }
     Buffer[0] = ISO7816_CMD_NO_ERROR;
     Buffer[1] = ISO7816_CMD_NO_ERROR;
@@ -2604,22 +2367,7 @@ uint16_t ISO7816CmdAppendRecord(uint8_t *Buffer, uint16_t ByteCount) {
         nextRecordPointer = (SelectedFile.File.RecordFile.RecordPointer + appendRecordLength) % fileMaxRecords;
     }
     uint16_t nextRecordIndexToAppend = SelectedFile.File.RecordFile.RecordPointer % fileMaxRecords;
-    uint16_t priorBlockBytesToCopy = DESFIRE_BLOCK_SIZE - (nextRecordIndexToAppend % DESFIRE_BLOCK_SIZE);
-    if ((priorBlockBytesToCopy == DESFIRE_BLOCK_SIZE) || (nextRecordIndexToAppend < DESFIRE_BLOCK_SIZE)) {
-        priorBlockBytesToCopy = 0;
-    }
-    uint16_t fileDataWriteAddr = SelectedFile.File.FileDataAddress + MIN(0, DESFIRE_BYTES_TO_BLOCKS(nextRecordIndexToAppend) - 1);
-    uint8_t *writeDataBufStart = &Buffer[1];
-    if (priorBlockBytesToCopy > 0) {
-        uint8_t firstBlockData[DESFIRE_BLOCK_SIZE];
-        ReadBlockBytes(firstBlockData, fileDataWriteAddr, priorBlockBytesToCopy);
-        memcpy(firstBlockData + priorBlockBytesToCopy, writeDataBufStart, DESFIRE_BLOCK_SIZE - 1 - priorBlockBytesToCopy);
-        WriteBlockBytes(firstBlockData, fileDataWriteAddr, DESFIRE_BLOCK_SIZE);
-        fileDataWriteAddr += 1;
-        appendRecordLength -= DESFIRE_BLOCK_SIZE - priorBlockBytesToCopy;
-        writeDataBufStart += DESFIRE_BLOCK_SIZE - priorBlockBytesToCopy;
-    }
-    WriteBlockBytes(writeDataBufStart, fileDataWriteAddr, appendRecordLength);
+    ISO7816WriteFileBytes(&Buffer[1], SelectedFile.File.FileDataAddress, nextRecordIndexToAppend, appendRecordLength);
     SelectedFile.File.RecordFile.RecordPointer = nextRecordPointer;
     WriteFileControlBlock(SelectedFile.Num, &(SelectedFile.File));
     Buffer[0] = ISO7816_CMD_NO_ERROR;
@@ -108,11 +108,6 @@ typedef enum DESFIRE_FIRMWARE_ENUM_PACKING {
 
 typedef uint16_t (*InsCodeHandlerFunc)(uint8_t *Buffer, uint16_t ByteCount);
 
-typedef struct {
-    DESFireCommandType  insCode;
-    InsCodeHandlerFunc  insFunc;
-} DESFireCommand DESFIRE_FIRMWARE_ALIGNAT;
-
 /* Helper and batch process functions */
 uint16_t CallInstructionHandler(uint8_t *Buffer, uint16_t ByteCount);
 
@@ -57,11 +57,56 @@ void WriteBlockBytesMain(const void *Buffer, SIZET StartBlock, SIZET Count) {
     MemoryWriteBlockInSetting(Buffer, StartBlock * BLOCKWISE_IO_MULTIPLIER, Count);
 }
 
+/* Blocks at and above this one can not be allocated */
+static uint16_t GetStorageEndBlock(void) {
+    return MIN(StorageSizeToBytes(Picc.StorageSize), MEMORY_SIZE_PER_SETTING) / BLOCKWISE_IO_MULTIPLIER;
+}
+
+void SynchronizeFreeBlockList(void) {
+    WriteBlockBytes(&FreeBlockList, DESFIRE_FREE_LIST_BLOCK_ID, sizeof(DESFireFreeListType));
+}
+
+void LoadFreeBlockList(void) {
+    ReadBlockBytes(&FreeBlockList, DESFIRE_FREE_LIST_BLOCK_ID, sizeof(DESFireFreeListType));
+    if (FreeBlockList.ExtentCount > DESFIRE_MAX_FREE_EXTENTS) {
+        FreeBlockList.ExtentCount = 0;
+    }
+}
+
+static void RemoveFreeExtent(uint8_t Index) {
+    FreeBlockList.ExtentCount--;
+    memmove(&FreeBlockList.Extents[Index], &FreeBlockList.Extents[Index + 1],
+            (FreeBlockList.ExtentCount - Index) * sizeof(DESFireFreeExtentType));
+}
+
 uint16_t AllocateBlocksMain(uint16_t BlockCount) {
     uint16_t Block;
-    /* Check if we have space */
+    /* Best fit from the blocks returned by deleted files and applications */
+    uint8_t BestIndex = DESFIRE_MAX_FREE_EXTENTS;
+    for (uint8_t i = 0; i < FreeBlockList.ExtentCount; i++) {
+        uint16_t ExtentSize = FreeBlockList.Extents[i].BlockCount;
+        if (ExtentSize >= BlockCount &&
+                (BestIndex == DESFIRE_MAX_FREE_EXTENTS || ExtentSize < FreeBlockList.Extents[BestIndex].BlockCount)) {
+            BestIndex = i;
+            if (ExtentSize == BlockCount) {
+                break;
+            }
+        }
+    }
+    if (BestIndex < DESFIRE_MAX_FREE_EXTENTS) {
+        DESFireFreeExtentType *Extent = &FreeBlockList.Extents[BestIndex];
+        Block = Extent->StartBlock;
+        Extent->StartBlock += BlockCount;
+        Extent->BlockCount -= BlockCount;
+        if (Extent->BlockCount == 0) {
+            RemoveFreeExtent(BestIndex);
+        }
+        SynchronizeFreeBlockList();
+        return Block;
+    }
+    /* Otherwise take them from the unused space at the end */
     Block = Picc.FirstFreeBlock;
-    if (Block + BlockCount < Block || Block + BlockCount >= StorageSizeToBytes(Picc.StorageSize) || Block + BlockCount >= MEMORY_SIZE_PER_SETTING / BLOCKWISE_IO_MULTIPLIER) {
+    if (Block + BlockCount < Block || Block + BlockCount >= GetStorageEndBlock()) {
         return 0;
     }
 
@@ -72,22 +117,108 @@ uint16_t AllocateBlocksMain(uint16_t BlockCount) {
     return Block;
 }
 
-uint8_t GetCardCapacityBlocks(void) {
-    uint8_t MaxFreeBlocks;
-    switch (Picc.StorageSize) {
-        case DESFIRE_STORAGE_SIZE_2K:
-            MaxFreeBlocks = 0x100 - DESFIRE_FIRST_FREE_BLOCK_ID;
-            break;
-        case DESFIRE_STORAGE_SIZE_4K:
-            MaxFreeBlocks = 0x200 - DESFIRE_FIRST_FREE_BLOCK_ID;
-            break;
-        case DESFIRE_STORAGE_SIZE_8K:
-            MaxFreeBlocks = (BYTE)(0x400 - DESFIRE_FIRST_FREE_BLOCK_ID);
-            break;
-        default:
-            return 0;
+/* Returns false, without changing anything, if the extent needs an entry
+ * of its own and the list is full */
+static bool InsertFreeExtent(uint16_t StartBlock, uint16_t BlockCount) {
+    if (StartBlock == 0 || BlockCount == 0) {
+        return true;
+    }
+    uint16_t EndBlock = StartBlock + BlockCount;
+    if (EndBlock == Picc.FirstFreeBlock) {
+        /* Give the blocks back to the unused space at the end, along with
+         * the extent right below them */
+        uint8_t Last = FreeBlockList.ExtentCount - 1;
+        if (FreeBlockList.ExtentCount > 0 &&
+                FreeBlockList.Extents[Last].StartBlock + FreeBlockList.Extents[Last].BlockCount == StartBlock) {
+            StartBlock = FreeBlockList.Extents[Last].StartBlock;
+            FreeBlockList.ExtentCount--;
+            SynchronizeFreeBlockList();
+        }
+        Picc.FirstFreeBlock = StartBlock;
+        DESFIRE_FIRST_FREE_BLOCK_ID = Picc.FirstFreeBlock;
+        SynchronizePICCInfo();
+        return true;
+    }
+    /* Find the position in the list and merge with the neighbours */
+    uint8_t Index = 0;
+    while (Index < FreeBlockList.ExtentCount && FreeBlockList.Extents[Index].StartBlock < StartBlock) {
+        Index++;
+    }
+    bool MergeBelow = Index > 0 &&
+                      FreeBlockList.Extents[Index - 1].StartBlock + FreeBlockList.Extents[Index - 1].BlockCount == StartBlock;
+    bool MergeAbove = Index < FreeBlockList.ExtentCount &&
+                      FreeBlockList.Extents[Index].StartBlock == EndBlock;
+    if (MergeBelow && MergeAbove) {
+        FreeBlockList.Extents[Index - 1].BlockCount += BlockCount + FreeBlockList.Extents[Index].BlockCount;
+        RemoveFreeExtent(Index);
+    } else if (MergeBelow) {
+        FreeBlockList.Extents[Index - 1].BlockCount += BlockCount;
+    } else if (MergeAbove) {
+        FreeBlockList.Extents[Index].StartBlock = StartBlock;
+        FreeBlockList.Extents[Index].BlockCount += BlockCount;
+    } else if (FreeBlockList.ExtentCount == DESFIRE_MAX_FREE_EXTENTS) {
+        return false;
+    } else {
+        memmove(&FreeBlockList.Extents[Index + 1], &FreeBlockList.Extents[Index],
+                (FreeBlockList.ExtentCount - Index) * sizeof(DESFireFreeExtentType));
+        FreeBlockList.Extents[Index].StartBlock = StartBlock;
+        FreeBlockList.Extents[Index].BlockCount = BlockCount;
+        FreeBlockList.ExtentCount++;
+    }
+    SynchronizeFreeBlockList();
+    return true;
+}
+
+void FreeBlockExtents(DESFireFreeExtentType *Extents, uint8_t ExtentCount) {
+    for (uint8_t i = 0; i < ExtentCount; i++) {
+        if (InsertFreeExtent(Extents[i].StartBlock, Extents[i].BlockCount)) {
+            continue;
+        }
+        /* The list is full: squeeze the listed extents out of the storage
+         * now. The blocks still to be freed move down with the rest, and
+         * the emptied list takes them afterwards. */
+        for (uint8_t j = i; j < ExtentCount; j++) {
+            Extents[j].StartBlock = CompactedBlockId(Extents[j].StartBlock);
+        }
+        CompactPiccStorageInSession();
+        InsertFreeExtent(Extents[i].StartBlock, Extents[i].BlockCount);
+    }
+}
+
+void FreeBlocks(uint16_t StartBlock, uint16_t BlockCount) {
+    DESFireFreeExtentType Extent = { StartBlock, BlockCount };
+    FreeBlockExtents(&Extent, 1);
+}
+
+void MoveBlocksDown(uint16_t DestBlock, uint16_t SrcBlock, uint16_t BlockCount) {
+    uint8_t Buffer[DESFIRE_MOVE_BLOCKS_CHUNK_SIZE];
+    uint16_t DestAddress = DestBlock * BLOCKWISE_IO_MULTIPLIER;
+    uint16_t SrcAddress = SrcBlock * BLOCKWISE_IO_MULTIPLIER;
+    uint16_t ByteCount = BlockCount * BLOCKWISE_IO_MULTIPLIER;
+    /* The destination is below the source, so copying front to back never
+     * overwrites data which has not been moved yet */
+    while (ByteCount > 0) {
+        uint16_t ChunkSize = MIN(ByteCount, sizeof(Buffer));
+        MemoryReadBlockInSetting(Buffer, SrcAddress, ChunkSize);
+        MemoryWriteBlockInSetting(Buffer, DestAddress, ChunkSize);
+        SrcAddress += ChunkSize;
+        DestAddress += ChunkSize;
+        ByteCount -= ChunkSize;
+    }
+}
+
+uint16_t GetCardCapacityBlocks(void) {
+    return GetStorageEndBlock() - DESFIRE_INITIAL_FIRST_FREE_BLOCK_ID;
+}
+
+uint16_t GetFreeBlockCount(void) {
+    uint16_t EndBlock = GetStorageEndBlock();
+    /* The last block is never handed out, see AllocateBlocksMain */
+    uint16_t FreeBlockCount = (EndBlock > Picc.FirstFreeBlock) ? (EndBlock - Picc.FirstFreeBlock - 1) : 0;
+    for (uint8_t i = 0; i < FreeBlockList.ExtentCount; i++) {
+        FreeBlockCount += FreeBlockList.Extents[i].BlockCount;
     }
-    return MaxFreeBlocks - Picc.FirstFreeBlock;
+    return FreeBlockCount;
 }
 
 uint16_t StorageSizeToBytes(uint8_t StorageSize) {
@@ -120,14 +251,16 @@ void MemoryRestoreDesfireHeaderBytes(bool LoadSettings) {
     memcpy(&Picc, &(GlobalSettings.ActiveSettingPtr->PiccHeaderData), sizeof(Picc));
 }
 
+/* The transfer pointers are byte addresses in the setting, so each frame
+ * payload moves in a single burst whatever the block size and offset */
 void ReadDataEEPROMSource(uint8_t *Buffer, uint8_t Count) {
-    MemoryReadBlock(Buffer, TransferState.ReadData.Source.Pointer, Count);
-    TransferState.ReadData.Source.Pointer += DESFIRE_BYTES_TO_BLOCKS(Count);
+    MemoryReadBlockInSetting(Buffer, TransferState.ReadData.Source.Pointer, Count);
+    TransferState.ReadData.Source.Pointer += Count;
 }
 
 void WriteDataEEPROMSink(uint8_t *Buffer, uint8_t Count) {
-    MemoryWriteBlock(Buffer, TransferState.WriteData.Sink.Pointer, Count);
-    TransferState.WriteData.Sink.Pointer += DESFIRE_BYTES_TO_BLOCKS(Count);
+    MemoryWriteBlockInSetting(Buffer, TransferState.WriteData.Sink.Pointer, Count);
+    TransferState.WriteData.Sink.Pointer += Count;
 }
 
 #endif /* CONFIG_MF_DESFIRE_SUPPORT */
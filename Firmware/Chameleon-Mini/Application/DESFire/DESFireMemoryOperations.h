@@ -29,6 +29,7 @@ This notice must be retained at the top of all source files where indicated.
 
 #include "DESFireFirmwareSettings.h"
 #include "DESFireLogging.h"
+#include "DESFirePICCHeaderLayout.h"
 
 /* Reserve some space on the stack (text / data segment) for intermediate
    storage of strings and data we need to write so we do not have to rely
@@ -44,10 +45,25 @@ void ReadBlockBytes(void *Buffer, SIZET StartBlock, SIZET Count);
 void WriteBlockBytesMain(const void *Buffer, SIZET StartBlock, SIZET Count);
 #define WriteBlockBytes(Buffer, StartBlock, Count)    WriteBlockBytesMain(Buffer, StartBlock, Count);
 
+/* Storage allocation: blocks are taken best fit from the extents freed by
+ * deleted files and applications, then from the unused space at the end.
+ * CompactPiccStorage squeezes the free extents out between sessions, and
+ * right away when the free list is full. This moves blocks, so callers
+ * freeing several extents pass them to FreeBlockExtents at once and must
+ * reread any other block id afterwards, and nothing may be freed while
+ * the transaction journal is open. */
+#define DESFIRE_MOVE_BLOCKS_CHUNK_SIZE      (32)
+
 uint16_t AllocateBlocksMain(uint16_t BlockCount);
 #define AllocateBlocks(BlockCount)    AllocateBlocksMain(BlockCount);
+void FreeBlocks(uint16_t StartBlock, uint16_t BlockCount);
+void FreeBlockExtents(DESFireFreeExtentType *Extents, uint8_t ExtentCount);
+void MoveBlocksDown(uint16_t DestBlock, uint16_t SrcBlock, uint16_t BlockCount);
+void SynchronizeFreeBlockList(void);
+void LoadFreeBlockList(void);
 
-BYTE GetCardCapacityBlocks(void);
+uint16_t GetCardCapacityBlocks(void);
+uint16_t GetFreeBlockCount(void);
 uint16_t StorageSizeToBytes(uint8_t StorageSize);
 
 void MemoryStoreDesfireHeaderBytes(void);
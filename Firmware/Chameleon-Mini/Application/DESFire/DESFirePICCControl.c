@@ -29,6 +29,9 @@ This notice must be retained at the top of all source files where indicated.
 #include "../../Settings.h"
 #include "../../Log.h"
 #include "../../Random.h"
+#include "../../Memory.h"
+#include "../../Codec/Codec.h"
+#include "../MifareDESFire.h"
 #include "../CryptoTDEA.h"
 
 #include "DESFirePICCControl.h"
@@ -37,6 +40,7 @@ This notice must be retained at the top of all source files where indicated.
 #include "DESFireStatusCodes.h"
 #include "DESFireISO14443Support.h"
 #include "DESFireMemoryOperations.h"
+#include "DESFireTransactionJournal.h"
 #include "DESFireUtils.h"
 #include "DESFireCrypto.h"
 #include "DESFireCryptoTests.h"
@@ -50,11 +54,13 @@ BYTE APP_CACHE_FILE_ACCESS_RIGHTS_ARRAY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(DES
 BYTE APP_CACHE_KEY_VERSIONS_ARRAY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(DESFIRE_MAX_KEYS);
 BYTE APP_CACHE_KEY_TYPES_ARRAY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(DESFIRE_MAX_KEYS);
 BYTE APP_CACHE_KEY_BLOCKIDS_ARRAY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(2 * DESFIRE_MAX_KEYS);
-BYTE APP_CACHE_FILE_BLOCKIDS_ARRAY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(2 * DESFIRE_MAX_KEYS);
+BYTE APP_CACHE_FILE_BLOCKIDS_ARRAY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(2 * DESFIRE_MAX_FILES);
 BYTE APP_CACHE_MAX_KEY_BLOCK_SIZE = DESFIRE_BYTES_TO_BLOCKS(CRYPTO_MAX_KEY_SIZE);
 
 SIZET DESFIRE_PICC_INFO_BLOCK_ID = 0;
 SIZET DESFIRE_APP_DIR_BLOCK_ID = 0;
+SIZET DESFIRE_FREE_LIST_BLOCK_ID = 0;
+SIZET DESFIRE_JOURNAL_BLOCK_ID = 0;
 SIZET DESFIRE_INITIAL_FIRST_FREE_BLOCK_ID = 0;
 SIZET DESFIRE_FIRST_FREE_BLOCK_ID = 0;
 SIZET CardCapacityBlocks = 0;
@@ -65,16 +71,22 @@ void InitBlockSizes(void) {
     DESFIRE_PICC_INFO_BLOCK_ID = 0;
     DESFIRE_APP_DIR_BLOCK_ID = DESFIRE_PICC_INFO_BLOCK_ID +
                                DESFIRE_BYTES_TO_BLOCKS(sizeof(DESFirePICCInfoType));
-    DESFIRE_FIRST_FREE_BLOCK_ID = DESFIRE_APP_DIR_BLOCK_ID +
-                                  DESFIRE_BYTES_TO_BLOCKS(sizeof(DESFireAppDirType));
+    DESFIRE_FREE_LIST_BLOCK_ID = DESFIRE_APP_DIR_BLOCK_ID +
+                                 DESFIRE_BYTES_TO_BLOCKS(sizeof(DESFireAppDirType));
+    DESFIRE_JOURNAL_BLOCK_ID = DESFIRE_FREE_LIST_BLOCK_ID +
+                               DESFIRE_BYTES_TO_BLOCKS(sizeof(DESFireFreeListType));
+    DESFIRE_FIRST_FREE_BLOCK_ID = DESFIRE_JOURNAL_BLOCK_ID +
+                                  DESFIRE_BYTES_TO_BLOCKS(sizeof(DESFireJournalHeaderType) + DESFIRE_JOURNAL_SIZE);
     DESFIRE_INITIAL_FIRST_FREE_BLOCK_ID = DESFIRE_FIRST_FREE_BLOCK_ID;
 }
 
 DESFirePICCInfoType Picc = { 0 };
 DESFireAppDirType AppDir = { 0 };
+DESFireFreeListType FreeBlockList = { 0 };
 SelectedAppCacheType SelectedApp = { 0 };
 SelectedFileCacheType SelectedFile = { 0 };
 TransferStateType TransferState = { 0 };
+TransferPrefetchType TransferPrefetch = { 0 };
 
 /* Transfer routines */
 
@@ -91,8 +103,16 @@ TransferStatus PiccToPcdTransfer(uint8_t *Buffer) {
         } else {
             XferBytes = (uint8_t) TransferState.ReadData.BytesLeft;
         }
-        /* Read input bytes */
-        TransferState.ReadData.Source.Func(Buffer, XferBytes);
+        /* Read input bytes, the next payload may already be prefetched */
+        if (TransferPrefetch.Valid && TransferPrefetch.ByteCount == XferBytes &&
+                TransferPrefetch.Pointer == TransferState.ReadData.Source.Pointer &&
+                TransferState.ReadData.Source.Func == &ReadDataEEPROMSource) {
+            memcpy(Buffer, CodecBuffer2, XferBytes);
+            TransferState.ReadData.Source.Pointer += XferBytes;
+        } else {
+            TransferState.ReadData.Source.Func(Buffer, XferBytes);
+        }
+        TransferPrefetch.Valid = false;
         TransferState.ReadData.BytesLeft -= XferBytes;
         Status.BytesProcessed = XferBytes;
         Status.IsComplete = TransferState.ReadData.BytesLeft == 0;
@@ -105,6 +125,22 @@ TransferStatus PiccToPcdTransfer(uint8_t *Buffer) {
     return Status;
 }
 
+void PrefetchTransferData(void) {
+    if (TransferPrefetch.Valid || DesfireState != DESFIRE_READ_DATA_FILE ||
+            TransferState.ReadData.BytesLeft == 0 ||
+            TransferState.ReadData.Source.Func != &ReadDataEEPROMSource) {
+        return;
+    }
+    TransferPrefetch.ByteCount = MIN(TransferState.ReadData.BytesLeft, DESFIRE_MAX_PAYLOAD_SIZE);
+    TransferPrefetch.Pointer = TransferState.ReadData.Source.Pointer;
+    MemoryReadBlockInSetting(CodecBuffer2, TransferPrefetch.Pointer, TransferPrefetch.ByteCount);
+    TransferPrefetch.Valid = true;
+}
+
+void InvalidateTransferPrefetch(void) {
+    TransferPrefetch.Valid = false;
+}
+
 uint8_t PcdToPiccTransfer(uint8_t *Buffer, uint8_t Count) {
     TransferState.WriteData.Sink.Func(Buffer, Count);
     return STATUS_OPERATION_OK;
@@ -166,14 +202,26 @@ void InitialisePiccBackendEV0(uint8_t StorageSize, bool formatPICC) {
     /* Init backend */
     InitBlockSizes();
     CardCapacityBlocks = StorageSize;
+    if (!formatPICC) {
+        FinishTransactionJournalInFRAM();
+    }
     MemoryRecall();
+    InvalidateAppCache();
     ReadBlockBytes(&Picc, DESFIRE_PICC_INFO_BLOCK_ID, sizeof(DESFirePICCInfoType));
     if (formatPICC) {
         DesfireLogEntry(LOG_INFO_DESFIRE_PICC_RESET, (void *) NULL, 0);
         FactoryFormatPiccEV0();
     } else {
+        /* The copy of the header in the settings is not updated when
+         * blocks are allocated, the one in FRAM is */
+        uint16_t FirstFreeBlock = Picc.FirstFreeBlock;
         MemoryRestoreDesfireHeaderBytes(false);
+        Picc.FirstFreeBlock = FirstFreeBlock;
         ReadBlockBytes(&AppDir, DESFIRE_APP_DIR_BLOCK_ID, sizeof(DESFireAppDirType));
+        LoadFreeBlockList();
+        /* The journal holds byte addresses, replay it before compacting */
+        RecoverTransactionJournal();
+        CompactPiccStorage();
         DesfireATQAReset = true;
         SelectedApp.Slot = (uint8_t) -1;
         SelectPiccApp();
@@ -187,14 +235,26 @@ void InitialisePiccBackendEV1(uint8_t StorageSize, bool formatPICC) {
     /* Init backend */
     InitBlockSizes();
     CardCapacityBlocks = StorageSize;
+    if (!formatPICC) {
+        FinishTransactionJournalInFRAM();
+    }
     MemoryRecall();
+    InvalidateAppCache();
     ReadBlockBytes(&Picc, DESFIRE_PICC_INFO_BLOCK_ID, sizeof(DESFirePICCInfoType));
     if (formatPICC) {
         DesfireLogEntry(LOG_INFO_DESFIRE_PICC_RESET, (void *) NULL, 0);
         FactoryFormatPiccEV1(StorageSize);
     } else {
+        /* The copy of the header in the settings is not updated when
+         * blocks are allocated, the one in FRAM is */
+        uint16_t FirstFreeBlock = Picc.FirstFreeBlock;
         MemoryRestoreDesfireHeaderBytes(false);
+        Picc.FirstFreeBlock = FirstFreeBlock;
         ReadBlockBytes(&AppDir, DESFIRE_APP_DIR_BLOCK_ID, sizeof(DESFireAppDirType));
+        LoadFreeBlockList();
+        /* The journal holds byte addresses, replay it before compacting */
+        RecoverTransactionJournal();
+        CompactPiccStorage();
         DesfireATQAReset = true;
         SelectedApp.Slot = (uint8_t) -1;
         SelectPiccApp();
@@ -208,14 +268,26 @@ void InitialisePiccBackendEV2(uint8_t StorageSize, bool formatPICC) {
     /* Init backend */
     InitBlockSizes();
     CardCapacityBlocks = StorageSize;
+    if (!formatPICC) {
+        FinishTransactionJournalInFRAM();
+    }
     MemoryRecall();
+    InvalidateAppCache();
     ReadBlockBytes(&Picc, DESFIRE_PICC_INFO_BLOCK_ID, sizeof(DESFirePICCInfoType));
     if (formatPICC) {
         DesfireLogEntry(LOG_INFO_DESFIRE_PICC_RESET, (void *) NULL, 0);
         FactoryFormatPiccEV2(StorageSize);
     } else {
+        /* The copy of the header in the settings is not updated when
+         * blocks are allocated, the one in FRAM is */
+        uint16_t FirstFreeBlock = Picc.FirstFreeBlock;
         MemoryRestoreDesfireHeaderBytes(false);
+        Picc.FirstFreeBlock = FirstFreeBlock;
         ReadBlockBytes(&AppDir, DESFIRE_APP_DIR_BLOCK_ID, sizeof(DESFireAppDirType));
+        LoadFreeBlockList();
+        /* The journal holds byte addresses, replay it before compacting */
+        RecoverTransactionJournal();
+        CompactPiccStorage();
         DesfireATQAReset = true;
         SelectedApp.Slot = (uint8_t) -1;
         SelectPiccApp();
@@ -260,6 +332,11 @@ void FormatPicc(void) {
     /* Wipe application directory */
     memset(&AppDir, 0x00, sizeof(DESFireAppDirType));
     memset(&SelectedApp, 0x00, sizeof(SelectedAppCacheType));
+    InvalidateAppCache();
+    /* All blocks from Picc.FirstFreeBlock on are unused */
+    memset(&FreeBlockList, 0x00, sizeof(DESFireFreeListType));
+    SynchronizeFreeBlockList();
+    ResetTransactionJournal();
     /* Set a random new UID */
     BYTE uidData[DESFIRE_UID_SIZE];
     RandomGetBuffer(uidData, DESFIRE_UID_SIZE);
@@ -303,6 +380,98 @@ void FormatPicc(void) {
     CreatePiccApp();
 }
 
+/* Block ids are shifted down by the size of the free extents below them */
+SIZET CompactedBlockId(SIZET BlockId) {
+    SIZET Shift = 0;
+    if (BlockId == 0) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < FreeBlockList.ExtentCount && FreeBlockList.Extents[i].StartBlock < BlockId; i++) {
+        Shift += FreeBlockList.Extents[i].BlockCount;
+    }
+    return BlockId - Shift;
+}
+
+/* The moves and fix-ups only change the image in FRAM. Flash keeps the old
+ * layout until the next MemoryStore(), so after a power loss in the middle
+ * the backend init recalls it and compacts again from the start. Nothing
+ * stores the FRAM image on its own while a compaction runs: the only store
+ * at init is for a committed journal, and the journal is empty here. */
+void CompactPiccStorage(void) {
+    if (FreeBlockList.ExtentCount == 0) {
+        return;
+    }
+    /* Move the data above each free extent down over the extents below it */
+    SIZET Shift = 0;
+    for (uint8_t i = 0; i < FreeBlockList.ExtentCount; i++) {
+        SIZET DataStart = FreeBlockList.Extents[i].StartBlock + FreeBlockList.Extents[i].BlockCount;
+        SIZET DataEnd = (i + 1 < FreeBlockList.ExtentCount) ? FreeBlockList.Extents[i + 1].StartBlock : Picc.FirstFreeBlock;
+        Shift += FreeBlockList.Extents[i].BlockCount;
+        MoveBlocksDown(DataStart - Shift, DataStart, DataEnd - DataStart);
+    }
+    /* Then fix up every block id stored in the application structures */
+    for (uint8_t Slot = 0; Slot < DESFIRE_MAX_SLOTS; Slot++) {
+        if (AppDir.AppCacheStructBlockOffset[Slot] == 0) {
+            continue;
+        }
+        SIZET AppBlockId = CompactedBlockId(AppDir.AppCacheStructBlockOffset[Slot]);
+        AppDir.AppCacheStructBlockOffset[Slot] = AppBlockId;
+        SelectedAppCacheType AppData;
+        ReadBlockBytes(&AppData, AppBlockId, sizeof(SelectedAppCacheType));
+        AppData.KeySettings = CompactedBlockId(AppData.KeySettings);
+        AppData.FileNumbersArrayMap = CompactedBlockId(AppData.FileNumbersArrayMap);
+        AppData.FileCommSettings = CompactedBlockId(AppData.FileCommSettings);
+        AppData.FileAccessRights = CompactedBlockId(AppData.FileAccessRights);
+        AppData.FilesAddress = CompactedBlockId(AppData.FilesAddress);
+        AppData.KeyVersionsArray = CompactedBlockId(AppData.KeyVersionsArray);
+        AppData.KeyTypesArray = CompactedBlockId(AppData.KeyTypesArray);
+        AppData.KeyAddress = CompactedBlockId(AppData.KeyAddress);
+        WriteBlockBytes(&AppData, AppBlockId, sizeof(SelectedAppCacheType));
+        SIZET KeyBlockIds[DESFIRE_MAX_KEYS];
+        ReadBlockBytes(KeyBlockIds, AppData.KeyAddress, sizeof(SIZET) * DESFIRE_MAX_KEYS);
+        for (uint8_t KeyId = 0; KeyId < DESFIRE_MAX_KEYS; KeyId++) {
+            KeyBlockIds[KeyId] = CompactedBlockId(KeyBlockIds[KeyId]);
+        }
+        WriteBlockBytes(KeyBlockIds, AppData.KeyAddress, sizeof(SIZET) * DESFIRE_MAX_KEYS);
+        SIZET FileBlockIds[DESFIRE_MAX_FILES];
+        ReadBlockBytes(FileBlockIds, AppData.FilesAddress, sizeof(SIZET) * DESFIRE_MAX_FILES);
+        for (uint8_t FileIndex = 0; FileIndex < DESFIRE_MAX_FILES; FileIndex++) {
+            if (FileBlockIds[FileIndex] == 0) {
+                continue;
+            }
+            FileBlockIds[FileIndex] = CompactedBlockId(FileBlockIds[FileIndex]);
+            DESFireFileTypeSettings FileData;
+            ReadBlockBytes(&FileData, FileBlockIds[FileIndex], sizeof(DESFireFileTypeSettings));
+            FileData.FileDataAddress = CompactedBlockId(FileData.FileDataAddress);
+            WriteBlockBytes(&FileData, FileBlockIds[FileIndex], sizeof(DESFireFileTypeSettings));
+        }
+        WriteBlockBytes(FileBlockIds, AppData.FilesAddress, sizeof(SIZET) * DESFIRE_MAX_FILES);
+    }
+    Picc.FirstFreeBlock -= Shift;
+    DESFIRE_FIRST_FREE_BLOCK_ID = Picc.FirstFreeBlock;
+    FreeBlockList.ExtentCount = 0;
+    SynchronizeAppDir();
+    SynchronizePICCInfo();
+    SynchronizeFreeBlockList();
+    InvalidateAppCache();
+}
+
+/* Compaction between two commands: the selected application is written
+ * back before its block ids are fixed up and loaded again afterwards. The
+ * journal holds byte addresses, so it must not be open: DeleteFile refuses
+ * and DeleteApplication aborts the transaction before freeing anything. */
+void CompactPiccStorageInSession(void) {
+    uint8_t Slot = SelectedApp.Slot;
+    if (Slot < DESFIRE_MAX_SLOTS) {
+        WriteBlockBytes(&SelectedApp, AppDir.AppCacheStructBlockOffset[Slot], sizeof(SelectedAppCacheType));
+    }
+    CompactPiccStorage();
+    if (Slot < DESFIRE_MAX_SLOTS) {
+        ReadBlockBytes(&SelectedApp, AppDir.AppCacheStructBlockOffset[Slot], sizeof(SelectedAppCacheType));
+        SelectedApp.Slot = Slot;
+    }
+}
+
 void CreatePiccApp(void) {
     CryptoKeyBufferType Key;
     BYTE MasterAppAID[] = { 0x00, 0x00, 0x00 };
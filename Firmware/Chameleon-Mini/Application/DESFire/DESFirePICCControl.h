@@ -43,6 +43,7 @@ This notice must be retained at the top of all source files where indicated.
 /* Cached data: flush to FRAM or relevant EEPROM addresses if changed */
 extern DESFirePICCInfoType Picc;
 extern DESFireAppDirType AppDir;
+extern DESFireFreeListType FreeBlockList;
 
 /* Cached app data */
 extern SelectedAppCacheType SelectedApp;
@@ -64,19 +65,33 @@ typedef union DESFIRE_FIRMWARE_PACKING {
         SIZET BytesLeft;
         struct DESFIRE_FIRMWARE_ALIGNAT {
             TransferSourceFuncType Func;
-            SIZET Pointer; /* in FRAM */
+            SIZET Pointer; /* Byte address in the FRAM setting */
         } Source;
     } ReadData;
     struct DESFIRE_FIRMWARE_ALIGNAT {
         SIZET BytesLeft;
         struct DESFIRE_FIRMWARE_ALIGNAT {
             TransferSinkFuncType Func;
-            SIZET Pointer; /* in FRAM */
+            SIZET Pointer; /* Byte address in the FRAM setting */
         } Sink;
     } WriteData;
 } TransferStateType;
 extern TransferStateType TransferState;
 
+/* Read-ahead of the next frame payload of a data file read. It is filled
+ * by MifareDesfireAppTask while the current frame is load modulated, so
+ * the ADDITIONAL_FRAME answer only has to copy it. The data lives in
+ * CodecBuffer2, which the card emulation codec does not use. */
+typedef struct DESFIRE_FIRMWARE_PACKING {
+    bool Valid;
+    uint8_t ByteCount;
+    SIZET Pointer; /* Source address the data was read from */
+} TransferPrefetchType;
+extern TransferPrefetchType TransferPrefetch;
+
+void PrefetchTransferData(void);
+void InvalidateTransferPrefetch(void);
+
 /* Transfer routines */
 void SyncronizePICCInfo(void);
 TransferStatus PiccToPcdTransfer(uint8_t *Buffer);
@@ -89,6 +104,14 @@ uint8_t WriteDataFilterSetup(uint8_t CommSettings);
 /* PICC management */
 void FormatPicc(void);
 void CreatePiccApp(void);
+/* Squeezes out the free extents, moving the application data down. Only
+ * call this between sessions: SelectedApp has to be selected again.
+ * CompactPiccStorageInSession takes care of SelectedApp itself but needs a
+ * closed transaction journal, and CompactedBlockId tells where a block
+ * will be moved to. */
+SIZET CompactedBlockId(SIZET BlockId);
+void CompactPiccStorage(void);
+void CompactPiccStorageInSession(void);
 
 void InitialisePiccBackendEV0(uint8_t StorageSize, bool formatPICC);
 void InitialisePiccBackendEV1(uint8_t StorageSize, bool formatPICC);
@@ -36,8 +36,15 @@ This notice must be retained at the top of all source files where indicated.
 #define DESFIRE_NATIVE_CLA              0x90
 #define DESFIRE_ISO7816_CLA             0x00
 
-/* Storage allocation constants */
+/* Storage allocation constants: every structure and file data area starts
+ * on a block boundary, so 16 or 32 byte blocks keep them aligned to the
+ * FRAM burst size at the cost of some slack per allocation */
+#ifndef DESFIRE_BLOCK_SIZE
 #define DESFIRE_BLOCK_SIZE              (1)  /* Bytes */
+#endif
+#if DESFIRE_BLOCK_SIZE != 1 && DESFIRE_BLOCK_SIZE != 16 && DESFIRE_BLOCK_SIZE != 32
+#error "DESFIRE_BLOCK_SIZE has to be 1, 16 or 32 bytes"
+#endif
 #define DESFIRE_BYTES_TO_BLOCKS(x)      (((x) + DESFIRE_BLOCK_SIZE - 1) / DESFIRE_BLOCK_SIZE)
 
 #define DESFIRE_UID_SIZE                ISO14443A_UID_SIZE_DOUBLE
@@ -143,6 +150,76 @@ typedef struct DESFIRE_FIRMWARE_PACKING DESFIRE_FIRMWARE_ALIGNAT {
     uint8_t TransactionStarted;
 } DESFirePICCInfoType;
 
+/*
+ * Blocks returned by deleted files and applications. The extents are
+ * sorted by their first block and never adjacent to each other or to
+ * Picc.FirstFreeBlock. The list is stored after the application directory.
+ */
+#ifndef DESFIRE_MAX_FREE_EXTENTS
+#ifdef MEMORY_LIMITED_TESTING
+#define DESFIRE_MAX_FREE_EXTENTS        (8)
+#else
+#define DESFIRE_MAX_FREE_EXTENTS        (16)
+#endif
+#endif
+
+typedef struct DESFIRE_FIRMWARE_PACKING {
+    uint16_t StartBlock;
+    uint16_t BlockCount;
+} DESFireFreeExtentType;
+
+typedef struct DESFIRE_FIRMWARE_PACKING DESFIRE_FIRMWARE_ALIGNAT {
+    uint8_t ExtentCount;
+    DESFireFreeExtentType Extents[DESFIRE_MAX_FREE_EXTENTS];
+} DESFireFreeListType;
+
+/*
+ * Redo journal of the pending transaction, stored after the free list.
+ * Entries are appended behind the header and only become part of the
+ * journal when the single byte Length is updated, Commit is the flip of
+ * the single byte State to COMMITTED. Both are written on their own, so a
+ * torn write can not leave a half valid header behind. The data written
+ * to a backup file goes to the copy behind its data area, the journal
+ * only records the range to copy over, so the size of a write does not
+ * matter.
+ */
+#ifndef DESFIRE_JOURNAL_SIZE
+#ifdef MEMORY_LIMITED_TESTING
+#define DESFIRE_JOURNAL_SIZE            (96)
+#else
+#define DESFIRE_JOURNAL_SIZE            (192)
+#endif
+#endif
+
+#if DESFIRE_JOURNAL_SIZE > 255
+#error "DESFIRE_JOURNAL_SIZE has to fit into the one byte journal length"
+#endif
+
+#define DESFIRE_JOURNAL_EMPTY           (0x00)
+#define DESFIRE_JOURNAL_OPEN            (0xA5)
+#define DESFIRE_JOURNAL_COMMITTED       (0x5A)
+
+/* Journal entry types */
+#define DESFIRE_JOURNAL_VALUE_ENTRY     (0x02)   /* New clean value of the value file at Address */
+#define DESFIRE_JOURNAL_COPY_ENTRY      (0x03)   /* Bytes of a backup copy to copy to Address on commit */
+
+typedef struct DESFIRE_FIRMWARE_PACKING {
+    uint8_t State;
+    uint8_t Length;                     /* Bytes of complete entries */
+} DESFireJournalHeaderType;
+
+typedef struct DESFIRE_FIRMWARE_PACKING {
+    uint8_t Type;
+    uint8_t ByteCount;                  /* Data bytes following the entry header */
+    uint16_t Address;                   /* Byte address in the FRAM setting */
+} DESFireJournalEntryType;
+
+typedef struct DESFIRE_FIRMWARE_PACKING {
+    uint16_t Source;                    /* Byte address in the backup copy */
+    uint16_t Length;
+} DESFireJournalCopyType;
+
+
 typedef struct DESFIRE_FIRMWARE_PACKING DESFIRE_FIRMWARE_ALIGNAT {
     BYTE  Slot;
     BYTE  KeyCount;
@@ -172,6 +249,8 @@ extern BYTE APP_CACHE_MAX_KEY_BLOCK_SIZE;
 
 extern SIZET DESFIRE_PICC_INFO_BLOCK_ID;
 extern SIZET DESFIRE_APP_DIR_BLOCK_ID;
+extern SIZET DESFIRE_FREE_LIST_BLOCK_ID;
+extern SIZET DESFIRE_JOURNAL_BLOCK_ID;
 extern SIZET DESFIRE_INITIAL_FIRST_FREE_BLOCK_ID;
 extern SIZET DESFIRE_FIRST_FREE_BLOCK_ID;
 extern SIZET CardCapacityBlocks;
@@ -0,0 +1,312 @@
+/*
+The DESFire stack portion of this firmware source
+is free software written by Maxie Dion Schmidt (@maxieds):
+You can redistribute it and/or modify
+it under the terms of this license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+The complete source distribution of
+this firmware is available at the following link:
+https://github.com/maxieds/ChameleonMiniFirmwareDESFireStack.
+
+Based in part on the original DESFire code created by
+@dev-zzo (GitHub handle) [Dmitry Janushkevich] available at
+https://github.com/dev-zzo/ChameleonMini/tree/desfire.
+
+This notice must be retained at the top of all source files where indicated.
+*/
+
+/*
+ * DESFireTransactionJournal.c
+ * Pending changes to backup and value files until CommitTransaction
+ */
+
+#ifdef CONFIG_MF_DESFIRE_SUPPORT
+
+#include <stddef.h>
+#include <string.h>
+
+#include "../../Common.h"
+#include "../../Memory.h"
+#include "../../Settings.h"
+
+#include "DESFireTransactionJournal.h"
+#include "DESFirePICCControl.h"
+#include "DESFireMemoryOperations.h"
+#include "DESFireFile.h"
+#include "DESFireStatusCodes.h"
+
+#define JOURNAL_HEADER_ADDRESS          (DESFIRE_JOURNAL_BLOCK_ID * DESFIRE_BLOCK_SIZE)
+#define JOURNAL_ENTRIES_ADDRESS         (JOURNAL_HEADER_ADDRESS + sizeof(DESFireJournalHeaderType))
+
+#define VALUE_FILE_FIELD(FileAddress, Field) \
+    ((FileAddress) + offsetof(DESFireFileTypeSettings, ValueFile.Field))
+
+typedef void (*JournalEntryFuncType)(const DESFireJournalEntryType *Entry, uint16_t DataAddress);
+
+DESFireJournalHeaderType TransactionJournal = { 0 };
+
+static bool JournalEntriesValid;
+
+/* The header bytes are the only ordering points of the journal. The FRAM
+ * write-back cache has to be flushed around them, so that the entries are
+ * in FRAM before they are counted and the header before anything else. */
+static void WriteJournalHeaderByte(uint8_t Offset, uint8_t Value) {
+    MemoryCacheFlush();
+    MemoryWriteBlockInSetting(&Value, JOURNAL_HEADER_ADDRESS + Offset, 1);
+    MemoryCacheFlush();
+}
+
+static void WriteJournalState(uint8_t State) {
+    TransactionJournal.State = State;
+    WriteJournalHeaderByte(offsetof(DESFireJournalHeaderType, State), State);
+}
+
+static void WriteJournalLength(uint8_t Length) {
+    TransactionJournal.Length = Length;
+    WriteJournalHeaderByte(offsetof(DESFireJournalHeaderType, Length), Length);
+}
+
+static void OpenTransactionJournal(void) {
+    if (TransactionJournal.State != DESFIRE_JOURNAL_OPEN) {
+        WriteJournalLength(0);
+        WriteJournalState(DESFIRE_JOURNAL_OPEN);
+    }
+}
+
+static void ForEachJournalEntry(JournalEntryFuncType Func) {
+    uint16_t Position = 0;
+    while (Position + sizeof(DESFireJournalEntryType) <= TransactionJournal.Length) {
+        DESFireJournalEntryType Entry;
+        uint16_t EntryAddress = JOURNAL_ENTRIES_ADDRESS + Position;
+        MemoryReadBlockInSetting(&Entry, EntryAddress, sizeof(DESFireJournalEntryType));
+        Position += sizeof(DESFireJournalEntryType) + Entry.ByteCount;
+        if (Position > TransactionJournal.Length) {
+            break;
+        }
+        Func(&Entry, EntryAddress + sizeof(DESFireJournalEntryType));
+    }
+}
+
+static uint16_t FindValueEntryData(uint16_t FileAddress) {
+    uint16_t Position = 0;
+    while (Position + sizeof(DESFireJournalEntryType) <= TransactionJournal.Length) {
+        DESFireJournalEntryType Entry;
+        uint16_t EntryAddress = JOURNAL_ENTRIES_ADDRESS + Position;
+        MemoryReadBlockInSetting(&Entry, EntryAddress, sizeof(DESFireJournalEntryType));
+        if (Entry.Type == DESFIRE_JOURNAL_VALUE_ENTRY && Entry.Address == FileAddress) {
+            return EntryAddress + sizeof(DESFireJournalEntryType);
+        }
+        Position += sizeof(DESFireJournalEntryType) + Entry.ByteCount;
+    }
+    return 0;
+}
+
+/* The journal only ever refers to the allocated application data */
+static bool JournalRangeIsValid(uint16_t Address, uint16_t Length) {
+    uint32_t Start = (uint32_t) DESFIRE_INITIAL_FIRST_FREE_BLOCK_ID * DESFIRE_BLOCK_SIZE;
+    uint32_t End = MIN((uint32_t) Picc.FirstFreeBlock * DESFIRE_BLOCK_SIZE, MEMORY_SIZE_PER_SETTING);
+    return Address >= Start && Address <= End && Length <= End - Address;
+}
+
+static void CheckJournalEntry(const DESFireJournalEntryType *Entry, uint16_t DataAddress) {
+    bool Valid = false;
+    if (Entry->Type == DESFIRE_JOURNAL_VALUE_ENTRY) {
+        Valid = Entry->ByteCount == sizeof(int32_t) &&
+                JournalRangeIsValid(Entry->Address, sizeof(DESFireFileTypeSettings));
+    } else if (Entry->Type == DESFIRE_JOURNAL_COPY_ENTRY && Entry->ByteCount == sizeof(DESFireJournalCopyType)) {
+        DESFireJournalCopyType Copy;
+        MemoryReadBlockInSetting(&Copy, DataAddress, sizeof(DESFireJournalCopyType));
+        Valid = JournalRangeIsValid(Entry->Address, Copy.Length) && JournalRangeIsValid(Copy.Source, Copy.Length);
+    }
+    JournalEntriesValid = JournalEntriesValid && Valid;
+}
+
+/* A journal read back after a restart is checked as a whole before any of
+ * it is applied or rolled back */
+static bool TransactionJournalIsValid(void) {
+    if (TransactionJournal.Length > DESFIRE_JOURNAL_SIZE) {
+        return false;
+    }
+    JournalEntriesValid = true;
+    ForEachJournalEntry(&CheckJournalEntry);
+    return JournalEntriesValid;
+}
+
+/* Only the bytes which differ are written */
+static void UpdateInt32(uint16_t Address, int32_t Value) {
+    int32_t Stored;
+    MemoryReadBlockInSetting(&Stored, Address, sizeof(int32_t));
+    if (Stored != Value) {
+        MemoryWriteBlockInSetting(&Value, Address, sizeof(int32_t));
+    }
+}
+
+/* Redo an entry, applying it twice gives the same result */
+static void ApplyJournalEntry(const DESFireJournalEntryType *Entry, uint16_t DataAddress) {
+    if (Entry->Type == DESFIRE_JOURNAL_VALUE_ENTRY) {
+        int32_t CleanValue;
+        MemoryReadBlockInSetting(&CleanValue, DataAddress, sizeof(int32_t));
+        UpdateInt32(VALUE_FILE_FIELD(Entry->Address, CleanValue), CleanValue);
+        UpdateInt32(VALUE_FILE_FIELD(Entry->Address, PreviousDebit), 0);
+    } else if (Entry->Type == DESFIRE_JOURNAL_COPY_ENTRY) {
+        uint8_t Chunk[DESFIRE_MOVE_BLOCKS_CHUNK_SIZE];
+        DESFireJournalCopyType Copy;
+        MemoryReadBlockInSetting(&Copy, DataAddress, sizeof(DESFireJournalCopyType));
+        uint16_t Address = Entry->Address;
+        while (Copy.Length > 0) {
+            uint8_t Count = MIN(Copy.Length, sizeof(Chunk));
+            MemoryReadBlockInSetting(Chunk, Copy.Source, Count);
+            MemoryWriteBlockInSetting(Chunk, Address, Count);
+            Copy.Source += Count;
+            Address += Count;
+            Copy.Length -= Count;
+        }
+    }
+}
+
+/* Backup file data is only in the backup copy yet, only value files need
+ * their dirty value reset */
+static void RollbackJournalEntry(const DESFireJournalEntryType *Entry, uint16_t DataAddress) {
+    if (Entry->Type == DESFIRE_JOURNAL_VALUE_ENTRY) {
+        int32_t CleanValue;
+        MemoryReadBlockInSetting(&CleanValue, VALUE_FILE_FIELD(Entry->Address, CleanValue), sizeof(int32_t));
+        UpdateInt32(VALUE_FILE_FIELD(Entry->Address, DirtyValue), CleanValue);
+        UpdateInt32(VALUE_FILE_FIELD(Entry->Address, PreviousDebit), 0);
+    }
+}
+
+void ResetTransactionJournal(void) {
+    WriteJournalState(DESFIRE_JOURNAL_EMPTY);
+    WriteJournalLength(0);
+}
+
+void FinishTransactionJournalInFRAM(void) {
+    /* Only trust the FRAM if it holds the image of this card. The init
+     * reads the PICC info again after the recall. */
+    MemoryReadBlockInSetting(&Picc, DESFIRE_PICC_INFO_BLOCK_ID * DESFIRE_BLOCK_SIZE, sizeof(DESFirePICCInfoType));
+    if (memcmp(Picc.Uid, GlobalSettings.ActiveSettingPtr->PiccHeaderData.Uid, DESFIRE_UID_SIZE) != 0) {
+        return;
+    }
+    MemoryReadBlockInSetting(&TransactionJournal, JOURNAL_HEADER_ADDRESS, sizeof(DESFireJournalHeaderType));
+    if (TransactionJournal.State != DESFIRE_JOURNAL_COMMITTED || !TransactionJournalIsValid()) {
+        return;
+    }
+    ForEachJournalEntry(&ApplyJournalEntry);
+    WriteJournalState(DESFIRE_JOURNAL_EMPTY);
+    /* The rest of the session is in FRAM as well, store all of it so that
+     * flash does not mix the new pages with the old layout */
+    MemoryStoreAll();
+}
+
+void RecoverTransactionJournal(void) {
+    MemoryReadBlockInSetting(&TransactionJournal, JOURNAL_HEADER_ADDRESS, sizeof(DESFireJournalHeaderType));
+    if (!TransactionJournalIsValid()) {
+        ResetTransactionJournal();
+        return;
+    }
+    switch (TransactionJournal.State) {
+        case DESFIRE_JOURNAL_EMPTY:
+            break;
+        case DESFIRE_JOURNAL_COMMITTED:
+            /* Torn while applying the entries: finish the commit */
+            ForEachJournalEntry(&ApplyJournalEntry);
+            WriteJournalState(DESFIRE_JOURNAL_EMPTY);
+            break;
+        case DESFIRE_JOURNAL_OPEN:
+            AbortTransactionJournal();
+            break;
+        default:
+            ResetTransactionJournal();
+            break;
+    }
+}
+
+uint8_t JournalValueUpdate(SIZET FileStructBlockId, int32_t DirtyValue) {
+    uint16_t FileAddress = FileStructBlockId * DESFIRE_BLOCK_SIZE;
+    OpenTransactionJournal();
+    uint16_t DataAddress = FindValueEntryData(FileAddress);
+    if (DataAddress != 0) {
+        /* Not applied before the commit flip, so it can be updated in place */
+        MemoryWriteBlockInSetting(&DirtyValue, DataAddress, sizeof(int32_t));
+        return STATUS_OPERATION_OK;
+    }
+    uint16_t EntryLength = sizeof(DESFireJournalEntryType) + sizeof(int32_t);
+    if (TransactionJournal.Length + EntryLength > DESFIRE_JOURNAL_SIZE) {
+        return STATUS_OUT_OF_EEPROM_ERROR;
+    }
+    DESFireJournalEntryType Entry = {
+        .Type = DESFIRE_JOURNAL_VALUE_ENTRY,
+        .ByteCount = sizeof(int32_t),
+        .Address = FileAddress,
+    };
+    uint16_t EntryAddress = JOURNAL_ENTRIES_ADDRESS + TransactionJournal.Length;
+    MemoryWriteBlockInSetting(&Entry, EntryAddress, sizeof(DESFireJournalEntryType));
+    MemoryWriteBlockInSetting(&DirtyValue, EntryAddress + sizeof(DESFireJournalEntryType), sizeof(int32_t));
+    WriteJournalLength(TransactionJournal.Length + EntryLength);
+    return STATUS_OPERATION_OK;
+}
+
+uint8_t JournalDataWriteSetup(uint16_t Address, uint16_t CopyAddress, uint16_t Length) {
+    uint16_t EntryLength = sizeof(DESFireJournalEntryType) + sizeof(DESFireJournalCopyType);
+    if (TransactionJournal.Length + EntryLength > DESFIRE_JOURNAL_SIZE) {
+        return STATUS_OUT_OF_EEPROM_ERROR;
+    }
+    OpenTransactionJournal();
+    DESFireJournalEntryType Entry = {
+        .Type = DESFIRE_JOURNAL_COPY_ENTRY,
+        .ByteCount = sizeof(DESFireJournalCopyType),
+        .Address = Address,
+    };
+    DESFireJournalCopyType Copy = {
+        .Source = CopyAddress,
+        .Length = Length,
+    };
+    uint16_t EntryAddress = JOURNAL_ENTRIES_ADDRESS + TransactionJournal.Length;
+    MemoryWriteBlockInSetting(&Entry, EntryAddress, sizeof(DESFireJournalEntryType));
+    MemoryWriteBlockInSetting(&Copy, EntryAddress + sizeof(DESFireJournalEntryType), sizeof(DESFireJournalCopyType));
+    TransferState.WriteData.BytesLeft = Length;
+    TransferState.WriteData.Sink.Func = &WriteDataJournalSink;
+    TransferState.WriteData.Sink.Pointer = CopyAddress;
+    return STATUS_OPERATION_OK;
+}
+
+void WriteDataJournalSink(uint8_t *Buffer, uint8_t Count) {
+    if (Count > TransferState.WriteData.BytesLeft) {
+        Count = TransferState.WriteData.BytesLeft;
+    }
+    if (Count == 0) {
+        return;
+    }
+    MemoryWriteBlockInSetting(Buffer, TransferState.WriteData.Sink.Pointer, Count);
+    TransferState.WriteData.Sink.Pointer += Count;
+    TransferState.WriteData.BytesLeft -= Count;
+    if (TransferState.WriteData.BytesLeft == 0) {
+        /* The backup copy is complete, count the entry */
+        WriteJournalLength(TransactionJournal.Length + sizeof(DESFireJournalEntryType) + sizeof(DESFireJournalCopyType));
+    }
+}
+
+void CommitTransactionJournal(void) {
+    if (TransactionJournal.State != DESFIRE_JOURNAL_OPEN) {
+        return;
+    }
+    if (TransactionJournal.Length > 0) {
+        WriteJournalState(DESFIRE_JOURNAL_COMMITTED);
+        ForEachJournalEntry(&ApplyJournalEntry);
+    }
+    WriteJournalState(DESFIRE_JOURNAL_EMPTY);
+}
+
+void AbortTransactionJournal(void) {
+    if (TransactionJournal.State != DESFIRE_JOURNAL_OPEN) {
+        return;
+    }
+    ForEachJournalEntry(&RollbackJournalEntry);
+    WriteJournalState(DESFIRE_JOURNAL_EMPTY);
+}
+
+#endif /* CONFIG_MF_DESFIRE_SUPPORT */
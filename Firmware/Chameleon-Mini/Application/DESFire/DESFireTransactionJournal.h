@@ -0,0 +1,57 @@
+/*
+The DESFire stack portion of this firmware source
+is free software written by Maxie Dion Schmidt (@maxieds):
+You can redistribute it and/or modify
+it under the terms of this license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+The complete source distribution of
+this firmware is available at the following link:
+https://github.com/maxieds/ChameleonMiniFirmwareDESFireStack.
+
+Based in part on the original DESFire code created by
+@dev-zzo (GitHub handle) [Dmitry Janushkevich] available at
+https://github.com/dev-zzo/ChameleonMini/tree/desfire.
+
+This notice must be retained at the top of all source files where indicated.
+*/
+
+/*
+ * DESFireTransactionJournal.h :
+ * Pending changes to backup and value files until CommitTransaction
+ */
+
+#ifndef __DESFIRE_TRANSACTION_JOURNAL_H__
+#define __DESFIRE_TRANSACTION_JOURNAL_H__
+
+#include "DESFireFirmwareSettings.h"
+#include "DESFirePICCHeaderLayout.h"
+
+extern DESFireJournalHeaderType TransactionJournal;
+
+void ResetTransactionJournal(void);
+void RecoverTransactionJournal(void);
+
+/* A commit torn by a power loss is only in FRAM, which MemoryRecall()
+ * overwrites with the copy in flash: finish it and store the whole memory
+ * before the recall, if the FRAM holds the image of this card and the
+ * journal only refers to its application data */
+void FinishTransactionJournalInFRAM(void);
+
+/* Value files: the dirty value is changed right away, the clean value
+ * is only replaced on commit */
+uint8_t JournalValueUpdate(SIZET FileStructBlockId, int32_t DirtyValue);
+
+/* Backup files: the sink writes the data to the backup copy of the file
+ * and the journal copies it over the file data when the transaction is
+ * committed */
+uint8_t JournalDataWriteSetup(uint16_t Address, uint16_t CopyAddress, uint16_t Length);
+void WriteDataJournalSink(uint8_t *Buffer, uint8_t Count);
+
+void CommitTransactionJournal(void);
+void AbortTransactionJournal(void);
+
+#endif
@@ -248,4 +248,58 @@ uint16_t DesfirePostprocessAPDU(uint8_t CommMode, uint8_t *Buffer, uint16_t Buff
     }
 }
 
+uint8_t DesfireWrappedFramePrologueSize(const uint8_t *Buffer, uint16_t ByteCount) {
+    uint8_t PCB = Buffer[0];
+    uint8_t PrologueSize = 1;
+    if ((PCB & ISO14443_PCB_BLOCK_TYPE_MASK) != ISO14443_PCB_I_BLOCK ||
+            (PCB & ISO14443_PCB_I_BLOCK_STATIC) == 0x00 || (PCB & ISO14443_PCB_I_BLOCK_CHAINING_MASK) ||
+            (PCB & (ISO14443_PCB_HAS_CID_MASK | ISO14443_PCB_HAS_NAD_MASK))) {
+        return 0;
+    }
+    /* Header, Le and CRC_A around the data */
+    const uint8_t *Header = &Buffer[PrologueSize];
+    if (ByteCount < PrologueSize + DESFIRE_FRAME_WRAP_HEADER_SIZE + 1 + ISO14443A_CRCA_SIZE ||
+            Header[0] != DESFIRE_NATIVE_CLA || Header[2] != 0x00 || Header[3] != 0x00 ||
+            Header[4] != ByteCount - PrologueSize - DESFIRE_FRAME_WRAP_HEADER_SIZE - 1 - ISO14443A_CRCA_SIZE) {
+        return 0;
+    }
+    return PrologueSize;
+}
+
+uint16_t DesfireUnwrapFrame(DesfireFrameType *Frame, uint8_t *Buffer, uint16_t ByteCount, uint8_t PrologueSize) {
+    /* Checks and drops the CRC_A or MAC in place */
+    if (DesfirePreprocessAPDUAndTruncate(ActiveCommMode, Buffer, ByteCount) == 0) {
+        return 0;
+    }
+    uint8_t *Header = &Buffer[PrologueSize];
+    uint8_t Ins = Header[1];
+    Frame->PrologueSize = PrologueSize;
+    Frame->DataSize = Header[4];
+    if (Frame->DataSize <= DESFIRE_FRAME_MOVE_DATA_MAX) {
+        /* The answer will be right behind the prologue, which is kept aside */
+        memcpy(Frame->Prologue, Buffer, PrologueSize);
+        Frame->CommandOffset = PrologueSize - 1;
+        memmove(&Buffer[PrologueSize], &Header[DESFIRE_FRAME_WRAP_HEADER_SIZE], Frame->DataSize);
+    } else {
+        /* Long data, i.e. writes, are followed by short answers: the answer is moved instead */
+        Frame->CommandOffset = PrologueSize + DESFIRE_FRAME_WRAP_HEADER_SIZE - 1;
+    }
+    Buffer[Frame->CommandOffset] = Ins;
+    return Frame->DataSize + 1;
+}
+
+uint16_t DesfireRewrapFrame(const DesfireFrameType *Frame, uint8_t *Buffer, uint16_t AnswerSize) {
+    uint8_t PrologueSize = Frame->PrologueSize;
+    uint8_t Status = Buffer[Frame->CommandOffset];
+    if (Frame->CommandOffset + 1 != PrologueSize) {
+        memmove(&Buffer[PrologueSize], &Buffer[Frame->CommandOffset + 1], AnswerSize - 1);
+    } else {
+        memcpy(Buffer, Frame->Prologue, PrologueSize);
+    }
+    uint16_t FrameSize = PrologueSize + AnswerSize - 1;
+    Buffer[FrameSize++] = 0x91;
+    Buffer[FrameSize++] = Status;
+    return FrameSize;
+}
+
 #endif /* CONFIG_MF_DESFIRE_SUPPORT */
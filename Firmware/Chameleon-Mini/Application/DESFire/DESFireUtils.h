@@ -35,7 +35,8 @@ This notice must be retained at the top of all source files where indicated.
 #define ASBITS(bc)   ((bc) * BITS_PER_BYTE)
 
 #define GET_LE16(p)     (*((uint16_t*)&(p)[0]))
-#define GET_LE24(p)     (*((__uint24*)&(p)[0])) // Careful! Don't use this if the first byte is LSB!!
+/* Assembled byte-wise: __uint24 is wider than three bytes off the AVR */
+#define GET_LE24(p)     ((__uint24) (p)[0] | ((__uint24) (p)[1] << 8) | ((__uint24) (p)[2] << 16))
 #define GET_LE32(p)     (*((uint32_t*)&(p)[0]))
 
 #define UnsignedTypeToUINT(typeValue) \
@@ -89,4 +90,35 @@ uint16_t DesfirePreprocessAPDUWrapper(uint8_t CommMode, uint8_t *Buffer, uint16_
         DesfirePreprocessAPDUWrapper(CommMode, Buffer, BufferSize, true)
 uint16_t DesfirePostprocessAPDU(uint8_t CommMode, uint8_t *Buffer, uint16_t BufferSize);
 
+/* Native command wrapped in an ISO14443-4 I-block, as sent by libnfc and
+ * the PM3 'hf mfdes' commands:
+ *
+ *   [PCB] [90 INS 00 00 Lc] [Data] [Le] [CRC_A or MAC]
+ *
+ * Blocks with a CID or NAD are left to ISO144434ProcessBlock(), which
+ * checks the CID and keeps the block number.
+ *
+ * The frame is processed in place in the codec buffer. The descriptor
+ * keeps the offsets of the parts. DesfireUnwrapFrame() makes INS and the
+ * data contiguous at CommandOffset, either by writing INS over Lc or,
+ * for short data, by moving the data in front of the answer position.
+ * DesfireRewrapFrame() turns the answer of the command, status first,
+ * into [PCB] [Answer] [91 Status]. Together they move
+ * min(Lc, answer size) bytes instead of the whole frame several times.
+ */
+#define DESFIRE_FRAME_MOVE_DATA_MAX         (8)
+#define DESFIRE_FRAME_MAX_PROLOGUE_SIZE     (1)
+#define DESFIRE_FRAME_WRAP_HEADER_SIZE      (5)
+
+typedef struct {
+    uint8_t Prologue[DESFIRE_FRAME_MAX_PROLOGUE_SIZE];
+    uint8_t PrologueSize;
+    uint8_t CommandOffset;
+    uint8_t DataSize;
+} DesfireFrameType;
+
+uint8_t DesfireWrappedFramePrologueSize(const uint8_t *Buffer, uint16_t ByteCount);
+uint16_t DesfireUnwrapFrame(DesfireFrameType *Frame, uint8_t *Buffer, uint16_t ByteCount, uint8_t PrologueSize);
+uint16_t DesfireRewrapFrame(const DesfireFrameType *Frame, uint8_t *Buffer, uint16_t AnswerSize);
+
 #endif
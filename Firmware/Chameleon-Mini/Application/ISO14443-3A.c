@@ -56,82 +56,17 @@ bool ISO14443ASelectDesfire(void *Buffer, uint16_t *BitCount, uint8_t *UidCL, ui
 }
 #endif /* CONFIG_MF_DESFIRE_SUPPORT */
 
-#define USE_HW_CRC
-#ifdef USE_HW_CRC
 uint16_t ISO14443AAppendCRCA(void *Buffer, uint16_t ByteCount) {
     uint8_t *DataPtr = (uint8_t *) Buffer;
+    uint16_t Checksum = CRCACalc(DataPtr, ByteCount);
 
-    CRC.CTRL = CRC_RESET0_bm;
-    CRC.CHECKSUM1 = (CRC_INIT_R >> 8) & 0xFF;
-    CRC.CHECKSUM0 = (CRC_INIT_R >> 0) & 0xFF;
-    CRC.CTRL = CRC_SOURCE_IO_gc;
-
-    while (ByteCount--) {
-        uint8_t Byte = *DataPtr++;
-        Byte = BitReverseByte(Byte);
-
-        CRC.DATAIN = Byte;
-    }
-
-    DataPtr[0] = BitReverseByte(CRC.CHECKSUM1);
-    DataPtr[1] = BitReverseByte(CRC.CHECKSUM0);
-
-    CRC.CTRL = CRC_SOURCE_DISABLE_gc;
-
-    return (uint16_t)(((DataPtr[0] << 8) & 0x00FF00) | (DataPtr[1] & 0x00FF));
-}
-#else
-#include <util/crc16.h>
-uint16_t ISO14443AAppendCRCA(void *Buffer, uint16_t ByteCount) {
-    uint16_t Checksum = CRC_INIT;
-    uint8_t *DataPtr = (uint8_t *) Buffer;
-
-    while (ByteCount--) {
-        uint8_t Byte = *DataPtr++;
-        Checksum = _crc_ccitt_update(Checksum, Byte);
-    }
-
-    DataPtr[0] = (Checksum >> 0) & 0x00FF;
-    DataPtr[1] = (Checksum >> 8) & 0x00FF;
+    DataPtr[ByteCount + 0] = (Checksum >> 0) & 0x00FF;
+    DataPtr[ByteCount + 1] = (Checksum >> 8) & 0x00FF;
 
     return Checksum;
 }
-#endif
 
-#ifdef USE_HW_CRC
 bool ISO14443ACheckCRCA(const void *Buffer, uint16_t ByteCount) {
-    const uint8_t *DataPtr = (const uint8_t *) Buffer;
-
-    CRC.CTRL = CRC_RESET0_bm;
-    CRC.CHECKSUM1 = (CRC_INIT_R >> 8) & 0xFF;
-    CRC.CHECKSUM0 = (CRC_INIT_R >> 0) & 0xFF;
-    CRC.CTRL = CRC_SOURCE_IO_gc;
-
-    while (ByteCount--) {
-        uint8_t Byte = *DataPtr++;
-        Byte = BitReverseByte(Byte);
-
-        CRC.DATAIN = Byte;
-    }
-
-    bool Result = (DataPtr[0] == BitReverseByte(CRC.CHECKSUM1)) && (DataPtr[1] == BitReverseByte(CRC.CHECKSUM0));
-
-    CRC.CTRL = CRC_SOURCE_DISABLE_gc;
-
-    return Result;
-}
-#else
-#include <util/crc16.h>
-bool ISO14443ACheckCRCA(const void *Buffer, uint16_t ByteCount) {
-    uint16_t Checksum = CRC_INIT;
-    const uint8_t *DataPtr = (const uint8_t *) Buffer;
-
-    while (ByteCount--) {
-        uint8_t Byte = *DataPtr++;
-
-        Checksum = _crc_ccitt_update(Checksum, Byte);
-    }
-
-    return (DataPtr[0] == ((Checksum >> 0) & 0xFF)) && (DataPtr[1] == ((Checksum >> 8) & 0xFF));
+    /* The CRC over the data and its appended CRC is zero */
+    return CRCACalc(Buffer, ByteCount + ISO14443A_CRCA_SIZE) == 0;
 }
-#endif
@@ -9,6 +9,7 @@
 #define ISO14443_3A_H_
 
 #include "../Common.h"
+#include "CRC.h"
 #include <string.h>
 
 #define ISO14443A_UID_SIZE_SINGLE   4
@@ -42,9 +43,6 @@
 
 #define ISO14443A_CRCA_SIZE         2
 
-#define CRC_INIT                0x6363
-#define CRC_INIT_R              0xC6C6 /* Bit reversed */
-
 #define ISO14443A_CALC_BCC(ByteBuffer) (ByteBuffer[0] ^ ByteBuffer[1] ^ ByteBuffer[2] ^ ByteBuffer[3])
 
 uint16_t ISO14443AAppendCRCA(void *Buffer, uint16_t ByteCount);
@@ -2,7 +2,7 @@
 
 #include "ISO15693-A.h"
 #include "../Common.h"
-#include <util/crc16.h>
+#include "CRC.h"
 
 CurrentFrame FrameInfo;
 uint8_t Uid[ISO15693_GENERIC_UID_SIZE];
@@ -11,23 +11,7 @@ uint16_t ResponseByteCount;
 
 //Refer to ISO/IEC 15693-3:2001 page 41
 uint16_t calculateCRC(void *FrameBuf, uint16_t FrameBufSize) {
-    uint16_t reg = ISO15693_CRC16_PRESET;
-    uint8_t i, j;
-
-    uint8_t *DataPtr = (uint8_t *)FrameBuf;
-
-    for (i = 0; i < FrameBufSize; i++) {
-        reg = reg ^ *DataPtr++;
-        for (j = 0; j < 8; j++) {
-            if (reg & 0x0001) {
-                reg = (reg >> 1) ^ ISO15693_CRC16_POLYNORMAL;
-            } else {
-                reg = (reg >> 1);
-            }
-        }
-    }
-
-    return ~reg;
+    return CRCISO15693Calc(FrameBuf, FrameBufSize);
 }
 
 void ISO15693AppendCRC(uint8_t *FrameBuf, uint16_t FrameBufSize) {
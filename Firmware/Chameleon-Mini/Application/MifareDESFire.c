@@ -127,7 +127,9 @@ void MifareDesfireAppTick(void) {
 }
 
 void MifareDesfireAppTask(void) {
-    /* EMPTY -- Do nothing. */
+    /* Runs while the last answer is sent: read the payload of the next
+     * ADDITIONAL_FRAME of a pending data file read ahead of time */
+    PrefetchTransferData();
 }
 
 //Checks if this is an EV1 frame which's content needs decryption.
@@ -335,8 +337,25 @@ uint16_t MifareDesfireAppProcess(uint8_t *Buffer, uint16_t BitCount) {
          * Send out the same data as last time -- already the same as the Buffer contents:
          */
         return ISO14443ALastIncomingDataFrameBits;
-    } else {
-        ISO14443ALastIncomingDataFrameBits = ISO14443AStoreLastDataFrameAndReturn(Buffer, BitCount);
+    }
+
+    /* The common case of a native command wrapped in an I-block is
+     * processed in place, see DesfireUnwrapFrame() */
+    uint8_t PrologueSize = DesfireWrappedFramePrologueSize(Buffer, ByteCount);
+    if (PrologueSize > 0) {
+        DesfireFrameType Frame;
+        DesfireCmdCLA = DESFIRE_NATIVE_CLA;
+        uint16_t CommandSize = DesfireUnwrapFrame(&Frame, Buffer, ByteCount, PrologueSize);
+        if (CommandSize == 0) {
+            return ISO14443A_APP_NO_RESPONSE;
+        }
+        uint16_t AnswerSize = MifareDesfireProcessCommand(&Buffer[Frame.CommandOffset], CommandSize);
+        if (AnswerSize == 0) {
+            return ISO14443A_APP_NO_RESPONSE;
+        }
+        uint16_t FrameSize = DesfireRewrapFrame(&Frame, Buffer, AnswerSize);
+        FrameSize = DesfirePostprocessAPDU(ActiveCommMode, Buffer, FrameSize);
+        return ISO14443AStoreLastDataFrameAndReturn(Buffer, ASBITS(FrameSize));
     }
 
     if (ByteCount >= 8 && DesfireCLA(Buffer[1]) && Buffer[2] == STATUS_ADDITIONAL_FRAME &&
@@ -541,9 +560,12 @@ void MifareDesfireReset(void) {
 void ResetLocalStructureData(void) {
     memset(&Picc, PICC_FORMAT_BYTE, sizeof(Picc));
     memset(&AppDir, 0x00, sizeof(AppDir));
+    memset(&FreeBlockList, 0x00, sizeof(FreeBlockList));
     memset(&SelectedApp, 0x00, sizeof(SelectedApp));
     memset(&SelectedFile, 0x00, sizeof(SelectedFile));
+    InvalidateAppCache();
     memset(&TransferState, 0x00, sizeof(TransferState));
+    InvalidateTransferPrefetch();
     SelectedApp.Slot = 0;
     SelectedFile.Num = -1;
     MifareDesfireReset();
@@ -7,6 +7,8 @@
 #include "../Codec/Reader14443-2A.h"
 #include "Crypto1.h"
 #include "../System.h"
+#include "../Memory.h"
+#include "../Random.h"
 
 #include "../Terminal/Terminal.h"
 
@@ -20,6 +22,16 @@
 #define FLAGS_PARITY_OK	0x01
 #define FLAGS_NO_DATA	0x02
 
+#define MFC_CMD_READ        0x30
+#define MFC_CMD_AUTH_A      0x60
+#define MFC_CMD_AUTH_B      0x61
+#define MFC_BLOCK_SIZE      16
+#define MFC_KEY_SIZE        6
+#define MFC_KEY_A_OFFSET    0 // in the sector trailer
+#define MFC_KEY_B_OFFSET    10
+#define MFC_ACCESS_OFFSET   6
+#define MFC_NONCE_SIZE      4
+
 // TODO replace remaining magic numbers
 
 uint8_t ReaderSendBuffer[CODEC_BUFFER_SIZE];
@@ -28,6 +40,21 @@ uint16_t ReaderSendBitCount;
 static bool Selected = false;
 Reader14443Command Reader14443CurrentCommand = Reader14443_Do_Nothing;
 
+uint8_t ReaderBatchScript[READER_BATCH_SCRIPT_SIZE];
+uint16_t ReaderBatchScriptSize;
+
+/* The result records are collected in CodecBuffer2, which the reader codec does not use */
+#define READER_BATCH_RESULT_SIZE    CODEC_BUFFER_SIZE
+
+static struct {
+    uint8_t Offset; // next operation
+    uint8_t Frame; // operation of the frame that waits for its answer
+    uint8_t Jumps;
+    bool Pending;
+    bool Failed;
+    uint16_t ResultSize;
+} ReaderBatch;
+
 static enum {
     STATE_IDLE,
     STATE_HALT,
@@ -117,6 +144,53 @@ static const CardIdentificationType PROGMEM CardIdentificationList[] = {
 static CardType CardCandidates[ARRAY_COUNT(CardIdentificationList)];
 static uint8_t CardCandidatesIdx = 0;
 
+/* Key dictionary of DUMP_MFC and CLONE_MFC, tried for every sector after the
+ * key of the same type which has been found last */
+static const uint8_t PROGMEM MifareClassicKeys[][MFC_KEY_SIZE] = {
+    { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, // transport key
+    { 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 }, // MAD key A
+    { 0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5 },
+    { 0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7 }, // NFC Forum key A
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x4D, 0x3A, 0x99, 0xC3, 0x51, 0xDD },
+    { 0x1A, 0x98, 0x2C, 0x7E, 0x45, 0x9A },
+    { 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF },
+    { 0x71, 0x4C, 0x5C, 0x88, 0x6E, 0x97 },
+    { 0x58, 0x7E, 0xE5, 0xF9, 0x35, 0x0F },
+    { 0xA0, 0x47, 0x8C, 0xC3, 0x90, 0x91 },
+    { 0x53, 0x3C, 0xB6, 0xC7, 0x23, 0xF6 },
+    { 0x8F, 0xD0, 0xA4, 0xF2, 0x56, 0xE9 }
+};
+
+static struct {
+    enum {
+        MFC_STEP_START, // the card has to be selected and identified
+        MFC_STEP_RESELECT, // the card has to be selected again after an error
+        MFC_STEP_NONCE, // AUTH has been sent
+        MFC_STEP_AUTH, // the reader nonce and answer have been sent
+        MFC_STEP_READ // READ has been sent
+    } Step;
+    enum {
+        MFC_SESSION_NONE, // the card has left the active state
+        MFC_SESSION_SELECTED,
+        MFC_SESSION_AUTHENTICATED // a following AUTH is nested
+    } Session;
+    uint8_t SectorCount;
+    uint8_t Sector;
+    uint16_t Block; // next block to read
+    uint16_t UnreadBlocks; // one bit per block of the sector, set until it has been read
+    uint8_t KeyType; // 0 for key A, 1 for key B
+    uint8_t Candidate; // 0 for key B of the trailer, 1 for the last found key, then the dictionary
+    uint8_t Key[MFC_KEY_SIZE];
+    uint8_t KnownKey[2][MFC_KEY_SIZE]; // last found key A and key B
+    uint8_t TrailerKeyB[MFC_KEY_SIZE];
+    bool KnownKeyValid[2];
+    bool TrailerKeyBValid; // key B could be read from the trailer with key A
+    bool SectorKeyFound;
+    uint8_t CardResponse[MFC_NONCE_SIZE];
+    uint8_t MissingSectors;
+} MFCRead;
+
 uint16_t addParityBits(uint8_t *Buffer, uint16_t BitCount) {
     if (BitCount == 7)
         return 7;
@@ -178,6 +252,8 @@ bool checkParityBits(uint8_t *Buffer, uint16_t BitCount) {
 }
 
 void Reader14443AAppTimeout(void) {
+    /* A batch may have been aborted with its own frame waiting time */
+    Reader_FWT = ISO14443A_RX_PENDING_TIMEOUT;
     Reader14443AAppReset();
     Reader14443ACodecReset();
     ReaderState = STATE_IDLE;
@@ -191,6 +267,7 @@ void Reader14443AAppReset(void) {
     ReaderState = STATE_IDLE;
     Reader14443CurrentCommand = Reader14443_Do_Nothing;
     Selected = false;
+    MFCRead.Step = MFC_STEP_START;
 }
 
 void Reader14443AAppTask(void) {
@@ -201,6 +278,229 @@ void Reader14443AAppTick(void) {
 
 }
 
+/* Size of the operation at the given offset, 0 if it is malformed */
+static uint16_t BatchOperationSize(uint16_t Offset) {
+    const uint8_t *Operation = &ReaderBatchScript[Offset];
+    uint16_t Left = ReaderBatchScriptSize - Offset;
+    uint16_t Size;
+
+    switch (Operation[0] & READER_BATCH_OP_MASK) {
+        case READER_BATCH_OP_END:
+            return (Operation[0] & ~READER_BATCH_OP_MASK) ? 0 : 1;
+
+        case READER_BATCH_OP_SEND:
+            if ((Left < 4) || (Operation[3] == 0)) {
+                return 0;
+            }
+            if ((Operation[0] & ~(READER_BATCH_OP_MASK | READER_BATCH_FLAG_CRC | READER_BATCH_FLAG_SHORT)) ||
+                    ((Operation[0] & READER_BATCH_FLAG_SHORT) && ((Operation[0] & READER_BATCH_FLAG_CRC) || (Operation[3] != 1)))) {
+                return 0;
+            }
+            /* The frame with CRC_A and parity bits has to fit into the codec buffer */
+            if ((Operation[3] + ISO14443A_CRCA_SIZE) * 9 / 8 + 1 > CODEC_BUFFER_SIZE) {
+                return 0;
+            }
+            Size = 4 + Operation[3];
+            break;
+
+        case READER_BATCH_OP_SEND_RAW:
+            if ((Left < 5) || (Operation[0] & ~READER_BATCH_OP_MASK)) {
+                return 0;
+            }
+            Size = ((uint16_t) Operation[3] << 8) | Operation[4];
+            if ((Size == 0) || (Size > CODEC_BUFFER_SIZE * BITS_PER_BYTE)) {
+                return 0;
+            }
+            Size = 5 + (Size + 7) / 8;
+            break;
+
+        case READER_BATCH_OP_JUMP:
+        case READER_BATCH_OP_JUMP_IF_FAIL:
+            if (Operation[0] & ~READER_BATCH_OP_MASK) {
+                return 0;
+            }
+            Size = 2;
+            break;
+
+        default:
+            return 0;
+    }
+
+    return (Size <= Left) ? Size : 0;
+}
+
+bool Reader14443ABatchCheck(void) {
+    uint16_t Offset = 0;
+
+    while (Offset < ReaderBatchScriptSize) {
+        uint16_t Size = BatchOperationSize(Offset);
+        uint8_t Opcode = ReaderBatchScript[Offset] & READER_BATCH_OP_MASK;
+
+        if (Size == 0) {
+            return false;
+        }
+
+        if ((Opcode == READER_BATCH_OP_JUMP) || (Opcode == READER_BATCH_OP_JUMP_IF_FAIL)) {
+            /* The target has to be the start of an operation */
+            uint16_t Target = ReaderBatchScript[Offset + 1];
+            uint16_t TargetOffset = 0;
+
+            while (TargetOffset < Target) {
+                uint16_t TargetSize = BatchOperationSize(TargetOffset);
+
+                if (TargetSize == 0) {
+                    return false;
+                }
+                TargetOffset += TargetSize;
+            }
+            if ((TargetOffset != Target) || (Target >= ReaderBatchScriptSize)) {
+                return false;
+            }
+        }
+
+        Offset += Size;
+    }
+
+    /* Offsets are single bytes */
+    return (ReaderBatchScriptSize > 0) && (ReaderBatchScriptSize < 0x100);
+}
+
+void Reader14443ABatchStart(void) {
+    ReaderBatch.Offset = 0;
+    ReaderBatch.Jumps = READER_BATCH_JUMPS_MAX;
+    ReaderBatch.Pending = false;
+    ReaderBatch.Failed = false;
+    ReaderBatch.ResultSize = 0;
+    Reader14443CurrentCommand = Reader14443_Batch;
+}
+
+/* Appends the result record of the frame, returns false if the result buffer is full */
+static bool BatchStoreResult(uint8_t *Buffer, uint16_t BitCount) {
+    const uint8_t *Operation = &ReaderBatchScript[ReaderBatch.Frame];
+    uint8_t *Result = &CodecBuffer2[ReaderBatch.ResultSize];
+    /* There is always room for the header, see below */
+    uint16_t Left = READER_BATCH_RESULT_SIZE - ReaderBatch.ResultSize - READER_BATCH_RESULT_HEADER_SIZE;
+    uint8_t Status = 0;
+
+    if (BitCount == 0) {
+        Status |= READER_BATCH_NO_DATA;
+    } else if ((Operation[0] & READER_BATCH_OP_MASK) == READER_BATCH_OP_SEND) {
+        /* Answers shorter than a byte, e.g. ACK and NAK, have no parity bit */
+        if (BitCount >= 9) {
+            if (!checkParityBits(Buffer, BitCount)) {
+                Status |= READER_BATCH_PARITY_ERROR;
+            }
+            BitCount = removeParityBits(Buffer, BitCount);
+        }
+        if ((Operation[0] & READER_BATCH_FLAG_CRC) && ((BitCount < (ISO14443A_CRCA_SIZE + 1) * BITS_PER_BYTE) ||
+                !ISO14443ACheckCRCA(Buffer, BitCount / BITS_PER_BYTE - ISO14443A_CRCA_SIZE))) {
+            Status |= READER_BATCH_CRC_ERROR;
+        }
+    }
+
+    uint16_t ByteCount = (BitCount + 7) / 8;
+
+    if ((BitCount != 0) && (Operation[2] != READER_BATCH_ANY_LENGTH) && (Operation[2] != ByteCount)) {
+        Status |= READER_BATCH_LENGTH_MISMATCH;
+    }
+
+    ReaderBatch.Failed = (Status != 0);
+
+    if (ByteCount > Left) {
+        ByteCount = Left;
+        BitCount = ByteCount * BITS_PER_BYTE;
+    }
+
+    if (Left - ByteCount < READER_BATCH_RESULT_HEADER_SIZE) {
+        /* No room for the result of another frame */
+        Status |= READER_BATCH_TRUNCATED;
+    }
+
+    Result[0] = ReaderBatch.Frame;
+    Result[1] = Status;
+    Result[2] = (uint8_t)(BitCount >> 8);
+    Result[3] = (uint8_t)(BitCount >> 0);
+    memcpy(&Result[READER_BATCH_RESULT_HEADER_SIZE], Buffer, ByteCount);
+    ReaderBatch.ResultSize += READER_BATCH_RESULT_HEADER_SIZE + ByteCount;
+
+    return !(Status & READER_BATCH_TRUNCATED);
+}
+
+/* Returns the bit count of the next frame of the script, or 0 when it has ended */
+static uint16_t BatchNextFrame(uint8_t *Buffer) {
+    while (ReaderBatch.Offset < ReaderBatchScriptSize) {
+        const uint8_t *Operation = &ReaderBatchScript[ReaderBatch.Offset];
+        uint16_t BitCount;
+
+        switch (Operation[0] & READER_BATCH_OP_MASK) {
+            case READER_BATCH_OP_SEND: {
+                uint8_t ByteCount = Operation[3];
+
+                memcpy(Buffer, &Operation[4], ByteCount);
+                if (Operation[0] & READER_BATCH_FLAG_SHORT) {
+                    BitCount = 7;
+                } else {
+                    if (Operation[0] & READER_BATCH_FLAG_CRC) {
+                        ISO14443AAppendCRCA(Buffer, ByteCount);
+                        ByteCount += ISO14443A_CRCA_SIZE;
+                    }
+                    BitCount = addParityBits(Buffer, ByteCount * BITS_PER_BYTE);
+                }
+                break;
+            }
+
+            case READER_BATCH_OP_SEND_RAW:
+                BitCount = ((uint16_t) Operation[3] << 8) | Operation[4];
+                memcpy(Buffer, &Operation[5], (BitCount + 7) / 8);
+                break;
+
+            case READER_BATCH_OP_JUMP:
+            case READER_BATCH_OP_JUMP_IF_FAIL:
+                if (((Operation[0] & READER_BATCH_OP_MASK) == READER_BATCH_OP_JUMP) || ReaderBatch.Failed) {
+                    if (ReaderBatch.Jumps-- == 0) {
+                        return 0;
+                    }
+                    ReaderBatch.Offset = Operation[1];
+                } else {
+                    ReaderBatch.Offset += 2;
+                }
+                continue;
+
+            default: // END
+                return 0;
+        }
+
+        Reader_FWT = (Operation[1] != 0) ? Operation[1] : ISO14443A_RX_PENDING_TIMEOUT;
+        ReaderBatch.Frame = ReaderBatch.Offset;
+        ReaderBatch.Offset += BatchOperationSize(ReaderBatch.Offset);
+        ReaderBatch.Pending = true;
+        return BitCount;
+    }
+
+    return 0;
+}
+
+static uint16_t Reader14443A_Batch(uint8_t *Buffer, uint16_t BitCount) {
+    if (ReaderBatch.Pending) {
+        ReaderBatch.Pending = false;
+        if (!BatchStoreResult(Buffer, BitCount)) {
+            ReaderBatch.Offset = ReaderBatchScriptSize;
+        }
+    }
+
+    BitCount = BatchNextFrame(Buffer);
+
+    if (BitCount == 0) {
+        /* The field stays on like after SEND, the card keeps its state */
+        Reader_FWT = ISO14443A_RX_PENDING_TIMEOUT;
+        Reader14443CurrentCommand = Reader14443_Do_Nothing;
+        CommandLinePendingTaskFinished(COMMAND_INFO_OK_WITH_TEXT_ID, NULL);
+        CommandLineAppendData(CodecBuffer2, ReaderBatch.ResultSize);
+    }
+
+    return BitCount;
+}
+
 static uint16_t Reader14443A_Deselect(uint8_t *Buffer) { // deselects the card because of an error, so we will continue to select the card afterwards
     Buffer[0] = 0xC2;
     ISO14443AAppendCRCA(Buffer, 1);
@@ -483,6 +783,366 @@ static bool Identify(uint8_t *Buffer, uint16_t *BitCount) {
     return false;
 }
 
+INLINE uint8_t MifareClassicFirstBlock(uint8_t Sector) {
+    return (Sector < 32) ? Sector * 4 : 128 + (Sector - 32) * 16;
+}
+
+INLINE uint8_t MifareClassicTrailerBlock(uint8_t Sector) {
+    return (Sector < 32) ? Sector * 4 + 3 : 128 + (Sector - 32) * 16 + 15;
+}
+
+/* Key B of the trailer is only tried for key B */
+INLINE bool MifareClassicTrailerKeyBUsable(void) {
+    return (MFCRead.KeyType == 1) && MFCRead.TrailerKeyBValid;
+}
+
+/* Loads the key of the current candidate, returns false if there is none left */
+static bool MifareClassicLoadKey(void) {
+    if (MFCRead.Candidate == 0) {
+        if (MifareClassicTrailerKeyBUsable()) {
+            memcpy(MFCRead.Key, MFCRead.TrailerKeyB, MFC_KEY_SIZE);
+            return true;
+        }
+        MFCRead.Candidate++;
+    }
+
+    if (MFCRead.Candidate == 1) {
+        if (MFCRead.KnownKeyValid[MFCRead.KeyType] &&
+                (!MifareClassicTrailerKeyBUsable() ||
+                 memcmp(MFCRead.KnownKey[MFCRead.KeyType], MFCRead.TrailerKeyB, MFC_KEY_SIZE) != 0)) {
+            memcpy(MFCRead.Key, MFCRead.KnownKey[MFCRead.KeyType], MFC_KEY_SIZE);
+            return true;
+        }
+        MFCRead.Candidate++;
+    }
+
+    while (MFCRead.Candidate - 2 < ARRAY_COUNT(MifareClassicKeys)) {
+        memcpy_P(MFCRead.Key, MifareClassicKeys[MFCRead.Candidate - 2], MFC_KEY_SIZE);
+        /* The known key and key B of the trailer have already been tried */
+        if ((!MFCRead.KnownKeyValid[MFCRead.KeyType] ||
+                memcmp(MFCRead.Key, MFCRead.KnownKey[MFCRead.KeyType], MFC_KEY_SIZE) != 0) &&
+                (!MifareClassicTrailerKeyBUsable() || memcmp(MFCRead.Key, MFCRead.TrailerKeyB, MFC_KEY_SIZE) != 0)) {
+            return true;
+        }
+        MFCRead.Candidate++;
+    }
+
+    return false;
+}
+
+/* Key B can be read with key A for the trailer access conditions 000, 001 and 010 */
+static bool MifareClassicKeyBReadable(const uint8_t *Trailer) {
+    uint8_t C1 = (Trailer[MFC_ACCESS_OFFSET + 1] >> 7) & 1;
+    uint8_t C2 = (Trailer[MFC_ACCESS_OFFSET + 2] >> 3) & 1;
+    uint8_t C3 = (Trailer[MFC_ACCESS_OFFSET + 2] >> 7) & 1;
+
+    return !C1 && !(C2 && C3);
+}
+
+static void MifareClassicSectorStart(void) {
+    uint8_t Block[MFC_BLOCK_SIZE] = {0};
+
+    /* Blocks which cannot be read stay empty */
+    for (uint16_t i = MifareClassicFirstBlock(MFCRead.Sector); i <= MifareClassicTrailerBlock(MFCRead.Sector); i++) {
+        MemoryUploadBlock(Block, (uint16_t) i * MFC_BLOCK_SIZE, MFC_BLOCK_SIZE);
+    }
+
+    MFCRead.Block = MifareClassicFirstBlock(MFCRead.Sector);
+    MFCRead.UnreadBlocks = (1U << (MifareClassicTrailerBlock(MFCRead.Sector) - MFCRead.Block)) * 2 - 1;
+    MFCRead.KeyType = 0;
+    MFCRead.Candidate = 0;
+    MFCRead.TrailerKeyBValid = false;
+    MFCRead.SectorKeyFound = false;
+}
+
+/* Sends AUTH with the loaded key, nested if the card is authenticated already */
+static uint16_t MifareClassicAuth(uint8_t *Buffer) {
+    uint16_t BitCount;
+
+    if (MFCRead.Session == MFC_SESSION_NONE) {
+        /* E.g. after a failed authentication the card has to be selected again */
+        MFCRead.Step = MFC_STEP_RESELECT;
+        Selected = false;
+        ReaderState = STATE_IDLE;
+        Reader14443ACodecStart();
+        return 0;
+    }
+
+    Buffer[0] = MFCRead.KeyType ? MFC_CMD_AUTH_B : MFC_CMD_AUTH_A;
+    Buffer[1] = MifareClassicTrailerBlock(MFCRead.Sector);
+    ISO14443AAppendCRCA(Buffer, 2);
+    BitCount = addParityBits(Buffer, 4 * BITS_PER_BYTE);
+    if (MFCRead.Session == MFC_SESSION_AUTHENTICATED) {
+        Crypto1EncryptWithParity(Buffer, BitCount);
+    }
+    MFCRead.Step = MFC_STEP_NONCE;
+    return BitCount;
+}
+
+static uint16_t MifareClassicSectorDone(uint8_t *Buffer);
+
+/* Tries the next key candidate, falls back to key B and gives up the sector when the dictionary is exhausted */
+static uint16_t MifareClassicAuthNext(uint8_t *Buffer) {
+    while (!MifareClassicLoadKey()) {
+        if (MFCRead.KeyType == 1) {
+            return MifareClassicSectorDone(Buffer);
+        }
+        MFCRead.KeyType = 1;
+        MFCRead.Candidate = 0;
+    }
+
+    return MifareClassicAuth(Buffer);
+}
+
+static uint16_t MifareClassicSectorDone(uint8_t *Buffer) {
+    if (!MFCRead.SectorKeyFound) {
+        MFCRead.MissingSectors++;
+    }
+    /* A card with many unknown sectors takes longer than the timeout, which
+     * only has to catch a sector that makes no progress */
+    CommandLinePendingTaskRestartTimeout();
+    if (++MFCRead.Sector == MFCRead.SectorCount) {
+        return 0;
+    }
+    MifareClassicSectorStart();
+    return MifareClassicAuthNext(Buffer);
+}
+
+/* Reads the next block of the sector which has not been read yet, afterwards
+ * looks for key B and reads the blocks again which key A could not read */
+static uint16_t MifareClassicReadNext(uint8_t *Buffer) {
+    uint8_t FirstBlock = MifareClassicFirstBlock(MFCRead.Sector);
+    uint16_t BitCount;
+
+    while ((MFCRead.Block <= MifareClassicTrailerBlock(MFCRead.Sector)) &&
+            !(MFCRead.UnreadBlocks & (1U << (MFCRead.Block - FirstBlock)))) {
+        MFCRead.Block++;
+    }
+
+    if (MFCRead.Block > MifareClassicTrailerBlock(MFCRead.Sector)) {
+        if (MFCRead.KeyType == 1) {
+            return MifareClassicSectorDone(Buffer);
+        }
+        /* A clone needs key B even if the access conditions do not allow to read it */
+        MFCRead.KeyType = 1;
+        MFCRead.Candidate = 0;
+        MFCRead.Block = FirstBlock;
+        return MifareClassicAuthNext(Buffer);
+    }
+
+    if (MFCRead.Session != MFC_SESSION_AUTHENTICATED) {
+        /* Authenticate again with the same key after a failed read */
+        return MifareClassicAuth(Buffer);
+    }
+
+    Buffer[0] = MFC_CMD_READ;
+    Buffer[1] = MFCRead.Block;
+    ISO14443AAppendCRCA(Buffer, 2);
+    BitCount = addParityBits(Buffer, 4 * BITS_PER_BYTE);
+    Crypto1EncryptWithParity(Buffer, BitCount);
+    MFCRead.Step = MFC_STEP_READ;
+    return BitCount;
+}
+
+static uint16_t MifareClassicAuthenticated(uint8_t *Buffer) {
+    uint16_t KeyAddress = (uint16_t) MifareClassicTrailerBlock(MFCRead.Sector) * MFC_BLOCK_SIZE +
+                          (MFCRead.KeyType ? MFC_KEY_B_OFFSET : MFC_KEY_A_OFFSET);
+
+    /* The card never returns key A, so the keys are written to the trailer as found */
+    MemoryUploadBlock(MFCRead.Key, KeyAddress, MFC_KEY_SIZE);
+    memcpy(MFCRead.KnownKey[MFCRead.KeyType], MFCRead.Key, MFC_KEY_SIZE);
+    MFCRead.KnownKeyValid[MFCRead.KeyType] = true;
+    MFCRead.SectorKeyFound = true;
+    MFCRead.Session = MFC_SESSION_AUTHENTICATED;
+
+    return MifareClassicReadNext(Buffer);
+}
+
+static uint16_t MifareClassicAuthFailed(uint8_t *Buffer) {
+    MFCRead.Session = MFC_SESSION_NONE;
+    MFCRead.Candidate++;
+    return MifareClassicAuthNext(Buffer);
+}
+
+/* ApplicationSetUid takes a whole ConfigurationUidType, which is longer
+ * than the UID of the card characteristics */
+static void ReaderSetCardUid(void) {
+    ConfigurationUidType Uid;
+
+    memset(Uid, 0, sizeof(Uid));
+    memcpy(Uid, CardCharacteristics.UID, sizeof(CardCharacteristics.UID));
+    ApplicationSetUid(Uid);
+}
+
+/* Configuration to emulate the card, -1 if it is not supported */
+static int MifareClassicConfiguration(void) {
+    int cfgid = -1;
+
+    if (CardCharacteristics.UIDSize == UIDSize_Single) {
+        switch (MFCRead.SectorCount) {
+#ifdef CONFIG_MF_CLASSIC_MINI_4B_SUPPORT
+            case 5:
+                cfgid = CONFIG_MF_CLASSIC_MINI_4B;
+                break;
+#endif
+#ifdef CONFIG_MF_CLASSIC_1K_SUPPORT
+            case 16:
+                cfgid = CONFIG_MF_CLASSIC_1K;
+                break;
+#endif
+#ifdef CONFIG_MF_CLASSIC_4K_SUPPORT
+            case 40:
+                cfgid = CONFIG_MF_CLASSIC_4K;
+                break;
+#endif
+            default:
+                break;
+        }
+    } else if (CardCharacteristics.UIDSize == UIDSize_Double) {
+        switch (MFCRead.SectorCount) {
+#ifdef CONFIG_MF_CLASSIC_1K_7B_SUPPORT
+            case 16:
+                cfgid = CONFIG_MF_CLASSIC_1K_7B;
+                break;
+#endif
+#ifdef CONFIG_MF_CLASSIC_4K_7B_SUPPORT
+            case 40:
+                cfgid = CONFIG_MF_CLASSIC_4K_7B;
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+
+    return cfgid;
+}
+
+static uint16_t MifareClassicProcess(uint8_t *Buffer, uint16_t BitCount) {
+    uint8_t *Uid = &CardCharacteristics.UID[CardCharacteristics.UIDSize - MFC_NONCE_SIZE];
+    uint8_t Nonce[2 * MFC_NONCE_SIZE];
+
+    switch (MFCRead.Step) {
+        case MFC_STEP_START:
+            switch (CardCharacteristics.SAK) {
+                case 0x09:
+                    MFCRead.SectorCount = 5;
+                    break;
+                case 0x08:
+                case 0x88:
+                    MFCRead.SectorCount = 16;
+                    break;
+                case 0x18:
+                    MFCRead.SectorCount = 40;
+                    break;
+                default:
+                    MFCRead.SectorCount = 0;
+                    return 0;
+            }
+            if ((Reader14443CurrentCommand == Reader14443_Clone_MF_Classic) && (MifareClassicConfiguration() < 0)) {
+                MFCRead.SectorCount = 0;
+                return 0;
+            }
+            MFCRead.Sector = 0;
+            MFCRead.KnownKeyValid[0] = MFCRead.KnownKeyValid[1] = false;
+            MFCRead.MissingSectors = 0;
+            MFCRead.Session = MFC_SESSION_SELECTED;
+            MifareClassicSectorStart();
+            return MifareClassicAuthNext(Buffer);
+
+        case MFC_STEP_RESELECT:
+            MFCRead.Session = MFC_SESSION_SELECTED;
+            return MifareClassicAuth(Buffer);
+
+        case MFC_STEP_NONCE:
+            if (BitCount != MFC_NONCE_SIZE * 9) {
+                return MifareClassicAuthFailed(Buffer);
+            }
+            if (MFCRead.Session == MFC_SESSION_AUTHENTICATED) {
+                /* The nonce of a nested authentication is encrypted with the new key */
+                removeParityBits(Buffer, BitCount);
+                memcpy(Nonce, Buffer, MFC_NONCE_SIZE);
+                Crypto1SetupNested(MFCRead.Key, Uid, Nonce, true);
+            } else {
+                if (!checkParityBits(Buffer, BitCount)) {
+                    return MifareClassicAuthFailed(Buffer);
+                }
+                removeParityBits(Buffer, BitCount);
+                memcpy(Nonce, Buffer, MFC_NONCE_SIZE);
+                /* Crypto1Setup() encrypts the nonce in place */
+                Crypto1Setup(MFCRead.Key, Uid, Buffer);
+            }
+
+            /* Reader answer and the expected card answer */
+            Crypto1PRNG(Nonce, 64);
+            memcpy(MFCRead.CardResponse, Nonce, MFC_NONCE_SIZE);
+            Crypto1PRNG(MFCRead.CardResponse, 32);
+
+            RandomGetBuffer(Buffer, MFC_NONCE_SIZE);
+            memcpy(&Buffer[MFC_NONCE_SIZE], Nonce, MFC_NONCE_SIZE);
+            BitCount = addParityBits(Buffer, 2 * MFC_NONCE_SIZE * BITS_PER_BYTE);
+            Crypto1ReaderAuthWithParity(Buffer);
+            MFCRead.Step = MFC_STEP_AUTH;
+            return BitCount;
+
+        case MFC_STEP_AUTH:
+            if (BitCount != MFC_NONCE_SIZE * 9) {
+                return MifareClassicAuthFailed(Buffer);
+            }
+            Crypto1EncryptWithParity(Buffer, BitCount);
+            if (!checkParityBits(Buffer, BitCount)) {
+                return MifareClassicAuthFailed(Buffer);
+            }
+            removeParityBits(Buffer, BitCount);
+            if (memcmp(Buffer, MFCRead.CardResponse, MFC_NONCE_SIZE) != 0) {
+                return MifareClassicAuthFailed(Buffer);
+            }
+            return MifareClassicAuthenticated(Buffer);
+
+        case MFC_STEP_READ: {
+            uint16_t Address = (uint16_t) MFCRead.Block * MFC_BLOCK_SIZE;
+
+            MFCRead.Block++;
+            if (BitCount != (MFC_BLOCK_SIZE + ISO14443A_CRCA_SIZE) * 9) {
+                /* Most likely a NAK, the access conditions do not allow to read the block */
+                MFCRead.Session = MFC_SESSION_NONE;
+                return MifareClassicReadNext(Buffer);
+            }
+            Crypto1EncryptWithParity(Buffer, BitCount);
+            if (!checkParityBits(Buffer, BitCount)) {
+                MFCRead.Session = MFC_SESSION_NONE;
+                return MifareClassicReadNext(Buffer);
+            }
+            removeParityBits(Buffer, BitCount);
+            if (!ISO14443ACheckCRCA(Buffer, MFC_BLOCK_SIZE)) {
+                MFCRead.Session = MFC_SESSION_NONE;
+                return MifareClassicReadNext(Buffer);
+            }
+
+            MFCRead.UnreadBlocks &= ~(1U << (MFCRead.Block - 1 - MifareClassicFirstBlock(MFCRead.Sector)));
+            if (MFCRead.Block - 1 == MifareClassicTrailerBlock(MFCRead.Sector)) {
+                /* Keep the keys found, key B is only returned if it is readable */
+                MemoryUploadBlock(&Buffer[MFC_KEY_A_OFFSET + MFC_KEY_SIZE], Address + MFC_KEY_A_OFFSET + MFC_KEY_SIZE,
+                                  MFC_KEY_B_OFFSET - MFC_KEY_SIZE);
+                if (MFCRead.KeyType == 0) {
+                    MemoryUploadBlock(&Buffer[MFC_KEY_B_OFFSET], Address + MFC_KEY_B_OFFSET, MFC_KEY_SIZE);
+                    /* Try it first when looking for key B */
+                    if (MifareClassicKeyBReadable(Buffer)) {
+                        memcpy(MFCRead.TrailerKeyB, &Buffer[MFC_KEY_B_OFFSET], MFC_KEY_SIZE);
+                        MFCRead.TrailerKeyBValid = true;
+                    }
+                }
+            } else {
+                MemoryUploadBlock(Buffer, Address, MFC_BLOCK_SIZE);
+            }
+            return MifareClassicReadNext(Buffer);
+        }
+
+        default:
+            return 0;
+    }
+}
+
 uint16_t Reader14443AAppProcess(uint8_t *Buffer, uint16_t BitCount) {
     switch (Reader14443CurrentCommand) {
         case Reader14443_Send: {
@@ -759,6 +1419,51 @@ uint16_t Reader14443AAppProcess(uint8_t *Buffer, uint16_t BitCount) {
             return rVal;
         }
 
+        case Reader14443_Clone_MF_Classic:
+        case Reader14443_Read_MF_Classic: {
+            uint16_t rVal = Reader14443A_Select(Buffer, BitCount);
+            if (!Selected) {
+                return rVal;
+            }
+
+            rVal = MifareClassicProcess(Buffer, BitCount);
+            if ((rVal != 0) || (MFCRead.Step == MFC_STEP_RESELECT)) {
+                return rVal;
+            }
+
+            /* The whole card has been read into the memory of the slot */
+            CodecReaderFieldStop();
+            Selected = false;
+            if (MFCRead.SectorCount == 0) {
+                CommandLinePendingTaskFinished(COMMAND_INFO_OK_WITH_TEXT_ID, "Unsupported card type.");
+            } else if (Reader14443CurrentCommand == Reader14443_Read_MF_Classic) { // dump
+                uint16_t BlockCount = (MFCRead.SectorCount <= 32) ? MFCRead.SectorCount * 4 : 128 + (MFCRead.SectorCount - 32) * 16;
+
+                CommandLinePendingTaskFinished(COMMAND_INFO_OK_WITH_TEXT_ID, NULL);
+                for (uint16_t i = 0; i < BlockCount; i++) {
+                    MemoryDownloadBlock(Buffer, i * MFC_BLOCK_SIZE, MFC_BLOCK_SIZE);
+                    CommandLineAppendData(Buffer, MFC_BLOCK_SIZE);
+                }
+            } else { // clone
+                char tmpBuf[48];
+
+                if (MFCRead.MissingSectors == 0) {
+                    snprintf(tmpBuf, sizeof(tmpBuf), "Card Cloned to Slot");
+                } else {
+                    snprintf(tmpBuf, sizeof(tmpBuf), "Card Cloned to Slot, %u sectors without key", MFCRead.MissingSectors);
+                }
+                CommandLinePendingTaskFinished(COMMAND_INFO_OK_WITH_TEXT_ID, tmpBuf);
+                ConfigurationSetById(MifareClassicConfiguration(), false);
+                /* Block 0 may not have been readable */
+                ReaderSetCardUid();
+                MemoryStore();
+                SettingsSave();
+            }
+            Reader14443CurrentCommand = Reader14443_Do_Nothing;
+            MFCRead.Step = MFC_STEP_START;
+            return 0;
+        }
+
         /************************************
          * This function identifies a PICC. *
          ************************************/
@@ -872,7 +1577,7 @@ uint16_t Reader14443AAppProcess(uint8_t *Buffer, uint16_t BitCount) {
                         LEDHook(LED_SETTING_CHANGE, LED_BLINK_2X);
                         ConfigurationSetById(cfgid, false);
                         ApplicationReset();
-                        ApplicationSetUid(CardCharacteristics.UID);
+                        ReaderSetCardUid();
                         MemoryStore();
                         SettingsSave();
                     } else {
@@ -892,6 +1597,9 @@ uint16_t Reader14443AAppProcess(uint8_t *Buffer, uint16_t BitCount) {
             return 0;
         }
 
+        case Reader14443_Batch:
+            return Reader14443A_Batch(Buffer, BitCount);
+
         default: // e.g. Do_Nothing
             return 0;
     }
@@ -899,15 +1607,7 @@ uint16_t Reader14443AAppProcess(uint8_t *Buffer, uint16_t BitCount) {
 }
 
 uint16_t ISO14443_CRCA(uint8_t *Buffer, uint8_t ByteCount) {
-    uint8_t *DataPtr = Buffer;
-    uint16_t crc = 0x6363;
-    uint8_t ch;
-    while (ByteCount--) {
-        ch = *DataPtr++ ^ crc;
-        ch = ch ^ (ch << 4);
-        crc = (crc >> 8) ^ (ch << 8) ^ (ch << 3) ^ (ch >> 4);
-    }
-    return crc;
+    return CRCACalc(Buffer, ByteCount);
 }
 
 #endif
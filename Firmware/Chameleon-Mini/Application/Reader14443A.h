@@ -4,11 +4,55 @@
 #include "Application.h"
 #include "Codec/Codec.h"
 
-#define CRC_INIT 0x6363
 
 extern uint8_t ReaderSendBuffer[];
 extern uint16_t ReaderSendBitCount;
 
+/* Script of the SEND_BATCH command, which runs many frames in one command
+ * line round trip. Each operation starts with its opcode byte:
+ *  SEND          Opcode, timeout, expected length, byte count, bytes
+ *  SEND_RAW      Opcode, timeout, expected length, bit count (2 bytes MSB
+ *                first), bytes with parity bits like for SEND_RAW
+ *  JUMP          Opcode, offset of the target operation
+ *  JUMP_IF_FAIL  Opcode, offset of the target operation, jumps if the last
+ *                frame has been answered with a non zero status
+ *  END           Opcode
+ * The timeout is in ms, 0 for the default. The expected length is the byte
+ * count of the answer, or READER_BATCH_ANY_LENGTH. For every frame a result
+ * record is returned: offset of the frame in the script, status, bit count
+ * of the answer (2 bytes MSB first) and the answer, without parity bits for
+ * SEND. */
+#ifndef READER_BATCH_SCRIPT_SIZE
+#define READER_BATCH_SCRIPT_SIZE        128
+#endif
+
+#define READER_BATCH_OP_END             0x00
+#define READER_BATCH_OP_SEND            0x01
+#define READER_BATCH_OP_SEND_RAW        0x02
+#define READER_BATCH_OP_JUMP            0x03
+#define READER_BATCH_OP_JUMP_IF_FAIL    0x04
+#define READER_BATCH_OP_MASK            0x0F
+#define READER_BATCH_FLAG_CRC           0x80 // SEND: appends CRC_A and checks the CRC_A of the answer
+#define READER_BATCH_FLAG_SHORT         0x40 // SEND: the single byte is sent as a 7 bit short frame
+
+#define READER_BATCH_ANY_LENGTH         0xFF
+#define READER_BATCH_JUMPS_MAX          255 // the script ends after this many jumps
+
+/* Status of a result record */
+#define READER_BATCH_NO_DATA            0x01
+#define READER_BATCH_PARITY_ERROR       0x02
+#define READER_BATCH_CRC_ERROR          0x04
+#define READER_BATCH_LENGTH_MISMATCH    0x08
+#define READER_BATCH_TRUNCATED          0x80 // the result buffer is full, the script ends
+
+#define READER_BATCH_RESULT_HEADER_SIZE 4
+
+extern uint8_t ReaderBatchScript[READER_BATCH_SCRIPT_SIZE];
+extern uint16_t ReaderBatchScriptSize;
+
+bool Reader14443ABatchCheck(void);
+void Reader14443ABatchStart(void);
+
 void Reader14443AAppInit(void);
 void Reader14443AAppReset(void);
 void Reader14443AAppTask(void);
@@ -31,7 +75,10 @@ typedef enum {
     Reader14443_Read_MF_Ultralight,
     Reader14443_Identify,
     Reader14443_Identify_Clone,
-    Reader14443_Clone_MF_Ultralight
+    Reader14443_Clone_MF_Ultralight,
+    Reader14443_Batch,
+    Reader14443_Read_MF_Classic,
+    Reader14443_Clone_MF_Classic
 } Reader14443Command;
 
 
@@ -162,6 +162,10 @@ static void ExecuteButtonAction(ButtonActionEnum ButtonAction) {
         }
 
         case BUTTON_ACTION_TOGGLE_FIELD: {
+            if (CodecTimestampIsRunning()) {
+                /* The reader timer counts the codec timestamps */
+                break;
+            }
             if (!CodecGetReaderField()) {
                 CodecReaderFieldStart();
             } else {
@@ -26,6 +26,7 @@ int main(void) {
             ButtonTick();
             ApplicationTick();
             LogTick();
+            MemoryTick();
             CommandLineTick();
             AntennaLevelTick();
             LEDHook(LED_POWERED, LED_ON);
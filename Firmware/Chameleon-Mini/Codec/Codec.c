@@ -8,6 +8,7 @@
 #include "Codec.h"
 #include "../System.h"
 #include "../LEDHook.h"
+#include "../Log.h"
 
 uint16_t Reader_FWT = ISO14443A_RX_PENDING_TIMEOUT;
 
@@ -35,6 +36,22 @@ void (* volatile isr_func_CODEC_TIMER_LOADMOD_CCA_VECT)(void) = NULL;
 void (* volatile isr_func_CODEC_TIMER_LOADMOD_CCB_VECT)(void) = NULL;
 void (* volatile isr_func_CODEC_TIMER_TIMESTAMPS_CCA_VECT)(void) = NULL;
 
+#ifdef LOG_CODEC_TIMESTAMPS
+volatile uint32_t CodecRxTimestamp;
+volatile uint32_t CodecTxTimestamp;
+bool CodecTimestampRunning = false;
+
+void CodecLogTimestamp(LogEntryEnum Entry, uint32_t Timestamp) {
+    /* MSB first like the timestamp sync record */
+    uint8_t Data[4] = {
+        (uint8_t)(Timestamp >> 24), (uint8_t)(Timestamp >> 16),
+        (uint8_t)(Timestamp >> 8), (uint8_t)(Timestamp >> 0)
+    };
+
+    LogEntry(Entry, Data, sizeof(Data));
+}
+#endif
+
 // the following three functions prevent sending data directly after turning on the reader field
 void CodecReaderFieldStart(void) { // DO NOT CALL THIS FUNCTION INSIDE APPLICATION!
     if (!CodecGetReaderField() && !ReaderFieldFlags.ToBeRestarted) {
@@ -69,6 +69,14 @@
 #define CODEC_TIMER_TIMESTAMPS_CCA_VECT	TCD1_CCA_vect
 #define CODEC_TIMER_TIMESTAMPS_CCB_VECT	TCD1_CCB_vect
 
+/* The emulation codecs use neither the timestamp nor the reader timer, so
+ * with LOG_CODEC_TIMESTAMPS they are cascaded into a free running 32 bit
+ * counter of carrier cycles for the high resolution frame timestamps */
+#define CODEC_TIMESTAMP_TIMER_LOW	CODEC_TIMER_TIMESTAMPS
+#define CODEC_TIMESTAMP_TIMER_HIGH	CODEC_READER_TIMER
+#define CODEC_TIMESTAMP_EVMUX		EVSYS_CHMUX_TCD1_OVF_gc
+#define CODEC_TIMESTAMP_HIGH_CLKSEL	TC_CLKSEL_EVCH7_gc
+
 #ifndef __ASSEMBLER__
 
 #include <avr/io.h>
@@ -77,6 +85,7 @@
 #include "../Common.h"
 #include "../Configuration.h"
 #include "../Settings.h"
+#include "../Log.h"
 
 #include "ISO14443-2A.h"
 #include "Reader14443-2A.h"
@@ -303,6 +312,67 @@ void CodecThresholdSet(uint16_t th);
 uint16_t CodecThresholdIncrement(void);
 void CodecThresholdReset(void);
 
+#ifdef LOG_CODEC_TIMESTAMPS
+/* Carrier cycle timestamps of the end of the last reader frame and of the
+ * start of the last response, taken by the ISRs of the emulation codecs */
+extern volatile uint32_t CodecRxTimestamp;
+extern volatile uint32_t CodecTxTimestamp;
+/* The counter uses the reader timer, the field must not be switched while
+ * it runs */
+extern bool CodecTimestampRunning;
+
+INLINE void CodecTimestampStart(void) {
+    CODEC_TIMESTAMP_TIMER_LOW.CTRLA = TC_CLKSEL_OFF_gc;
+    CODEC_TIMESTAMP_TIMER_HIGH.CTRLA = TC_CLKSEL_OFF_gc;
+    CODEC_TIMESTAMP_TIMER_LOW.CTRLB = TC_WGMODE_NORMAL_gc;
+    CODEC_TIMESTAMP_TIMER_HIGH.CTRLB = TC_WGMODE_NORMAL_gc;
+    CODEC_TIMESTAMP_TIMER_LOW.CTRLD = TC_EVACT_OFF_gc;
+    CODEC_TIMESTAMP_TIMER_LOW.INTCTRLA = 0;
+    CODEC_TIMESTAMP_TIMER_LOW.INTCTRLB = 0;
+    CODEC_TIMESTAMP_TIMER_LOW.PER = 0xFFFF;
+    CODEC_TIMESTAMP_TIMER_HIGH.PER = 0xFFFF;
+    CODEC_TIMESTAMP_TIMER_LOW.CNT = 0;
+    CODEC_TIMESTAMP_TIMER_HIGH.CNT = 0;
+
+    /* The low word counts the carrier like the loadmod timer does, the
+     * high word counts the overflows of the low word */
+    EVSYS.CH7MUX = CODEC_TIMESTAMP_EVMUX;
+    CODEC_TIMESTAMP_TIMER_HIGH.CTRLA = CODEC_TIMESTAMP_HIGH_CLKSEL;
+    CODEC_TIMESTAMP_TIMER_LOW.CTRLA = CODEC_TIMER_CARRIER_CLKSEL;
+    CodecTimestampRunning = true;
+}
+
+INLINE void CodecTimestampStop(void) {
+    CODEC_TIMESTAMP_TIMER_LOW.CTRLA = TC_CLKSEL_OFF_gc;
+    CODEC_TIMESTAMP_TIMER_HIGH.CTRLA = TC_CLKSEL_OFF_gc;
+    EVSYS.CH7MUX = EVSYS_CHMUX_OFF_gc;
+    CodecTimestampRunning = false;
+}
+
+INLINE uint32_t CodecTimestampGet(void) {
+    uint16_t High = CODEC_TIMESTAMP_TIMER_HIGH.CNT;
+    uint16_t Low = CODEC_TIMESTAMP_TIMER_LOW.CNT;
+
+    if (CODEC_TIMESTAMP_TIMER_HIGH.CNT != High) {
+        /* The low word wrapped around in between */
+        High = CODEC_TIMESTAMP_TIMER_HIGH.CNT;
+        Low = CODEC_TIMESTAMP_TIMER_LOW.CNT;
+    }
+
+    return ((uint32_t) High << 16) | Low;
+}
+
+void CodecLogTimestamp(LogEntryEnum Entry, uint32_t Timestamp);
+
+INLINE bool CodecTimestampIsRunning(void) {
+    return CodecTimestampRunning;
+}
+#else
+INLINE bool CodecTimestampIsRunning(void) {
+    return false;
+}
+#endif
+
 #endif /* __ASSEMBLER__ */
 
 #endif /* CODEC_H_ */
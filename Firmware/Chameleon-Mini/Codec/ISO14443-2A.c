@@ -146,6 +146,11 @@ ISR(CODEC_TIMER_SAMPLING_CCA_VECT) {
             CODEC_TIMER_LOADMOD.INTFLAGS = TC0_OVFIF_bm;
             CODEC_TIMER_LOADMOD.INTCTRLA = TC_OVFINTLVL_HI_gc;
 
+#ifdef LOG_CODEC_TIMESTAMPS
+            /* The FDT timer counts the carrier since the last modulation edge */
+            CodecRxTimestamp = CodecTimestampGet() - CODEC_TIMER_LOADMOD.CNT;
+#endif
+
             /* Determine if we did not receive a multiple of 8 bits.
              * If this is the case, right-align the remaining data and
              * store it into the buffer. */
@@ -262,6 +267,11 @@ LOADMOD_START_BIT0_LABEL:
 
     CODEC_TIMER_LOADMOD.PER = ISO14443A_BIT_RATE_CYCLES / 2 - 1;
     StateRegister = LOADMOD_START_BIT1;
+
+#ifdef LOG_CODEC_TIMESTAMPS
+    /* Taken after the modulation has started, at the overflow of the bit grid */
+    CodecTxTimestamp = CodecTimestampGet() - CODEC_TIMER_LOADMOD.CNT;
+#endif
     return;
 
 
@@ -388,6 +398,9 @@ void ISO14443ACodecInit(void) {
     isr_func_CODEC_DEMOD_IN_INT0_VECT = &isr_ISO14443_2A_TCD0_CCC_vect;
     isr_func_CODEC_TIMER_LOADMOD_OVF_VECT = &isr_ISO14443_2A_CODEC_TIMER_LOADMOD_OVF_VECT;
     CodecInitCommon();
+#ifdef LOG_CODEC_TIMESTAMPS
+    CodecTimestampStart();
+#endif
     StartDemod();
 }
 
@@ -413,6 +426,9 @@ void ISO14443ACodecDeInit(void) {
     CodecSetDemodPower(false);
     CodecSetLoadmodState(false);
 
+#ifdef LOG_CODEC_TIMESTAMPS
+    CodecTimestampStop();
+#endif
 }
 
 void ISO14443ACodecTask(void) {
@@ -425,6 +441,9 @@ void ISO14443ACodecTask(void) {
         if (DemodBitCount >= ISO14443A_MIN_BITS_PER_FRAME) {
             // For logging data
             LogEntry(LOG_INFO_CODEC_RX_DATA, CodecBuffer, (DemodBitCount + 7) / 8);
+#ifdef LOG_CODEC_TIMESTAMPS
+            CodecLogTimestamp(LOG_INFO_CODEC_RX_TIMESTAMP, CodecRxTimestamp);
+#endif
             LEDHook(LED_CODEC_RX, LED_PULSE);
 
             /* Call application if we received data */
@@ -464,6 +483,10 @@ void ISO14443ACodecTask(void) {
         /* Load modulation has been finished. Stop it and start to listen
          * for incoming data again. */
         StartDemod();
+
+#ifdef LOG_CODEC_TIMESTAMPS
+        CodecLogTimestamp(LOG_INFO_CODEC_TX_TIMESTAMP, CodecTxTimestamp);
+#endif
     }
 }
 
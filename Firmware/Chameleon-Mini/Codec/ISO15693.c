@@ -151,6 +151,11 @@ INLINE void ISO15693_EOC(void) {
      * The current PERIOD was set in StartISO15693Demod to ISO15693_T1_TIME, once ISO15693_T1_TIME is reached, this will be the new PERIOD.
      * From 3.7 [8045A-AVR-02/08] */
     CODEC_TIMER_LOADMOD.PERBUF = BitRate1 - 1;
+
+#ifdef LOG_CODEC_TIMESTAMPS
+    /* TCE0 counts the carrier since the start of the last modulation pause */
+    CodecRxTimestamp = CodecTimestampGet() - CODEC_TIMER_LOADMOD.CNT;
+#endif
 }
 
 /* Disable data demodulation interrupt and inform the codec to restart demodulation from scratch */
@@ -319,6 +324,13 @@ LOADMOD_SOF_SINGLE_LABEL:
     ShiftRegister <<= 1;
     BitSent++;
 
+#ifdef LOG_CODEC_TIMESTAMPS
+    if (BitSent == 1) {
+        /* First SOF bit, taken after the modulation has started */
+        CodecTxTimestamp = CodecTimestampGet() - CODEC_TIMER_LOADMOD.CNT;
+    }
+#endif
+
     if ((BitSent % 8) == 0) {
         /* Last SOF bit has been put out. Start sending out data */
         StateRegister = LOADMOD_BIT0_SINGLE;
@@ -401,6 +413,13 @@ LOADMOD_SOF_DUAL_LABEL:
     ShiftRegister <<= 1;
     BitSent++;
 
+#ifdef LOG_CODEC_TIMESTAMPS
+    if (BitSent == 1) {
+        /* First SOF bit, taken after the modulation has started */
+        CodecTxTimestamp = CodecTimestampGet() - CODEC_TIMER_LOADMOD.CNT;
+    }
+#endif
+
     if ((BitSent % 8) == 0) {
         /* Last SOF bit has been put out. Start sending out data */
         StateRegister = LOADMOD_BIT0_DUAL;
@@ -574,6 +593,10 @@ void ISO15693CodecInit(void) {
     /* Activate Power for demodulator */
     CodecSetDemodPower(true);
 
+#ifdef LOG_CODEC_TIMESTAMPS
+    CodecTimestampStart();
+#endif
+
     StartISO15693Demod();
 }
 
@@ -616,6 +639,10 @@ void ISO15693CodecDeInit(void) {
     CodecSetSubcarrier(CODEC_SUBCARRIERMOD_OFF, 0);
     CodecSetDemodPower(false);
     CodecSetLoadmodState(false);
+
+#ifdef LOG_CODEC_TIMESTAMPS
+    CodecTimestampStop();
+#endif
 }
 
 void ISO15693CodecTask(void) {
@@ -628,6 +655,9 @@ void ISO15693CodecTask(void) {
 
         if (DemodByteCount > 0) {
             LogEntry(LOG_INFO_CODEC_RX_DATA, CodecBuffer, DemodByteCount);
+#ifdef LOG_CODEC_TIMESTAMPS
+            CodecLogTimestamp(LOG_INFO_CODEC_RX_TIMESTAMP, CodecRxTimestamp);
+#endif
             LEDHook(LED_CODEC_RX, LED_PULSE);
 
             if (CodecBuffer[0] & REQ_SUBCARRIER_DUAL) {
@@ -682,5 +712,9 @@ void ISO15693CodecTask(void) {
         Flags.LoadmodFinished = 0;
         /* Load modulation has been finished. Stop it and start to listen for incoming data again. */
         StartISO15693Demod();
+
+#ifdef LOG_CODEC_TIMESTAMPS
+        CodecLogTimestamp(LOG_INFO_CODEC_TX_TIMESTAMP, CodecTxTimestamp);
+#endif
     }
 }
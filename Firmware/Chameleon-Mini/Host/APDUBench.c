@@ -0,0 +1,188 @@
+/*
+ * APDUBench.c
+ *
+ * Benchmark of the DESFire frame pipeline: wrapped native commands in
+ * ISO14443-4 I-blocks are fed to ApplicationProcess() like the codec does.
+ * The program is linked with --wrap for memcpy(), memmove() and memcmp(),
+ * so the bytes these touch per frame are counted next to the time taken.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "HostReader.h"
+#include "../Codec/Codec.h"
+#include "../Application/Application.h"
+#include "../Application/ISO14443-3A.h"
+
+#define BENCH_PAYLOAD_SIZE      64
+/* Keeps the I-block within MAX_DATA_FRAME_XFER_SIZE */
+#define BENCH_WRITE_SIZE        48
+#define BENCH_FILE_NO           0x01
+
+void *__real_memcpy(void *Dest, const void *Src, size_t Count);
+void *__real_memmove(void *Dest, const void *Src, size_t Count);
+int __real_memcmp(const void *A, const void *B, size_t Count);
+
+static bool Counting = false;
+static uint64_t BytesCopied = 0;
+static uint64_t BytesCompared = 0;
+
+void *__wrap_memcpy(void *Dest, const void *Src, size_t Count) {
+    if (Counting) {
+        BytesCopied += Count;
+    }
+    return __real_memcpy(Dest, Src, Count);
+}
+
+void *__wrap_memmove(void *Dest, const void *Src, size_t Count) {
+    if (Counting) {
+        BytesCopied += Count;
+    }
+    return __real_memmove(Dest, Src, Count);
+}
+
+int __wrap_memcmp(const void *A, const void *B, size_t Count) {
+    if (Counting) {
+        BytesCompared += Count;
+    }
+    return __real_memcmp(A, B, Count);
+}
+
+static uint64_t GetNanoseconds(void) {
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t) Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+static uint8_t ReadDataAPDU[] = {
+    0x90, 0xBD, 0x00, 0x00, 0x07, BENCH_FILE_NO, 0x00, 0x00, 0x00, BENCH_PAYLOAD_SIZE, 0x00, 0x00, 0x00
+};
+static uint8_t WriteDataAPDU[5 + 7 + BENCH_WRITE_SIZE + 1] = {
+    0x90, 0x3D, 0x00, 0x00, 7 + BENCH_WRITE_SIZE, BENCH_FILE_NO, 0x00, 0x00, 0x00, BENCH_WRITE_SIZE, 0x00, 0x00
+};
+static uint8_t GetFileSettingsAPDU[] = {
+    0x90, 0xF5, 0x00, 0x00, 0x01, BENCH_FILE_NO, 0x00
+};
+
+static const struct {
+    const char *Name;
+    const uint8_t *APDU;
+    uint16_t Size;
+} Benchmarks[] = {
+    { "GetFileSettings",        GetFileSettingsAPDU,    sizeof(GetFileSettingsAPDU) },
+    { "ReadData 64 bytes",      ReadDataAPDU,           sizeof(ReadDataAPDU) },
+    { "WriteData 48 bytes",     WriteDataAPDU,          sizeof(WriteDataAPDU) },
+};
+
+/* The legacy authentications are the ones of Traces/DESFireData.trc, the
+ * host build generates the same RndB as the trace replay */
+static bool Setup(void) {
+    static const uint8_t SetupAPDUs[][22] = {
+        { 0x90, 0x0A, 0x00, 0x00, 0x01, 0x00, 0x00 },
+        {
+            0x90, 0xAF, 0x00, 0x00, 0x10, 0xCE, 0xAD, 0x37, 0x3D, 0xB8, 0x0E, 0xAB, 0xF8,
+            0xFF, 0xA4, 0x99, 0x84, 0x85, 0xD6, 0x46, 0x62, 0x00
+        },
+        /* CreateApplication 010203, select it and authenticate */
+        { 0x90, 0xCA, 0x00, 0x00, 0x05, 0x01, 0x02, 0x03, 0x0F, 0x02, 0x00 },
+        { 0x90, 0x5A, 0x00, 0x00, 0x03, 0x01, 0x02, 0x03, 0x00 },
+        { 0x90, 0x0A, 0x00, 0x00, 0x01, 0x00, 0x00 },
+        {
+            0x90, 0xAF, 0x00, 0x00, 0x10, 0xCE, 0xAD, 0x37, 0x3D, 0xB8, 0x0E, 0xAB, 0xF8,
+            0xF6, 0x6D, 0x57, 0x1C, 0xD9, 0xF6, 0x1D, 0xAE, 0x00
+        },
+        /* CreateStdDataFile with free access */
+        { 0x90, 0xCD, 0x00, 0x00, 0x07, BENCH_FILE_NO, 0x00, 0xEE, 0xEE, BENCH_PAYLOAD_SIZE, 0x00, 0x00, 0x00 },
+    };
+    static const uint8_t SetupSizes[] = { 7, 22, 11, 9, 7, 22, 13 };
+    uint8_t Uid[10];
+    uint8_t Answer[CODEC_BUFFER_SIZE];
+
+    if (!HostReaderInit("MF_DESFIRE") || HostReaderActivate(Uid) == 0) {
+        return false;
+    }
+    for (unsigned i = 0; i < sizeof(SetupSizes); i++) {
+        int AnswerBytes = HostReaderExchangeAPDU(SetupAPDUs[i], SetupSizes[i], Answer, sizeof(Answer), NULL);
+        if (AnswerBytes < 2 || Answer[AnswerBytes - 2] != 0x91 ||
+                (Answer[AnswerBytes - 1] != 0x00 && Answer[AnswerBytes - 1] != 0xAF)) {
+            fprintf(stderr, "Setup APDU %u failed\n", i);
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < BENCH_WRITE_SIZE; i++) {
+        WriteDataAPDU[12 + i] = i;
+    }
+    return true;
+}
+
+/* One I-block through ApplicationProcess(), returns the answer size in
+ * bytes or 0 for no or an unsuccessful answer */
+static uint16_t ProcessFrame(const uint8_t *APDU, uint16_t Size, uint8_t BlockNumber) {
+    CodecBuffer[0] = 0x02 | BlockNumber;
+    __real_memcpy(&CodecBuffer[1], APDU, Size);
+    ISO14443AAppendCRCA(CodecBuffer, Size + 1);
+
+    uint16_t AnswerBits = ApplicationProcess(CodecBuffer, (Size + 1 + ISO14443A_CRCA_SIZE) * 8);
+    uint16_t AnswerBytes = (AnswerBits & ~ISO14443A_APP_CUSTOM_PARITY) / 8;
+    if (AnswerBits == ISO14443A_APP_NO_RESPONSE || AnswerBytes < 1 + 2 + ISO14443A_CRCA_SIZE ||
+            !ISO14443ACheckCRCA(CodecBuffer, AnswerBytes - ISO14443A_CRCA_SIZE) ||
+            CodecBuffer[AnswerBytes - ISO14443A_CRCA_SIZE - 2] != 0x91 ||
+            CodecBuffer[AnswerBytes - ISO14443A_CRCA_SIZE - 1] != 0x00) {
+        return 0;
+    }
+    return AnswerBytes;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long Iterations = 100000;
+    int Option;
+
+    while ((Option = getopt(argc, argv, "n:")) != -1) {
+        switch (Option) {
+            case 'n':
+                Iterations = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n iterations]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (Iterations == 0 || !Setup()) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%-24s %8s %8s %10s %10s %12s\n", "Frame", "In", "Out", "Copied", "Compared", "ns/frame");
+    for (unsigned b = 0; b < sizeof(Benchmarks) / sizeof(Benchmarks[0]); b++) {
+        uint16_t AnswerBytes = 0;
+
+        /* Bytes touched by a single frame */
+        BytesCopied = BytesCompared = 0;
+        Counting = true;
+        AnswerBytes = ProcessFrame(Benchmarks[b].APDU, Benchmarks[b].Size, 0);
+        Counting = false;
+        if (AnswerBytes == 0) {
+            fprintf(stderr, "%s: unexpected answer\n", Benchmarks[b].Name);
+            return EXIT_FAILURE;
+        }
+
+        uint64_t Start = GetNanoseconds();
+        for (unsigned long i = 0; i < Iterations; i++) {
+            if (ProcessFrame(Benchmarks[b].APDU, Benchmarks[b].Size, (i + 1) & 1) == 0) {
+                fprintf(stderr, "%s: unexpected answer in iteration %lu\n", Benchmarks[b].Name, i);
+                return EXIT_FAILURE;
+            }
+        }
+        uint64_t Elapsed = GetNanoseconds() - Start;
+
+        printf("%-24s %8u %8u %10llu %10llu %12.1f\n", Benchmarks[b].Name,
+               Benchmarks[b].Size + 1 + ISO14443A_CRCA_SIZE, AnswerBytes,
+               (unsigned long long) BytesCopied, (unsigned long long) BytesCompared,
+               (double) Elapsed / Iterations);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,213 @@
+/*
+ * CRCBench.c
+ *
+ * Benchmark of the CRC kernels in Application/CRC.c against the byte- and
+ * bitwise loops they replaced. Every kernel is checked against its
+ * reference, also when a buffer is processed in two parts. Any mismatch
+ * makes the benchmark fail.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <util/crc16.h>
+
+#include "../Application/CRC.h"
+
+#define BENCH_POOL_SIZE         64
+#define BENCH_FRAME_SIZE        64
+
+static uint8_t Pool[BENCH_POOL_SIZE][BENCH_FRAME_SIZE];
+static volatile uint32_t Sink;
+
+static uint64_t GetNanoseconds(void) {
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t) Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+static uint32_t XorShift(void) {
+    static uint32_t Seed = 0x12345678UL;
+
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 17;
+    Seed ^= Seed << 5;
+    return Seed;
+}
+
+/* Former ISO14443AAppendCRCA() and ISO14443AUpdateCRCA() without CRC peripheral */
+static uint32_t RefCRCAccitt(const uint8_t *Buffer, uint16_t ByteCount) {
+    uint16_t Checksum = CRC_A_PRESET;
+
+    while (ByteCount--) {
+        Checksum = _crc_ccitt_update(Checksum, *Buffer++);
+    }
+
+    return Checksum;
+}
+
+/* Former ISO14443_CRCA() of Reader14443A.c */
+static uint32_t RefCRCAReader(const uint8_t *Buffer, uint16_t ByteCount) {
+    uint16_t crc = 0x6363;
+    uint8_t ch;
+
+    while (ByteCount--) {
+        ch = *Buffer++ ^ crc;
+        ch = ch ^ (ch << 4);
+        crc = (crc >> 8) ^ (ch << 8) ^ (ch << 3) ^ (ch >> 4);
+    }
+
+    return crc;
+}
+
+/* Former calculateCRC() of ISO15693-A.c */
+static uint32_t RefCRCISO15693(const uint8_t *Buffer, uint16_t ByteCount) {
+    uint16_t reg = CRC_ISO15693_PRESET;
+
+    while (ByteCount--) {
+        reg = reg ^ *Buffer++;
+        for (uint8_t j = 0; j < 8; j++) {
+            reg = (reg & 0x0001) ? ((reg >> 1) ^ 0x8408) : (reg >> 1);
+        }
+    }
+
+    return (uint16_t) ~reg;
+}
+
+/* Former desfire_crc32() of CryptoAES128.c */
+static uint32_t RefCRC32DESFire(const uint8_t *Buffer, uint16_t ByteCount) {
+    uint32_t crc = CRC32_DESFIRE_PRESET;
+
+    while (ByteCount--) {
+        crc ^= *Buffer++;
+        for (int current_bit = 7; current_bit >= 0; current_bit--) {
+            int bit_out = crc & 0x00000001;
+            crc >>= 1;
+            if (bit_out)
+                crc ^= 0xEDB88320;
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t CRCA(const uint8_t *Buffer, uint16_t ByteCount) {
+    return CRCACalc(Buffer, ByteCount);
+}
+
+static uint32_t CRCA2Parts(const uint8_t *Buffer, uint16_t ByteCount) {
+    return CRC16Update(CRC16Update(CRC_A_PRESET, Buffer, ByteCount / 3), Buffer + ByteCount / 3, ByteCount - ByteCount / 3);
+}
+
+static uint32_t CRCISO15693(const uint8_t *Buffer, uint16_t ByteCount) {
+    return CRCISO15693Calc(Buffer, ByteCount);
+}
+
+static uint32_t CRC32DESFire(const uint8_t *Buffer, uint16_t ByteCount) {
+    return CRC32DESFireCalc(Buffer, ByteCount);
+}
+
+static uint32_t CRC32DESFire2Parts(const uint8_t *Buffer, uint16_t ByteCount) {
+    return CRC32Update(CRC32Update(CRC32_DESFIRE_PRESET, Buffer, ByteCount / 3), Buffer + ByteCount / 3, ByteCount - ByteCount / 3);
+}
+
+typedef uint32_t (*CRCFuncType)(const uint8_t *Buffer, uint16_t ByteCount);
+
+static const struct {
+    const char *Name;
+    CRCFuncType Func;
+    CRCFuncType Reference;
+} Benchmarks[] = {
+    { "CRC_A _crc_ccitt_update",            RefCRCAccitt,       NULL },
+    { "CRC_A ISO14443_CRCA (old)",          RefCRCAReader,      NULL },
+    { "CRC_A CRCACalc",                     CRCA,               RefCRCAccitt },
+    { "CRC_A CRC16Update (2 parts)",        CRCA2Parts,         RefCRCAccitt },
+    { "ISO15693 bitwise (old)",             RefCRCISO15693,     NULL },
+    { "ISO15693 CRCISO15693Calc",           CRCISO15693,        RefCRCISO15693 },
+    { "CRC32 bitwise (old)",                RefCRC32DESFire,    NULL },
+    { "CRC32 CRC32DESFireCalc",             CRC32DESFire,       RefCRC32DESFire },
+    { "CRC32 CRC32Update (2 parts)",        CRC32DESFire2Parts, RefCRC32DESFire },
+};
+
+static bool Verify(void) {
+    bool Success = true;
+
+    for (unsigned b = 0; b < sizeof(Benchmarks) / sizeof(Benchmarks[0]); b++) {
+        if (Benchmarks[b].Reference == NULL) {
+            continue;
+        }
+
+        for (unsigned i = 0; i < BENCH_POOL_SIZE; i++) {
+            for (uint16_t Length = 0; Length <= BENCH_FRAME_SIZE; Length++) {
+                if (Benchmarks[b].Func(Pool[i], Length) != Benchmarks[b].Reference(Pool[i], Length)) {
+                    fprintf(stderr, "%s: mismatch at length %u\n", Benchmarks[b].Name, Length);
+                    Success = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    /* CRC_A and the old reader implementation agree, a valid frame leaves a zero residue */
+    uint8_t Frame[BENCH_FRAME_SIZE + 2];
+    uint16_t Checksum = CRCACalc(Pool[0], BENCH_FRAME_SIZE);
+
+    memcpy(Frame, Pool[0], BENCH_FRAME_SIZE);
+    Frame[BENCH_FRAME_SIZE + 0] = Checksum & 0xFF;
+    Frame[BENCH_FRAME_SIZE + 1] = Checksum >> 8;
+
+    if ((RefCRCAReader(Pool[0], BENCH_FRAME_SIZE) != Checksum) || (CRCACalc(Frame, sizeof(Frame)) != 0)) {
+        fprintf(stderr, "CRC_A residue mismatch\n");
+        Success = false;
+    }
+
+    return Success;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long Iterations = 1000000;
+    uint16_t FrameSize = 18;
+    int Option;
+
+    while ((Option = getopt(argc, argv, "n:s:")) != -1) {
+        if (Option == 'n') {
+            Iterations = strtoul(optarg, NULL, 0);
+        } else if (Option == 's' && atoi(optarg) <= BENCH_FRAME_SIZE) {
+            FrameSize = atoi(optarg);
+        } else {
+            fprintf(stderr, "Usage: %s [-n ITERATIONS] [-s FRAMESIZE]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (unsigned i = 0; i < BENCH_POOL_SIZE; i++) {
+        for (unsigned j = 0; j < BENCH_FRAME_SIZE; j++) {
+            Pool[i][j] = XorShift();
+        }
+    }
+
+    if (!Verify()) {
+        return EXIT_FAILURE;
+    }
+
+    printf("CRC kernels, %u byte frames\n", FrameSize);
+
+    for (unsigned b = 0; b < sizeof(Benchmarks) / sizeof(Benchmarks[0]); b++) {
+        uint64_t Start = GetNanoseconds();
+        uint32_t Result = 0;
+
+        for (unsigned long i = 0; i < Iterations; i++) {
+            Result ^= Benchmarks[b].Func(Pool[i % BENCH_POOL_SIZE], FrameSize);
+        }
+
+        uint64_t Elapsed = GetNanoseconds() - Start;
+
+        Sink = Result;
+        printf("%-34s%10.1f ns\n", Benchmarks[b].Name, (double) Elapsed / Iterations);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*
+ * Crypto1Bench.c
+ *
+ * Benchmark of the Crypto1 engine in Application/Crypto1.c. The Makefile
+ * builds it once with the bitwise engine and once with the table driven
+ * engine (-DCRYPTO1_TABLE_ENGINE). Both runs print a digest over all
+ * generated keystream, parity bits and LFSR states, which has to match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "../Application/Crypto1.h"
+
+#define BENCH_POOL_SIZE         64
+#define BENCH_FRAME_SIZE        18  /* READ answer: 16 bytes data + CRC */
+#define BENCH_PARITY_OFFSET     128 /* ISO14443A_BUFFER_PARITY_OFFSET of the host build */
+
+typedef struct {
+    uint8_t Key[6];
+    uint8_t Uid[4];
+    uint8_t Nonce[8];
+    uint8_t ReaderNonce[4];
+    uint8_t Frame[BENCH_FRAME_SIZE];
+} BenchInputType;
+
+static BenchInputType Pool[BENCH_POOL_SIZE];
+static uint32_t Digest = 0x811C9DC5UL;
+
+static uint64_t GetNanoseconds(void) {
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t) Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+static uint32_t XorShift(void) {
+    static uint32_t Seed = 0x12345678UL;
+
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 17;
+    Seed ^= Seed << 5;
+    return Seed;
+}
+
+/* FNV-1a */
+static void DigestUpdate(const uint8_t *Data, size_t Count) {
+    while (Count--) {
+        Digest = (Digest ^ *Data++) * 0x01000193UL;
+    }
+}
+
+static void DigestState(void) {
+    uint8_t Even[3], Odd[3];
+
+    Crypto1GetState(Even, Odd);
+    DigestUpdate(Even, sizeof(Even));
+    DigestUpdate(Odd, sizeof(Odd));
+}
+
+static void FillPool(void) {
+    for (unsigned i = 0; i < BENCH_POOL_SIZE; i++) {
+        uint8_t *Bytes = (uint8_t *) &Pool[i];
+
+        for (unsigned j = 0; j < sizeof(BenchInputType); j++) {
+            Bytes[j] = XorShift();
+        }
+    }
+}
+
+static void BenchSetup(unsigned Index) {
+    uint8_t Nonce[4];
+
+    memcpy(Nonce, Pool[Index].Nonce, sizeof(Nonce));
+    Crypto1Setup(Pool[Index].Key, Pool[Index].Uid, Nonce);
+    DigestUpdate(Nonce, sizeof(Nonce));
+}
+
+static void BenchSetupNested(unsigned Index) {
+    uint8_t Nonce[8];
+
+    memcpy(Nonce, Pool[Index].Nonce, sizeof(Nonce));
+    Crypto1SetupNested(Pool[Index].Key, Pool[Index].Uid, Nonce, false);
+    DigestUpdate(Nonce, sizeof(Nonce));
+}
+
+static void BenchSetupNestedDecrypt(unsigned Index) {
+    uint8_t Nonce[8];
+
+    memcpy(Nonce, Pool[Index].Nonce, sizeof(Nonce));
+    Crypto1SetupNested(Pool[Index].Key, Pool[Index].Uid, Nonce, true);
+    DigestUpdate(Nonce, sizeof(Nonce));
+}
+
+static void BenchAuth(unsigned Index) {
+    Crypto1Auth(Pool[Index].ReaderNonce);
+}
+
+static void BenchByteArray(unsigned Index) {
+    uint8_t Buffer[BENCH_FRAME_SIZE];
+
+    memcpy(Buffer, Pool[Index].Frame, sizeof(Buffer));
+    Crypto1ByteArray(Buffer, sizeof(Buffer));
+    DigestUpdate(Buffer, sizeof(Buffer));
+}
+
+static void BenchByteArrayWithParity(unsigned Index) {
+    uint8_t Buffer[BENCH_PARITY_OFFSET + BENCH_FRAME_SIZE];
+
+    memcpy(Buffer, Pool[Index].Frame, BENCH_FRAME_SIZE);
+    Crypto1ByteArrayWithParity(Buffer, BENCH_FRAME_SIZE);
+    DigestUpdate(Buffer, BENCH_FRAME_SIZE);
+    DigestUpdate(&Buffer[BENCH_PARITY_OFFSET], BENCH_FRAME_SIZE);
+}
+
+static const struct {
+    const char *Name;
+    void (*Func)(unsigned Index);
+} Benchmarks[] = {
+    { "Crypto1Setup",                       BenchSetup },
+    { "Crypto1Auth",                        BenchAuth },
+    { "Crypto1ByteArray(18)",               BenchByteArray },
+    { "Crypto1ByteArrayWithParity(18)",     BenchByteArrayWithParity },
+    { "Crypto1SetupNested",                 BenchSetupNested },
+    { "Crypto1SetupNested(Decrypt)",        BenchSetupNestedDecrypt },
+};
+
+int main(int argc, char *argv[]) {
+    unsigned long Iterations = 1000000;
+    int Option;
+
+    while ((Option = getopt(argc, argv, "n:")) != -1) {
+        if (Option == 'n') {
+            Iterations = strtoul(optarg, NULL, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [-n ITERATIONS]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+#ifdef CRYPTO1_TABLE_ENGINE
+    printf("Crypto1 engine: table driven\n");
+#else
+    printf("Crypto1 engine: bitwise\n");
+#endif
+
+    FillPool();
+
+    for (unsigned b = 0; b < sizeof(Benchmarks) / sizeof(Benchmarks[0]); b++) {
+        uint64_t Start = GetNanoseconds();
+
+        /* Every function continues from the state left by the previous call */
+        for (unsigned long i = 0; i < Iterations; i++) {
+            Benchmarks[b].Func(i % BENCH_POOL_SIZE);
+        }
+
+        uint64_t Elapsed = GetNanoseconds() - Start;
+
+        DigestState();
+        printf("%-34s%10.1f ns\n", Benchmarks[b].Name, (double) Elapsed / Iterations);
+    }
+
+    printf("Digest 0x%08lX\n", (unsigned long) Digest);
+
+    return EXIT_SUCCESS;
+}
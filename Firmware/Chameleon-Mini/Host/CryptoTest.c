@@ -0,0 +1,40 @@
+/*
+ * CryptoTest.c
+ *
+ * Runs the known-answer tests of Tests/CryptoTests.c, which RUNTESTS runs
+ * on the device, against the host models of the crypto peripherals.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Tests/CryptoTests.h"
+
+typedef bool (*CryptoTestType)(char *OutParam, uint16_t MaxOutputLength);
+
+static const struct {
+    const char *Name;
+    CryptoTestType Test;
+} TestCases[] = {
+    { "CryptoAESTestCase1", CryptoAESTestCase1 },
+    { "CryptoAESTestCase2", CryptoAESTestCase2 },
+    { "CryptoAESTestCase3", CryptoAESTestCase3 },
+    { "Crypto1TestCase1", Crypto1TestCase1 },
+};
+
+int main(void) {
+    char Output[TERMINAL_BUFFER_SIZE];
+    int Failed = 0;
+
+    for (size_t i = 0; i < sizeof(TestCases) / sizeof(TestCases[0]); i++) {
+        memset(Output, 0, sizeof(Output));
+        if (TestCases[i].Test(Output, sizeof(Output))) {
+            printf("%s ok\n", TestCases[i].Name);
+        } else {
+            printf("%s FAILED\n%s", TestCases[i].Name, Output);
+            Failed++;
+        }
+    }
+    return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
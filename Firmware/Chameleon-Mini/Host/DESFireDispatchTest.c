@@ -0,0 +1,186 @@
+/*
+ * DESFireDispatchTest.c
+ *
+ * Checks the DESFire instruction dispatch table. The test includes
+ * DESFireInstructions.c to see the static command handlers and is linked
+ * against the other host objects instead of DESFireInstructions.o.
+ *
+ * Every CMD_* code in DESFireInstructions.h has to map to the handler
+ * listed below, all other instruction bytes have to give no response.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Application/DESFire/DESFireInstructions.c"
+
+#define EXPECT(Code, Handler)   { Code, #Code, &Handler }
+
+typedef struct {
+    uint8_t InsCode;
+    const char *Name;
+    InsCodeHandlerFunc Handler;
+} ExpectedHandlerType;
+
+static const ExpectedHandlerType ExpectedHandlers[] = {
+    EXPECT(CMD_AUTHENTICATE, EV0CmdAuthenticateLegacy1),
+    EXPECT(CMD_CREDIT, EV0CmdCredit),
+    EXPECT(CMD_AUTHENTICATE_ISO, DesfireCmdAuthenticate3KTDEA1),
+    EXPECT(CMD_LIMITED_CREDIT, EV0CmdLimitedCredit),
+    EXPECT(CMD_WRITE_RECORD, EV0CmdWriteRecord),
+    EXPECT(CMD_WRITE_DATA, EV0CmdWriteData),
+    EXPECT(CMD_GET_KEY_SETTINGS, EV0CmdGetKeySettings),
+    EXPECT(CMD_GET_CARD_UID, DesfireCmdGetCardUID),
+    EXPECT(CMD_CHANGE_KEY_SETTINGS, EV0CmdChangeKeySettings),
+    EXPECT(CMD_SELECT_APPLICATION, EV0CmdSelectApplication),
+    EXPECT(CMD_SET_CONFIGURATION, CmdNotImplemented),
+    EXPECT(CMD_CHANGE_FILE_SETTINGS, EV0CmdChangeFileSettings),
+    EXPECT(CMD_GET_VERSION, EV0CmdGetVersion1),
+    EXPECT(CMD_GET_ISO_FILE_IDS, EV0CmdGetFileIds),
+    EXPECT(CMD_GET_KEY_VERSION, DesfireCmdGetKeyVersion),
+    EXPECT(CMD_GET_APPLICATION_IDS, EV0CmdGetApplicationIds1),
+    EXPECT(CMD_GET_VALUE, EV0CmdGetValue),
+    EXPECT(CMD_GET_DF_NAMES, DesfireCmdGetDFNames),
+    EXPECT(CMD_FREE_MEMORY, DesfireCmdFreeMemory),
+    EXPECT(CMD_GET_FILE_IDS, EV0CmdGetFileIds),
+    EXPECT(CMD_AUTHENTICATE_EV2_FIRST, CmdNotImplemented),
+    EXPECT(CMD_AUTHENTICATE_EV2_NONFIRST, CmdNotImplemented),
+    EXPECT(CMD_ABORT_TRANSACTION, EV0CmdAbortTransaction),
+    EXPECT(CMD_AUTHENTICATE_AES, DesfireCmdAuthenticateAES1),
+    EXPECT(CMD_READ_RECORDS, EV0CmdReadRecords),
+    EXPECT(CMD_READ_DATA, EV0CmdReadData),
+    EXPECT(CMD_CREATE_CYCLIC_RECORD_FILE, EV0CmdCreateCyclicRecordFile),
+    EXPECT(CMD_CREATE_LINEAR_RECORD_FILE, EV0CmdCreateLinearRecordFile),
+    EXPECT(CMD_CHANGE_KEY, EV0CmdChangeKey),
+    EXPECT(CMD_CREATE_APPLICATION, EV0CmdCreateApplication),
+    EXPECT(CMD_CREATE_BACKUPDATA_FILE, EV0CmdCreateBackupDataFile),
+    EXPECT(CMD_CREATE_VALUE_FILE, EV0CmdCreateValueFile),
+    EXPECT(CMD_CREATE_STDDATA_FILE, EV0CmdCreateStandardDataFile),
+    EXPECT(CMD_COMMIT_TRANSACTION, EV0CmdCommitTransaction),
+    EXPECT(CMD_DELETE_APPLICATION, EV0CmdDeleteApplication),
+    EXPECT(CMD_DEBIT, EV0CmdDebit),
+    EXPECT(CMD_DELETE_FILE, EV0CmdDeleteFile),
+    EXPECT(CMD_CLEAR_RECORD_FILE, EV0CmdClearRecords),
+    EXPECT(CMD_FORMAT_PICC, EV0CmdFormatPicc),
+    EXPECT(CMD_GET_FILE_SETTINGS, EV0CmdGetFileSettings),
+    EXPECT(CMD_ISO7816_EXTERNAL_AUTHENTICATE, ISO7816CmdExternalAuthenticate),
+    EXPECT(CMD_ISO7816_GET_CHALLENGE, ISO7816CmdGetChallenge),
+    EXPECT(CMD_ISO7816_INTERNAL_AUTHENTICATE, ISO7816CmdInternalAuthenticate),
+    EXPECT(CMD_ISO7816_SELECT, ISO7816CmdSelect),
+    EXPECT(CMD_ISO7816_READ_BINARY, ISO7816CmdReadBinary),
+    EXPECT(CMD_ISO7816_READ_RECORDS, ISO7816CmdReadRecords),
+    EXPECT(CMD_ISO7816_UPDATE_BINARY, ISO7816CmdUpdateBinary),
+    EXPECT(CMD_ISO7816_APPEND_RECORD, ISO7816CmdAppendRecord),
+};
+
+/* Codes of the enumeration which are handled by the state machine in
+ * MifareDESFire.c and must not be dispatched */
+static const char *const StateMachineCodes[] = {
+    "NO_COMMAND_TO_CONTINUE",
+    "CMD_CONTINUE",
+};
+
+#define EXPECTED_HANDLER_COUNT  (sizeof(ExpectedHandlers) / sizeof(ExpectedHandlers[0]))
+
+static unsigned Failures = 0;
+
+static void Fail(const char *Message, const char *Name, unsigned InsCode) {
+    fprintf(stderr, "%s: %s (0x%02X)\n", Message, Name, InsCode);
+    Failures++;
+}
+
+static InsCodeHandlerFunc LookupHandler(uint8_t InsCode) {
+    return (InsCodeHandlerFunc) pgm_read_ptr(&DESFireCommandTable[InsCode]);
+}
+
+static const ExpectedHandlerType *FindExpectedByName(const char *Name) {
+    for (unsigned i = 0; i < EXPECTED_HANDLER_COUNT; i++) {
+        if (strcmp(ExpectedHandlers[i].Name, Name) == 0) {
+            return &ExpectedHandlers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Every "CMD_... = 0x.." line of the header has to be covered above, so
+ * that a new instruction code can not be added without a table entry */
+static unsigned CheckHeaderCodes(const char *HeaderFile) {
+    FILE *Header = fopen(HeaderFile, "r");
+    char Line[256];
+    unsigned CodeCount = 0;
+
+    if (Header == NULL) {
+        perror(HeaderFile);
+        Failures++;
+        return 0;
+    }
+    while (fgets(Line, sizeof(Line), Header) != NULL) {
+        char Name[64];
+        unsigned InsCode;
+        if (sscanf(Line, " %63[A-Z0-9_] = 0x%x", Name, &InsCode) != 2) {
+            continue;
+        }
+        bool IsStateMachineCode = false;
+        for (unsigned i = 0; i < sizeof(StateMachineCodes) / sizeof(StateMachineCodes[0]); i++) {
+            IsStateMachineCode |= strcmp(StateMachineCodes[i], Name) == 0;
+        }
+        if (IsStateMachineCode) {
+            if (InsCode != NO_COMMAND_TO_CONTINUE && LookupHandler(InsCode) != NULL) {
+                Fail("State machine code is dispatched", Name, InsCode);
+            }
+            continue;
+        }
+        const ExpectedHandlerType *Expected = FindExpectedByName(Name);
+        if (Expected == NULL) {
+            Fail("Instruction code without expected handler", Name, InsCode);
+        } else if (Expected->InsCode != InsCode) {
+            Fail("Instruction code changed", Name, InsCode);
+        }
+        CodeCount++;
+    }
+    fclose(Header);
+    return CodeCount;
+}
+
+int main(int argc, char *argv[]) {
+    uint8_t Buffer[16];
+    const char *HeaderFile = (argc > 1) ? argv[1] : "../Application/DESFire/DESFireInstructions.h";
+
+    for (unsigned i = 0; i < EXPECTED_HANDLER_COUNT; i++) {
+        const ExpectedHandlerType *Expected = &ExpectedHandlers[i];
+        if (LookupHandler(Expected->InsCode) != Expected->Handler) {
+            Fail("Wrong handler", Expected->Name, Expected->InsCode);
+        }
+    }
+
+    /* Everything else is not answered */
+    for (unsigned InsCode = 0; InsCode < 256; InsCode++) {
+        bool Listed = false;
+        for (unsigned i = 0; i < EXPECTED_HANDLER_COUNT; i++) {
+            Listed |= ExpectedHandlers[i].InsCode == InsCode;
+        }
+        if (Listed) {
+            continue;
+        }
+        Buffer[0] = InsCode;
+        if (LookupHandler(InsCode) != NULL || CallInstructionHandler(Buffer, 1) != ISO14443A_APP_NO_RESPONSE) {
+            Fail("Unknown instruction is dispatched", "-", InsCode);
+        }
+    }
+
+    Buffer[0] = CMD_GET_VERSION;
+    if (CallInstructionHandler(Buffer, 0) != DESFIRE_STATUS_RESPONSE_SIZE || Buffer[0] != STATUS_PARAMETER_ERROR) {
+        Fail("Empty command is not rejected", "-", CMD_GET_VERSION);
+    }
+
+    unsigned CodeCount = CheckHeaderCodes(HeaderFile);
+    if (CodeCount != EXPECTED_HANDLER_COUNT) {
+        fprintf(stderr, "%u instruction codes in %s, %u expected handlers\n",
+                CodeCount, HeaderFile, (unsigned) EXPECTED_HANDLER_COUNT);
+        Failures++;
+    }
+
+    printf("%u instruction codes checked, %u failures\n", (unsigned) EXPECTED_HANDLER_COUNT, Failures);
+    return Failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
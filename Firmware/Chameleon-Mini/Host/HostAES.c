@@ -0,0 +1,223 @@
+/*
+ * HostAES.c
+ *
+ * Software model of the XMEGA AES peripheral, implementing the aes_*
+ * accessors of Application/CryptoAES128.c for the host build.
+ *
+ * Like the hardware, the key register holds the last round key after an
+ * encryption, and decryption expects the last round key to be loaded.
+ * In XOR mode, data written to the state is XORed into the current state.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "../Application/CryptoAES128.h"
+
+#define HOST_AES_ROUNDS     10
+
+static struct {
+    uint8_t Ctrl;
+    bool Done;
+    uint8_t Key[CRYPTO_AES_KEY_SIZE];
+    uint8_t State[CRYPTO_AES_BLOCK_SIZE];
+} HostAES;
+
+static uint8_t SBox[256];
+static uint8_t InvSBox[256];
+
+static uint8_t XTime(uint8_t x) {
+    return (x << 1) ^ ((x & 0x80) ? 0x1B : 0x00);
+}
+
+static uint8_t Multiply(uint8_t a, uint8_t b) {
+    uint8_t Result = 0;
+
+    while (b) {
+        if (b & 1) {
+            Result ^= a;
+        }
+        a = XTime(a);
+        b >>= 1;
+    }
+
+    return Result;
+}
+
+static void InitSBoxes(void) {
+    /* Generate the S-box from the multiplicative inverse in GF(2^8) */
+    uint8_t p = 1, q = 1;
+
+    if (SBox[0] == 0x63) {
+        return;
+    }
+
+    do {
+        p = p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0x00);
+        q ^= q << 1;
+        q ^= q << 2;
+        q ^= q << 4;
+        q ^= (q & 0x80) ? 0x09 : 0x00;
+        uint8_t x = q ^ (q << 1 | q >> 7) ^ (q << 2 | q >> 6) ^ (q << 3 | q >> 5) ^ (q << 4 | q >> 4);
+        SBox[p] = x ^ 0x63;
+    } while (p != 1);
+
+    SBox[0] = 0x63;
+
+    for (uint16_t i = 0; i < 256; i++) {
+        InvSBox[SBox[i]] = i;
+    }
+}
+
+static void NextRoundKey(uint8_t *Key, uint8_t Rcon) {
+    Key[0] ^= SBox[Key[13]] ^ Rcon;
+    Key[1] ^= SBox[Key[14]];
+    Key[2] ^= SBox[Key[15]];
+    Key[3] ^= SBox[Key[12]];
+
+    for (uint8_t i = 4; i < 16; i++) {
+        Key[i] ^= Key[i - 4];
+    }
+}
+
+static void PrevRoundKey(uint8_t *Key, uint8_t Rcon) {
+    for (uint8_t i = 15; i >= 4; i--) {
+        Key[i] ^= Key[i - 4];
+    }
+
+    Key[0] ^= SBox[Key[13]] ^ Rcon;
+    Key[1] ^= SBox[Key[14]];
+    Key[2] ^= SBox[Key[15]];
+    Key[3] ^= SBox[Key[12]];
+}
+
+static void ShiftRows(uint8_t *State, bool Inverse) {
+    uint8_t Temp[CRYPTO_AES_BLOCK_SIZE];
+
+    for (uint8_t Col = 0; Col < 4; Col++) {
+        for (uint8_t Row = 0; Row < 4; Row++) {
+            uint8_t Src = Inverse ? (Col + 4 - Row) % 4 : (Col + Row) % 4;
+            Temp[Col * 4 + Row] = State[Src * 4 + Row];
+        }
+    }
+
+    memcpy(State, Temp, sizeof(Temp));
+}
+
+static void MixColumns(uint8_t *State, bool Inverse) {
+    static const uint8_t Forward[4] = { 2, 3, 1, 1 };
+    static const uint8_t Backward[4] = { 14, 11, 13, 9 };
+    const uint8_t *Coeff = Inverse ? Backward : Forward;
+
+    for (uint8_t Col = 0; Col < 4; Col++) {
+        uint8_t *c = &State[Col * 4];
+        uint8_t Temp[4];
+
+        for (uint8_t Row = 0; Row < 4; Row++) {
+            Temp[Row] = Multiply(c[0], Coeff[(4 - Row) % 4]) ^ Multiply(c[1], Coeff[(5 - Row) % 4]) ^
+                        Multiply(c[2], Coeff[(6 - Row) % 4]) ^ Multiply(c[3], Coeff[(7 - Row) % 4]);
+        }
+
+        memcpy(c, Temp, sizeof(Temp));
+    }
+}
+
+static void AddRoundKey(uint8_t *State, const uint8_t *Key) {
+    for (uint8_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; i++) {
+        State[i] ^= Key[i];
+    }
+}
+
+static void HostAESEncrypt(uint8_t *State, uint8_t *Key) {
+    uint8_t Rcon = 0x01;
+
+    AddRoundKey(State, Key);
+
+    for (uint8_t Round = 1; Round <= HOST_AES_ROUNDS; Round++) {
+        for (uint8_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; i++) {
+            State[i] = SBox[State[i]];
+        }
+        ShiftRows(State, false);
+        if (Round != HOST_AES_ROUNDS) {
+            MixColumns(State, false);
+        }
+        NextRoundKey(Key, Rcon);
+        AddRoundKey(State, Key);
+        Rcon = XTime(Rcon);
+    }
+}
+
+static void HostAESDecrypt(uint8_t *State, uint8_t *Key) {
+    uint8_t Rcon = 0x36;
+
+    for (uint8_t Round = HOST_AES_ROUNDS; Round >= 1; Round--) {
+        AddRoundKey(State, Key);
+        if (Round != HOST_AES_ROUNDS) {
+            MixColumns(State, true);
+        }
+        ShiftRows(State, true);
+        for (uint8_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; i++) {
+            State[i] = InvSBox[State[i]];
+        }
+        PrevRoundKey(Key, Rcon);
+        Rcon = (Rcon >> 1) ^ ((Rcon & 0x01) ? 0x8D : 0x00);
+    }
+
+    AddRoundKey(State, Key);
+}
+
+void aes_start(void) {
+    InitSBoxes();
+
+    if (HostAES.Ctrl & AES_DECRYPT_bm) {
+        HostAESDecrypt(HostAES.State, HostAES.Key);
+    } else {
+        HostAESEncrypt(HostAES.State, HostAES.Key);
+    }
+
+    HostAES.Done = true;
+}
+
+void aes_software_reset(void) {
+    memset(&HostAES, 0, sizeof(HostAES));
+}
+
+bool aes_is_busy(void) {
+    return !HostAES.Done;
+}
+
+bool aes_is_error(void) {
+    return false;
+}
+
+void aes_clear_interrupt_flag(void) {
+    HostAES.Done = false;
+}
+
+void aes_clear_error_flag(void) {
+}
+
+void aes_configure(CryptoAESDec_t op_mode, CryptoAESAuto_t auto_start, CryptoAESXor_t xor_mode) {
+    HostAES.Ctrl = ((uint8_t) op_mode | (uint8_t) auto_start | (uint8_t) xor_mode);
+}
+
+void aes_set_key(uint8_t *key_in) {
+    memcpy(HostAES.Key, key_in, CRYPTO_AES_KEY_SIZE);
+}
+
+void aes_get_key(uint8_t *key_out) {
+    memcpy(key_out, HostAES.Key, CRYPTO_AES_KEY_SIZE);
+}
+
+void aes_write_inputdata(uint8_t *data_in) {
+    for (uint8_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; i++) {
+        if (HostAES.Ctrl & AES_XOR_bm) {
+            HostAES.State[i] ^= data_in[i];
+        } else {
+            HostAES.State[i] = data_in[i];
+        }
+    }
+}
+
+void aes_read_outputdata(uint8_t *data_out) {
+    memcpy(data_out, HostAES.State, CRYPTO_AES_BLOCK_SIZE);
+}
@@ -0,0 +1,118 @@
+/*
+ * HostCodec.c
+ *
+ * Stand-ins for the codec modules referenced by the ConfigurationTable.
+ * The shared codec state (CodecBuffer, reader field, threshold) comes from
+ * the real Codec/Codec.c.
+ */
+
+#include <string.h>
+#include "HostCodec.h"
+#include "HostHardware.h"
+#include "../Codec/Codec.h"
+#include "../Application/Application.h"
+#include "../Application/ISO15693-A.h"
+#include "../LEDHook.h"
+#include "../Log.h"
+
+HostCodecStatsType HostCodecStats;
+
+uint16_t HostCodecProcessFrame(const void *Frame, uint16_t Count, void *Response, uint64_t *Nanoseconds) {
+    uint16_t ByteCount = (ActiveConfiguration.TagFamily == TAG_FAMILY_ISO15693) ? Count : (Count + 7) / 8;
+    uint16_t AnswerCount;
+
+    if (ByteCount > CODEC_BUFFER_SIZE) {
+        ByteCount = CODEC_BUFFER_SIZE;
+    }
+
+    HostSystemTickUpdate();
+    memcpy(CodecBuffer, Frame, ByteCount);
+
+    /* Same sequence as in ISO14443ACodecTask() */
+    LogEntry(LOG_INFO_CODEC_RX_DATA, CodecBuffer, ByteCount);
+    LEDHook(LED_CODEC_RX, LED_PULSE);
+
+    uint64_t Start = HostGetNanoseconds();
+    AnswerCount = ApplicationProcess(CodecBuffer, Count);
+    uint64_t Elapsed = HostGetNanoseconds() - Start;
+
+    if (ActiveConfiguration.TagFamily != TAG_FAMILY_ISO15693) {
+        AnswerCount &= ~ISO14443A_APP_CUSTOM_PARITY;
+        ByteCount = (AnswerCount + 7) / 8;
+    } else if (AnswerCount != ISO15693_APP_NO_RESPONSE) {
+        /* Same as in ISO15693CodecTask(), the codec appends the CRC */
+        if (AnswerCount > CODEC_BUFFER_SIZE - ISO15693_CRC16_SIZE) {
+            CodecBuffer[ISO15693_ADDR_FLAGS] = ISO15693_RES_FLAG_ERROR;
+            CodecBuffer[ISO15693_RES_ADDR_PARAM] = ISO15693_RES_ERR_NOT_SUPP;
+            AnswerCount = 2;
+        }
+        ISO15693AppendCRC(CodecBuffer, AnswerCount);
+        AnswerCount += ISO15693_CRC16_SIZE;
+        ByteCount = AnswerCount;
+    }
+
+    if (AnswerCount != ISO14443A_APP_NO_RESPONSE) {
+        LogEntry(LOG_INFO_CODEC_TX_DATA, CodecBuffer, ByteCount);
+        LEDHook(LED_CODEC_TX, LED_PULSE);
+        memcpy(Response, CodecBuffer, MIN(ByteCount, CODEC_BUFFER_SIZE));
+        HostCodecStats.Responses++;
+    }
+
+    /* The main loop runs the application task while the answer is sent,
+     * this is not part of the frame processing time */
+    ApplicationTask();
+
+    HostCodecStats.Frames++;
+    HostCodecStats.TotalNanoseconds += Elapsed;
+    if (Elapsed > HostCodecStats.MaxNanoseconds) {
+        HostCodecStats.MaxNanoseconds = Elapsed;
+    }
+
+    if (Nanoseconds != NULL) {
+        *Nanoseconds = Elapsed;
+    }
+
+    return AnswerCount;
+}
+
+void HostCodecResetStats(void) {
+    memset(&HostCodecStats, 0, sizeof(HostCodecStats));
+}
+
+/* Codec interface of the configurations. Frames are pushed through
+ * HostCodecProcessFrame() instead of being polled from a codec task. */
+static void HostCodecInit(void) { }
+static void HostCodecDeInit(void) { }
+static void HostCodecTask(void) { }
+
+void ISO14443ACodecInit(void) { HostCodecInit(); }
+void ISO14443ACodecDeInit(void) { HostCodecDeInit(); }
+void ISO14443ACodecTask(void) { HostCodecTask(); }
+
+void ISO15693CodecInit(void) { HostCodecInit(); }
+void ISO15693CodecDeInit(void) { HostCodecDeInit(); }
+void ISO15693CodecTask(void) { HostCodecTask(); }
+
+void Reader14443ACodecInit(void) { HostCodecInit(); }
+void Reader14443ACodecDeInit(void) { HostCodecDeInit(); }
+void Reader14443ACodecTask(void) { HostCodecTask(); }
+void Reader14443ACodecStart(void) { }
+void Reader14443ACodecReset(void) { }
+
+void Sniff14443ACodecInit(void) { HostCodecInit(); }
+void Sniff14443ACodecDeInit(void) { HostCodecDeInit(); }
+void Sniff14443ACodecTask(void) { HostCodecTask(); }
+
+void SniffISO15693CodecInit(void) { HostCodecInit(); }
+void SniffISO15693CodecDeInit(void) { HostCodecDeInit(); }
+void SniffISO15693CodecTask(void) { HostCodecTask(); }
+
+uint16_t SniffISO15693GetFloorNoise(void) {
+    return 0;
+}
+
+bool SniffISO15693GetAutoThreshold(void) {
+    return false;
+}
+
+void SniffISO15693CtrlAutoThreshold(bool enable) { }
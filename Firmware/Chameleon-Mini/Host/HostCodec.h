@@ -0,0 +1,41 @@
+/*
+ * HostCodec.h
+ *
+ * Simulated codec for the host build. Instead of demodulating a reader
+ * field, frames are handed in by the caller, placed into CodecBuffer and
+ * processed by the active application exactly like the real codec task
+ * does. The time spent in ApplicationProcess() is measured per frame.
+ */
+
+#ifndef HOST_CODEC_H_
+#define HOST_CODEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t Frames;
+    uint32_t Responses;
+    uint64_t TotalNanoseconds;
+    uint64_t MaxNanoseconds;
+} HostCodecStatsType;
+
+extern HostCodecStatsType HostCodecStats;
+
+/* Hands a frame to the active application.
+ *
+ * \param Frame         Received frame, copied into CodecBuffer
+ * \param Count         Passed on to ApplicationProcess() unchanged, i.e. the
+ *                      number of bits for ISO14443A and bytes for ISO15693
+ * \param Response      Buffer of at least CODEC_BUFFER_SIZE bytes for the answer
+ * \param Nanoseconds   Time spent in ApplicationProcess(), may be NULL
+ *
+ * \return Answer of the application (bits or bytes, see above). The
+ *         ISO14443A custom parity flag is stripped, the ISO15693 CRC is
+ *         appended like the codec does.
+ */
+uint16_t HostCodecProcessFrame(const void *Frame, uint16_t Count, void *Response, uint64_t *Nanoseconds);
+
+void HostCodecResetStats(void);
+
+#endif /* HOST_CODEC_H_ */
@@ -0,0 +1,270 @@
+/*
+ * HostCryptoTDEA.c
+ *
+ * Portable C replacement for Application/CryptoTDEA-HWAccelerated.S, which
+ * relies on the XMEGA DES instruction. Exports the same symbols with the
+ * same argument conventions (note that the ECB decryption routines take the
+ * output buffer first). All data is handled big-endian (MSByte first).
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "../Application/CryptoTDEA.h"
+
+static const uint8_t IP[64] = {
+    58, 50, 42, 34, 26, 18, 10, 2, 60, 52, 44, 36, 28, 20, 12, 4,
+    62, 54, 46, 38, 30, 22, 14, 6, 64, 56, 48, 40, 32, 24, 16, 8,
+    57, 49, 41, 33, 25, 17,  9, 1, 59, 51, 43, 35, 27, 19, 11, 3,
+    61, 53, 45, 37, 29, 21, 13, 5, 63, 55, 47, 39, 31, 23, 15, 7
+};
+
+static const uint8_t FP[64] = {
+    40, 8, 48, 16, 56, 24, 64, 32, 39, 7, 47, 15, 55, 23, 63, 31,
+    38, 6, 46, 14, 54, 22, 62, 30, 37, 5, 45, 13, 53, 21, 61, 29,
+    36, 4, 44, 12, 52, 20, 60, 28, 35, 3, 43, 11, 51, 19, 59, 27,
+    34, 2, 42, 10, 50, 18, 58, 26, 33, 1, 41,  9, 49, 17, 57, 25
+};
+
+static const uint8_t E[48] = {
+    32,  1,  2,  3,  4,  5,  4,  5,  6,  7,  8,  9,
+     8,  9, 10, 11, 12, 13, 12, 13, 14, 15, 16, 17,
+    16, 17, 18, 19, 20, 21, 20, 21, 22, 23, 24, 25,
+    24, 25, 26, 27, 28, 29, 28, 29, 30, 31, 32,  1
+};
+
+static const uint8_t P[32] = {
+    16,  7, 20, 21, 29, 12, 28, 17,  1, 15, 23, 26,  5, 18, 31, 10,
+     2,  8, 24, 14, 32, 27,  3,  9, 19, 13, 30,  6, 22, 11,  4, 25
+};
+
+static const uint8_t PC1[56] = {
+    57, 49, 41, 33, 25, 17,  9,  1, 58, 50, 42, 34, 26, 18,
+    10,  2, 59, 51, 43, 35, 27, 19, 11,  3, 60, 52, 44, 36,
+    63, 55, 47, 39, 31, 23, 15,  7, 62, 54, 46, 38, 30, 22,
+    14,  6, 61, 53, 45, 37, 29, 21, 13,  5, 28, 20, 12,  4
+};
+
+static const uint8_t PC2[48] = {
+    14, 17, 11, 24,  1,  5,  3, 28, 15,  6, 21, 10,
+    23, 19, 12,  4, 26,  8, 16,  7, 27, 20, 13,  2,
+    41, 52, 31, 37, 47, 55, 30, 40, 51, 45, 33, 48,
+    44, 49, 39, 56, 34, 53, 46, 42, 50, 36, 29, 32
+};
+
+static const uint8_t Shifts[16] = { 1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1 };
+
+static const uint8_t SBox[8][64] = {
+    {
+        14,  4, 13,  1,  2, 15, 11,  8,  3, 10,  6, 12,  5,  9,  0,  7,
+         0, 15,  7,  4, 14,  2, 13,  1, 10,  6, 12, 11,  9,  5,  3,  8,
+         4,  1, 14,  8, 13,  6,  2, 11, 15, 12,  9,  7,  3, 10,  5,  0,
+        15, 12,  8,  2,  4,  9,  1,  7,  5, 11,  3, 14, 10,  0,  6, 13
+    }, {
+        15,  1,  8, 14,  6, 11,  3,  4,  9,  7,  2, 13, 12,  0,  5, 10,
+         3, 13,  4,  7, 15,  2,  8, 14, 12,  0,  1, 10,  6,  9, 11,  5,
+         0, 14,  7, 11, 10,  4, 13,  1,  5,  8, 12,  6,  9,  3,  2, 15,
+        13,  8, 10,  1,  3, 15,  4,  2, 11,  6,  7, 12,  0,  5, 14,  9
+    }, {
+        10,  0,  9, 14,  6,  3, 15,  5,  1, 13, 12,  7, 11,  4,  2,  8,
+        13,  7,  0,  9,  3,  4,  6, 10,  2,  8,  5, 14, 12, 11, 15,  1,
+        13,  6,  4,  9,  8, 15,  3,  0, 11,  1,  2, 12,  5, 10, 14,  7,
+         1, 10, 13,  0,  6,  9,  8,  7,  4, 15, 14,  3, 11,  5,  2, 12
+    }, {
+         7, 13, 14,  3,  0,  6,  9, 10,  1,  2,  8,  5, 11, 12,  4, 15,
+        13,  8, 11,  5,  6, 15,  0,  3,  4,  7,  2, 12,  1, 10, 14,  9,
+        10,  6,  9,  0, 12, 11,  7, 13, 15,  1,  3, 14,  5,  2,  8,  4,
+         3, 15,  0,  6, 10,  1, 13,  8,  9,  4,  5, 11, 12,  7,  2, 14
+    }, {
+         2, 12,  4,  1,  7, 10, 11,  6,  8,  5,  3, 15, 13,  0, 14,  9,
+        14, 11,  2, 12,  4,  7, 13,  1,  5,  0, 15, 10,  3,  9,  8,  6,
+         4,  2,  1, 11, 10, 13,  7,  8, 15,  9, 12,  5,  6,  3,  0, 14,
+        11,  8, 12,  7,  1, 14,  2, 13,  6, 15,  0,  9, 10,  4,  5,  3
+    }, {
+        12,  1, 10, 15,  9,  2,  6,  8,  0, 13,  3,  4, 14,  7,  5, 11,
+        10, 15,  4,  2,  7, 12,  9,  5,  6,  1, 13, 14,  0, 11,  3,  8,
+         9, 14, 15,  5,  2,  8, 12,  3,  7,  0,  4, 10,  1, 13, 11,  6,
+         4,  3,  2, 12,  9,  5, 15, 10, 11, 14,  1,  7,  6,  0,  8, 13
+    }, {
+         4, 11,  2, 14, 15,  0,  8, 13,  3, 12,  9,  7,  5, 10,  6,  1,
+        13,  0, 11,  7,  4,  9,  1, 10, 14,  3,  5, 12,  2, 15,  8,  6,
+         1,  4, 11, 13, 12,  3,  7, 14, 10, 15,  6,  8,  0,  5,  9,  2,
+         6, 11, 13,  8,  1,  4, 10,  7,  9,  5,  0, 15, 14,  2,  3, 12
+    }, {
+        13,  2,  8,  4,  6, 15, 11,  1, 10,  9,  3, 14,  5,  0, 12,  7,
+         1, 15, 13,  8, 10,  3,  7,  4, 12,  5,  6, 11,  0, 14,  9,  2,
+         7, 11,  4,  1,  9, 12, 14,  2,  0,  6, 10, 13, 15,  3,  5,  8,
+         2,  1, 14,  7,  4, 10,  8, 13, 15, 12,  9,  0,  3,  5,  6, 11
+    }
+};
+
+/* Generic bit permutation, bit positions are 1-based and counted from the MSB */
+static uint64_t Permute(uint64_t In, uint8_t InBits, const uint8_t *Table, uint8_t OutBits) {
+    uint64_t Out = 0;
+
+    for (uint8_t i = 0; i < OutBits; i++) {
+        Out = (Out << 1) | ((In >> (InBits - Table[i])) & 1);
+    }
+
+    return Out;
+}
+
+static uint64_t LoadBlock(const uint8_t *Buffer) {
+    uint64_t Block = 0;
+
+    for (uint8_t i = 0; i < CRYPTO_DES_BLOCK_SIZE; i++) {
+        Block = (Block << 8) | Buffer[i];
+    }
+
+    return Block;
+}
+
+static void StoreBlock(uint8_t *Buffer, uint64_t Block) {
+    for (int8_t i = CRYPTO_DES_BLOCK_SIZE - 1; i >= 0; i--) {
+        Buffer[i] = Block & 0xFF;
+        Block >>= 8;
+    }
+}
+
+static uint64_t RunDEA(uint64_t Block, const uint8_t *Key, bool Decipher) {
+    uint64_t SubKeys[16];
+    uint64_t CD = Permute(LoadBlock(Key), 64, PC1, 56);
+    uint32_t C = (CD >> 28) & 0x0FFFFFFF;
+    uint32_t D = CD & 0x0FFFFFFF;
+
+    for (uint8_t Round = 0; Round < 16; Round++) {
+        C = ((C << Shifts[Round]) | (C >> (28 - Shifts[Round]))) & 0x0FFFFFFF;
+        D = ((D << Shifts[Round]) | (D >> (28 - Shifts[Round]))) & 0x0FFFFFFF;
+        SubKeys[Round] = Permute(((uint64_t) C << 28) | D, 56, PC2, 48);
+    }
+
+    Block = Permute(Block, 64, IP, 64);
+    uint32_t L = Block >> 32;
+    uint32_t R = Block & 0xFFFFFFFF;
+
+    for (uint8_t Round = 0; Round < 16; Round++) {
+        uint64_t X = Permute(R, 32, E, 48) ^ SubKeys[Decipher ? 15 - Round : Round];
+        uint32_t S = 0;
+
+        for (uint8_t Box = 0; Box < 8; Box++) {
+            uint8_t Six = (X >> (42 - 6 * Box)) & 0x3F;
+            uint8_t Row = ((Six & 0x20) >> 4) | (Six & 0x01);
+            uint8_t Col = (Six >> 1) & 0x0F;
+            S = (S << 4) | SBox[Box][Row * 16 + Col];
+        }
+
+        uint32_t F = Permute(S, 32, P, 32);
+        uint32_t Temp = R;
+        R = L ^ F;
+        L = Temp;
+    }
+
+    return Permute(((uint64_t) R << 32) | L, 64, FP, 64);
+}
+
+static uint64_t Encrypt2KTDEA(uint64_t Block, const uint8_t *Keys) {
+    Block = RunDEA(Block, &Keys[0], false);
+    Block = RunDEA(Block, &Keys[8], true);
+    return RunDEA(Block, &Keys[0], false);
+}
+
+static uint64_t Decrypt2KTDEA(uint64_t Block, const uint8_t *Keys) {
+    Block = RunDEA(Block, &Keys[0], true);
+    Block = RunDEA(Block, &Keys[8], false);
+    return RunDEA(Block, &Keys[0], true);
+}
+
+static uint64_t Encrypt3KTDEA(uint64_t Block, const uint8_t *Keys) {
+    Block = RunDEA(Block, &Keys[0], false);
+    Block = RunDEA(Block, &Keys[8], true);
+    return RunDEA(Block, &Keys[16], false);
+}
+
+static uint64_t Decrypt3KTDEA(uint64_t Block, const uint8_t *Keys) {
+    Block = RunDEA(Block, &Keys[16], true);
+    Block = RunDEA(Block, &Keys[8], false);
+    return RunDEA(Block, &Keys[0], true);
+}
+
+typedef uint64_t (*HostDEAFuncType)(uint64_t Block, const uint8_t *Keys);
+
+/* CBC "send" mode chaining: C = E(P ^ IV); IV = C */
+static void DEACBCSend(HostDEAFuncType Primitive, uint16_t Count, const void *Input, void *Output,
+                       void *IV, const uint8_t *Keys) {
+    const uint8_t *InPtr = (const uint8_t *) Input;
+    uint8_t *OutPtr = (uint8_t *) Output;
+    uint64_t Chain = LoadBlock((uint8_t *) IV);
+
+    while (Count-- > 0) {
+        Chain = Primitive(LoadBlock(InPtr) ^ Chain, Keys);
+        StoreBlock(OutPtr, Chain);
+        InPtr += CRYPTO_DES_BLOCK_SIZE;
+        OutPtr += CRYPTO_DES_BLOCK_SIZE;
+    }
+
+    StoreBlock((uint8_t *) IV, Chain);
+}
+
+/* CBC "receive" mode chaining: C = E(P) ^ IV; IV = P */
+static void DEACBCReceive(HostDEAFuncType Primitive, uint16_t Count, const void *Input, void *Output,
+                          void *IV, const uint8_t *Keys) {
+    const uint8_t *InPtr = (const uint8_t *) Input;
+    uint8_t *OutPtr = (uint8_t *) Output;
+
+    while (Count-- > 0) {
+        uint64_t Block = LoadBlock(InPtr);
+        uint64_t Result = Primitive(Block, Keys) ^ LoadBlock((uint8_t *) IV);
+        StoreBlock((uint8_t *) IV, Block);
+        StoreBlock(OutPtr, Result);
+        InPtr += CRYPTO_DES_BLOCK_SIZE;
+        OutPtr += CRYPTO_DES_BLOCK_SIZE;
+    }
+}
+
+void CryptoEncryptDES(const void *Plaintext, void *Ciphertext, const uint8_t *Keys) {
+    StoreBlock(Ciphertext, RunDEA(LoadBlock(Plaintext), Keys, false));
+}
+
+void CryptoDecryptDES(const void *Plaintext, void *Ciphertext, const uint8_t *Keys) {
+    StoreBlock((void *) Plaintext, RunDEA(LoadBlock(Ciphertext), Keys, true));
+}
+
+void CryptoEncrypt2KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t *Keys) {
+    StoreBlock(Ciphertext, Encrypt2KTDEA(LoadBlock(Plaintext), Keys));
+}
+
+void CryptoDecrypt2KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t *Keys) {
+    StoreBlock((void *) Plaintext, Decrypt2KTDEA(LoadBlock(Ciphertext), Keys));
+}
+
+void CryptoEncrypt3KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t *Keys) {
+    StoreBlock(Ciphertext, Encrypt3KTDEA(LoadBlock(Plaintext), Keys));
+}
+
+void CryptoDecrypt3KTDEA(const void *Plaintext, void *Ciphertext, const uint8_t *Keys) {
+    StoreBlock((void *) Plaintext, Decrypt3KTDEA(LoadBlock(Ciphertext), Keys));
+}
+
+void CryptoEncrypt2KTDEA_CBCSend(uint16_t Count, const void *Input, void *Output, void *IV, const uint8_t *Keys) {
+    DEACBCSend(Encrypt2KTDEA, Count, Input, Output, IV, Keys);
+}
+
+void CryptoEncrypt2KTDEA_CBCReceive(uint16_t Count, const void *Input, void *Output, void *IV, const uint8_t *Keys) {
+    DEACBCReceive(Encrypt2KTDEA, Count, Input, Output, IV, Keys);
+}
+
+void CryptoDecrypt2KTDEA_CBCSend(uint16_t Count, const void *Input, void *Output, void *IV, const uint8_t *Keys) {
+    DEACBCSend(Decrypt2KTDEA, Count, Input, Output, IV, Keys);
+}
+
+void CryptoDecrypt2KTDEA_CBCReceive(uint16_t Count, const void *Input, void *Output, void *IV, const uint8_t *Keys) {
+    DEACBCReceive(Decrypt2KTDEA, Count, Input, Output, IV, Keys);
+}
+
+void CryptoEncrypt3KTDEA_CBCSend(uint16_t Count, const void *Plaintext, void *Ciphertext, void *IV, const uint8_t *Keys) {
+    DEACBCSend(Encrypt3KTDEA, Count, Plaintext, Ciphertext, IV, Keys);
+}
+
+/* Note: the assembler implementation exports this symbol with the 3K TDEA decryption primitive */
+void CryptoEncrypt3KTDEA_CBCReceive(uint16_t Count, const void *Plaintext, void *Ciphertext, void *IV, const uint8_t *Keys) {
+    DEACBCReceive(Decrypt3KTDEA, Count, Plaintext, Ciphertext, IV, Keys);
+}
@@ -0,0 +1,43 @@
+/*
+ * HostHardware.c
+ *
+ * Register storage for the peripherals declared in Host/include/avr/io.h
+ * and a system tick that follows the host's monotonic clock.
+ */
+
+#include <time.h>
+#include "HostHardware.h"
+#include "../System.h"
+
+#define HOST_DEFINE_PERIPHERAL(Name) HostRegisterBlockType Name;
+HOST_PERIPHERAL_LIST(HOST_DEFINE_PERIPHERAL)
+#undef HOST_DEFINE_PERIPHERAL
+
+volatile uint8_t HostGPIOR[16];
+volatile uint8_t CCP;
+
+static uint64_t HostStartTime;
+
+uint64_t HostGetNanoseconds(void) {
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t) Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+void HostSystemInit(void) {
+    HostStartTime = HostGetNanoseconds();
+    HostSystemTickUpdate();
+}
+
+void HostSystemTickUpdate(void) {
+    /* The RTC counts milliseconds up to SYSTEM_TICK_PERIOD, the upper bits live in the tick register */
+    uint16_t Milliseconds = (HostGetNanoseconds() - HostStartTime) / 1000000ULL;
+
+    RTC.CNT = Milliseconds & (SYSTEM_TICK_PERIOD - 1);
+    SYSTEM_TICK_REGISTER = Milliseconds & ~(SYSTEM_TICK_PERIOD - 1);
+}
+
+void SystemReset(void) {
+    /* RESET has nothing to restart on the host */
+}
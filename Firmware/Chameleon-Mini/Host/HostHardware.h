@@ -0,0 +1,17 @@
+/*
+ * HostHardware.h
+ *
+ * Helpers of the host build that stand in for the system and clock
+ * handling in System.c.
+ */
+
+#ifndef HOST_HARDWARE_H_
+#define HOST_HARDWARE_H_
+
+#include <stdint.h>
+
+uint64_t HostGetNanoseconds(void);
+void HostSystemInit(void);
+void HostSystemTickUpdate(void);
+
+#endif /* HOST_HARDWARE_H_ */
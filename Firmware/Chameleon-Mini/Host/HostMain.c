@@ -0,0 +1,497 @@
+/*
+ * HostMain.c
+ *
+ * Replays reader traces against the application layer on the host and
+ * reports per-command processing times.
+ *
+ * Trace file syntax, one item per line ('#' starts a comment):
+ *   config <NAME>       Select configuration (as with CONFIG=<NAME>), first pass only
+ *   uid <HEX>           Set the UID of the configuration, first pass only
+ *   reset               Reset the application (field off/on)
+ *   reload              Store the memory and initialise the configuration
+ *                       again without the run once initialisation, as after
+ *                       STORE and a power cycle
+ *   tear <N>            Lose the power after N more FRAM writes, the
+ *                       following writes are dropped
+ *   powercycle          Initialise the configuration again without storing
+ *                       the memory first, as after a power loss
+ *   > <HEX>[/<BITS>]    Frame sent by the reader, optionally with a bit count
+ *   < <HEX>             Expected answer, '*' accepts any answer, an empty
+ *                       line or '-' expects no answer at all
+ * The token "crc" within a frame or answer appends CRC_A (ISO14443A) or
+ * the ISO15693 CRC over the preceding bytes.
+ *
+ * With -f, the traces of the FDTBENCH command (Tests/FDTBenchmark.c) are
+ * run instead of a trace file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <getopt.h>
+
+#include "HostCodec.h"
+#include "HostHardware.h"
+#include "HostMemory.h"
+#include "HostTerminal.h"
+#include "../Common.h"
+#include "../Configuration.h"
+#include "../Settings.h"
+#include "../Memory.h"
+#include "../Log.h"
+#include "../Random.h"
+#include "../Codec/Codec.h"
+#include "../Application/Application.h"
+#include "../Application/ISO14443-3A.h"
+#include "../Application/ISO15693-A.h"
+#include "../Tests/FDTBenchmark.h"
+
+#define HOST_TRACE_LINE_MAX     1024
+#define HOST_TRACE_STEPS_MAX    4096
+
+typedef enum {
+    STEP_CONFIG,
+    STEP_UID,
+    STEP_RESET,
+    STEP_RELOAD,
+    STEP_TEAR,
+    STEP_POWERCYCLE,
+    STEP_FRAME
+} HostStepEnum;
+
+typedef enum {
+    EXPECT_NONE,
+    EXPECT_ANY,
+    EXPECT_DATA
+} HostExpectEnum;
+
+typedef struct {
+    HostStepEnum Type;
+    unsigned Line;
+    char Name[CONFIGURATION_NAME_LENGTH_MAX];
+    uint8_t Data[CODEC_BUFFER_SIZE];
+    uint16_t DataSize;
+    uint16_t BitCount;
+    bool FrameCRC;
+    HostExpectEnum Expect;
+    uint8_t Answer[CODEC_BUFFER_SIZE];
+    uint16_t AnswerSize;
+    bool AnswerCRC;
+    unsigned Writes; /* FRAM writes before the power loss of a tear */
+    /* Statistics */
+    uint32_t Count;
+    uint64_t TotalNanoseconds;
+    uint64_t MaxNanoseconds;
+} HostStepType;
+
+static HostStepType Steps[HOST_TRACE_STEPS_MAX];
+static unsigned StepCount = 0;
+static bool Verbose = false;
+
+static bool IsISO15693(void) {
+    return ActiveConfiguration.TagFamily == TAG_FAMILY_ISO15693;
+}
+
+static void PrintHex(FILE *Stream, const uint8_t *Buffer, uint16_t ByteCount) {
+    for (uint16_t i = 0; i < ByteCount; i++) {
+        fprintf(Stream, "%02X", Buffer[i]);
+    }
+}
+
+/* Parses hex bytes and "crc" tokens. Returns false on syntax errors. */
+static bool ParseHex(char *Text, uint8_t *Buffer, uint16_t *ByteCount, int16_t *CRCPosition) {
+    *ByteCount = 0;
+    *CRCPosition = -1;
+
+    for (char *Token = strtok(Text, " \t"); Token != NULL; Token = strtok(NULL, " \t")) {
+        if (strcasecmp(Token, "crc") == 0) {
+            *CRCPosition = *ByteCount;
+            continue;
+        }
+
+        size_t Length = strlen(Token);
+
+        if ((Length % 2) != 0) {
+            return false;
+        }
+
+        for (size_t i = 0; i < Length; i += 2) {
+            unsigned Byte;
+
+            if (!isxdigit((unsigned char) Token[i]) || !isxdigit((unsigned char) Token[i + 1]) ||
+                    sscanf(&Token[i], "%2x", &Byte) != 1 || *ByteCount >= CODEC_BUFFER_SIZE - 2) {
+                return false;
+            }
+
+            Buffer[(*ByteCount)++] = Byte;
+        }
+    }
+
+    return true;
+}
+
+static uint16_t AppendCRC(uint8_t *Buffer, uint16_t ByteCount) {
+    if (IsISO15693()) {
+        ISO15693AppendCRC(Buffer, ByteCount);
+    } else {
+        ISO14443AAppendCRCA(Buffer, ByteCount);
+    }
+
+    return ByteCount + 2;
+}
+
+static bool LoadTrace(const char *FileName) {
+    FILE *File = fopen(FileName, "r");
+    char Line[HOST_TRACE_LINE_MAX];
+    unsigned LineNumber = 0;
+    HostStepType *LastFrame = NULL;
+
+    if (File == NULL) {
+        perror(FileName);
+        return false;
+    }
+
+    while (fgets(Line, sizeof(Line), File) != NULL) {
+        char *Comment = strchr(Line, '#');
+        char *Text = Line;
+        int16_t CRCPosition;
+
+        LineNumber++;
+
+        if (Comment != NULL) {
+            *Comment = '\0';
+        }
+
+        Text[strcspn(Text, "\r\n")] = '\0';
+        while (isspace((unsigned char) *Text)) {
+            Text++;
+        }
+
+        if (*Text == '\0') {
+            continue;
+        }
+
+        if (StepCount >= HOST_TRACE_STEPS_MAX) {
+            fprintf(stderr, "%s:%u: too many steps\n", FileName, LineNumber);
+            break;
+        }
+
+        HostStepType *Step = &Steps[StepCount];
+        memset(Step, 0, sizeof(*Step));
+        Step->Line = LineNumber;
+
+        if (*Text == '>') {
+            char *Bits = strchr(Text, '/');
+
+            if (Bits != NULL) {
+                *Bits++ = '\0';
+            }
+
+            Step->Type = STEP_FRAME;
+            if (!ParseHex(Text + 1, Step->Data, &Step->DataSize, &CRCPosition)) {
+                goto SyntaxError;
+            }
+            /* CRC and default bit count are resolved once the configuration is active */
+            Step->BitCount = (Bits != NULL) ? atoi(Bits) : 0;
+            Step->FrameCRC = (CRCPosition >= 0);
+            Step->Expect = EXPECT_NONE;
+            LastFrame = Step;
+            StepCount++;
+        } else if (*Text == '<') {
+            char *Answer = Text + 1;
+
+            while (isspace((unsigned char) *Answer)) {
+                Answer++;
+            }
+
+            if (LastFrame == NULL) {
+                goto SyntaxError;
+            } else if (*Answer == '*') {
+                LastFrame->Expect = EXPECT_ANY;
+            } else if (*Answer == '-' || *Answer == '\0') {
+                LastFrame->Expect = EXPECT_NONE;
+            } else if (ParseHex(Answer, LastFrame->Answer, &LastFrame->AnswerSize, &CRCPosition)) {
+                LastFrame->Expect = EXPECT_DATA;
+                LastFrame->AnswerCRC = (CRCPosition >= 0);
+            } else {
+                goto SyntaxError;
+            }
+
+            LastFrame = NULL;
+        } else if (strncasecmp(Text, "config", 6) == 0 && isspace((unsigned char) Text[6])) {
+            Step->Type = STEP_CONFIG;
+            sscanf(Text + 6, " %31s", Step->Name);
+            StepCount++;
+        } else if (strncasecmp(Text, "uid", 3) == 0 && isspace((unsigned char) Text[3])) {
+            Step->Type = STEP_UID;
+            if (!ParseHex(Text + 3, Step->Data, &Step->DataSize, &CRCPosition)) {
+                goto SyntaxError;
+            }
+            StepCount++;
+        } else if (strcasecmp(Text, "reset") == 0) {
+            Step->Type = STEP_RESET;
+            StepCount++;
+        } else if (strcasecmp(Text, "reload") == 0) {
+            Step->Type = STEP_RELOAD;
+            StepCount++;
+        } else if (strncasecmp(Text, "tear", 4) == 0 && isspace((unsigned char) Text[4])) {
+            Step->Type = STEP_TEAR;
+            if (sscanf(Text + 4, " %u", &Step->Writes) != 1) {
+                goto SyntaxError;
+            }
+            StepCount++;
+        } else if (strcasecmp(Text, "powercycle") == 0) {
+            Step->Type = STEP_POWERCYCLE;
+            StepCount++;
+        } else {
+            goto SyntaxError;
+        }
+
+        continue;
+
+SyntaxError:
+        fprintf(stderr, "%s:%u: syntax error\n", FileName, LineNumber);
+        fclose(File);
+        return false;
+    }
+
+    fclose(File);
+    return true;
+}
+
+static bool RunStep(HostStepType *Step, bool FirstPass) {
+    uint8_t Response[CODEC_BUFFER_SIZE];
+    uint64_t Nanoseconds;
+
+    switch (Step->Type) {
+        case STEP_CONFIG:
+            if (FirstPass && !ConfigurationSetByName(Step->Name, true)) {
+                fprintf(stderr, "line %u: unknown configuration %s\n", Step->Line, Step->Name);
+                return false;
+            }
+            return true;
+
+        case STEP_UID:
+            if (FirstPass) {
+                ConfigurationUidType Uid = { 0 };
+                memcpy(Uid, Step->Data, MIN(Step->DataSize, sizeof(Uid)));
+                ApplicationSetUid(Uid);
+            }
+            return true;
+
+        case STEP_RESET:
+            ApplicationReset();
+            return true;
+
+        case STEP_RELOAD:
+            MemoryStore();
+            ConfigurationSetById(GlobalSettings.ActiveSettingPtr->Configuration, false);
+            return true;
+
+        case STEP_TEAR:
+            HostFRAMWritesLeft = Step->Writes;
+            return true;
+
+        case STEP_POWERCYCLE:
+            HostFRAMWritesLeft = HOST_FRAM_NO_TEAR;
+            MemoryPowerLoss();
+            ConfigurationSetById(GlobalSettings.ActiveSettingPtr->Configuration, false);
+            return true;
+
+        case STEP_FRAME:
+            break;
+    }
+
+    if (FirstPass) {
+        /* Resolve CRC tokens now that the configuration is active */
+        if (Step->FrameCRC) {
+            Step->DataSize = AppendCRC(Step->Data, Step->DataSize);
+        }
+        if (Step->AnswerCRC) {
+            Step->AnswerSize = AppendCRC(Step->Answer, Step->AnswerSize);
+        }
+        if (Step->BitCount == 0) {
+            Step->BitCount = IsISO15693() ? Step->DataSize : Step->DataSize * 8;
+        }
+    }
+
+    uint16_t AnswerCount = HostCodecProcessFrame(Step->Data, Step->BitCount, Response, &Nanoseconds);
+    uint16_t AnswerSize = IsISO15693() ? AnswerCount : (AnswerCount + 7) / 8;
+
+    Step->Count++;
+    Step->TotalNanoseconds += Nanoseconds;
+    if (Nanoseconds > Step->MaxNanoseconds) {
+        Step->MaxNanoseconds = Nanoseconds;
+    }
+
+    if (Verbose) {
+        printf("> ");
+        PrintHex(stdout, Step->Data, IsISO15693() ? Step->BitCount : (Step->BitCount + 7) / 8);
+        printf("\n< ");
+        PrintHex(stdout, Response, AnswerSize);
+        printf("    (%llu ns)\n", (unsigned long long) Nanoseconds);
+    }
+
+    bool Match = true;
+
+    if (Step->Expect == EXPECT_NONE) {
+        Match = (AnswerCount == ISO14443A_APP_NO_RESPONSE);
+    } else if (Step->Expect == EXPECT_ANY) {
+        Match = (AnswerCount != ISO14443A_APP_NO_RESPONSE);
+    } else if (Step->Expect == EXPECT_DATA) {
+        Match = (AnswerSize == Step->AnswerSize) && (memcmp(Response, Step->Answer, AnswerSize) == 0);
+    }
+
+    if (!Match) {
+        fprintf(stderr, "line %u: unexpected answer '", Step->Line);
+        PrintHex(stderr, Response, AnswerSize);
+        fprintf(stderr, "'\n");
+    }
+
+    return Match;
+}
+
+static void PrintReport(unsigned Passes, uint64_t WallNanoseconds) {
+    printf("%6s  %-24s %10s %12s %12s\n", "line", "frame", "count", "avg [ns]", "max [ns]");
+
+    for (unsigned i = 0; i < StepCount; i++) {
+        HostStepType *Step = &Steps[i];
+        char Frame[25] = "";
+
+        if (Step->Type != STEP_FRAME || Step->Count == 0) {
+            continue;
+        }
+
+        for (uint16_t j = 0; j < Step->DataSize && j < 8; j++) {
+            snprintf(&Frame[2 * j], sizeof(Frame) - 2 * j, "%02X", Step->Data[j]);
+        }
+        if (Step->DataSize > 8) {
+            strcat(Frame, "...");
+        }
+
+        printf("%6u  %-24s %10u %12llu %12llu\n", Step->Line, Frame, Step->Count,
+               (unsigned long long)(Step->TotalNanoseconds / Step->Count),
+               (unsigned long long) Step->MaxNanoseconds);
+    }
+
+    printf("\n%u passes, %u frames, %llu ns in ApplicationProcess (max %llu ns), %.0f frames/s\n",
+           Passes, HostCodecStats.Frames, (unsigned long long) HostCodecStats.TotalNanoseconds,
+           (unsigned long long) HostCodecStats.MaxNanoseconds,
+           WallNanoseconds ? HostCodecStats.Frames * 1e9 / WallNanoseconds : 0.0);
+    printf("FRAM: %u reads (%u bytes), %u writes (%u bytes)\n",
+           HostMemoryStats.FRAMReads, HostMemoryStats.FRAMBytesRead,
+           HostMemoryStats.FRAMWrites, HostMemoryStats.FRAMBytesWritten);
+#if MEMORY_CACHE_LINES > 0
+    printf("Cache: %u lines, %u hits, %u misses, %u write-backs\n", MEMORY_CACHE_LINES,
+           MemoryCacheStats.Hits, MemoryCacheStats.Misses, MemoryCacheStats.WriteBacks);
+#endif
+}
+
+static bool RunFDTBenchmark(void) {
+    static char Report[4096];
+    char Names[1024];
+    char *Name = Names;
+    bool Passed = true;
+
+    /* The trace names come as a comma separated list, in table order */
+    FDTBenchmarkListTraces(Names, sizeof(Names));
+
+    for (uint8_t i = 0; i < FDTBenchmarkGetTraceCount(); i++) {
+        Passed &= FDTBenchmarkReportTrace(i, Report, sizeof(Report));
+        printf("== %s\n%s\n\n", strsep(&Name, ","), Report);
+    }
+
+    return Passed;
+}
+
+static void Usage(const char *Program) {
+    fprintf(stderr, "Usage: %s [-n PASSES] [-v] [-t] TRACE\n"
+            "       %s [-t] -f\n"
+            "  -n PASSES  replay the trace PASSES times (default 1), the first\n"
+            "             pass is not timed if there is more than one\n"
+            "  -v         print every frame and answer\n"
+            "  -t         show terminal output of the application\n"
+            "  -f         run the FDT benchmark traces, cycles are estimated at F_CPU\n", Program, Program);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned Passes = 1;
+    bool FDTBenchmark = false;
+    int Option;
+
+    while ((Option = getopt(argc, argv, "n:vtf")) != -1) {
+        switch (Option) {
+            case 'n':
+                Passes = strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                Verbose = true;
+                break;
+            case 't':
+                HostTerminalOutput = stdout;
+                break;
+            case 'f':
+                FDTBenchmark = true;
+                break;
+            default:
+                Usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((FDTBenchmark && optind != argc) || (!FDTBenchmark && optind != argc - 1) || Passes == 0) {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!FDTBenchmark && !LoadTrace(argv[optind])) {
+        return EXIT_FAILURE;
+    }
+
+    /* Same order as in main() of the firmware, minus the peripherals */
+    HostSystemInit();
+    SettingsLoad();
+    MemoryInit();
+    ConfigurationInit();
+    RandomInit();
+    LogInit();
+
+    /* Traces have to be reproducible, e.g. for randomly generated UIDs */
+    srand(0);
+
+    if (FDTBenchmark) {
+        return RunFDTBenchmark() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    bool Success = true;
+    uint64_t Start = 0;
+
+    for (unsigned Pass = 0; Pass < Passes && Success; Pass++) {
+        if (Pass == 1) {
+            /* Do not account for setup work done in the first pass */
+            HostCodecResetStats();
+            HostMemoryResetStats();
+            MemoryCacheResetStats();
+            for (unsigned i = 0; i < StepCount; i++) {
+                Steps[i].Count = 0;
+                Steps[i].TotalNanoseconds = 0;
+                Steps[i].MaxNanoseconds = 0;
+            }
+            Start = HostGetNanoseconds();
+        }
+
+        if (Pass > 0) {
+            ApplicationReset();
+        }
+
+        for (unsigned i = 0; i < StepCount && Success; i++) {
+            Success = RunStep(&Steps[i], Pass == 0);
+        }
+    }
+
+    PrintReport(Passes > 1 ? Passes - 1 : 1, Passes > 1 ? HostGetNanoseconds() - Start : 0);
+
+    return Success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
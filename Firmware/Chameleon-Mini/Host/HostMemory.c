@@ -0,0 +1,63 @@
+/*
+ * HostMemory.c
+ *
+ * RAM backed FRAM, flash and EEPROM for the host build.
+ */
+
+#include "HostMemory.h"
+#include "../Memory.h"
+
+uint8_t HostFRAM[HOST_FRAM_SIZE];
+uint8_t HostFlash[HOST_FLASH_SIZE];
+HostMemoryStatsType HostMemoryStats;
+uint32_t HostFRAMWritesLeft = HOST_FRAM_NO_TEAR;
+
+/* EEMEM variables are placed into the host_eeprom section by avr/eeprom.h.
+ * The firmware passes their addresses around truncated to 16 bit, so we
+ * reconstruct the full pointer relative to the start of that section. */
+extern uint8_t __start_host_eeprom[];
+extern uint8_t __stop_host_eeprom[];
+
+static uint8_t *HostEEPROMPointer(uint16_t Address) {
+    uintptr_t Start = (uintptr_t) __start_host_eeprom;
+    uintptr_t Pointer = (Start & ~(uintptr_t) 0xFFFF) | Address;
+
+    if (Pointer < Start) {
+        Pointer += 0x10000;
+    }
+
+    return (uint8_t *) Pointer;
+}
+
+void HostMemoryInit(void) {
+    /* Erased flash reads as all ones */
+    memset(HostFRAM, 0x00, sizeof(HostFRAM));
+    memset(HostFlash, 0xFF, sizeof(HostFlash));
+    HostMemoryResetStats();
+}
+
+void HostMemoryResetStats(void) {
+    memset(&HostMemoryStats, 0, sizeof(HostMemoryStats));
+}
+
+uint16_t ReadEEPBlock(uint16_t Address, void *DestPtr, uint16_t ByteCount) {
+    uint8_t *SrcPtr = HostEEPROMPointer(Address);
+
+    if (SrcPtr + ByteCount > __stop_host_eeprom) {
+        return 0;
+    }
+
+    memcpy(DestPtr, SrcPtr, ByteCount);
+    return ByteCount;
+}
+
+uint16_t WriteEEPBlock(uint16_t Address, const void *SrcPtr, uint16_t ByteCount) {
+    uint8_t *DestPtr = HostEEPROMPointer(Address);
+
+    if (DestPtr + ByteCount > __stop_host_eeprom) {
+        return 0;
+    }
+
+    memcpy(DestPtr, SrcPtr, ByteCount);
+    return ByteCount;
+}
@@ -0,0 +1,101 @@
+/*
+ * HostMemory.h
+ *
+ * In-RAM stand-ins for the FRAM and flash primitives of Memory.c used by
+ * the host build. The access counters allow to compare the amount of
+ * (simulated) SPI traffic that a code path causes on the real hardware.
+ */
+
+#ifndef HOST_MEMORY_H_
+#define HOST_MEMORY_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "../Common.h"
+
+#define HOST_FRAM_SIZE      0x10000
+#define HOST_FLASH_SIZE     FLASH_DATA_SIZE
+
+/* Number of SPI clocks a single FRAM command header occupies (opcode and address) */
+#define HOST_FRAM_CMD_BYTES 3
+
+typedef struct {
+    uint32_t FRAMReads;
+    uint32_t FRAMWrites;
+    uint32_t FRAMBytesRead;
+    uint32_t FRAMBytesWritten;
+    uint32_t FlashPagesWritten;
+    uint32_t FlashPagesErased;
+} HostMemoryStatsType;
+
+extern uint8_t HostFRAM[HOST_FRAM_SIZE];
+extern uint8_t HostFlash[HOST_FLASH_SIZE];
+extern HostMemoryStatsType HostMemoryStats;
+
+/* FRAM writes which still reach the array before the power is lost, see
+ * the tear step of HostMain.c. Later writes are dropped. */
+#define HOST_FRAM_NO_TEAR   UINT32_MAX
+extern uint32_t HostFRAMWritesLeft;
+
+void HostMemoryInit(void);
+void HostMemoryResetStats(void);
+
+INLINE void FRAMRead(void *Buffer, uint16_t Address, uint16_t ByteCount) {
+    /* The FRAM address counter wraps around at the end of the array */
+    uint8_t *BufPtr = (uint8_t *) Buffer;
+
+    HostMemoryStats.FRAMReads++;
+    HostMemoryStats.FRAMBytesRead += ByteCount;
+
+    while (ByteCount-- > 0) {
+        *BufPtr++ = HostFRAM[Address++];
+    }
+}
+
+INLINE void FRAMWrite(const void *Buffer, uint16_t Address, uint16_t ByteCount) {
+    const uint8_t *BufPtr = (const uint8_t *) Buffer;
+
+    HostMemoryStats.FRAMWrites++;
+    HostMemoryStats.FRAMBytesWritten += ByteCount;
+
+    if (HostFRAMWritesLeft == 0) {
+        return;
+    } else if (HostFRAMWritesLeft != HOST_FRAM_NO_TEAR) {
+        HostFRAMWritesLeft--;
+    }
+
+    while (ByteCount-- > 0) {
+        HostFRAM[Address++] = *BufPtr++;
+    }
+}
+
+INLINE bool HostFlashRangeValid(uint32_t Address, uint32_t ByteCount) {
+    return (Address < HOST_FLASH_SIZE) && (ByteCount <= HOST_FLASH_SIZE - Address);
+}
+
+INLINE void FlashErase(uint32_t Address, uint16_t ByteCount) {
+    uint16_t PageCount = ByteCount / APP_SECTION_PAGE_SIZE;
+
+    if (HostFlashRangeValid(Address, (uint32_t) PageCount * APP_SECTION_PAGE_SIZE)) {
+        memset(&HostFlash[Address], 0xFF, (uint32_t) PageCount * APP_SECTION_PAGE_SIZE);
+        HostMemoryStats.FlashPagesErased += PageCount;
+    }
+}
+
+INLINE void FlashToFRAM(uint32_t Address, uint16_t ByteCount) {
+    /* Like on the device, the setting is always recalled to FRAM address 0 */
+    if (HostFlashRangeValid(Address, ByteCount)) {
+        FRAMWrite(&HostFlash[Address], 0, ByteCount);
+    }
+}
+
+INLINE void FRAMToFlash(uint32_t Address, uint16_t FRAMAddress, uint16_t ByteCount) {
+    uint16_t PageCount = ByteCount / APP_SECTION_PAGE_SIZE;
+
+    if (HostFlashRangeValid(Address, (uint32_t) PageCount * APP_SECTION_PAGE_SIZE)) {
+        FRAMRead(&HostFlash[Address], FRAMAddress, PageCount * APP_SECTION_PAGE_SIZE);
+        HostMemoryStats.FlashPagesWritten += PageCount;
+    }
+}
+
+#endif /* HOST_MEMORY_H_ */
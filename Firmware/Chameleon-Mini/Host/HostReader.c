@@ -0,0 +1,162 @@
+/*
+ * HostReader.c
+ *
+ * Reader side of the simulated field, see HostReader.h. The frames go
+ * through HostCodecProcessFrame() just like the ones of a trace.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostReader.h"
+#include "HostCodec.h"
+#include "HostHardware.h"
+#include "../Common.h"
+#include "../Configuration.h"
+#include "../Settings.h"
+#include "../Memory.h"
+#include "../Log.h"
+#include "../Random.h"
+#include "../Codec/Codec.h"
+#include "../Application/Application.h"
+#include "../Application/ISO14443-3A.h"
+
+#define HOST_READER_CASCADE_LEVELS  3
+#define HOST_READER_CASCADE_TAG     0x88
+#define HOST_READER_SAK_CASCADE     0x04
+#define HOST_READER_PCB_I_BLOCK     0x02
+#define HOST_READER_PCB_TYPE_MASK   0xE2
+
+static const uint8_t CascadeCommands[HOST_READER_CASCADE_LEVELS] = {
+    ISO14443A_CMD_SELECT_CL1, ISO14443A_CMD_SELECT_CL2, ISO14443A_CMD_SELECT_CL3
+};
+
+static uint8_t BlockNumber = 0;
+
+bool HostReaderInit(const char *Configuration) {
+    /* Same order as in main() of the firmware, minus the peripherals */
+    HostSystemInit();
+    SettingsLoad();
+    MemoryInit();
+    ConfigurationInit();
+    RandomInit();
+    LogInit();
+    /* Runs have to be reproducible, e.g. for randomly generated UIDs */
+    srand(0);
+    return ConfigurationSetByName(Configuration, true);
+}
+
+void HostReaderReset(void) {
+    ApplicationReset();
+    BlockNumber = 0;
+}
+
+int HostReaderTransceiveBits(const uint8_t *Frame, uint16_t BitCount, bool AppendCRC,
+                             uint8_t *Answer, uint16_t MaxBits, uint64_t *Nanoseconds) {
+    uint8_t Buffer[CODEC_BUFFER_SIZE];
+    uint8_t Response[CODEC_BUFFER_SIZE];
+    uint16_t ByteCount = (BitCount + 7) / 8;
+    uint64_t Elapsed;
+
+    if (ByteCount + (AppendCRC ? ISO14443A_CRCA_SIZE : 0) > sizeof(Buffer)) {
+        return HOST_READER_NO_ANSWER;
+    }
+    memcpy(Buffer, Frame, ByteCount);
+    if (AppendCRC) {
+        ISO14443AAppendCRCA(Buffer, ByteCount);
+        BitCount = (ByteCount + ISO14443A_CRCA_SIZE) * 8;
+    }
+
+    uint16_t AnswerBits = HostCodecProcessFrame(Buffer, BitCount, Response, &Elapsed);
+    if (Nanoseconds != NULL) {
+        *Nanoseconds += Elapsed;
+    }
+    if (AnswerBits == ISO14443A_APP_NO_RESPONSE) {
+        return HOST_READER_NO_ANSWER;
+    }
+
+    uint16_t AnswerBytes = (AnswerBits + 7) / 8;
+    if (AppendCRC) {
+        if (AnswerBytes < ISO14443A_CRCA_SIZE || !ISO14443ACheckCRCA(Response, AnswerBytes - ISO14443A_CRCA_SIZE)) {
+            return HOST_READER_NO_ANSWER;
+        }
+        AnswerBytes -= ISO14443A_CRCA_SIZE;
+        AnswerBits = AnswerBytes * 8;
+    }
+    if (AnswerBits > MaxBits) {
+        return HOST_READER_NO_ANSWER;
+    }
+    memcpy(Answer, Response, AnswerBytes);
+    return AnswerBits;
+}
+
+uint8_t HostReaderActivate(uint8_t *Uid) {
+    uint8_t Frame[7];
+    uint8_t Answer[CODEC_BUFFER_SIZE];
+    uint8_t UidSize = 0;
+
+    HostReaderReset();
+    Frame[0] = ISO14443A_CMD_REQA;
+    if (HostReaderTransceiveBits(Frame, 7, false, Answer, sizeof(Answer) * 8, NULL) != ISO14443A_ATQA_FRAME_SIZE) {
+        return 0;
+    }
+
+    for (uint8_t Level = 0; Level < HOST_READER_CASCADE_LEVELS; Level++) {
+        Frame[0] = CascadeCommands[Level];
+        Frame[1] = 0x20;
+        if (HostReaderTransceiveBits(Frame, 16, false, Answer, sizeof(Answer) * 8, NULL) != 5 * 8) {
+            return 0;
+        }
+        Frame[1] = 0x70;
+        memcpy(&Frame[2], Answer, 5);
+        if (HostReaderTransceiveBits(Frame, sizeof(Frame) * 8, true, Answer, sizeof(Answer) * 8, NULL) != 8) {
+            return 0;
+        }
+        if (Frame[2] == HOST_READER_CASCADE_TAG) {
+            memcpy(&Uid[UidSize], &Frame[3], 3);
+            UidSize += 3;
+        } else {
+            memcpy(&Uid[UidSize], &Frame[2], 4);
+            UidSize += 4;
+        }
+        if (!(Answer[0] & HOST_READER_SAK_CASCADE)) {
+            break;
+        }
+    }
+
+    /* RATS with FSD = 256 and CID 0 */
+    Frame[0] = 0xE0;
+    Frame[1] = 0x80;
+    if (HostReaderTransceiveBits(Frame, 16, true, Answer, sizeof(Answer) * 8, NULL) <= 0) {
+        return 0;
+    }
+    BlockNumber = 0;
+    return UidSize;
+}
+
+int HostReaderExchangeAPDU(const uint8_t *Apdu, uint16_t ByteCount,
+                           uint8_t *Answer, uint16_t MaxBytes, uint64_t *Nanoseconds) {
+    uint8_t Block[CODEC_BUFFER_SIZE];
+    uint8_t Response[CODEC_BUFFER_SIZE];
+
+    /* The application does not take chained blocks, the whole APDU is
+     * sent at once like the traces do */
+    if (ByteCount + 1 + ISO14443A_CRCA_SIZE > sizeof(Block)) {
+        return HOST_READER_NO_ANSWER;
+    }
+    Block[0] = HOST_READER_PCB_I_BLOCK | BlockNumber;
+    memcpy(&Block[1], Apdu, ByteCount);
+    int AnswerBits = HostReaderTransceiveBits(Block, (ByteCount + 1) * 8, true,
+                     Response, sizeof(Response) * 8, Nanoseconds);
+    BlockNumber ^= 1;
+    if (AnswerBits < 8 || (Response[0] & HOST_READER_PCB_TYPE_MASK) != HOST_READER_PCB_I_BLOCK) {
+        return HOST_READER_NO_ANSWER;
+    }
+
+    uint16_t AnswerBytes = AnswerBits / 8 - 1;
+    if (AnswerBytes > MaxBytes) {
+        return HOST_READER_NO_ANSWER;
+    }
+    memcpy(Answer, &Response[1], AnswerBytes);
+    return AnswerBytes;
+}
@@ -0,0 +1,55 @@
+/*
+ * HostReader.h
+ *
+ * Reader side of the simulated field for programs which are linked
+ * against the host build instead of talking to a real reader, e.g. the
+ * libnfc based DESFire tests in Software/DESFireLibNFCTesting. Only
+ * standard C types are used here, so that the callers do not need the
+ * stand-in AVR headers of the host build.
+ */
+
+#ifndef HOST_READER_H_
+#define HOST_READER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_READER_NO_ANSWER   (-1)
+
+/* Initialises the host build like main() does and activates the
+ * configuration with the given name, e.g. "MF_DESFIRE" */
+bool HostReaderInit(const char *Configuration);
+
+/* Field off and on, the card has to be activated again */
+void HostReaderReset(void);
+
+/* Exchanges a raw frame.
+ *
+ * \param Frame         Frame to send, CRC_A is appended when AppendCRC is set
+ * \param BitCount      Number of bits of the frame without the CRC
+ * \param Answer        Answer of the card, the CRC is removed and checked
+ *                      when AppendCRC is set
+ * \param MaxBits       Size of Answer in bits
+ * \param Nanoseconds   Processing time of the application, may be NULL
+ *
+ * \return Bits in Answer or HOST_READER_NO_ANSWER
+ */
+int HostReaderTransceiveBits(const uint8_t *Frame, uint16_t BitCount, bool AppendCRC,
+                             uint8_t *Answer, uint16_t MaxBits, uint64_t *Nanoseconds);
+
+/* REQA, anticollision, select of all cascade levels and RATS.
+ *
+ * \return Length of the UID written to Uid (at most 10 bytes) or 0
+ */
+uint8_t HostReaderActivate(uint8_t *Uid);
+
+/* Sends an APDU in a single ISO14443-4 I-block and returns the answer
+ * without the prologue. Chaining is not supported by the application.
+ *
+ * \return Bytes in Answer or HOST_READER_NO_ANSWER, the processing time
+ *         of all blocks of the exchange is added to *Nanoseconds
+ */
+int HostReaderExchangeAPDU(const uint8_t *Apdu, uint16_t ByteCount,
+                           uint8_t *Answer, uint16_t MaxBytes, uint64_t *Nanoseconds);
+
+#endif /* HOST_READER_H_ */
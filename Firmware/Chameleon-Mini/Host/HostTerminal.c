@@ -0,0 +1,59 @@
+/*
+ * HostTerminal.c
+ *
+ * Terminal stand-ins for the host build, the command line itself is the one
+ * of Terminal/CommandLine.c. Everything an application would send to the USB
+ * terminal is written to HostTerminalOutput (stdout unless redirected,
+ * discarded when NULL).
+ */
+
+#include <stdio.h>
+#include "HostTerminal.h"
+#include "../Terminal/Terminal.h"
+
+FILE *HostTerminalOutput = NULL;
+
+uint8_t TerminalBuffer[TERMINAL_BUFFER_SIZE];
+USB_ClassInfo_CDC_Device_t TerminalHandle;
+TerminalStateEnum TerminalState = TERMINAL_INITIALIZED;
+
+uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo, const uint8_t Data) {
+    if (HostTerminalOutput != NULL) {
+        fputc(Data, HostTerminalOutput);
+    }
+    return 0;
+}
+
+uint8_t CDC_Device_SendData(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo, const void *const Buffer, const uint16_t Length) {
+    if (HostTerminalOutput != NULL) {
+        fwrite(Buffer, 1, Length, HostTerminalOutput);
+    }
+    return 0;
+}
+
+void USB_Detach(void) {
+}
+
+void USB_Disable(void) {
+}
+
+uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo) {
+    if (HostTerminalOutput != NULL) {
+        fflush(HostTerminalOutput);
+    }
+    return 0;
+}
+
+void TerminalSendString(const char *s) {
+    if (HostTerminalOutput != NULL) {
+        fputs(s, HostTerminalOutput);
+    }
+}
+
+void TerminalSendStringP(const char *s) {
+    TerminalSendString(s);
+}
+
+void TerminalSendBlock(const void *Buffer, uint16_t ByteCount) {
+    CDC_Device_SendData(&TerminalHandle, Buffer, ByteCount);
+}
@@ -0,0 +1,12 @@
+/*
+ * HostTerminal.h
+ */
+
+#ifndef HOST_TERMINAL_H_
+#define HOST_TERMINAL_H_
+
+#include <stdio.h>
+
+extern FILE *HostTerminalOutput;
+
+#endif /* HOST_TERMINAL_H_ */
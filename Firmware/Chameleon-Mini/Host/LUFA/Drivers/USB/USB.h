@@ -0,0 +1,51 @@
+/*
+ * LUFA/Drivers/USB/USB.h : Host build stand-in for the subset of the LUFA
+ * USB stack that the firmware headers reference. The CDC send functions are
+ * routed to the host terminal model in HostTerminal.c.
+ */
+
+#ifndef HOST_LUFA_USB_H_
+#define HOST_LUFA_USB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ATTR_WARN_UNUSED_RESULT
+#define ATTR_NON_NULL_PTR_ARG(...)
+#define ATTR_CONST
+#define ATTR_PURE
+
+#define ENDPOINT_DIR_IN                 0x80
+#define ENDPOINT_DIR_OUT                0x00
+
+typedef struct {
+    uint8_t Size;
+    uint8_t Type;
+} USB_Descriptor_Header_t;
+
+typedef struct { USB_Descriptor_Header_t Header; } USB_Descriptor_Configuration_Header_t;
+typedef struct { USB_Descriptor_Header_t Header; } USB_Descriptor_Interface_t;
+typedef struct { USB_Descriptor_Header_t Header; } USB_Descriptor_Endpoint_t;
+typedef struct { USB_Descriptor_Header_t Header; } USB_CDC_Descriptor_FunctionalHeader_t;
+typedef struct { USB_Descriptor_Header_t Header; } USB_CDC_Descriptor_FunctionalACM_t;
+typedef struct { USB_Descriptor_Header_t Header; } USB_CDC_Descriptor_FunctionalUnion_t;
+
+typedef struct {
+    struct {
+        uint8_t ControlInterfaceNumber;
+    } Config;
+    struct {
+        struct {
+            uint32_t BaudRateBPS;
+        } LineEncoding;
+    } State;
+} USB_ClassInfo_CDC_Device_t;
+
+uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo, const uint8_t Data);
+uint8_t CDC_Device_SendData(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo, const void *const Buffer, const uint16_t Length);
+uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo);
+
+void USB_Detach(void);
+void USB_Disable(void);
+
+#endif /* HOST_LUFA_USB_H_ */
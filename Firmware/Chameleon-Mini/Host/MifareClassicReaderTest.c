@@ -0,0 +1,519 @@
+/*
+ * MifareClassicReaderTest.c
+ *
+ * Runs DUMP_MFC and CLONE_MFC of the ISO14443A reader application against
+ * a simulated MIFARE Classic card. The card uses its own bitwise Crypto1
+ * implementation, independent of Application/Crypto1.c, so that the reader
+ * role of the firmware cipher is checked against the reference algorithm.
+ *
+ * The test compares the memory of the slot with the expected dump and
+ * counts how often the card had to be selected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostReader.h"
+#include "HostTerminal.h"
+#include "../Application/Reader14443A.h"
+#include "../Application/ISO14443-3A.h"
+#include "../Codec/Codec.h"
+#include "../Configuration.h"
+#include "../Memory.h"
+
+extern Reader14443Command Reader14443CurrentCommand;
+
+#define BLOCK_SIZE          16
+#define MAX_BLOCKS          256
+#define KEY_SIZE            6
+#define KEY_B_OFFSET        10
+#define ACCESS_OFFSET       6
+
+/* Reference Crypto1, 48 bit LFSR split into odd and even bits */
+#define LF_POLY_ODD         0x29CE5C
+#define LF_POLY_EVEN        0x870804
+#define BIT(x, n)           (((x) >> (n)) & 1)
+
+typedef struct {
+    uint32_t Odd;
+    uint32_t Even;
+} CipherType;
+
+static uint8_t Parity32(uint32_t x) {
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    return (0x6996 >> (x & 0x0F)) & 1;
+}
+
+static uint8_t OddParity(uint8_t Byte) {
+    return Parity32(Byte) ^ 1;
+}
+
+static uint8_t Filter(uint32_t x) {
+    uint32_t f;
+
+    f  = (0xf22c0 >> (x & 0xf)) & 16;
+    f |= (0x6c9c0 >> ((x >> 4) & 0xf)) & 8;
+    f |= (0x3c8b0 >> ((x >> 8) & 0xf)) & 4;
+    f |= (0x1e458 >> ((x >> 12) & 0xf)) & 2;
+    f |= (0x0d938 >> ((x >> 16) & 0xf)) & 1;
+    return BIT(0xEC57E80A, f);
+}
+
+static void CipherInit(CipherType *Cipher, const uint8_t Key[KEY_SIZE]) {
+    uint64_t Value = 0;
+
+    for (int i = 0; i < KEY_SIZE; i++) {
+        Value = (Value << 8) | Key[i];
+    }
+    Cipher->Odd = Cipher->Even = 0;
+    for (int i = 47; i > 0; i -= 2) {
+        Cipher->Odd = (Cipher->Odd << 1) | BIT(Value, (i - 1) ^ 7);
+        Cipher->Even = (Cipher->Even << 1) | BIT(Value, i ^ 7);
+    }
+}
+
+static uint8_t CipherBit(CipherType *Cipher, uint8_t In, bool Encrypted) {
+    uint8_t Out = Filter(Cipher->Odd);
+    uint32_t Feedback = (Out & Encrypted) ^ (In & 1);
+    uint32_t Temp;
+
+    Feedback ^= LF_POLY_ODD & Cipher->Odd;
+    Feedback ^= LF_POLY_EVEN & Cipher->Even;
+    Cipher->Even = (Cipher->Even << 1) | Parity32(Feedback);
+    Temp = Cipher->Odd;
+    Cipher->Odd = Cipher->Even;
+    Cipher->Even = Temp;
+
+    return Out;
+}
+
+static uint8_t CipherByte(CipherType *Cipher, uint8_t In, bool Encrypted) {
+    uint8_t KeyStream = 0;
+
+    for (int i = 0; i < 8; i++) {
+        KeyStream |= CipherBit(Cipher, BIT(In, i), Encrypted) << i;
+    }
+    return KeyStream;
+}
+
+static void PrngSuccessor(uint8_t Nonce[4], int Clocks) {
+    uint32_t x = ((uint32_t) Nonce[0] << 24) | ((uint32_t) Nonce[1] << 16) | ((uint32_t) Nonce[2] << 8) | Nonce[3];
+
+    x = __builtin_bswap32(x);
+    while (Clocks--) {
+        x = (x >> 1) | (((x >> 16) ^ (x >> 18) ^ (x >> 19) ^ (x >> 21)) << 31);
+    }
+    x = __builtin_bswap32(x);
+    Nonce[0] = x >> 24;
+    Nonce[1] = x >> 16;
+    Nonce[2] = x >> 8;
+    Nonce[3] = x;
+}
+
+/* Frames of the reader codec carry a parity bit after every byte */
+static uint8_t UnpackFrame(const uint8_t *Buffer, uint16_t BitCount, uint8_t *Data, uint8_t *Parity) {
+    uint8_t ByteCount = BitCount / 9;
+
+    for (uint8_t i = 0; i < ByteCount; i++) {
+        Data[i] = 0;
+        for (uint8_t j = 0; j < 8; j++) {
+            uint16_t Bit = i * 9 + j;
+            Data[i] |= BIT(Buffer[Bit / 8], Bit % 8) << j;
+        }
+        Parity[i] = BIT(Buffer[(i * 9 + 8) / 8], (i * 9 + 8) % 8);
+    }
+    return ByteCount;
+}
+
+static uint16_t PackFrame(uint8_t *Buffer, const uint8_t *Data, const uint8_t *Parity, uint8_t ByteCount) {
+    uint16_t BitCount = ByteCount * 9;
+
+    memset(Buffer, 0, (BitCount + 7) / 8);
+    for (uint8_t i = 0; i < ByteCount; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            uint16_t Bit = i * 9 + j;
+            uint8_t Value = (j < 8) ? BIT(Data[i], j) : Parity[i];
+            Buffer[Bit / 8] |= Value << (Bit % 8);
+        }
+    }
+    return BitCount;
+}
+
+/* Simulated card */
+static struct {
+    uint8_t Sak;
+    uint8_t SectorCount;
+    uint8_t Uid[4];
+    uint8_t Memory[MAX_BLOCKS][BLOCK_SIZE];
+    bool KeyBHidden[40];
+    bool ReadDenied[MAX_BLOCKS];
+    bool ReadKeyBOnly[MAX_BLOCKS];
+    enum { CARD_IDLE, CARD_READY, CARD_ACTIVE, CARD_AUTHING, CARD_AUTHED } State;
+    CipherType Cipher;
+    uint8_t Nonce[4];
+    uint8_t AuthSector;
+    bool AuthKeyB;
+    unsigned Selects;
+    unsigned Auths;
+    unsigned NestedAuths;
+} Card;
+
+static uint8_t SectorOfBlock(uint8_t Block) {
+    return (Block < 128) ? Block / 4 : 32 + (Block - 128) / 16;
+}
+
+static uint8_t TrailerOfSector(uint8_t Sector) {
+    return (Sector < 32) ? Sector * 4 + 3 : 128 + (Sector - 32) * 16 + 15;
+}
+
+static uint16_t BlockCount(void) {
+    return (Card.SectorCount <= 32) ? Card.SectorCount * 4 : 128 + (Card.SectorCount - 32) * 16;
+}
+
+static void CardSetup(uint8_t Sak, uint8_t SectorCount) {
+    static const uint8_t Uid[] = { 0x4F, 0x12, 0xC3, 0x9A };
+    static const uint8_t Access[] = { 0xFF, 0x07, 0x80, 0x69 };
+
+    memset(&Card, 0, sizeof(Card));
+    Card.Sak = Sak;
+    Card.SectorCount = SectorCount;
+    memcpy(Card.Uid, Uid, sizeof(Uid));
+    for (uint16_t Block = 0; Block < BlockCount(); Block++) {
+        for (uint8_t i = 0; i < BLOCK_SIZE; i++) {
+            Card.Memory[Block][i] = Block * 7 + i;
+        }
+    }
+    memcpy(Card.Memory[0], Uid, sizeof(Uid));
+    Card.Memory[0][4] = Uid[0] ^ Uid[1] ^ Uid[2] ^ Uid[3];
+    for (uint8_t Sector = 0; Sector < SectorCount; Sector++) {
+        uint8_t *Trailer = Card.Memory[TrailerOfSector(Sector)];
+        memset(Trailer, 0xFF, KEY_SIZE);
+        memcpy(&Trailer[KEY_SIZE], Access, sizeof(Access));
+        memset(&Trailer[KEY_B_OFFSET], 0xFF, KEY_SIZE);
+    }
+}
+
+static void CardSetKeys(uint8_t Sector, const uint8_t *KeyA, const uint8_t *KeyB) {
+    uint8_t *Trailer = Card.Memory[TrailerOfSector(Sector)];
+
+    memcpy(Trailer, KeyA, KEY_SIZE);
+    memcpy(&Trailer[KEY_B_OFFSET], KeyB, KEY_SIZE);
+}
+
+/* Access condition 011 of the trailer, key B cannot be read */
+static void CardHideKeyB(uint8_t Sector) {
+    static const uint8_t Access[] = { 0x7F, 0x07, 0x88 };
+
+    memcpy(&Card.Memory[TrailerOfSector(Sector)][ACCESS_OFFSET], Access, sizeof(Access));
+    Card.KeyBHidden[Sector] = true;
+}
+
+/* Encrypts the answer in place and sends it with encrypted parity bits */
+static uint16_t CardSendEncrypted(uint8_t *Buffer, uint8_t *Data, uint8_t ByteCount) {
+    uint8_t Parity[BLOCK_SIZE + 2];
+
+    for (uint8_t i = 0; i < ByteCount; i++) {
+        uint8_t Plain = Data[i];
+        Data[i] ^= CipherByte(&Card.Cipher, 0, false);
+        Parity[i] = OddParity(Plain) ^ Filter(Card.Cipher.Odd);
+    }
+    return PackFrame(Buffer, Data, Parity, ByteCount);
+}
+
+static uint16_t CardSendPlain(uint8_t *Buffer, uint8_t *Data, uint8_t ByteCount) {
+    uint8_t Parity[BLOCK_SIZE + 2];
+
+    for (uint8_t i = 0; i < ByteCount; i++) {
+        Parity[i] = OddParity(Data[i]);
+    }
+    return PackFrame(Buffer, Data, Parity, ByteCount);
+}
+
+static uint16_t CardAuth(uint8_t *Buffer, uint8_t Command, uint8_t Block, bool Nested) {
+    uint8_t Sector = SectorOfBlock(Block);
+    uint8_t *Trailer = Card.Memory[TrailerOfSector(Sector)];
+    uint8_t Data[4];
+
+    Card.AuthSector = Sector;
+    Card.AuthKeyB = (Command == 0x61);
+    for (int i = 0; i < 4; i++) {
+        Card.Nonce[i] = rand();
+    }
+    CipherInit(&Card.Cipher, (Command == 0x60) ? Trailer : &Trailer[KEY_B_OFFSET]);
+    Card.State = CARD_AUTHING;
+
+    if (!Nested) {
+        for (int i = 0; i < 4; i++) {
+            CipherByte(&Card.Cipher, Card.Uid[i] ^ Card.Nonce[i], false);
+        }
+        Card.Auths++;
+        memcpy(Data, Card.Nonce, 4);
+        return CardSendPlain(Buffer, Data, 4);
+    } else {
+        uint8_t Parity[4];
+
+        for (int i = 0; i < 4; i++) {
+            Data[i] = Card.Nonce[i] ^ CipherByte(&Card.Cipher, Card.Uid[i] ^ Card.Nonce[i], false);
+            Parity[i] = OddParity(Card.Nonce[i]) ^ Filter(Card.Cipher.Odd);
+        }
+        Card.NestedAuths++;
+        return PackFrame(Buffer, Data, Parity, 4);
+    }
+}
+
+static uint16_t CardProcess(uint8_t *Buffer, uint16_t BitCount) {
+    uint8_t Data[BLOCK_SIZE + 2];
+    uint8_t Parity[BLOCK_SIZE + 2];
+    uint8_t ByteCount;
+
+    if (BitCount == 7) {
+        if (Buffer[0] == ISO14443A_CMD_WUPA) {
+            Card.State = CARD_READY;
+            Data[0] = 0x04;
+            Data[1] = 0x00;
+            return CardSendPlain(Buffer, Data, 2);
+        }
+        return 0;
+    }
+
+    ByteCount = UnpackFrame(Buffer, BitCount, Data, Parity);
+
+    switch (Card.State) {
+        case CARD_READY:
+            if ((ByteCount == 2) && (Data[0] == ISO14443A_CMD_SELECT_CL1) && (Data[1] == 0x20)) {
+                memcpy(Data, Card.Uid, 4);
+                Data[4] = Card.Uid[0] ^ Card.Uid[1] ^ Card.Uid[2] ^ Card.Uid[3];
+                return CardSendPlain(Buffer, Data, 5);
+            }
+            if ((ByteCount == 9) && (Data[1] == 0x70) && ISO14443ACheckCRCA(Data, 7) && !memcmp(&Data[2], Card.Uid, 4)) {
+                Card.State = CARD_ACTIVE;
+                Card.Selects++;
+                Data[0] = Card.Sak;
+                ISO14443AAppendCRCA(Data, 1);
+                return CardSendPlain(Buffer, Data, 3);
+            }
+            break;
+
+        case CARD_ACTIVE:
+            if ((ByteCount == 4) && ((Data[0] == 0x60) || (Data[0] == 0x61)) && ISO14443ACheckCRCA(Data, 2)) {
+                return CardAuth(Buffer, Data[0], Data[1], false);
+            }
+            break;
+
+        case CARD_AUTHING:
+            if (ByteCount == 8) {
+                /* The reader nonce is fed back, the reader answer is not */
+                for (int i = 0; i < 4; i++) {
+                    CipherByte(&Card.Cipher, Data[i], true);
+                }
+                for (int i = 4; i < 8; i++) {
+                    Data[i] ^= CipherByte(&Card.Cipher, 0, false);
+                }
+                PrngSuccessor(Card.Nonce, 64);
+                if (!memcmp(&Data[4], Card.Nonce, 4)) {
+                    PrngSuccessor(Card.Nonce, 32);
+                    memcpy(Data, Card.Nonce, 4);
+                    Card.State = CARD_AUTHED;
+                    return CardSendEncrypted(Buffer, Data, 4);
+                }
+            }
+            break;
+
+        case CARD_AUTHED:
+            for (uint8_t i = 0; i < ByteCount; i++) {
+                Data[i] ^= CipherByte(&Card.Cipher, 0, false);
+            }
+            if ((ByteCount == 4) && ISO14443ACheckCRCA(Data, 2)) {
+                if ((Data[0] == 0x60) || (Data[0] == 0x61)) {
+                    return CardAuth(Buffer, Data[0], Data[1], true);
+                }
+                if ((Data[0] == 0x30) && (Data[1] < BlockCount()) && (SectorOfBlock(Data[1]) == Card.AuthSector) &&
+                        !Card.ReadDenied[Data[1]] && (!Card.ReadKeyBOnly[Data[1]] || Card.AuthKeyB)) {
+                    uint8_t Block = Data[1];
+
+                    memcpy(Data, Card.Memory[Block], BLOCK_SIZE);
+                    if (Block == TrailerOfSector(Card.AuthSector)) {
+                        memset(Data, 0, KEY_SIZE);
+                        if (Card.KeyBHidden[Card.AuthSector]) {
+                            memset(&Data[KEY_B_OFFSET], 0, KEY_SIZE);
+                        }
+                    }
+                    ISO14443AAppendCRCA(Data, BLOCK_SIZE);
+                    return CardSendEncrypted(Buffer, Data, BLOCK_SIZE + 2);
+                }
+                /* NAK, 4 encrypted bits */
+                Card.State = CARD_IDLE;
+                Buffer[0] = 0x04 ^ (CipherByte(&Card.Cipher, 0, false) & 0x0F);
+                return 4;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    Card.State = CARD_IDLE;
+    return 0;
+}
+
+/* Runs the reader command until it has finished and returns the terminal output */
+static char *RunCommand(Reader14443Command Command) {
+    char *Output = NULL;
+    size_t OutputSize = 0;
+    uint16_t BitCount = 0;
+    unsigned Frames = 0;
+
+    HostTerminalOutput = open_memstream(&Output, &OutputSize);
+    Reader14443AAppReset();
+    Reader14443CurrentCommand = Command;
+
+    while ((Reader14443CurrentCommand != Reader14443_Do_Nothing) && (++Frames < 100000)) {
+        /* A zero bit count restarts the reader codec, like a timeout */
+        BitCount = Reader14443AAppProcess(CodecBuffer, BitCount);
+        if (BitCount != 0) {
+            BitCount = CardProcess(CodecBuffer, BitCount);
+        }
+    }
+
+    fclose(HostTerminalOutput);
+    HostTerminalOutput = NULL;
+    return Output;
+}
+
+/* Expected content of a block, unknown keys and unreadable blocks are zero */
+static void ExpectedBlock(uint8_t Block, uint8_t *Data, const bool *KeyAKnown, const bool *KeyBKnown) {
+    uint8_t Sector = SectorOfBlock(Block);
+
+    memcpy(Data, Card.Memory[Block], BLOCK_SIZE);
+    if ((!KeyAKnown[Sector] && !KeyBKnown[Sector]) || Card.ReadDenied[Block] ||
+            (Card.ReadKeyBOnly[Block] && !KeyBKnown[Sector])) {
+        memset(Data, 0, BLOCK_SIZE);
+    } else if (Block == TrailerOfSector(Sector)) {
+        if (!KeyAKnown[Sector]) {
+            memset(Data, 0, KEY_SIZE);
+        }
+        if (!KeyBKnown[Sector] && Card.KeyBHidden[Sector]) {
+            memset(&Data[KEY_B_OFFSET], 0, KEY_SIZE);
+        }
+    }
+}
+
+static int CheckMemory(const char *Name, const bool *KeyAKnown, const bool *KeyBKnown) {
+    int Failed = 0;
+
+    for (uint16_t Block = 0; Block < BlockCount(); Block++) {
+        uint8_t Expected[BLOCK_SIZE];
+        uint8_t Actual[BLOCK_SIZE];
+
+        ExpectedBlock(Block, Expected, KeyAKnown, KeyBKnown);
+        MemoryDownloadBlock(Actual, Block * BLOCK_SIZE, BLOCK_SIZE);
+        if (memcmp(Expected, Actual, BLOCK_SIZE) != 0) {
+            printf("FAIL %s: block %u differs\n", Name, Block);
+            Failed = 1;
+        }
+    }
+    return Failed;
+}
+
+static int CountLines(const char *Text) {
+    int Lines = 0;
+
+    while ((Text = strstr(Text, "\r\n")) != NULL) {
+        Lines++;
+        Text += 2;
+    }
+    return Lines;
+}
+
+int main(void) {
+    static const uint8_t KeyTransport[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    static const uint8_t KeyMadA[] = { 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 };
+    static const uint8_t KeyMadB[] = { 0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5 };
+    static const uint8_t KeyNfc[] = { 0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7 };
+    static const uint8_t KeyUnknownA[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    static const uint8_t KeyUnknownB[] = { 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+    bool KeyAKnown[40], KeyBKnown[40];
+    int Failed = 0;
+    char *Output;
+
+    if (!HostReaderInit("ISO14443A_READER")) {
+        printf("FAIL reader configuration\n");
+        return EXIT_FAILURE;
+    }
+    srand(1);
+
+    /* 1K with the keys of the dictionary, a sector which can only be read
+     * with key B, one without a known key and a block which cannot be read.
+     * Two blocks of sector 5 can only be read with key B from the
+     * dictionary, one of sector 6 with key B read from its trailer. */
+    CardSetup(0x08, 16);
+    CardSetKeys(1, KeyMadA, KeyMadB);
+    CardHideKeyB(1);
+    CardSetKeys(2, KeyUnknownA, KeyNfc);
+    CardHideKeyB(2);
+    CardSetKeys(3, KeyUnknownA, KeyUnknownB);
+    Card.ReadDenied[17] = true;
+    CardSetKeys(5, KeyMadA, KeyMadB);
+    CardHideKeyB(5);
+    Card.ReadKeyBOnly[21] = Card.ReadKeyBOnly[22] = true;
+    CardSetKeys(6, KeyNfc, KeyUnknownB);
+    Card.ReadKeyBOnly[25] = true;
+    for (int i = 0; i < 40; i++) {
+        KeyAKnown[i] = KeyBKnown[i] = true;
+    }
+    KeyAKnown[2] = false;
+    KeyAKnown[3] = KeyBKnown[3] = false;
+
+    Output = RunCommand(Reader14443_Read_MF_Classic);
+    Failed |= CheckMemory("DUMP_MFC 1K", KeyAKnown, KeyBKnown);
+    if (CountLines(Output) != 64) {
+        printf("FAIL DUMP_MFC 1K: %d lines\n", CountLines(Output));
+        Failed = 1;
+    }
+    printf("DUMP_MFC 1K: %u selects, %u authentications, %u nested\n", Card.Selects, Card.Auths, Card.NestedAuths);
+    free(Output);
+
+    /* 4K with transport keys only, every sector is reached by nested
+     * authentication after the first one */
+    CardSetup(0x18, 40);
+    for (int i = 0; i < 40; i++) {
+        KeyAKnown[i] = KeyBKnown[i] = true;
+    }
+
+    Output = RunCommand(Reader14443_Clone_MF_Classic);
+    Failed |= CheckMemory("CLONE_MFC 4K", KeyAKnown, KeyBKnown);
+    if (strcmp(Output, "") != 0 || Card.Selects != 1 || Card.Auths != 1) {
+        printf("FAIL CLONE_MFC 4K: %u selects, %u authentications\n", Card.Selects, Card.Auths);
+        Failed = 1;
+    }
+    if (GlobalSettings.ActiveSettingPtr->Configuration != CONFIG_MF_CLASSIC_4K) {
+        printf("FAIL CLONE_MFC 4K: configuration not set\n");
+        Failed = 1;
+    }
+    printf("CLONE_MFC 4K: %u selects, %u authentications, %u nested\n", Card.Selects, Card.Auths, Card.NestedAuths);
+    free(Output);
+
+    /* Mini with the transport key A and a readable key B outside the
+     * dictionary in every sector. Key B of the trailer is tried first, so no
+     * authentication fails and the card is selected once. */
+    CardSetup(0x09, 5);
+    for (int i = 0; i < 5; i++) {
+        CardSetKeys(i, KeyTransport, KeyUnknownB);
+        KeyAKnown[i] = KeyBKnown[i] = true;
+    }
+
+    Output = RunCommand(Reader14443_Read_MF_Classic);
+    Failed |= CheckMemory("DUMP_MFC Mini", KeyAKnown, KeyBKnown);
+    if (Card.Selects != 1 || Card.Auths != 1) {
+        printf("FAIL DUMP_MFC Mini: %u selects, %u authentications\n", Card.Selects, Card.Auths);
+        Failed = 1;
+    }
+    printf("DUMP_MFC Mini: %u selects, %u authentications, %u nested\n", Card.Selects, Card.Auths, Card.NestedAuths);
+    free(Output);
+
+    printf("%s\n", Failed ? "FAILED" : "OK");
+    return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/*
+ * ReaderBatchTest.c
+ *
+ * Runs SEND_BATCH scripts of the ISO14443A reader application against a
+ * simulated MIFARE Ultralight and compares the result records written to
+ * the terminal. Also checks that malformed scripts are rejected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostTerminal.h"
+#include "../Application/Reader14443A.h"
+#include "../Application/ISO14443-3A.h"
+#include "../Codec/Codec.h"
+#include "../Terminal/CommandLine.h"
+
+/* Simulated card, answers WUPA, ANTICOLLISION CL1 and READ */
+static const uint8_t CardUid[] = { 0xA1, 0xB2, 0xC3, 0xD4 };
+
+static uint16_t CardProcess(uint8_t *Buffer, uint16_t BitCount) {
+    uint16_t ByteCount;
+
+    if (BitCount == 7) {
+        if (Buffer[0] != ISO14443A_CMD_WUPA) {
+            return 0;
+        }
+        Buffer[0] = 0x44;
+        Buffer[1] = 0x00;
+        return addParityBits(Buffer, 16);
+    }
+
+    if (!checkParityBits(Buffer, BitCount)) {
+        return 0;
+    }
+    BitCount = removeParityBits(Buffer, BitCount);
+    ByteCount = BitCount / 8;
+
+    if ((ByteCount == 2) && (Buffer[0] == ISO14443A_CMD_SELECT_CL1) && (Buffer[1] == 0x20)) {
+        memcpy(Buffer, CardUid, sizeof(CardUid));
+        Buffer[4] = CardUid[0] ^ CardUid[1] ^ CardUid[2] ^ CardUid[3];
+        return addParityBits(Buffer, 40);
+    }
+
+    if ((ByteCount == 4) && (Buffer[0] == 0x30) && ISO14443ACheckCRCA(Buffer, 2)) {
+        uint8_t Page = Buffer[1];
+
+        for (uint8_t i = 0; i < 16; i++) {
+            Buffer[i] = Page * 4 + i;
+        }
+        ISO14443AAppendCRCA(Buffer, 16);
+        return addParityBits(Buffer, 18 * 8);
+    }
+
+    return 0;
+}
+
+/* Runs the hex script like the SEND_BATCH command and the reader codec would */
+static int RunScript(const char *Script, const char *Expected) {
+    char *Output = NULL;
+    size_t OutputSize = 0;
+    uint16_t BitCount = 0;
+    int Frames = 0;
+
+    ReaderBatchScriptSize = HexStringToBuffer(ReaderBatchScript, READER_BATCH_SCRIPT_SIZE, Script);
+    if (!Reader14443ABatchCheck()) {
+        printf("FAIL %s: rejected\n", Script);
+        return 1;
+    }
+
+    HostTerminalOutput = open_memstream(&Output, &OutputSize);
+    Reader14443AAppReset();
+    Reader14443ABatchStart();
+
+    while ((BitCount = Reader14443AAppProcess(CodecBuffer, BitCount)) != 0) {
+        if (++Frames > 1000) {
+            break;
+        }
+        BitCount = CardProcess(CodecBuffer, BitCount);
+    }
+
+    fclose(HostTerminalOutput);
+    HostTerminalOutput = NULL;
+
+    int Failed = (Frames > 1000) || (strcmp(Output, Expected) != 0);
+    printf("%s %s\n     %s", Failed ? "FAIL" : "ok  ", Script, Output);
+    free(Output);
+
+    return Failed;
+}
+
+static int RejectScript(const char *Script) {
+    ReaderBatchScriptSize = HexStringToBuffer(ReaderBatchScript, READER_BATCH_SCRIPT_SIZE, Script);
+    if (Reader14443ABatchCheck()) {
+        printf("FAIL %s: accepted\n", Script);
+        return 1;
+    }
+    printf("ok   %s: rejected\n", Script);
+    return 0;
+}
+
+int main(void) {
+    int Failed = 0;
+
+    /* WUPA and ANTICOLLISION, the example of the documentation */
+    Failed += RunScript("410002015201000502932000",
+                        "00000010440005000028A1B2C3D404\r\n");
+    /* READ with CRC_A, the length mismatch of the second READ is reported */
+    Failed += RunScript("81001202300481001002300800",
+                        "00000090101112131415161718191A1B1C1D1E1F22E8"
+                        "06080090202122232425262728292A2B2C2D2E2FDDCF\r\n");
+    /* REQA is not answered, JUMP_IF_FAIL continues with WUPA */
+    Failed += RunScript("41000201260408004100020152040700",
+                        "00010000080000104400\r\n");
+    /* An endless loop ends when the result buffer is full */
+    Failed += RunScript("41000201520300",
+                        "000000104400000000104400000000104400000000104400000000104400000000104400000000104400000000104400"
+                        "000000104400000000104400000000104400000000104400000000104400000000104400000000104400000000104400"
+                        "000000104400000000104400000000104400000000104400000000104400000000104400000000104400000000104400"
+                        "000000104400000000104400000000104400000000104400000000104400000000104400000000104400000000104400"
+                        "000000104400000000104400000000104400000000104400000000104400000000104400000000104400000000104400"
+                        "00000010440000000010440000800000\r\n");
+
+    /* Incomplete operation, unknown opcode, reserved flag, short frame with
+     * CRC_A, SEND_RAW without bits, jumps out of the script and into an
+     * operation, empty script */
+    Failed += RejectScript("0100");
+    Failed += RejectScript("05");
+    Failed += RejectScript("2100020152");
+    Failed += RejectScript("C100020152");
+    Failed += RejectScript("020002000052");
+    Failed += RejectScript("0302");
+    Failed += RejectScript("41000201520301");
+    Failed += RejectScript("");
+
+    return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * SniffLogTest.c
+ *
+ * Runs the same MIFARE Classic session once in the LIVE and once in the
+ * SNIFF log mode and compares the streams written to the terminal. The
+ * SNIFF stream has to hold the codec entries of the LIVE stream in the same
+ * order and with the same data, in the compact format between
+ * COMPACT_BEGIN and COMPACT_END, and nothing else.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostReader.h"
+#include "HostTerminal.h"
+#include "../Log.h"
+#include "../LiveLogTick.h"
+#include "../Application/ISO14443-3A.h"
+
+#define SNIFF_TEST_ENTRIES_MAX  128
+
+typedef struct {
+    uint8_t Entry;
+    uint8_t Length;
+    uint8_t Data[256];
+} SniffTestEntryType;
+
+typedef struct {
+    SniffTestEntryType Entries[SNIFF_TEST_ENTRIES_MAX];
+    unsigned Count;
+} SniffTestLogType;
+
+static SniffTestLogType LiveLog, SniffLog;
+
+static void DrainLog(void) {
+    while (LiveLogPending() > 0) {
+        LogTask();
+    }
+}
+
+static int Transceive(const uint8_t *Frame, uint16_t BitCount, bool AppendCRC, uint8_t *Answer) {
+    int AnswerBits = HostReaderTransceiveBits(Frame, BitCount, AppendCRC, Answer, 256 * 8, NULL);
+
+    DrainLog();
+    return AnswerBits;
+}
+
+/* REQA, anticollision and select, an authentication which is not completed
+ * and HALT. The application logs the authentication and the HALT. */
+static bool RunSession(LogModeEnum Mode, char **Stream, size_t *StreamSize) {
+    uint8_t Frame[7] = { 0x26 };
+    uint8_t Answer[256];
+    bool Ok;
+
+    if (!HostReaderInit("MF_CLASSIC_1K")) {
+        return false;
+    }
+
+    HostTerminalOutput = open_memstream(Stream, StreamSize);
+    LogSetModeById(Mode);
+
+    Ok = (Transceive(Frame, 7, false, Answer) > 0);
+    Frame[0] = 0x93;
+    Frame[1] = 0x20;
+    Ok = Ok && (Transceive(Frame, 16, false, Answer) == 5 * 8);
+    Frame[1] = 0x70;
+    memcpy(&Frame[2], Answer, 5);
+    Ok = Ok && (Transceive(Frame, 7 * 8, true, Answer) > 0);
+    /* The nonce is answered without CRC_A */
+    Frame[0] = 0x60;
+    Frame[1] = 0x00;
+    ISO14443AAppendCRCA(Frame, 2);
+    Ok = Ok && (Transceive(Frame, 32, false, Answer) == 4 * 8);
+    Frame[0] = 0x50;
+    Ok = Ok && (Transceive(Frame, 16, true, Answer) == HOST_READER_NO_ANSWER);
+
+    /* Leaving the mode ends the stream */
+    LogSetModeById(LOG_MODE_OFF);
+
+    fclose(HostTerminalOutput);
+    HostTerminalOutput = NULL;
+
+    return Ok;
+}
+
+static bool AddEntry(SniffTestLogType *Log, uint8_t Entry, const uint8_t *Data, uint16_t Length) {
+    if ((Log->Count >= SNIFF_TEST_ENTRIES_MAX) || (Length > sizeof(Log->Entries[0].Data))) {
+        return false;
+    }
+
+    SniffTestEntryType *LogEntry = &Log->Entries[Log->Count++];
+    LogEntry->Entry = Entry;
+    LogEntry->Length = Length;
+    memcpy(LogEntry->Data, Data, Length);
+
+    return true;
+}
+
+/* Entry code, length, two timestamp bytes and the data */
+static bool ParseLive(const uint8_t *Stream, size_t StreamSize, SniffTestLogType *Log) {
+    size_t Pos = 0;
+
+    while (Pos + 4 <= StreamSize) {
+        uint8_t Length = Stream[Pos + 1];
+
+        if ((Pos + 4 + Length > StreamSize) || !AddEntry(Log, Stream[Pos], &Stream[Pos + 4], Length)) {
+            return false;
+        }
+        Pos += 4 + Length;
+    }
+
+    return (Pos == StreamSize);
+}
+
+static bool ParseVarInt(const uint8_t *Stream, size_t StreamSize, size_t *Pos, uint16_t *Value) {
+    uint8_t Shift = 0;
+
+    *Value = 0;
+    while (*Pos < StreamSize) {
+        uint8_t Byte = Stream[(*Pos)++];
+
+        *Value |= (uint16_t)(Byte & 0x7F) << Shift;
+        if (!(Byte & 0x80)) {
+            return true;
+        }
+        Shift += 7;
+    }
+
+    return false;
+}
+
+/* A regular COMPACT_BEGIN, then entry code, delta timestamp, length and data */
+static bool ParseSniff(const uint8_t *Stream, size_t StreamSize, SniffTestLogType *Log) {
+    size_t Pos = 4;
+
+    if ((StreamSize < 4) || (Stream[0] != LOG_INFO_COMPACT_BEGIN) || (Stream[1] != 0)) {
+        return false;
+    }
+    AddEntry(Log, LOG_INFO_COMPACT_BEGIN, NULL, 0);
+
+    while (Pos < StreamSize) {
+        uint8_t Entry = Stream[Pos++];
+        uint16_t Delta, Length;
+
+        if (!ParseVarInt(Stream, StreamSize, &Pos, &Delta) || !ParseVarInt(Stream, StreamSize, &Pos, &Length) ||
+                (Pos + Length > StreamSize) || !AddEntry(Log, Entry, &Stream[Pos], Length)) {
+            return false;
+        }
+        Pos += Length;
+    }
+
+    return true;
+}
+
+static int Check(bool Condition, const char *Text) {
+    printf("%s %s\n", Condition ? "ok  " : "FAIL", Text);
+    return Condition ? 0 : 1;
+}
+
+int main(void) {
+    char *LiveStream = NULL, *SniffStream = NULL;
+    size_t LiveStreamSize = 0, SniffStreamSize = 0;
+    unsigned CodecEntries = 0, OtherEntries = 0;
+    int Failed = 0;
+
+    Failed += Check(RunSession(LOG_MODE_LIVE, &LiveStream, &LiveStreamSize), "session in the LIVE mode");
+    Failed += Check(ParseLive((uint8_t *) LiveStream, LiveStreamSize, &LiveLog), "LIVE stream parsed");
+    Failed += Check(RunSession(LOG_MODE_SNIFF, &SniffStream, &SniffStreamSize), "session in the SNIFF mode");
+    Failed += Check(ParseSniff((uint8_t *) SniffStream, SniffStreamSize, &SniffLog), "SNIFF stream parsed");
+
+    for (unsigned i = 0; i < LiveLog.Count; i++) {
+        uint8_t Entry = LiveLog.Entries[i].Entry;
+
+        if ((Entry >= LOG_SNIFF_FIRST_ENTRY) && (Entry <= LOG_SNIFF_LAST_ENTRY)) {
+            CodecEntries++;
+        } else {
+            OtherEntries++;
+        }
+    }
+    /* Otherwise the filter is not put to the test */
+    Failed += Check((CodecEntries > 0) && (OtherEntries > 0), "LIVE stream has codec and other entries");
+
+    /* COMPACT_BEGIN, the codec entries of the LIVE stream, COMPACT_END */
+    bool Match = (SniffLog.Count == CodecEntries + 2) &&
+                 (SniffLog.Entries[SniffLog.Count - 1].Entry == LOG_INFO_COMPACT_END);
+    unsigned SniffIdx = 1;
+
+    for (unsigned i = 0; Match && (i < LiveLog.Count); i++) {
+        const SniffTestEntryType *Live = &LiveLog.Entries[i];
+
+        if ((Live->Entry < LOG_SNIFF_FIRST_ENTRY) || (Live->Entry > LOG_SNIFF_LAST_ENTRY)) {
+            continue;
+        }
+
+        const SniffTestEntryType *Sniff = &SniffLog.Entries[SniffIdx++];
+        Match = (Sniff->Entry == Live->Entry) && (Sniff->Length == Live->Length) &&
+                (memcmp(Sniff->Data, Live->Data, Live->Length) == 0);
+    }
+    Failed += Check(Match, "SNIFF stream holds only the codec entries, in order");
+
+    printf("     %u codec entries, %u other entries in the LIVE stream\n", CodecEntries, OtherEntries);
+
+    free(LiveStream);
+    free(SniffStream);
+
+    return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+/*
+ * avr/eeprom.h : Host build stand-in. EEMEM variables live in their own
+ * section of ordinary RAM; see HostHardware.c for the address mapping used
+ * by ReadEEPBlock() and WriteEEPBlock().
+ */
+
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM                           __attribute__((section("host_eeprom"), used))
+
+#define eeprom_read_byte(addr)          (*(const uint8_t *) (addr))
+#define eeprom_read_word(addr)          (*(const uint16_t *) (addr))
+#define eeprom_read_block(dst, src, n)  memcpy((dst), (src), (n))
+#define eeprom_write_byte(addr, val)    (*(uint8_t *) (addr) = (val))
+#define eeprom_write_word(addr, val)    (*(uint16_t *) (addr) = (val))
+#define eeprom_write_block(src, dst, n) memcpy((dst), (src), (n))
+#define eeprom_update_byte              eeprom_write_byte
+#define eeprom_update_word              eeprom_write_word
+#define eeprom_update_block             eeprom_write_block
+#define eeprom_busy_wait()              do { } while (0)
+
+#endif /* HOST_AVR_EEPROM_H_ */
@@ -0,0 +1,19 @@
+/*
+ * avr/interrupt.h : Host build stand-in. There are no interrupts on the host,
+ * so global interrupt masking is a no-op and ISRs become plain functions.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#define sei()                           do { } while (0)
+#define cli()                           do { } while (0)
+#define reti()                          do { } while (0)
+
+#define ISR(vector, ...)                void vector(void); void vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define ISR_ALIASOF(v)
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -0,0 +1,333 @@
+/*
+ * avr/io.h : Host build stand-in for the XMEGA register definitions.
+ *
+ * Every peripheral is modeled as one generic, flat register block so that
+ * the inline helpers in the firmware headers (Codec.h, System.h, ...) still
+ * compile. Nothing here drives real hardware: writes are simply stored and
+ * reads return whatever was last written. Peripherals that the application
+ * layer depends on functionally (FRAM, flash, EEPROM, AES, DES) are replaced
+ * by software models in the Host/ sources instead.
+ */
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define _BV(bit)                (1 << (bit))
+#define _SFR_IO_ADDR(x)         (0)
+
+/* avr-gcc provides a native 24 bit integer type */
+typedef uint32_t __uint24;
+typedef int32_t __int24;
+
+typedef struct {
+    volatile uint8_t DIR, DIRSET, DIRCLR, DIRTGL;
+    volatile uint8_t OUT, OUTSET, OUTCLR, OUTTGL;
+    volatile uint8_t IN, INTCTRL, INT0MASK, INT1MASK, INTFLAGS;
+    volatile uint8_t PIN0CTRL, PIN1CTRL, PIN2CTRL, PIN3CTRL;
+    volatile uint8_t PIN4CTRL, PIN5CTRL, PIN6CTRL, PIN7CTRL;
+    volatile uint8_t CTRL, CTRLA, CTRLB, CTRLC, CTRLD, CTRLE, CTRLFSET, CTRLFCLR, CTRLGSET, CTRLGCLR;
+    volatile uint8_t INTCTRLA, INTCTRLB, STATUS, TEMP;
+    volatile uint16_t CNT, PER, PERBUF, CCA, CCB, CCC, CCD, CCABUF, CCBBUF, CCCBUF, CCDBUF;
+    volatile uint8_t DATA, BAUDCTRLA, BAUDCTRLB;
+    volatile uint8_t CH0MUX, CH1MUX, CH2MUX, CH3MUX, CH4MUX, CH5MUX, CH6MUX, CH7MUX;
+    volatile uint8_t CH0CTRL, CH1CTRL, CH2CTRL, CH3CTRL, CH4CTRL, CH5CTRL, CH6CTRL, CH7CTRL;
+    volatile uint8_t AC0CTRL, AC1CTRL, AC0MUXCTRL, AC1MUXCTRL, WINCTRL;
+    volatile uint16_t CH0DATA, CH1DATA;
+    volatile uint8_t EVCTRL, REFCTRL, PRESCALER, CALL, CALH, COMP0, COMP1;
+    volatile uint16_t COMP, CAL, CH0RES, CH1RES;
+    volatile uint8_t OUTOVEN, DTBOTH, DTLS, DTHS;
+    volatile uint8_t VPCTRLA, VPCTRLB, CLKEVOUT, EBIOUT, EVCTRL2;
+    volatile uint8_t ADDR0, ADDR1, ADDR2, DATA0, DATA1, DATA2, CMD;
+    volatile uint8_t KEY, STATE;
+    volatile uint8_t PSCTRL, LOCK, RTCCTRL, USBCTRL;
+    volatile uint8_t XOSCCTRL, XOSCFAIL, RC32KCAL, PLLCTRL, DFLLCTRL;
+    volatile uint8_t ADDRCTRL, TRIGSRC, REPCNT;
+    volatile uint16_t TRFCNT;
+    volatile uint8_t SRCADDR0, SRCADDR1, SRCADDR2, DESTADDR0, DESTADDR1, DESTADDR2;
+    volatile uint8_t SMODE, SEN;
+    struct {
+        volatile uint8_t CTRL, MUXCTRL, INTCTRL, INTFLAGS, SCAN;
+        volatile uint16_t RES;
+    } CH0, CH1, CH2, CH3;
+} HostRegisterBlockType;
+
+/* Single instances shared by all translation units; see HostHardware.c */
+#define HOST_PERIPHERAL_LIST(X) \
+    X(PORTA) X(PORTB) X(PORTC) X(PORTD) X(PORTE) X(PORTR) \
+    X(VPORT0) X(VPORT1) X(VPORT2) X(VPORT3) \
+    X(TCC0) X(TCC1) X(TCD0) X(TCD1) X(TCE0) \
+    X(USARTC0) X(USARTD0) X(USARTE0) X(DMA) X(EVSYS) \
+    X(ACA) X(ACB) X(DACB) X(ADCA) X(AWEXC) X(RTC) X(AES) X(NVM) \
+    X(CLK) X(OSC) X(PMIC) X(SLEEP) X(PORTCFG) X(CRC) X(RST) X(WDT) \
+    X(DFLLRC32M) X(DFLLRC2M) X(USB)
+
+#define HOST_DECLARE_PERIPHERAL(Name) extern HostRegisterBlockType Name;
+HOST_PERIPHERAL_LIST(HOST_DECLARE_PERIPHERAL)
+#undef HOST_DECLARE_PERIPHERAL
+
+/* General purpose I/O registers, used as fast globals by the codecs and system tick */
+extern volatile uint8_t HostGPIOR[16];
+#define GPIOR0      (HostGPIOR[0x0])
+#define GPIOR1      (HostGPIOR[0x1])
+#define GPIOR2      (HostGPIOR[0x2])
+#define GPIOR3      (HostGPIOR[0x3])
+#define GPIOR4      (HostGPIOR[0x4])
+#define GPIOR5      (HostGPIOR[0x5])
+#define GPIOR6      (HostGPIOR[0x6])
+#define GPIOR7      (HostGPIOR[0x7])
+#define GPIOR8      (HostGPIOR[0x8])
+#define GPIOR9      (HostGPIOR[0x9])
+#define GPIORA      (HostGPIOR[0xA])
+#define GPIORB      (HostGPIOR[0xB])
+#define GPIORC      (HostGPIOR[0xC])
+#define GPIORD      (HostGPIOR[0xD])
+#define GPIORE      (HostGPIOR[0xE])
+#define GPIORF      (HostGPIOR[0xF])
+
+extern volatile uint8_t CCP;
+#define NVM_CTRLA   (NVM.CTRLA)
+
+/* Memory geometry of the ATxmega128A4U */
+#define APP_SECTION_PAGE_SIZE   256
+#define EEPROM_PAGE_SIZE        32
+#define EEPROM_SIZE             2048
+
+/* Pin masks */
+#define PIN0_bm     0x01
+#define PIN1_bm     0x02
+#define PIN2_bm     0x04
+#define PIN3_bm     0x08
+#define PIN4_bm     0x10
+#define PIN5_bm     0x20
+#define PIN6_bm     0x40
+#define PIN7_bm     0x80
+
+/* The remaining bit masks and group configurations only have to be distinct
+ * enough for the firmware's register bookkeeping to compile. */
+#define PORT_ISC_BOTHEDGES_gc           0x00
+#define PORT_ISC_RISING_gc              0x01
+#define PORT_ISC_FALLING_gc             0x02
+#define PORT_ISC_LEVEL_gc               0x03
+#define PORT_ISC_INPUT_DISABLE_gc       0x07
+#define PORT_OPC_PULLUP_gc              0x18
+#define PORT_OPC_TOTEM_gc               0x00
+#define PORT_INVEN_bm                   0x40
+#define PORT_INT0LVL_HI_gc              0x03
+#define PORT_INT1LVL_HI_gc              0x0C
+#define PORT_INT0IF_bm                  0x01
+#define PORT_INT1IF_bm                  0x02
+#define PORTCFG_VP0MAP_gm               0x0F
+#define PORTCFG_VP02MAP_PORTC_gc        0x02
+#define PORTCFG_VP13MAP_PORTB_gc        0x10
+
+#define EVSYS_CHMUX_PORTB_PIN1_gc       0x59
+#define EVSYS_CHMUX_PORTB_PIN2_gc       0x5A
+#define EVSYS_CHMUX_PORTC_PIN2_gc       0x62
+#define EVSYS_CHMUX_ACA_CH0_gc          0x10
+#define EVSYS_CHMUX_ACA_CH1_gc          0x11
+#define EVSYS_CHMUX_TCD1_OVF_gc         0xD8
+#define EVSYS_CHMUX_OFF_gc              0x00
+#define EVSYS_DIGFILT_3SAMPLES_gc       0x02
+
+#define TC_CLKSEL_OFF_gc                0x00
+#define TC_CLKSEL_DIV1_gc               0x01
+#define TC_CLKSEL_DIV2_gc               0x02
+#define TC_CLKSEL_DIV4_gc               0x03
+#define TC_CLKSEL_DIV8_gc               0x04
+#define TC_CLKSEL_DIV64_gc              0x05
+#define TC_CLKSEL_DIV256_gc             0x06
+#define TC_CLKSEL_DIV1024_gc            0x07
+#define TC_CLKSEL_EVCH0_gc              0x08
+#define TC_CLKSEL_EVCH1_gc              0x09
+#define TC_CLKSEL_EVCH2_gc              0x0A
+#define TC_CLKSEL_EVCH3_gc              0x0B
+#define TC_CLKSEL_EVCH4_gc              0x0C
+#define TC_CLKSEL_EVCH5_gc              0x0D
+#define TC_CLKSEL_EVCH6_gc              0x0E
+#define TC_CLKSEL_EVCH7_gc              0x0F
+#define TC_WGMODE_NORMAL_gc             0x00
+#define TC_WGMODE_FRQ_gc                0x01
+#define TC_WGMODE_SINGLESLOPE_gc        0x03
+#define TC_EVSEL_OFF_gc                 0x00
+#define TC_EVSEL_CH0_gc                 0x08
+#define TC_EVSEL_CH1_gc                 0x09
+#define TC_EVSEL_CH2_gc                 0x0A
+#define TC_EVSEL_CH3_gc                 0x0B
+#define TC_EVSEL_CH4_gc                 0x0C
+#define TC_EVSEL_CH5_gc                 0x0D
+#define TC_EVSEL_CH6_gc                 0x0E
+#define TC_EVSEL_CH7_gc                 0x0F
+#define TC_EVACT_OFF_gc                 0x00
+#define TC_EVACT_CAPT_gc                0x20
+#define TC_EVACT_RESTART_gc             0x80
+#define TC_EVACT_FRQ_gc                 0xA0
+#define TC_CMD_RESTART_gc               0x08
+#define TC_CMD_UPDATE_gc                0x04
+#define TC_OVFINTLVL_OFF_gc             0x00
+#define TC_OVFINTLVL_LO_gc              0x01
+#define TC_OVFINTLVL_MED_gc             0x02
+#define TC_OVFINTLVL_HI_gc              0x03
+#define TC_CCAINTLVL_OFF_gc             0x00
+#define TC_CCAINTLVL_LO_gc              0x01
+#define TC_CCAINTLVL_HI_gc              0x03
+#define TC_CCBINTLVL_OFF_gc             0x00
+#define TC_CCBINTLVL_HI_gc              0x0C
+#define TC_CCCINTLVL_OFF_gc             0x00
+#define TC_CCCINTLVL_HI_gc              0x30
+#define TC_CCDINTLVL_OFF_gc             0x00
+#define TC_CCDINTLVL_HI_gc              0xC0
+#define TC0_CCAEN_bm                    0x10
+#define TC0_CCBEN_bm                    0x20
+#define TC0_CCCEN_bm                    0x40
+#define TC0_CCDEN_bm                    0x80
+#define TC1_CCAEN_bm                    0x10
+#define TC1_CCBEN_bm                    0x20
+#define TC0_OVFIF_bm                    0x01
+#define TC0_CCAIF_bm                    0x10
+#define TC0_CCBIF_bm                    0x20
+#define TC0_CCCIF_bm                    0x40
+#define TC0_CCDIF_bm                    0x80
+#define TC1_OVFIF_bm                    0x01
+#define TC1_CCAIF_bm                    0x10
+#define TC1_CCBIF_bm                    0x20
+
+#define AWEX_CWCM_bm                    0x04
+#define AWEX_DTICCAEN_bm                0x01
+#define AWEX_DTICCBEN_bm                0x02
+
+#define DAC_IDOEN_bm                    0x10
+#define DAC_ENABLE_bm                   0x01
+#define DAC_CHSEL_SINGLE_gc             0x00
+#define DAC_REFSEL_AVCC_gc              0x08
+#define DAC_CH0DRE_bm                   0x01
+
+#define AC_HSMODE_bm                    0x08
+#define AC_HYSMODE_NO_gc                0x00
+#define AC_ENABLE_bm                    0x01
+#define AC_MUXPOS_DAC_gc                0x38
+#define AC_MUXNEG_PIN7_gc               0x07
+#define AC_AC0STATE_bm                  0x10
+#define AC_AC1STATE_bm                  0x20
+#define AC_AC0IF_bm                     0x01
+#define AC_INTMODE_BOTHEDGES_gc         0x00
+#define AC_INTMODE_FALLING_gc           0x20
+#define AC_INTMODE_RISING_gc            0x30
+#define AC_INTLVL_HI_gc                 0x03
+#define AC_INTLVL_OFF_gc                0x00
+
+#define ADC_ENABLE_bm                   0x01
+#define ADC_CH0START_bm                 0x04
+#define ADC_CH0IF_bm                    0x01
+#define ADC_CH_CHIF_bm                  0x01
+#define ADC_CH_INPUTMODE_SINGLEENDED_gc 0x01
+#define ADC_CH_MUXPOS_PIN0_gc           0x00
+#define ADC_CH_MUXPOS_PIN1_gc           0x08
+#define ADC_CH_START_bm                 0x80
+#define ADC_BANDGAP_bm                  0x02
+#define PRODSIGNATURES_ADCACAL0         0x20
+#define PRODSIGNATURES_ADCACAL1         0x21
+#define ADC_CH_MUXPOS_PIN6_gc           0x30
+#define ADC_CH_MUXPOS_PIN7_gc           0x38
+#define ADC_REFSEL_INT1V_gc             0x00
+#define ADC_REFSEL_AREFA_gc             0x20
+#define ADC_RESOLUTION_12BIT_gc         0x00
+#define ADC_PRESCALER_DIV32_gc          0x03
+#define ADC_CONMODE_bm                  0x10
+#define ADC_FREERUN_bm                  0x08
+
+#define USART_RXCIF_bm                  0x80
+#define USART_DREIF_bm                  0x20
+#define USART_TXCIF_bm                  0x40
+#define USART_RXEN_bm                   0x10
+#define USART_TXEN_bm                   0x08
+#define USART_CMODE_MSPI_gc             0xC0
+
+#define DMA_ENABLE_bm                   0x80
+#define DMA_CH_ENABLE_bm                0x80
+#define DMA_CH_SINGLE_bm                0x04
+#define DMA_CH_BURSTLEN_1BYTE_gc        0x00
+#define DMA_CH_TRNIF_bm                 0x10
+#define DMA_CH_ERRIF_bm                 0x20
+#define DMA_CH_SRCRELOAD_NONE_gc        0x00
+#define DMA_CH_SRCDIR_FIXED_gc          0x00
+#define DMA_CH_SRCDIR_INC_gc            0x10
+#define DMA_CH_DESTRELOAD_NONE_gc       0x00
+#define DMA_CH_DESTDIR_FIXED_gc         0x00
+#define DMA_CH_DESTDIR_INC_gc           0x01
+#define DMA_CH_TRIGSRC_USARTD0_RXC_gc   0x6B
+#define DMA_CH_TRIGSRC_USARTD0_DRE_gc   0x6C
+
+#define RTC_COMPIF_bm                   0x02
+#define RTC_OVFIF_bm                    0x01
+#define RTC_SYNCBUSY_bm                 0x01
+#define RTC_PRESCALER_DIV1_gc           0x01
+
+#define AES_START_bm                    0x80
+#define AES_AUTO_bm                     0x40
+#define AES_RESET_bm                    0x20
+#define AES_DECRYPT_bm                  0x10
+#define AES_XOR_bm                      0x04
+#define AES_SRIF_bm                     0x01
+#define AES_ERROR_bm                    0x80
+#define AES_INTLVL_OFF_gc               0x00
+#define AES_INTLVL_LO_gc                0x01
+#define AES_INTLVL_MED_gc               0x02
+#define AES_INTLVL_HI_gc                0x03
+
+#define NVM_NVMBUSY_bm                  0x80
+#define NVM_EELOAD_bm                   0x02
+#define NVM_CMDEX_bm                    0x01
+#define NVM_CMD_READ_EEPROM_gc          0x06
+#define NVM_CMD_LOAD_EEPROM_BUFFER_gc   0x33
+#define NVM_CMD_ERASE_EEPROM_BUFFER_gc  0x36
+#define NVM_CMD_ERASE_WRITE_EEPROM_PAGE_gc 0x35
+#define NVM_CMD_READ_CALIB_ROW_gc       0x02
+#define NVM_CMD_NO_OPERATION_gc         0x00
+#define CCP_IOREG_gc                    0xD8
+#define CCP_SPM_gc                      0x9D
+
+#define CLK_SCLKSEL_RC2M_gc             0x00
+#define CLK_SCLKSEL_RC32M_gc            0x01
+#define CLK_SCLKSEL_XOSC_gc             0x03
+#define CLK_SCLKSEL_PLL_gc              0x04
+#define CLK_USBSRC_RC32M_gc             0x02
+#define CLK_USBSEN_bm                   0x01
+#define CLK_USBPSDIV_1_gc               0x00
+#define CLK_RTCSRC_RCOSC_gc             0x04
+#define CLK_RTCSRC_ULP_gc               0x00
+#define CLK_RTCEN_bm                    0x01
+#define OSC_RC32MEN_bm                  0x02
+#define OSC_RC32MRDY_bm                 0x02
+#define OSC_RC32KEN_bm                  0x04
+#define OSC_RC32KRDY_bm                 0x04
+#define OSC_XOSCEN_bm                   0x08
+#define OSC_XOSCRDY_bm                  0x08
+#define OSC_PLLEN_bm                    0x10
+#define OSC_PLLRDY_bm                   0x10
+#define OSC_RC32MCREF_USBSOF_gc         0x04
+#define OSC_FRQRANGE_12TO16_gc          0xC0
+#define OSC_XOSCSEL_EXTCLK_gc           0x00
+#define OSC_XOSCSEL_XTAL_16KCLK_gc      0x0B
+#define OSC_PLLSRC_XOSC_gc              0xC0
+#define DFLL_ENABLE_bm                  0x01
+#define PMIC_LOLVLEN_bm                 0x01
+#define PMIC_MEDLVLEN_bm                0x02
+#define PMIC_HILVLEN_bm                 0x04
+#define SLEEP_SMODE_IDLE_gc             0x00
+#define SLEEP_SMODE_PSAVE_gc            0x06
+#define SLEEP_SEN_bm                    0x01
+#define RST_SWRST_bm                    0x01
+#define WDT_ENABLE_bm                   0x02
+#define WDT_CEN_bm                      0x01
+#define WDT_PER_8CLK_gc                 0x00
+#define WDT_PER_500CLK_gc               0x18
+#define CRC_RESET_RESET1_gc             0xC0
+#define CRC_RESET_RESET0_gc             0x80
+#define CRC_SOURCE_IO_gc                0x01
+#define CRC_CRC32_bm                    0x20
+#define CRC_BUSY_bm                     0x01
+
+#endif /* HOST_AVR_IO_H_ */
@@ -0,0 +1,39 @@
+/*
+ * avr/pgmspace.h : Host build stand-in. Program memory is ordinary memory.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P                           const char *
+#define PSTR(s)                         (s)
+
+#define pgm_read_byte(addr)             (*(const uint8_t *) (addr))
+#define pgm_read_word(addr)             (*(const uint16_t *) (addr))
+#define pgm_read_dword(addr)            (*(const uint32_t *) (addr))
+#define pgm_read_ptr(addr)              (*(void *const *) (addr))
+#define pgm_read_byte_near(addr)        pgm_read_byte(addr)
+#define pgm_read_word_near(addr)        pgm_read_word(addr)
+#define pgm_read_byte_far(addr)         pgm_read_byte(addr)
+
+#define memcpy_P                        memcpy
+#define memcmp_P                        memcmp
+#define strcpy_P                        strcpy
+#define strncpy_P                       strncpy
+#define strcat_P                        strcat
+#define strcmp_P                        strcmp
+#define strlen_P                        strlen
+#define strcasecmp_P                    strcasecmp
+#define strncasecmp_P                   strncasecmp
+#define snprintf_P                      snprintf
+#define sprintf_P                       sprintf
+#define sscanf_P                        sscanf
+#define printf_P                        printf
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
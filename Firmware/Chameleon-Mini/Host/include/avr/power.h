@@ -0,0 +1,8 @@
+/*
+ * avr/power.h : Host build stand-in.
+ */
+
+#ifndef HOST_AVR_POWER_H_
+#define HOST_AVR_POWER_H_
+
+#endif /* HOST_AVR_POWER_H_ */
@@ -0,0 +1,13 @@
+/*
+ * avr/sleep.h : Host build stand-in.
+ */
+
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+#define sleep_mode()                    do { } while (0)
+#define sleep_cpu()                     do { } while (0)
+#define sleep_enable()                  do { } while (0)
+#define sleep_disable()                 do { } while (0)
+
+#endif /* HOST_AVR_SLEEP_H_ */
@@ -0,0 +1,12 @@
+/*
+ * avr/wdt.h : Host build stand-in.
+ */
+
+#ifndef HOST_AVR_WDT_H_
+#define HOST_AVR_WDT_H_
+
+#define wdt_reset()                     do { } while (0)
+#define wdt_enable(Timeout)             do { } while (0)
+#define wdt_disable()                   do { } while (0)
+
+#endif /* HOST_AVR_WDT_H_ */
@@ -0,0 +1,15 @@
+/*
+ * util/atomic.h : Host build stand-in. The host build is single threaded.
+ */
+
+#ifndef HOST_UTIL_ATOMIC_H_
+#define HOST_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define NONATOMIC_RESTORESTATE
+#define NONATOMIC_FORCEOFF
+#define ATOMIC_BLOCK(type)              for (int __host_once = 1; __host_once; __host_once = 0)
+#define NONATOMIC_BLOCK(type)           for (int __host_once = 1; __host_once; __host_once = 0)
+
+#endif /* HOST_UTIL_ATOMIC_H_ */
@@ -0,0 +1,11 @@
+/*
+ * util/delay.h : Host build stand-in. Busy waits are not modeled.
+ */
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+#define _delay_ms(ms)                   do { (void) (ms); } while (0)
+#define _delay_us(us)                   do { (void) (us); } while (0)
+
+#endif /* HOST_UTIL_DELAY_H_ */
@@ -0,0 +1,10 @@
+/*
+ * util/parity.h : Host build stand-in.
+ */
+
+#ifndef HOST_UTIL_PARITY_H_
+#define HOST_UTIL_PARITY_H_
+
+#define parity_even_bit(val)            (__builtin_parity((unsigned char) (val)))
+
+#endif /* HOST_UTIL_PARITY_H_ */
@@ -54,8 +54,17 @@
 /** Size in bytes of the CDC device-to-host notification IN endpoint. */
 #define CDC_NOTIFICATION_EPSIZE        8
 
-/** Size in bytes of the CDC data IN and OUT endpoints. */
-#define CDC_TXRX_EPSIZE                16
+/** Size in bytes of the CDC data IN and OUT endpoints. 64 bytes is the
+ *  largest full speed bulk packet, so that a transaction moves four times
+ *  the data of the former 16 byte endpoints. The XMEGA driver of LUFA keeps
+ *  a 64 byte FIFO per endpoint anyway, so this takes no additional SRAM. */
+#ifndef CDC_TXRX_EPSIZE
+#define CDC_TXRX_EPSIZE                64
+#endif
+
+/** Number of banks of the CDC data endpoints. The XMEGA driver of LUFA does
+ *  not support ping-pong operation yet and configures a single bank. */
+#define CDC_TXRX_BANKS                 1
 
 /* Type Defines: */
 /** Type define for the device configuration descriptor structure. This must be defined in the
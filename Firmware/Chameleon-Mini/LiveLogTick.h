@@ -1,8 +1,12 @@
-/* LiveLogTick.h : Handle flushing of live logging buffers out through USB
- *                 by an atomic code block with interrupts disabled.
- *                 If there are many logs being generated at once, this will maintain
- *                 consistency in the returned buffers and prevent the contents of
- *                 USB serial data from getting jumbled or concatenated.
+/* LiveLogTick.h : Live logging through a single-producer single-consumer
+ *                 ring buffer in LogMem. Entries are appended by the codecs
+ *                 and applications without disabling interrupts and are
+ *                 drained to USB by LogTask in bounded chunks, so that a
+ *                 transfer never stalls the processing of a frame. When the
+ *                 ring is full, entries are dropped and counted instead.
+ *                 The stream sent to the host is unchanged: entry code,
+ *                 length, two timestamp bytes and the data. The SNIFF log
+ *                 mode streams records in the compact format instead.
  */
 
 #ifndef __LIVE_LOG_TICK_H__
@@ -10,8 +14,7 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
-#include <avr/interrupt.h>
-#include <avr/io.h>
+#include <string.h>
 #include <util/atomic.h>
 
 #include "LUFADescriptors.h"
@@ -19,107 +22,140 @@
 #include "Log.h"
 #include "Terminal/Terminal.h"
 
-#define cli_memory() __asm volatile( "cli" ::: "memory" )
-#define sei_memory() __asm volatile( "sei" ::: "memory" )
-
-#ifndef FLUSH_LOGS_ON_SPACE_ERROR
-#define FLUSH_LOGS_ON_SPACE_ERROR            (1)
+/* Maximum number of bytes LogTask hands to the USB endpoint per call */
+#ifndef LIVE_LOG_FLUSH_CHUNK_SIZE
+#define LIVE_LOG_FLUSH_CHUNK_SIZE            (4 * CDC_TXRX_EPSIZE)
 #endif
-typedef struct LogBlockListNode {
-    uint8_t                  *logBlockDataStart;
-    uint8_t                  logBlockDataSize;
-    struct LogBlockListNode  *nextBlock;
-} LogBlockListNode;
 
-#define LOG_BLOCK_LIST_NODE_SIZE             (sizeof(LogBlockListNode) + 4 - (uint8_t) (sizeof(LogBlockListNode) % 4))
-extern LogBlockListNode *LogBlockListBegin;
-extern LogBlockListNode *LogBlockListEnd;
-extern uint8_t LogBlockListElementCount;
+#define LIVE_LOG_HEADER_SIZE                 4
 
-#define LIVE_LOGGER_POST_TICKS              (4)
-extern uint8_t LiveLogModePostTickCount;
+/* Keeps the compiler from moving the entry stores behind the publishing
+ * store of the head index */
+#define LiveLogMemoryBarrier()               __asm volatile( "" ::: "memory" )
 
-INLINE bool AtomicAppendLogBlock(LogEntryEnum logCode, uint16_t sysTickTime, const uint8_t *logData, uint8_t logDataSize);
-INLINE void FreeLogBlocks(void);
-INLINE bool AtomicLiveLogTick(void);
-INLINE bool LiveLogTick(void);
+typedef struct {
+    uint16_t Dropped;   /* Entries dropped because the ring was full */
+    uint16_t Overflows; /* Number of times the ring ran full */
+} LiveLogStatsType;
 
-INLINE bool
-AtomicAppendLogBlock(LogEntryEnum logCode, uint16_t sysTickTime, const uint8_t *logData, uint8_t logDataSize) {
-    cli_memory();
-    bool status = true;
-    if ((logDataSize + 4 + 3 + LOG_BLOCK_LIST_NODE_SIZE > LogMemLeft) && (LogMemPtr != LogMem)) {
-        if (FLUSH_LOGS_ON_SPACE_ERROR) {
-            LiveLogTick();
-            FreeLogBlocks();
-        }
-        status = false;
-    } else if (logDataSize + 4 + 3 + LOG_BLOCK_LIST_NODE_SIZE <= LogMemLeft) {
-        uint8_t alignOffset = 4 - (uint8_t)(((uint16_t) LogMemPtr) % 4);
-        uint8_t *logBlockStart = LogMemPtr + alignOffset;
-        LogBlockListNode logBlock;
-        LogMemPtr += LOG_BLOCK_LIST_NODE_SIZE + alignOffset;
-        LogMemLeft -= LOG_BLOCK_LIST_NODE_SIZE + alignOffset;
-        logBlock.logBlockDataStart = LogMemPtr;
-        logBlock.logBlockDataSize = logDataSize + 4;
-        logBlock.nextBlock = 0;
-        *(LogMemPtr++) = (uint8_t) logCode;
-        *(LogMemPtr++) = logDataSize;
-        *(LogMemPtr++) = (uint8_t)(sysTickTime >> 8);
-        *(LogMemPtr++) = (uint8_t)(sysTickTime >> 0);
-        memcpy(LogMemPtr, logData, logDataSize);
-        LogMemPtr += logDataSize;
-        LogMemLeft -= logDataSize + 4;
-        memcpy(logBlockStart, &logBlock, sizeof(LogBlockListNode));
-        if (LogBlockListBegin != NULL && LogBlockListEnd != NULL) {
-            LogBlockListEnd->nextBlock = (LogBlockListNode *) logBlockStart;
-            LogBlockListEnd = (LogBlockListNode *) logBlockStart;
-        } else {
-            LogBlockListBegin = LogBlockListEnd = (LogBlockListNode *) logBlockStart;
-        }
-        ++LogBlockListElementCount;
-    } else {
-        status = false;
+/* The head is only written by the producer, the tail only by the consumer.
+ * The consumer accesses both atomically, since the producer may run in
+ * interrupt context. */
+extern volatile uint16_t LiveLogHead;
+extern volatile uint16_t LiveLogTail;
+extern bool LiveLogOverflowing;
+extern LiveLogStatsType LiveLogStats;
+
+INLINE void LiveLogReset(void);
+INLINE uint16_t LiveLogPending(void);
+INLINE bool LiveLogAppendRecord(const uint8_t *Header, uint8_t HeaderSize, const uint8_t *Data, uint8_t ByteCount);
+INLINE bool LiveLogAppend(LogEntryEnum logCode, uint16_t sysTickTime, const uint8_t *logData, uint8_t logDataSize);
+INLINE void LiveLogFlush(uint16_t MaxByteCount);
+
+INLINE void
+LiveLogReset(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        LiveLogHead = 0;
+        LiveLogTail = 0;
     }
-    sei_memory();
-    return status;
+    LiveLogOverflowing = false;
+    LiveLogStats.Dropped = 0;
+    LiveLogStats.Overflows = 0;
 }
 
-INLINE void
-FreeLogBlocks(void) {
-    LogMemPtr = &LogMem[0];
-    LogMemLeft = LOG_SIZE;
-    LogBlockListBegin = LogBlockListEnd = NULL;
-    LogBlockListElementCount = 0;
+INLINE uint16_t
+LiveLogPending(void) {
+    uint16_t Head, Tail;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Head = LiveLogHead;
+        Tail = LiveLogTail;
+    }
+
+    return (Head >= Tail) ? (Head - Tail) : (LOG_SIZE - Tail + Head);
 }
 
-INLINE bool
-AtomicLiveLogTick(void) {
-    //cli_memory();
-    bool opStatus = LiveLogTick();
-    //sei_memory();
-    return opStatus;
+INLINE uint16_t
+LiveLogCopyIn(uint16_t Head, const uint8_t *Data, uint8_t ByteCount) {
+    uint16_t Contiguous = LOG_SIZE - Head;
+
+    if (ByteCount < Contiguous) {
+        memcpy(&LogMem[Head], Data, ByteCount);
+        return Head + ByteCount;
+    }
+
+    /* Wrap around the end of the ring */
+    memcpy(&LogMem[Head], Data, Contiguous);
+    memcpy(LogMem, Data + Contiguous, ByteCount - Contiguous);
+    return ByteCount - Contiguous;
 }
 
+/* Appends a record consisting of a header and the data as one unit, so that
+ * either the whole record or nothing of it reaches the host */
 INLINE bool
-LiveLogTick(void) {
-    LogBlockListNode logBlockCurrent, *tempBlockPtr = NULL;
-    memcpy(&logBlockCurrent, LogBlockListBegin, sizeof(LogBlockListNode));
-    while (LogBlockListElementCount > 0) {
-        TerminalFlushBuffer();
-        TerminalSendBlock(logBlockCurrent.logBlockDataStart, logBlockCurrent.logBlockDataSize);
-        tempBlockPtr = logBlockCurrent.nextBlock;
-        if (tempBlockPtr != NULL) {
-            memcpy(&logBlockCurrent, tempBlockPtr, sizeof(LogBlockListNode));
-        } else {
-            break;
+LiveLogAppendRecord(const uint8_t *Header, uint8_t HeaderSize, const uint8_t *Data, uint8_t ByteCount) {
+    uint16_t Head = LiveLogHead;
+    uint16_t Tail = LiveLogTail;
+    /* One byte stays unused to tell a full from an empty ring */
+    uint16_t Free = (Tail > Head) ? (Tail - Head - 1) : (LOG_SIZE - 1 - Head + Tail);
+
+    if (Free < (uint16_t) ByteCount + HeaderSize) {
+        if (!LiveLogOverflowing) {
+            LiveLogOverflowing = true;
+            LiveLogStats.Overflows++;
         }
-        --LogBlockListElementCount;
+        LiveLogStats.Dropped++;
+        return false;
     }
-    FreeLogBlocks();
-    LiveLogModePostTickCount = 0;
-    TerminalFlushBuffer();
+
+    Head = LiveLogCopyIn(Head, Header, HeaderSize);
+    Head = LiveLogCopyIn(Head, Data, ByteCount);
+
+    /* Publish the complete record to the consumer */
+    LiveLogMemoryBarrier();
+    LiveLogHead = Head;
+    LiveLogOverflowing = false;
+
     return true;
 }
 
+INLINE bool
+LiveLogAppend(LogEntryEnum logCode, uint16_t sysTickTime, const uint8_t *logData, uint8_t logDataSize) {
+    uint8_t Header[LIVE_LOG_HEADER_SIZE] = {
+        (uint8_t) logCode,
+        logDataSize,
+        (uint8_t)(sysTickTime >> 8),
+        (uint8_t)(sysTickTime >> 0)
+    };
+
+    return LiveLogAppendRecord(Header, LIVE_LOG_HEADER_SIZE, logData, logDataSize);
+}
+
+INLINE void
+LiveLogFlush(uint16_t MaxByteCount) {
+    uint16_t Head, Tail = LiveLogTail;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Head = LiveLogHead;
+    }
+
+    while ((Tail != Head) && (MaxByteCount > 0)) {
+        /* Send the part up to the head or up to the end of the ring */
+        uint16_t ByteCount = (Head > Tail) ? (Head - Tail) : (LOG_SIZE - Tail);
+
+        ByteCount = MIN(ByteCount, MaxByteCount);
+        TerminalSendBlock(&LogMem[Tail], ByteCount);
+
+        Tail += ByteCount;
+        if (Tail >= LOG_SIZE) {
+            Tail = 0;
+        }
+        MaxByteCount -= ByteCount;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        LiveLogTail = Tail;
+    }
+}
+
 #endif
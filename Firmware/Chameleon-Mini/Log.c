@@ -10,22 +10,196 @@ uint8_t LogMem[LOG_SIZE];
 uint8_t *LogMemPtr;
 uint16_t LogMemLeft;
 
+/* The FRAM log holds the bytes from LogFRAMTail up to LogFRAMAddr (exclusive),
+ * wrapping around at the end of the log area. LogMem holds the newer entries,
+ * of which the first LogMemFlushed bytes have already been copied to FRAM. */
 static uint16_t LogFRAMAddr = FRAM_LOG_START_ADDR;
+static uint16_t LogFRAMTail = FRAM_LOG_START_ADDR;
+static uint16_t LogMemFlushed = 0;
 static uint8_t EEMEM LogFRAMAddrValid = false;
 static bool EnableLogSRAMtoFRAM = false;
+static bool EnableLogFRAMRing = false;
+static uint16_t LogCompactLastTick;
 LogFuncType CurrentLogFunc;
 
-LogBlockListNode *LogBlockListBegin = NULL;
-LogBlockListNode *LogBlockListEnd = NULL;
-uint8_t LogBlockListElementCount = 0;
-uint8_t LiveLogModePostTickCount = 0;
+volatile uint16_t LiveLogHead = 0;
+volatile uint16_t LiveLogTail = 0;
+bool LiveLogOverflowing = false;
+LiveLogStatsType LiveLogStats = { 0 };
 
 static const MapEntryType PROGMEM LogModeMap[] = {
     { .Id = LOG_MODE_OFF, 	.Text = "OFF" 		},
     { .Id = LOG_MODE_MEMORY, 	.Text = "MEMORY" 	},
-    { .Id = LOG_MODE_LIVE, 	.Text = "LIVE" 	        }
+    { .Id = LOG_MODE_LIVE, 	.Text = "LIVE" 	        },
+    { .Id = LOG_MODE_COMPACT, 	.Text = "COMPACT" 	},
+    { .Id = LOG_MODE_CIRCULAR, 	.Text = "CIRCULAR" 	},
+    { .Id = LOG_MODE_SNIFF, 	.Text = "SNIFF" 	}
 };
 
+static uint16_t LogFRAMAdvance(uint16_t Address, uint16_t ByteCount) {
+    Address += ByteCount;
+
+    if (Address >= FRAM_LOG_START_ADDR + FRAM_LOG_SIZE) {
+        Address -= FRAM_LOG_SIZE;
+    }
+
+    return Address;
+}
+
+static uint16_t LogFRAMUsed(void) {
+    if (LogFRAMAddr >= LogFRAMTail) {
+        return LogFRAMAddr - LogFRAMTail;
+    } else {
+        return FRAM_LOG_SIZE - (LogFRAMTail - LogFRAMAddr);
+    }
+}
+
+static uint16_t LogFRAMFree(void) {
+    /* One byte stays unused to tell a full from an empty ring */
+    return FRAM_LOG_SIZE - 1 - LogFRAMUsed();
+}
+
+static void LogFRAMRead(void *Buffer, uint16_t Address, uint16_t ByteCount) {
+    uint16_t Contiguous = FRAM_LOG_START_ADDR + FRAM_LOG_SIZE - Address;
+
+    if (ByteCount > Contiguous) {
+        MemoryReadBlock(Buffer, Address, Contiguous);
+        MemoryReadBlock(Buffer + Contiguous, FRAM_LOG_START_ADDR, ByteCount - Contiguous);
+    } else {
+        MemoryReadBlock(Buffer, Address, ByteCount);
+    }
+}
+
+static void LogFRAMWrite(const void *Buffer, uint16_t Address, uint16_t ByteCount) {
+    uint16_t Contiguous = FRAM_LOG_START_ADDR + FRAM_LOG_SIZE - Address;
+
+    if (ByteCount > Contiguous) {
+        MemoryWriteBlock(Buffer, Address, Contiguous);
+        MemoryWriteBlock(Buffer + Contiguous, FRAM_LOG_START_ADDR, ByteCount - Contiguous);
+    } else {
+        MemoryWriteBlock(Buffer, Address, ByteCount);
+    }
+}
+
+static uint16_t LogFRAMEntrySize(uint16_t Address, bool *Compact) {
+    uint8_t Header[LOG_COMPACT_HEADER_MAX];
+    uint8_t Idx = 1;
+    uint16_t Length = 0;
+    uint8_t Shift = 0;
+
+    LogFRAMRead(Header, Address, sizeof(Header));
+
+    if (!*Compact || (Header[0] == LOG_INFO_COMPACT_BEGIN)) {
+        /* Regular format */
+        *Compact = (Header[0] == LOG_INFO_COMPACT_BEGIN);
+        return 4 + Header[1];
+    }
+
+    if (Header[0] == LOG_INFO_COMPACT_END) {
+        *Compact = false;
+    }
+
+    /* Skip the delta timestamp, then decode the length */
+    while ((Idx < sizeof(Header)) && (Header[Idx++] & 0x80))
+        ;
+
+    while (Idx < sizeof(Header)) {
+        Length |= (uint16_t)(Header[Idx] & 0x7F) << Shift;
+        Shift += 7;
+        if (!(Header[Idx++] & 0x80)) {
+            break;
+        }
+    }
+
+    return Idx + Length;
+}
+
+static void LogFRAMMakeRoom(uint16_t ByteCount) {
+    bool Compact = false;
+
+    if (LogFRAMFree() >= ByteCount) {
+        return;
+    }
+
+    /* Drop the oldest entries. The tail always points to an entry in the regular
+     * format, so a compact section is dropped as a whole. */
+    while ((LogFRAMFree() < ByteCount) || Compact) {
+        uint16_t EntrySize = LogFRAMEntrySize(LogFRAMTail, &Compact);
+
+        if (EntrySize >= LogFRAMUsed()) {
+            LogFRAMTail = LogFRAMAddr;
+            break;
+        }
+
+        LogFRAMTail = LogFRAMAdvance(LogFRAMTail, EntrySize);
+    }
+
+    MemoryWriteBlock(&LogFRAMTail, FRAM_LOG_TAIL_ADDR, 2);
+}
+
+INLINE void LogSRAMClear(void) {
+    uint16_t i, until = LOG_SIZE - LogMemLeft;
+
+    for (i = 0; i < until; i++) {
+        LogMem[i] = (uint8_t) LOG_EMPTY;
+    }
+
+    LogMemPtr = LogMem;
+    LogMemLeft = sizeof(LogMem);
+    LogMemFlushed = 0;
+}
+
+static uint16_t LogSRAMPending(void) {
+    return LOG_SIZE - LogMemLeft - LogMemFlushed;
+}
+
+static void LogSRAMDiscardFlushed(void) {
+    uint16_t Pending = LogSRAMPending();
+
+    memmove(LogMem, LogMem + LogMemFlushed, Pending);
+    memset(LogMem + Pending, LOG_EMPTY, LogMemFlushed);
+    LogMemPtr -= LogMemFlushed;
+    LogMemLeft += LogMemFlushed;
+    LogMemFlushed = 0;
+}
+
+static bool LogSRAMFlushChunk(uint16_t MaxByteCount) {
+    uint16_t ByteCount = MIN(LogSRAMPending(), MaxByteCount);
+
+    if (EnableLogFRAMRing) {
+        LogFRAMMakeRoom(ByteCount);
+    } else {
+        ByteCount = MIN(ByteCount, LogFRAMFree());
+    }
+
+    if (ByteCount == 0) {
+        return false;
+    }
+
+    LogFRAMWrite(&LogMem[LogMemFlushed], LogFRAMAddr, ByteCount);
+    LogFRAMAddr = LogFRAMAdvance(LogFRAMAddr, ByteCount);
+    LogMemFlushed += ByteCount;
+
+    if (LogSRAMPending() == 0) {
+        /* LogMem ends with a complete entry, so the FRAM log does as well.
+         * Only then the new end is made persistent. */
+        LogSRAMClear();
+        MemoryWriteBlock(&LogFRAMAddr, FRAM_LOG_ADDR_ADDR, 2);
+    }
+
+    return true;
+}
+
+static bool LogSRAMReserve(uint16_t ByteCount) {
+    /* Unless the FRAM log is a ring, an entry is only taken if it fits into the
+     * FRAM together with everything pending, so it never ends with a partial entry */
+    if (EnableLogSRAMtoFRAM && !EnableLogFRAMRing && (LogFRAMFree() < LogSRAMPending() + ByteCount)) {
+        return false;
+    }
+
+    return (LogMemLeft >= ByteCount);
+}
+
 static void LogFuncOff(LogEntryEnum Entry, const void *Data, uint8_t Length) {
     /* Do nothing */
 }
@@ -33,7 +207,7 @@ static void LogFuncOff(LogEntryEnum Entry, const void *Data, uint8_t Length) {
 static void LogFuncMemory(LogEntryEnum Entry, const void *Data, uint8_t Length) {
     uint16_t SysTick = SystemGetSysTick();
 
-    if (LogMemLeft >= (Length + 4)) {
+    if (LogSRAMReserve(Length + 4)) {
         LogMemLeft -= Length + 4;
 
         uint8_t *DataPtr = (uint8_t *) Data;
@@ -55,13 +229,117 @@ static void LogFuncMemory(LogEntryEnum Entry, const void *Data, uint8_t Length)
     }
 }
 
+/* Little endian base 128: 7 bits per byte, MSB set on all but the last byte */
+static uint8_t LogVarIntEncode(uint8_t *Buffer, uint16_t Value) {
+    uint8_t ByteCount = 0;
+
+    while (Value >= 0x80) {
+        Buffer[ByteCount++] = (uint8_t) Value | 0x80;
+        Value >>= 7;
+    }
+    Buffer[ByteCount++] = (uint8_t) Value;
+
+    return ByteCount;
+}
+
+static bool LogCompactAppend(LogEntryEnum Entry, uint16_t SysTick, const void *Data, uint8_t Length) {
+    uint8_t Header[LOG_COMPACT_HEADER_MAX];
+    uint8_t HeaderSize = 0;
+
+    /* Write down Entry Id, the systicks since the previous entry and Data length */
+    Header[HeaderSize++] = (uint8_t) Entry;
+    HeaderSize += LogVarIntEncode(&Header[HeaderSize], SysTick - LogCompactLastTick);
+    HeaderSize += LogVarIntEncode(&Header[HeaderSize], Length);
+
+    if (!LogSRAMReserve(HeaderSize + Length)) {
+        return false;
+    }
+
+    memcpy(LogMemPtr, Header, HeaderSize);
+    memcpy(LogMemPtr + HeaderSize, Data, Length);
+    LogMemPtr += HeaderSize + Length;
+    LogMemLeft -= HeaderSize + Length;
+    LogCompactLastTick = SysTick;
+
+    return true;
+}
+
+static void LogCompactBegin(void) {
+    uint16_t SysTick = SystemGetSysTick();
+
+    /* Regular entry, which switches the reader of the log to the compact format */
+    if (LogSRAMReserve(4)) {
+        LogMemLeft -= 4;
+        *LogMemPtr++ = (uint8_t) LOG_INFO_COMPACT_BEGIN;
+        *LogMemPtr++ = 0;
+        *LogMemPtr++ = (uint8_t)(SysTick >> 8);
+        *LogMemPtr++ = (uint8_t)(SysTick >> 0);
+    }
+
+    LogCompactLastTick = SysTick;
+}
+
+static void LogCompactSync(void) {
+    uint16_t SysTick = SystemGetSysTick();
+    uint8_t Data[2] = { (uint8_t)(SysTick >> 8), (uint8_t)(SysTick >> 0) };
+
+    LogCompactAppend(LOG_INFO_TIMESTAMP_SYNC, SysTick, Data, sizeof(Data));
+}
+
+static void LogFuncCompact(LogEntryEnum Entry, const void *Data, uint8_t Length) {
+    if (!LogCompactAppend(Entry, SystemGetSysTick(), Data, Length)) {
+        /* If memory full. Deactivate logmode */
+        LogSetModeById(LOG_MODE_OFF);
+        LEDHook(LED_LOG_MEM_FULL, LED_ON);
+    }
+}
+
 static void LogFuncLive(LogEntryEnum Entry, const void *Data, uint8_t Length) {
     uint16_t SysTick = SystemGetSysTick();
-    AtomicAppendLogBlock(Entry, SysTick, Data, Length);
+    LiveLogAppend(Entry, SysTick, (const uint8_t *) Data, Length);
+}
+
+static bool LogSniffAppend(LogEntryEnum Entry, uint16_t SysTick, const void *Data, uint8_t Length) {
+    uint8_t Header[LOG_COMPACT_HEADER_MAX];
+    uint8_t HeaderSize = 0;
+
+    /* Same record as in the compact log, but put into the live log ring */
+    Header[HeaderSize++] = (uint8_t) Entry;
+    HeaderSize += LogVarIntEncode(&Header[HeaderSize], SysTick - LogCompactLastTick);
+    HeaderSize += LogVarIntEncode(&Header[HeaderSize], Length);
+
+    if (!LiveLogAppendRecord(Header, HeaderSize, (const uint8_t *) Data, Length)) {
+        /* Dropped, the next delta stays relative to the last record sent */
+        return false;
+    }
+
+    LogCompactLastTick = SysTick;
+
+    return true;
+}
+
+static void LogSniffBegin(void) {
+    uint16_t SysTick = SystemGetSysTick();
+
+    /* Regular record, which switches the reader of the stream to the compact format */
+    LiveLogAppend(LOG_INFO_COMPACT_BEGIN, SysTick, NULL, 0);
+    LogCompactLastTick = SysTick;
+}
+
+static void LogFuncSniff(LogEntryEnum Entry, const void *Data, uint8_t Length) {
+    /* Only the frames go to the stream, so that the application entries
+     * do not take up room in the ring on a busy reader */
+    if ((Entry >= LOG_SNIFF_FIRST_ENTRY) && (Entry <= LOG_SNIFF_LAST_ENTRY)) {
+        LogSniffAppend(Entry, SystemGetSysTick(), Data, Length);
+    }
+}
+
+/* Whether LogMem holds the live log ring instead of the memory log */
+static bool LogRingActive(void) {
+    return (CurrentLogFunc == LogFuncLive) || (CurrentLogFunc == LogFuncSniff);
 }
 
 void LogInit(void) {
-    LogSetModeById(GlobalSettings.ActiveSettingPtr->LogMode);
     LogMemPtr = LogMem;
     LogMemLeft = sizeof(LogMem);
 
@@ -70,95 +348,126 @@ void LogInit(void) {
     memset(LogMemPtr, LOG_EMPTY, LOG_SIZE);
     if (result) {
         MemoryReadBlock(&LogFRAMAddr, FRAM_LOG_ADDR_ADDR, 2);
-    } else {
+        MemoryReadBlock(&LogFRAMTail, FRAM_LOG_TAIL_ADDR, 2);
+    }
+
+    if (!result ||
+            (LogFRAMAddr < FRAM_LOG_START_ADDR) || (LogFRAMAddr >= FRAM_LOG_START_ADDR + FRAM_LOG_SIZE) ||
+            (LogFRAMTail < FRAM_LOG_START_ADDR) || (LogFRAMTail >= FRAM_LOG_START_ADDR + FRAM_LOG_SIZE)) {
         LogFRAMAddr = FRAM_LOG_START_ADDR;
+        LogFRAMTail = FRAM_LOG_START_ADDR;
         MemoryWriteBlock(&LogFRAMAddr, FRAM_LOG_ADDR_ADDR, 2);
+        MemoryWriteBlock(&LogFRAMTail, FRAM_LOG_TAIL_ADDR, 2);
         result = true;
         WriteEEPBlock((uint16_t) &LogFRAMAddrValid, &result, 1);
     }
+
+    /* LogMem has to be set up before, since the live log ring reuses it */
+    LogSetModeById(GlobalSettings.ActiveSettingPtr->LogMode);
     LogEntry(LOG_INFO_SYSTEM_BOOT, NULL, 0);
 }
 
 void LogTick(void) {
-    /*
-     * The logging functionality slows down the timings of data exchanges between
-     *  Chameleon emulated tags and readers, so schedule the logging writes to
-     * happen only on intervals that will be outside of timing windows for individual xfers
-     * initiated from PICC <--> PCD (e.g., currently approximately every 600ms):
-     */
-    if (GlobalSettings.ActiveSettingPtr->LogMode == LOG_MODE_LIVE) {
-        if ((++LiveLogModePostTickCount % LIVE_LOGGER_POST_TICKS) == 0) {
-            AtomicLiveLogTick();
-            LiveLogModePostTickCount = 0;
-        }
-    } else if (EnableLogSRAMtoFRAM) {
+    if ((CurrentLogFunc == LogFuncCompact) &&
+            ((uint16_t)(SystemGetSysTick() - LogCompactLastTick) >= LOG_COMPACT_SYNC_INTERVAL)) {
+        LogCompactSync();
+    } else if ((CurrentLogFunc == LogFuncSniff) &&
+               ((uint16_t)(SystemGetSysTick() - LogCompactLastTick) >= LOG_COMPACT_SYNC_INTERVAL)) {
+        uint16_t SysTick = SystemGetSysTick();
+        uint8_t Data[2] = { (uint8_t)(SysTick >> 8), (uint8_t)(SysTick >> 0) };
+
+        LogSniffAppend(LOG_INFO_TIMESTAMP_SYNC, SysTick, Data, sizeof(Data));
+    }
+
+    if (EnableLogSRAMtoFRAM && (LogSRAMPending() > 0)) {
+        /* Whatever LogTask has not moved to FRAM yet, outside of the frame handling */
         LogSRAMToFRAM();
+        if (LogMemFlushed > 0) {
+            LogSRAMDiscardFlushed();
+        }
     }
 }
 
 void LogTask(void) {
+    /*
+     * The live log is drained in small chunks on every pass of the main loop,
+     * so that the USB transfers never add up to a delay noticeable by a reader
+     * waiting for the response to a frame.
+     */
+    if (LogRingActive()) {
+        LiveLogFlush(LIVE_LOG_FLUSH_CHUNK_SIZE);
+    } else if (EnableLogSRAMtoFRAM && (LogSRAMPending() > 0)) {
+        /* Same for moving the memory log from SRAM to FRAM */
+        LogSRAMFlushChunk(LOG_FRAM_FLUSH_CHUNK_SIZE);
+    }
+}
 
+static void LogSRAMRead(void *Buffer, uint16_t Offset, uint16_t ByteCount) {
+    if (LogRingActive()) {
+        /* LogMem holds the live log ring, which is not part of the memory log */
+        memset(Buffer, LOG_EMPTY, ByteCount);
+    } else {
+        memcpy(Buffer, LogMem + Offset, ByteCount);
+    }
 }
 
 bool LogMemLoadBlock(void *Buffer, uint32_t BlockAddress, uint16_t ByteCount) {
-    if (BlockAddress < sizeof(LogMem) + (LogFRAMAddr - FRAM_LOG_START_ADDR)) {
-        bool overflow = false;
-        uint16_t remainderByteCount = 0;
-        uint16_t SizeInFRAMStored = LogFRAMAddr - FRAM_LOG_START_ADDR;
-        // prevent buffer overflows:
-        if ((BlockAddress + ByteCount) >= sizeof(LogMem) + SizeInFRAMStored) {
-            overflow = true;
-            uint16_t tmp = sizeof(LogMem) + SizeInFRAMStored - BlockAddress;
-            remainderByteCount = ByteCount - tmp;
-            ByteCount = tmp;
-        }
+    uint16_t SizeInFRAMStored = LogFRAMUsed();
+    uint16_t LogByteCount = SizeInFRAMStored + sizeof(LogMem) - LogMemFlushed;
+    uint8_t *BufferPtr = (uint8_t *) Buffer;
 
-        /*
-         * 1. case: The whole block is in FRAM.
-         * 2. case: The block wraps from FRAM to SRAM
-         * 3. case: The whole block is in SRAM.
-         */
-        if (BlockAddress < SizeInFRAMStored && (BlockAddress + ByteCount) < SizeInFRAMStored) {
-            MemoryReadBlock(Buffer, BlockAddress + FRAM_LOG_START_ADDR, ByteCount);
-        } else if (BlockAddress < SizeInFRAMStored) {
-            uint16_t FramByteCount = SizeInFRAMStored - BlockAddress;
-            MemoryReadBlock(Buffer, BlockAddress + FRAM_LOG_START_ADDR, FramByteCount);
-            memcpy(Buffer + FramByteCount, LogMem, ByteCount - FramByteCount);
-        } else {
-            memcpy(Buffer, LogMem + BlockAddress - SizeInFRAMStored, ByteCount);
-        }
+    if (BlockAddress >= LogByteCount) {
+        return false;
+    }
 
-        if (overflow) {
-            while (remainderByteCount--)
-                ((uint8_t *) Buffer)[ByteCount + remainderByteCount] = 0x00;
-        }
+    /* The log consists of the FRAM ring from its tail, followed by the part of
+     * the SRAM which has not been moved to FRAM yet */
+    if (BlockAddress < SizeInFRAMStored) {
+        uint16_t FRAMByteCount = MIN(ByteCount, SizeInFRAMStored - BlockAddress);
 
-        return true;
-    } else {
-        return false;
+        LogFRAMRead(BufferPtr, LogFRAMAdvance(LogFRAMTail, BlockAddress), FRAMByteCount);
+        BufferPtr += FRAMByteCount;
+        BlockAddress += FRAMByteCount;
+        ByteCount -= FRAMByteCount;
     }
-}
 
-INLINE void LogSRAMClear(void) {
-    uint16_t i, until = LOG_SIZE - LogMemLeft;
+    if ((ByteCount > 0) && (BlockAddress < LogByteCount)) {
+        uint16_t SRAMByteCount = MIN(ByteCount, LogByteCount - BlockAddress);
 
-    for (i = 0; i < until; i++) {
-        LogMem[i] = (uint8_t) LOG_EMPTY;
+        LogSRAMRead(BufferPtr, LogMemFlushed + BlockAddress - SizeInFRAMStored, SRAMByteCount);
+        BufferPtr += SRAMByteCount;
+        ByteCount -= SRAMByteCount;
     }
 
-    LogMemPtr = LogMem;
-    LogMemLeft = sizeof(LogMem);
+    // prevent buffer overflows:
+    memset(BufferPtr, 0x00, ByteCount);
+
+    return true;
 }
 
 void LogMemClear(void) {
     LogSRAMClear();
     LogFRAMAddr = FRAM_LOG_START_ADDR;
+    LogFRAMTail = FRAM_LOG_START_ADDR;
     MemoryWriteBlock(&LogFRAMAddr, FRAM_LOG_ADDR_ADDR, 2);
+    MemoryWriteBlock(&LogFRAMTail, FRAM_LOG_TAIL_ADDR, 2);
     LEDHook(LED_LOG_MEM_FULL, LED_OFF);
+
+    if (CurrentLogFunc == LogFuncCompact) {
+        LogCompactBegin();
+    }
 }
 
 uint16_t LogMemFree(void) {
-    return LogMemLeft + FRAM_LOG_SIZE - LogFRAMAddr + FRAM_LOG_START_ADDR;
+    if (EnableLogSRAMtoFRAM && !EnableLogFRAMRing) {
+        /* See LogSRAMReserve() */
+        uint16_t FRAMFree = LogFRAMFree();
+        uint16_t Pending = LogSRAMPending();
+
+        return (FRAMFree > Pending) ? MIN(LogMemLeft, FRAMFree - Pending) : 0;
+    }
+
+    return LogMemLeft + LogFRAMFree();
 }
 
 
@@ -170,6 +479,36 @@ void LogSetModeById(LogModeEnum Mode) {
     }
 #endif
     GlobalSettings.ActiveSettingPtr->LogMode = Mode;
+
+    if ((Mode != LOG_MODE_COMPACT) && (CurrentLogFunc == LogFuncCompact)) {
+        /* Switch the reader of the log back to the regular format */
+        LogCompactAppend(LOG_INFO_COMPACT_END, SystemGetSysTick(), NULL, 0);
+    } else if ((Mode != LOG_MODE_SNIFF) && (CurrentLogFunc == LogFuncSniff)) {
+        /* Same for the stream, in case the live log continues it */
+        LogSniffAppend(LOG_INFO_COMPACT_END, SystemGetSysTick(), NULL, 0);
+    }
+
+    bool UsesRing = (Mode == LOG_MODE_LIVE) || (Mode == LOG_MODE_SNIFF);
+
+    if (UsesRing && !LogRingActive()) {
+        /* Save the memory log before LogMem is taken over by the live log ring */
+        if (EnableLogSRAMtoFRAM) {
+            LogSRAMToFRAM();
+        }
+        LogSRAMClear();
+        LiveLogReset();
+    } else if (!UsesRing && LogRingActive()) {
+        /* Send the rest of the stream, e.g. the COMPACT_END of the SNIFF mode,
+         * then leave an empty memory log behind */
+        LiveLogFlush(LOG_SIZE);
+        memset(LogMem, LOG_EMPTY, LOG_SIZE);
+        LogMemPtr = LogMem;
+        LogMemLeft = sizeof(LogMem);
+        LogMemFlushed = 0;
+    }
+
+    EnableLogFRAMRing = (Mode == LOG_MODE_CIRCULAR);
+
     switch (Mode) {
         case LOG_MODE_OFF:
             EnableLogSRAMtoFRAM = false;
@@ -177,6 +516,7 @@ void LogSetModeById(LogModeEnum Mode) {
             break;
 
         case LOG_MODE_MEMORY:
+        case LOG_MODE_CIRCULAR:
             EnableLogSRAMtoFRAM = true;
             CurrentLogFunc = LogFuncMemory;
             break;
@@ -186,6 +526,22 @@ void LogSetModeById(LogModeEnum Mode) {
             CurrentLogFunc = LogFuncLive;
             break;
 
+        case LOG_MODE_COMPACT:
+            if (CurrentLogFunc != LogFuncCompact) {
+                LogCompactBegin();
+            }
+            EnableLogSRAMtoFRAM = true;
+            CurrentLogFunc = LogFuncCompact;
+            break;
+
+        case LOG_MODE_SNIFF:
+            if (CurrentLogFunc != LogFuncSniff) {
+                LogSniffBegin();
+            }
+            EnableLogSRAMtoFRAM = false;
+            CurrentLogFunc = LogFuncSniff;
+            break;
+
         default:
             break;
     }
@@ -213,26 +569,13 @@ void LogGetModeList(char *List, uint16_t BufferSize) {
 }
 
 void LogSRAMToFRAM(void) {
-    if (LogMemLeft < LOG_SIZE) {
-        uint16_t FRAM_Free = FRAM_LOG_SIZE - (LogFRAMAddr - FRAM_LOG_START_ADDR);
-        if (FRAM_Free >= LOG_SIZE - LogMemLeft) {
-            MemoryWriteBlock(LogMem, LogFRAMAddr, LOG_SIZE - LogMemLeft);
-            LogFRAMAddr += LOG_SIZE - LogMemLeft;
-            LogSRAMClear();
-            MemoryWriteBlock(&LogFRAMAddr, FRAM_LOG_ADDR_ADDR, 2);
-        } else if (FRAM_Free > 0) {
-            // not everything fits in FRAM, simply write as much as possible to FRAM
-            MemoryWriteBlock(LogMem, LogFRAMAddr, FRAM_Free);
-            memmove(LogMem, LogMem + FRAM_Free, LOG_SIZE - FRAM_Free); // FRAM_Free is < LOG_SIZE - LogMemLeft and thus also < LOG_SIZE
-            LogMemPtr -= FRAM_Free;
-            LogMemLeft += FRAM_Free;
-            LogFRAMAddr += FRAM_Free;
-            MemoryWriteBlock(&LogFRAMAddr, FRAM_LOG_ADDR_ADDR, 2);
-        } else {
+    while (LogSRAMPending() > 0) {
+        if (!LogSRAMFlushChunk(LogSRAMPending())) {
             // TODO: handle the case in which the FRAM is full ???
             // Notify the user by repeatedly blinking the LED:
             LEDHook(LED_LOG_MEM_FULL, LED_BLINK_8X);
             LEDHook(LED_LOG_MEM_FULL, LED_BLINK_8X);
+            break;
         }
     }
 }
@@ -9,8 +9,26 @@
 #define LOG_SIZE	          2048
 #endif
 #define FRAM_LOG_ADDR_ADDR	0x4000 // start of the second half of FRAM
-#define FRAM_LOG_START_ADDR	0x4002 // directly after the address
-#define FRAM_LOG_SIZE		0x3FFE // the whole second half (minus the 2 Bytes of Address)
+#define FRAM_LOG_TAIL_ADDR	0x4002 // oldest entry, the FRAM log is a ring buffer
+#define FRAM_LOG_START_ADDR	0x4004 // directly after the addresses
+#define FRAM_LOG_SIZE		0x3FFC // the whole second half (minus the 4 Bytes of Addresses)
+
+/* Maximum number of bytes LogTask moves from SRAM to FRAM per call */
+#ifndef LOG_FRAM_FLUSH_CHUNK_SIZE
+#define LOG_FRAM_FLUSH_CHUNK_SIZE   64
+#endif
+
+/* In the compact format, a timestamp sync record is written by LogTick
+ * when no entry has been logged for this many systicks, so that the
+ * 16 bit deltas never wrap around */
+#define LOG_COMPACT_SYNC_INTERVAL   0x4000
+/* Entry type, 16 bit varint delta timestamp and 8 bit varint length */
+#define LOG_COMPACT_HEADER_MAX      (1 + 3 + 2)
+
+/* Range of the codec entry types, which are the only ones streamed in
+ * the SNIFF log mode */
+#define LOG_SNIFF_FIRST_ENTRY       LOG_INFO_CODEC_RX_DATA
+#define LOG_SNIFF_LAST_ENTRY        LOG_INFO_CODEC_TX_TIMESTAMP
 
 extern uint8_t LogMem[LOG_SIZE];
 extern uint8_t *LogMemPtr;
@@ -18,6 +36,11 @@ extern uint16_t LogMemLeft;
 
 /** Enum for log entry type. \note Every entry type has a specific integer value, which can be found in the source code. */
 typedef enum {
+    /* Compact log format */
+    LOG_INFO_TIMESTAMP_SYNC		           = 0x01, ///< Absolute systick inside a compact log section.
+    LOG_INFO_COMPACT_BEGIN		           = 0x02, ///< Start of a compact log section. Always written in the regular format.
+    LOG_INFO_COMPACT_END		           = 0x03, ///< End of a compact log section.
+
     /* Generic */
     LOG_INFO_GENERIC			           = 0x10, ///< Unspecific log entry.
     LOG_INFO_CONFIG_SET			           = 0x11, ///< Configuration change.
@@ -35,6 +58,8 @@ typedef enum {
     LOG_INFO_CODEC_SNI_CARD_DATA                   = 0x46, //< Sniffing codec receive data from card
     LOG_INFO_CODEC_SNI_CARD_DATA_W_PARITY          = 0x47, //< Sniffing codec receive data from card
     LOG_INFO_CODEC_READER_FIELD_DETECTED           = 0x48, ///< Add logging of the LEDHook case for FIELD_DETECTED
+    LOG_INFO_CODEC_RX_TIMESTAMP                    = 0x49, ///< Carrier cycle timestamp of the end of the preceding received frame.
+    LOG_INFO_CODEC_TX_TIMESTAMP                    = 0x4A, ///< Carrier cycle timestamp of the start of the preceding sent frame.
 
     /* App */
     LOG_INFO_APP_CMD_READ		           = 0x80, ///< Application processed read command.
@@ -68,7 +93,10 @@ typedef enum {
 typedef enum {
     LOG_MODE_OFF,
     LOG_MODE_MEMORY,
-    LOG_MODE_LIVE
+    LOG_MODE_LIVE,
+    LOG_MODE_COMPACT,
+    LOG_MODE_CIRCULAR,
+    LOG_MODE_SNIFF
 } LogModeEnum;
 
 typedef void (*LogFuncType)(LogEntryEnum Entry, const void *Data, uint8_t Length);
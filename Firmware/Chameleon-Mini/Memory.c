@@ -12,14 +12,23 @@
 #include "LEDHook.h"
 #include "System.h"
 
-#define USE_DMA
-#define RECV_DMA DMA.CH0
-#define SEND_DMA DMA.CH1
-
 /* Convert defines from Makefile */
 #define FLASH_DATA_START		FLASH_DATA_ADDR
 #define FLASH_DATA_END			(FLASH_DATA_ADDR + FLASH_DATA_SIZE - 1)
 
+#ifdef HOST_BUILD
+/* FRAM and flash are simulated in RAM when building for the host */
+#include "Host/HostMemory.h"
+
+void MemoryInit(void) {
+    HostMemoryInit();
+}
+#else
+
+#define USE_DMA
+#define RECV_DMA DMA.CH0
+#define SEND_DMA DMA.CH1
+
 /* Definitions for FRAM */
 #define FRAM_USART	USARTD0
 #define FRAM_PORT	PORTD
@@ -268,7 +277,7 @@ INLINE void FlashToFRAM(uint32_t Address, uint16_t ByteCount) {
     }
 }
 
-INLINE void FRAMToFlash(uint32_t Address, uint16_t ByteCount) {
+INLINE void FRAMToFlash(uint32_t Address, uint16_t FRAMAddress, uint16_t ByteCount) {
     /* We assume that FlashWrite is always called for write actions that are
      * aligned to APP_SECTION_PAGE_SIZE and a multiple of APP_SECTION_PAGE_SIZE.
      * Thus only full pages are written into the flash. */
@@ -281,8 +290,8 @@ INLINE void FRAMToFlash(uint32_t Address, uint16_t ByteCount) {
         FRAM_PORT.OUTCLR = FRAM_CS;
 
         SPITransferByte(0x03); /* Read command */
-        SPITransferByte(0); /* Address hi and lo byte */
-        SPITransferByte(0);
+        SPITransferByte((FRAMAddress >> 8) & 0xFF); /* Address hi and lo byte */
+        SPITransferByte((FRAMAddress >> 0) & 0xFF);
 
         while (PageCount-- > 0) {
             /* For each page to program, wait for NVM to get ready,
@@ -355,17 +364,243 @@ void MemoryInit(void) {
     SEND_DMA.DESTADDR2 = 0;
     SEND_DMA.CTRLA = DMA_CH_SINGLE_bm | DMA_CH_BURSTLEN_1BYTE_gc;
 }
+#endif /* HOST_BUILD */
+
+MemoryCacheStatsType MemoryCacheStats;
+MemoryStoreStatsType MemoryStoreStats;
+
+/* One bit per flash page of the memory image in FRAM that may differ from
+ * its copy in flash, so that MemoryStore() only has to rewrite those. After a
+ * reset all pages are dirty, since the FRAM keeps changes that have never
+ * been stored. */
+#define DIRTY_PAGES_SIZE	((MEMORY_PAGE_COUNT + 7) / 8)
+
+static uint8_t DirtyPages[DIRTY_PAGES_SIZE] = {
+    [0 ... DIRTY_PAGES_SIZE - 1] = 0xFF
+};
+
+INLINE bool PageIsDirty(uint8_t Page) {
+    return DirtyPages[Page / 8] & (1 << (Page % 8));
+}
+
+static void MarkPagesDirty(uint16_t Address, uint16_t ByteCount) {
+    if (Address >= MEMORY_SIZE_PER_SETTING) {
+        return;
+    }
+
+    uint16_t LastAddress = MIN((uint32_t) Address + ByteCount, MEMORY_SIZE_PER_SETTING) - 1;
+
+    for (uint8_t Page = Address / APP_SECTION_PAGE_SIZE; Page <= LastAddress / APP_SECTION_PAGE_SIZE; Page++) {
+        DirtyPages[Page / 8] |= 1 << (Page % 8);
+    }
+}
+
+#if MEMORY_CACHE_LINES > 0
+/* Direct mapped write-back cache in SRAM for the emulated memory image at the
+ * start of the FRAM. Each line is indexed by its FRAM address, so that e.g. the
+ * sector trailer and the data blocks of a MIFARE Classic sector never evict
+ * each other. Only accesses of at most one line inside the image are served
+ * from the cache. Larger accesses and everything outside of the image (e.g. the
+ * log) go straight to the FRAM, the cached lines are kept coherent with them.
+ * Modified lines are written back on MemoryStore(), i.e. also before switching
+ * the setting, on a periodic MemoryTick() and when VBUS is lost. */
+#define CACHE_TAG_INVALID	0xFFFF
+#define CACHE_OFFSET_MASK	(MEMORY_CACHE_LINE_SIZE - 1)
+#define CACHE_INDEX(Tag)	((Tag) & (MEMORY_CACHE_LINES - 1))
+
+typedef struct {
+    uint16_t Tag; /* FRAM address divided by MEMORY_CACHE_LINE_SIZE */
+    bool Dirty;
+    uint8_t Data[MEMORY_CACHE_LINE_SIZE];
+} CacheLineType;
+
+static CacheLineType CacheLines[MEMORY_CACHE_LINES] = {
+    [0 ... MEMORY_CACHE_LINES - 1] = { .Tag = CACHE_TAG_INVALID }
+};
+static uint8_t CacheDirtyCount = 0;
+
+static void CacheInvalidate(void) {
+    /* Drops all lines without writing them back */
+    for (uint8_t i = 0; i < MEMORY_CACHE_LINES; i++) {
+        CacheLines[i].Tag = CACHE_TAG_INVALID;
+        CacheLines[i].Dirty = false;
+    }
+
+    CacheDirtyCount = 0;
+}
+
+#ifdef HOST_BUILD
+void MemoryPowerLoss(void) {
+    /* The cache lines and the dirty page bits are kept in SRAM */
+    CacheInvalidate();
+    memset(DirtyPages, 0xFF, sizeof(DirtyPages));
+}
+#endif
+
+static void CacheWriteBack(CacheLineType *Line) {
+    if (Line->Dirty) {
+        FRAMWrite(Line->Data, Line->Tag * MEMORY_CACHE_LINE_SIZE, MEMORY_CACHE_LINE_SIZE);
+        Line->Dirty = false;
+        CacheDirtyCount--;
+        MemoryCacheStats.WriteBacks++;
+    }
+}
+
+static void CacheMerge(void *Buffer, uint16_t Address, uint16_t ByteCount, bool IntoCache) {
+    /* Copies the overlap of an uncached access with the cached lines either
+     * into the lines (after a write) or from modified lines (after a read) */
+    uint8_t *BufPtr = (uint8_t *) Buffer;
+    uint32_t End = (uint32_t) Address + ByteCount;
+
+    for (uint8_t i = 0; i < MEMORY_CACHE_LINES; i++) {
+        CacheLineType *Line = &CacheLines[i];
+
+        if ((Line->Tag == CACHE_TAG_INVALID) || (!IntoCache && !Line->Dirty)) {
+            continue;
+        }
+
+        uint32_t LineStart = (uint32_t) Line->Tag * MEMORY_CACHE_LINE_SIZE;
+        uint32_t From = MAX(LineStart, Address);
+        uint32_t To = MIN(LineStart + MEMORY_CACHE_LINE_SIZE, End);
+
+        if (From < To) {
+            if (IntoCache) {
+                memcpy(&Line->Data[From - LineStart], &BufPtr[From - Address], To - From);
+            } else {
+                memcpy(&BufPtr[From - Address], &Line->Data[From - LineStart], To - From);
+            }
+        }
+    }
+}
+
+INLINE bool CacheIsCacheable(uint16_t Address, uint16_t ByteCount) {
+    return (ByteCount <= MEMORY_CACHE_LINE_SIZE) && (Address <= MEMORY_SIZE_PER_SETTING - ByteCount);
+}
+
+static void CachedFRAMRead(void *Buffer, uint16_t Address, uint16_t ByteCount) {
+    uint8_t *BufPtr = (uint8_t *) Buffer;
+
+    if (!CacheIsCacheable(Address, ByteCount)) {
+        FRAMRead(Buffer, Address, ByteCount);
+
+        if ((Address < MEMORY_SIZE_PER_SETTING) && (CacheDirtyCount > 0)) {
+            CacheMerge(Buffer, Address, ByteCount, false);
+        }
+
+        return;
+    }
+
+    while (ByteCount > 0) {
+        uint16_t Tag = Address / MEMORY_CACHE_LINE_SIZE;
+        uint8_t Offset = Address & CACHE_OFFSET_MASK;
+        uint8_t Chunk = MIN(ByteCount, MEMORY_CACHE_LINE_SIZE - Offset);
+        CacheLineType *Line = &CacheLines[CACHE_INDEX(Tag)];
+
+        if (Line->Tag == Tag) {
+            MemoryCacheStats.Hits++;
+        } else {
+            /* Evict the previous line and fill in the requested one */
+            MemoryCacheStats.Misses++;
+            CacheWriteBack(Line);
+            FRAMRead(Line->Data, Tag * MEMORY_CACHE_LINE_SIZE, MEMORY_CACHE_LINE_SIZE);
+            Line->Tag = Tag;
+        }
+
+        memcpy(BufPtr, &Line->Data[Offset], Chunk);
+        BufPtr += Chunk;
+        Address += Chunk;
+        ByteCount -= Chunk;
+    }
+}
+
+static void CachedFRAMWrite(const void *Buffer, uint16_t Address, uint16_t ByteCount) {
+    const uint8_t *BufPtr = (const uint8_t *) Buffer;
+
+    if (!CacheIsCacheable(Address, ByteCount)) {
+        FRAMWrite(Buffer, Address, ByteCount);
+
+        if (Address < MEMORY_SIZE_PER_SETTING) {
+            CacheMerge((void *) Buffer, Address, ByteCount, true);
+        }
+
+        return;
+    }
+
+    while (ByteCount > 0) {
+        uint16_t Tag = Address / MEMORY_CACHE_LINE_SIZE;
+        uint8_t Offset = Address & CACHE_OFFSET_MASK;
+        uint8_t Chunk = MIN(ByteCount, MEMORY_CACHE_LINE_SIZE - Offset);
+        CacheLineType *Line = &CacheLines[CACHE_INDEX(Tag)];
+
+        if (Line->Tag == Tag) {
+            MemoryCacheStats.Hits++;
+        } else if (Chunk == MEMORY_CACHE_LINE_SIZE) {
+            /* A whole line is overwritten, so there is no need to fill it */
+            MemoryCacheStats.Misses++;
+            CacheWriteBack(Line);
+            Line->Tag = Tag;
+        } else {
+            /* Write around the cache rather than reading the line first */
+            MemoryCacheStats.Misses++;
+            FRAMWrite(BufPtr, Address, Chunk);
+            BufPtr += Chunk;
+            Address += Chunk;
+            ByteCount -= Chunk;
+            continue;
+        }
+
+        memcpy(&Line->Data[Offset], BufPtr, Chunk);
+
+        if (!Line->Dirty) {
+            Line->Dirty = true;
+            CacheDirtyCount++;
+        }
+
+        BufPtr += Chunk;
+        Address += Chunk;
+        ByteCount -= Chunk;
+    }
+}
+
+void MemoryCacheFlush(void) {
+    if (CacheDirtyCount == 0) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MEMORY_CACHE_LINES; i++) {
+        CacheWriteBack(&CacheLines[i]);
+    }
+}
+#else
+#define CacheInvalidate()
+#define CachedFRAMRead		FRAMRead
+#define CachedFRAMWrite		FRAMWrite
+
+void MemoryCacheFlush(void) {
+}
+#endif /* MEMORY_CACHE_LINES */
+
+void MemoryCacheResetStats(void) {
+    memset(&MemoryCacheStats, 0, sizeof(MemoryCacheStats));
+}
+
+void MemoryTick(void) {
+    /* There is no brown-out detection on the board, so bound the amount of
+     * data lost on a sudden power loss by writing back regularly */
+    MemoryCacheFlush();
+}
 
 void MemoryReadBlock(void *Buffer, uint16_t Address, uint16_t ByteCount) {
     if (ByteCount == 0)
         return;
-    FRAMRead(Buffer, Address, ByteCount);
+    CachedFRAMRead(Buffer, Address, ByteCount);
 }
 
 void MemoryWriteBlock(const void *Buffer, uint16_t Address, uint16_t ByteCount) {
     if (ByteCount == 0)
         return;
-    FRAMWrite(Buffer, Address, ByteCount);
+    CachedFRAMWrite(Buffer, Address, ByteCount);
+    MarkPagesDirty(Address, ByteCount);
     LEDHook(LED_MEMORY_CHANGED, LED_ON);
 }
 
@@ -375,7 +610,7 @@ void MemoryReadBlockInSetting(void *Buffer, uint16_t Address, uint16_t ByteCount
     uint16_t ShiftedAddress = Address + GlobalSettings.ActiveSettingIdx * MEMORY_SIZE_PER_SETTING;
     if (ShiftedAddress < Address)
         return;
-    FRAMRead(Buffer, ShiftedAddress, ByteCount);
+    CachedFRAMRead(Buffer, ShiftedAddress, ByteCount);
 }
 
 void MemoryWriteBlockInSetting(const void *Buffer, uint16_t Address, uint16_t ByteCount) {
@@ -384,7 +619,8 @@ void MemoryWriteBlockInSetting(const void *Buffer, uint16_t Address, uint16_t By
     uint16_t ShiftedAddress = Address + GlobalSettings.ActiveSettingIdx * MEMORY_SIZE_PER_SETTING;
     if (ShiftedAddress < Address)
         return;
-    FRAMWrite(Buffer, ShiftedAddress, ByteCount);
+    CachedFRAMWrite(Buffer, ShiftedAddress, ByteCount);
+    MarkPagesDirty(ShiftedAddress, ByteCount);
     LEDHook(LED_MEMORY_CHANGED, LED_ON);
 }
 
@@ -394,14 +630,44 @@ void MemoryClear(void) {
 }
 
 void MemoryRecall(void) {
-    /* Recall memory from permanent flash */
+    /* Recall memory from permanent flash, discarding any cached modifications */
     FlashToFRAM((uint32_t) GlobalSettings.ActiveSettingIdx * MEMORY_SIZE_PER_SETTING, MEMORY_SIZE_PER_SETTING);
+    CacheInvalidate();
+    memset(DirtyPages, 0, sizeof(DirtyPages));
     SystemTickClearFlag();
 }
 
 void MemoryStore(void) {
-    /* Store current memory into permanent flash */
-    FRAMToFlash((uint32_t) GlobalSettings.ActiveSettingIdx * MEMORY_SIZE_PER_SETTING, MEMORY_SIZE_PER_SETTING);
+    /* Store the modified pages of the current memory into permanent flash */
+    uint32_t FlashAddress = (uint32_t) GlobalSettings.ActiveSettingIdx * MEMORY_SIZE_PER_SETTING;
+    uint16_t StartTick = SystemGetSysTick();
+    uint8_t PagesWritten = 0;
+    uint8_t Page = 0;
+
+    MemoryCacheFlush();
+
+    while (Page < MEMORY_PAGE_COUNT) {
+        if (!PageIsDirty(Page)) {
+            Page++;
+            continue;
+        }
+
+        /* Program a run of consecutive dirty pages with a single FRAM read */
+        uint8_t FirstPage = Page;
+
+        while ((Page < MEMORY_PAGE_COUNT) && PageIsDirty(Page)) {
+            Page++;
+        }
+
+        FRAMToFlash(FlashAddress + (uint32_t) FirstPage * APP_SECTION_PAGE_SIZE,
+                    FirstPage * APP_SECTION_PAGE_SIZE, (Page - FirstPage) * APP_SECTION_PAGE_SIZE);
+        PagesWritten += Page - FirstPage;
+    }
+
+    memset(DirtyPages, 0, sizeof(DirtyPages));
+
+    MemoryStoreStats.PagesWritten = PagesWritten;
+    MemoryStoreStats.Milliseconds = SystemGetSysTick() - StartTick;
 
     LEDHook(LED_MEMORY_CHANGED, LED_OFF);
     LEDHook(LED_MEMORY_STORED, LED_PULSE);
@@ -409,6 +675,11 @@ void MemoryStore(void) {
     SystemTickClearFlag();
 }
 
+void MemoryStoreAll(void) {
+    memset(DirtyPages, 0xFF, sizeof(DirtyPages));
+    MemoryStore();
+}
+
 bool MemoryUploadBlock(void *Buffer, uint32_t BlockAddress, uint16_t ByteCount) {
     if (BlockAddress >= MEMORY_SIZE_PER_SETTING) {
         /* Prevent writing out of bounds by silently ignoring it */
@@ -419,7 +690,8 @@ bool MemoryUploadBlock(void *Buffer, uint32_t BlockAddress, uint16_t ByteCount)
         ByteCount = MIN(ByteCount, BytesLeft);
 
         /* Store to local memory */
-        FRAMWrite(Buffer, BlockAddress, ByteCount);
+        CachedFRAMWrite(Buffer, BlockAddress, ByteCount);
+        MarkPagesDirty(BlockAddress, ByteCount);
 
         return true;
     }
@@ -435,13 +707,14 @@ bool MemoryDownloadBlock(void *Buffer, uint32_t BlockAddress, uint16_t ByteCount
         ByteCount = MIN(ByteCount, BytesLeft);
 
         /* Output local memory contents */
-        FRAMRead(Buffer, BlockAddress, ByteCount);
+        CachedFRAMRead(Buffer, BlockAddress, ByteCount);
 
         return true;
     }
 }
 
 // EEPROM functions
+#ifndef HOST_BUILD
 
 static inline void NVM_EXEC(void) {
     void *z = (void *)&NVM_CTRLA;
@@ -535,3 +808,4 @@ uint16_t WriteEEPBlock(uint16_t Address, const void *SrcPtr, uint16_t ByteCount)
 
     return BytesWritten;
 }
+#endif /* HOST_BUILD */
@@ -12,10 +12,37 @@
 #define MEMORY_INIT_VALUE		0x00
 
 #define MEMORY_SIZE_PER_SETTING		8192
+#define MEMORY_PAGE_COUNT		(MEMORY_SIZE_PER_SETTING / APP_SECTION_PAGE_SIZE)
+
+/* Number of lines of the SRAM write-back cache in front of the FRAM (see
+ * Memory.c). Has to be a power of two, 0 disables the cache. */
+#ifndef MEMORY_CACHE_LINES
+#define MEMORY_CACHE_LINES		0
+#endif
+#define MEMORY_CACHE_LINE_SIZE		16
+
+#if (MEMORY_CACHE_LINES & (MEMORY_CACHE_LINES - 1)) != 0
+#error "MEMORY_CACHE_LINES has to be a power of two"
+#endif
 
 #ifndef __ASSEMBLER__
 #include "Common.h"
 
+typedef struct {
+    uint32_t Hits;
+    uint32_t Misses;
+    uint32_t WriteBacks;
+} MemoryCacheStatsType;
+
+extern MemoryCacheStatsType MemoryCacheStats;
+
+typedef struct {
+    uint8_t PagesWritten; /* Flash pages programmed by the last MemoryStore() */
+    uint16_t Milliseconds; /* Duration of the last MemoryStore() */
+} MemoryStoreStatsType;
+
+extern MemoryStoreStatsType MemoryStoreStats;
+
 void MemoryInit(void);
 void MemoryReadBlock(void *Buffer, uint16_t Address, uint16_t ByteCount);
 void MemoryWriteBlock(const void *Buffer, uint16_t Address, uint16_t ByteCount);
@@ -25,6 +52,19 @@ void MemoryClear(void);
 
 void MemoryRecall(void);
 void MemoryStore(void);
+/* Store every page, also those changed before the dirty page bits were
+ * cleared by the last recall or store */
+void MemoryStoreAll(void);
+
+/* Write back all modified cache lines to the FRAM */
+void MemoryCacheFlush(void);
+void MemoryCacheResetStats(void);
+void MemoryTick(void);
+
+#ifdef HOST_BUILD
+/* Forget everything that is lost with the power, as before a restart */
+void MemoryPowerLoss(void);
+#endif
 
 /* For use with XModem */
 bool MemoryUploadBlock(void *Buffer, uint32_t BlockAddress, uint16_t ByteCount);
@@ -176,6 +176,13 @@ const PROGMEM CommandEntryType CommandTable[] = {
         .SetFunc    = NO_FUNCTION,
         .GetFunc    = CommandGetLogMem
     },
+    {
+        .Command    = COMMAND_LIVELOGSTATS,
+        .ExecFunc   = NO_FUNCTION,
+        .ExecParamFunc = NO_FUNCTION,
+        .SetFunc    = NO_FUNCTION,
+        .GetFunc    = CommandGetLiveLogStats
+    },
     {
         .Command    = COMMAND_LOGDOWNLOAD,
         .ExecFunc   = CommandExecLogDownload,
@@ -225,6 +232,13 @@ const PROGMEM CommandEntryType CommandTable[] = {
         .SetFunc	= NO_FUNCTION,
         .GetFunc	= NO_FUNCTION
     },
+    {
+        .Command	= COMMAND_STORESTATS,
+        .ExecFunc	= NO_FUNCTION,
+        .ExecParamFunc = NO_FUNCTION,
+        .SetFunc	= NO_FUNCTION,
+        .GetFunc	= CommandGetStoreStats
+    },
     {
         .Command    = COMMAND_CHARGING,
         .ExecFunc   = NO_FUNCTION,
@@ -253,6 +267,15 @@ const PROGMEM CommandEntryType CommandTable[] = {
         .SetFunc 	= NO_FUNCTION,
         .GetFunc 	= CommandGetSysTick
     },
+#if MEMORY_CACHE_LINES > 0
+    {
+        .Command	= COMMAND_MEMCACHE,
+        .ExecFunc 	= CommandExecMemCache,
+        .ExecParamFunc = NO_FUNCTION,
+        .SetFunc 	= NO_FUNCTION,
+        .GetFunc 	= CommandGetMemCache
+    },
+#endif
 #ifdef CONFIG_ISO14443A_READER_SUPPORT
     {
         .Command	= COMMAND_SEND_RAW,
@@ -268,6 +291,13 @@ const PROGMEM CommandEntryType CommandTable[] = {
         .SetFunc 	= NO_FUNCTION,
         .GetFunc 	= NO_FUNCTION
     },
+    {
+        .Command	= COMMAND_SEND_BATCH,
+        .ExecFunc 	= NO_FUNCTION,
+        .ExecParamFunc = CommandExecParamSendBatch,
+        .SetFunc 	= NO_FUNCTION,
+        .GetFunc 	= NO_FUNCTION
+    },
     {
         .Command	= COMMAND_GETUID,
         .ExecFunc 	= CommandExecGetUid,
@@ -289,6 +319,20 @@ const PROGMEM CommandEntryType CommandTable[] = {
         .SetFunc 	= NO_FUNCTION,
         .GetFunc 	= NO_FUNCTION
     },
+    {
+        .Command	= COMMAND_DUMP_MFC,
+        .ExecFunc 	= CommandExecDumpMFC,
+        .ExecParamFunc = NO_FUNCTION,
+        .SetFunc 	= NO_FUNCTION,
+        .GetFunc 	= NO_FUNCTION
+    },
+    {
+        .Command	= COMMAND_CLONE_MFC,
+        .ExecFunc 	= CommandExecCloneMFC,
+        .ExecParamFunc = NO_FUNCTION,
+        .SetFunc 	= NO_FUNCTION,
+        .GetFunc 	= NO_FUNCTION
+    },
     {
         .Command	= COMMAND_IDENTIFY_CARD,
         .ExecFunc 	= CommandExecIdentifyCard,
@@ -343,7 +387,7 @@ const PROGMEM CommandEntryType CommandTable[] = {
         .GetFunc        = CommandGetAutoThreshold
     },
 #endif
-#ifdef ENABLE_RUNTESTS_TERMINAL_COMMAND
+#if defined(ENABLE_RUNTESTS_TERMINAL_COMMAND) || defined(ENABLE_FDT_BENCHMARK)
 #include "../Tests/ChameleonTerminalInclude.c"
 #endif
 #if defined(CONFIG_MF_DESFIRE_SUPPORT) && !defined(DISABLE_DESFIRE_TERMINAL_COMMANDS)
@@ -566,6 +610,10 @@ void CommandLinePendingTaskBreak(void) {
     Timeout();
 }
 
+void CommandLinePendingTaskRestartTimeout(void) {
+    TaskPendingSince = SystemGetSysTick();
+}
+
 void CommandLinePendingTaskFinished(CommandStatusIdType ReturnStatusID, char const *const OutMessage) {
     if (!TaskPending) // if no task is pending, no task can be finished
         return;
@@ -582,26 +630,17 @@ void CommandLinePendingTaskFinished(CommandStatusIdType ReturnStatusID, char con
 
 void CommandLineAppendData(void const *const Buffer, uint16_t Bytes) {
     char *pTerminalBuffer = (char *) TerminalBuffer;
+    uint8_t const *ByteBuffer = (uint8_t const *) Buffer;
 
-    uint16_t tmpBytes = Bytes;
-    if (Bytes > (TERMINAL_BUFFER_SIZE / 2))
-        tmpBytes = TERMINAL_BUFFER_SIZE / 2;
-    Bytes -= tmpBytes;
-
-    BufferToHexString(pTerminalBuffer, TERMINAL_BUFFER_SIZE, Buffer, tmpBytes);
-    TerminalSendString(pTerminalBuffer);
-
-    uint8_t i = 1;
-    while (Bytes > (TERMINAL_BUFFER_SIZE / 2)) {
-        Bytes -= TERMINAL_BUFFER_SIZE / 2;
-        BufferToHexString(pTerminalBuffer, TERMINAL_BUFFER_SIZE, Buffer + i * TERMINAL_BUFFER_SIZE / 2, TERMINAL_BUFFER_SIZE);
-        TerminalSendString(pTerminalBuffer);
-        i++;
-    }
+    /* BufferToHexString keeps one char of the buffer for the '\0', so a
+     * chunk has to be one byte shorter than half of the terminal buffer */
+    while (Bytes > 0) {
+        uint16_t ChunkBytes = MIN(Bytes, TERMINAL_BUFFER_SIZE / 2 - 1);
 
-    if (Bytes > 0) {
-        BufferToHexString(pTerminalBuffer, TERMINAL_BUFFER_SIZE, Buffer + i * TERMINAL_BUFFER_SIZE / 2, Bytes);
+        BufferToHexString(pTerminalBuffer, TERMINAL_BUFFER_SIZE, ByteBuffer, ChunkBytes);
         TerminalSendString(pTerminalBuffer);
+        ByteBuffer += ChunkBytes;
+        Bytes -= ChunkBytes;
     }
 
     TerminalSendStringP(PSTR(OPTIONAL_ANSWER_TRAILER));
@@ -22,5 +22,6 @@ void CommandLineAppendData(void const *const Buffer, uint16_t Bytes);
 void CommandLinePendingTaskFinished(CommandStatusIdType ReturnStatusID, char const *const OutMessage);  // must be called, when the intended task is finished
 extern void (*CommandLinePendingTaskTimeout)(void);  // gets called on timeout to end the pending task
 void CommandLinePendingTaskBreak(void); // this manually triggers a timeout
+void CommandLinePendingTaskRestartTimeout(void); // starts the timeout again, e.g. while a long task makes progress
 
 #endif /* COMMANDLINE_H_ */
@@ -334,6 +334,13 @@ CommandStatusIdType CommandGetLogMem(char *OutParam) {
     return COMMAND_INFO_OK_WITH_TEXT_ID;
 }
 
+CommandStatusIdType CommandGetLiveLogStats(char *OutParam) {
+    snprintf_P(OutParam, TERMINAL_BUFFER_SIZE, PSTR("DROPPED=%u OVERFLOWS=%u PENDING=%u"),
+               LiveLogStats.Dropped, LiveLogStats.Overflows, LiveLogPending());
+
+    return COMMAND_INFO_OK_WITH_TEXT_ID;
+}
+
 
 CommandStatusIdType CommandExecLogDownload(char *OutMessage) {
     XModemSend(LogMemLoadBlock);
@@ -378,6 +385,13 @@ CommandStatusIdType CommandExecRecall(char *OutMessage) {
     return COMMAND_INFO_OK_ID;
 }
 
+CommandStatusIdType CommandGetStoreStats(char *OutParam) {
+    snprintf_P(OutParam, TERMINAL_BUFFER_SIZE, PSTR("PAGES=%u/%u TIME=%u ms"),
+               MemoryStoreStats.PagesWritten, MEMORY_PAGE_COUNT, MemoryStoreStats.Milliseconds);
+
+    return COMMAND_INFO_OK_WITH_TEXT_ID;
+}
+
 CommandStatusIdType CommandGetCharging(char *OutMessage) {
     if (BatteryIsCharging()) {
         return COMMAND_INFO_TRUE_ID;
@@ -424,6 +438,22 @@ CommandStatusIdType CommandGetSysTick(char *OutParam) {
     return COMMAND_INFO_OK_WITH_TEXT_ID;
 }
 
+#if MEMORY_CACHE_LINES > 0
+CommandStatusIdType CommandExecMemCache(char *OutMessage) {
+    MemoryCacheFlush();
+    MemoryCacheResetStats();
+
+    return COMMAND_INFO_OK_ID;
+}
+
+CommandStatusIdType CommandGetMemCache(char *OutParam) {
+    snprintf_P(OutParam, TERMINAL_BUFFER_SIZE, PSTR("HITS=%lu MISSES=%lu WRITEBACKS=%lu"),
+               MemoryCacheStats.Hits, MemoryCacheStats.Misses, MemoryCacheStats.WriteBacks);
+
+    return COMMAND_INFO_OK_WITH_TEXT_ID;
+}
+#endif
+
 #ifdef CONFIG_ISO14443A_READER_SUPPORT
 CommandStatusIdType CommandExecParamSend(char *OutMessage, const char *InParams) {
 #ifndef CONFIG_ISO14443A_READER_SUPPORT
@@ -468,6 +498,34 @@ CommandStatusIdType CommandExecParamSend(char *OutMessage, const char *InParams)
 #endif
 }
 
+CommandStatusIdType CommandExecParamSendBatch(char *OutMessage, const char *InParams) {
+#ifndef CONFIG_ISO14443A_READER_SUPPORT
+    return COMMAND_ERR_INVALID_USAGE_ID;
+#else
+    if (GlobalSettings.ActiveSettingPtr->Configuration != CONFIG_ISO14443A_READER){
+        return COMMAND_ERR_INVALID_USAGE_ID;
+    }
+
+    if (strlen(InParams) > 2 * READER_BATCH_SCRIPT_SIZE) {
+        return COMMAND_ERR_INVALID_PARAM_ID;
+    }
+
+    ReaderBatchScriptSize = HexStringToBuffer(ReaderBatchScript, READER_BATCH_SCRIPT_SIZE, InParams);
+
+    if (!Reader14443ABatchCheck()) {
+        return COMMAND_ERR_INVALID_PARAM_ID;
+    }
+
+    ApplicationReset();
+    Reader14443ABatchStart();
+    Reader14443ACodecStart();
+
+    CommandLinePendingTaskTimeout = &Reader14443AAppTimeout;
+
+    return TIMEOUT_COMMAND;
+#endif
+}
+
 CommandStatusIdType CommandExecParamSendRaw(char *OutMessage, const char *InParams) {
 #ifndef CONFIG_ISO14443A_READER_SUPPORT
     return COMMAND_ERR_INVALID_USAGE_ID;
@@ -546,6 +604,38 @@ CommandStatusIdType CommandExecCloneMFU(char *OutMessage) {
 #endif
 }
 
+CommandStatusIdType CommandExecDumpMFC(char *OutMessage) {
+#ifndef CONFIG_ISO14443A_READER_SUPPORT
+    return COMMAND_ERR_INVALID_USAGE_ID;
+#else
+    if (GlobalSettings.ActiveSettingPtr->Configuration != CONFIG_ISO14443A_READER){
+        return COMMAND_ERR_INVALID_USAGE_ID;
+    }
+    ApplicationReset();
+
+    Reader14443CurrentCommand = Reader14443_Read_MF_Classic;
+    Reader14443AAppInit();
+    Reader14443ACodecStart();
+    CommandLinePendingTaskTimeout = &Reader14443AAppTimeout;
+    return TIMEOUT_COMMAND;
+#endif
+}
+
+CommandStatusIdType CommandExecCloneMFC(char *OutMessage) {
+#ifndef CONFIG_ISO14443A_READER_SUPPORT
+    return COMMAND_ERR_INVALID_USAGE_ID;
+#else
+    ConfigurationSetById(CONFIG_ISO14443A_READER, false);
+    ApplicationReset();
+
+    Reader14443CurrentCommand = Reader14443_Clone_MF_Classic;
+    Reader14443AAppInit();
+    Reader14443ACodecStart();
+    CommandLinePendingTaskTimeout = &Reader14443AAppTimeout;
+    return TIMEOUT_COMMAND;
+#endif
+}
+
 CommandStatusIdType CommandExecGetUid(char *OutMessage) { // this function is for reading the uid in reader mode
 #ifndef CONFIG_ISO14443A_READER_SUPPORT
     return COMMAND_ERR_INVALID_USAGE_ID;
@@ -623,6 +713,10 @@ CommandStatusIdType CommandSetField(char *OutMessage, const char *InParam) {
         snprintf_P(OutMessage, TERMINAL_BUFFER_SIZE, PSTR("%c,%c"), COMMAND_CHAR_TRUE, COMMAND_CHAR_FALSE);
         return COMMAND_INFO_OK_WITH_TEXT_ID;
     }
+    if (CodecTimestampIsRunning()) {
+        /* The reader timer counts the codec timestamps */
+        return COMMAND_ERR_INVALID_USAGE_ID;
+    }
     if (InParam[0] == COMMAND_CHAR_TRUE) {
         CodecReaderFieldStart();
     } else if (InParam[0] == COMMAND_CHAR_FALSE) {
@@ -4,6 +4,7 @@
 #define COMMANDS_H_
 
 #include "../Common.h"
+#include "../Memory.h"
 
 #define MAX_COMMAND_LENGTH          16
 #define MAX_STATUS_LENGTH           32
@@ -124,6 +125,9 @@ CommandStatusIdType CommandSetLogMode(char *OutMessage, const char *InParam);
 #define COMMAND_LOGMEM        "LOGMEM"
 CommandStatusIdType CommandGetLogMem(char *OutParam);
 
+#define COMMAND_LIVELOGSTATS  "LIVELOGSTATS"
+CommandStatusIdType CommandGetLiveLogStats(char *OutParam);
+
 #define COMMAND_LOGDOWNLOAD	"LOGDOWNLOAD"
 CommandStatusIdType CommandExecLogDownload(char *OutMessage);
 
@@ -146,6 +150,9 @@ CommandStatusIdType CommandExecStore(char *OutMessage);
 #define COMMAND_RECALL		"RECALL"
 CommandStatusIdType CommandExecRecall(char *OutMessage);
 
+#define COMMAND_STORESTATS	"STORESTATS"
+CommandStatusIdType CommandGetStoreStats(char *OutParam);
+
 #define COMMAND_CHARGING 	"CHARGING"
 CommandStatusIdType CommandGetCharging(char *OutParam);
 
@@ -158,12 +165,21 @@ CommandStatusIdType CommandGetRssi(char *OutParam);
 #define COMMAND_SYSTICK		"SYSTICK"
 CommandStatusIdType CommandGetSysTick(char *OutParam);
 
+#if MEMORY_CACHE_LINES > 0
+#define COMMAND_MEMCACHE	"MEMCACHE"
+CommandStatusIdType CommandExecMemCache(char *OutMessage);
+CommandStatusIdType CommandGetMemCache(char *OutParam);
+#endif
+
 #define COMMAND_SEND_RAW	     "SEND_RAW"
 CommandStatusIdType CommandExecParamSendRaw(char *OutMessage, const char *InParams);
 
 #define COMMAND_SEND		"SEND"
 CommandStatusIdType CommandExecParamSend(char *OutMessage, const char *InParams);
 
+#define COMMAND_SEND_BATCH	"SEND_BATCH"
+CommandStatusIdType CommandExecParamSendBatch(char *OutMessage, const char *InParams);
+
 #define COMMAND_GETUID		"GETUID"
 CommandStatusIdType CommandExecGetUid(char *OutMessage);
 
@@ -173,6 +189,12 @@ CommandStatusIdType CommandExecDumpMFU(char *OutMessage);
 #define COMMAND_CLONE_MFU	"CLONE_MFU"
 CommandStatusIdType CommandExecCloneMFU(char *OutMessage);
 
+#define COMMAND_DUMP_MFC	"DUMP_MFC"
+CommandStatusIdType CommandExecDumpMFC(char *OutMessage);
+
+#define COMMAND_CLONE_MFC	"CLONE_MFC"
+CommandStatusIdType CommandExecCloneMFC(char *OutMessage);
+
 #define COMMAND_IDENTIFY_CARD	"IDENTIFY"
 CommandStatusIdType CommandExecIdentifyCard(char *OutMessage);
 
@@ -200,7 +222,7 @@ CommandStatusIdType CommandGetAutoThreshold(char *OutParam);
 CommandStatusIdType CommandSetAutoThreshold(char *OutMessage, const char *InParam);
 #endif /*#ifdef CONFIG_ISO15693_SNIFF_SUPPORT*/
 
-#ifdef ENABLE_RUNTESTS_TERMINAL_COMMAND
+#if defined(ENABLE_RUNTESTS_TERMINAL_COMMAND) || defined(ENABLE_FDT_BENCHMARK)
 #include "../Tests/ChameleonTerminal.h"
 #endif
 
@@ -2,6 +2,7 @@
 #include "Terminal.h"
 #include "../System.h"
 #include "../LEDHook.h"
+#include "../Memory.h"
 
 #include "../LUFADescriptors.h"
 
@@ -14,11 +15,11 @@ USB_ClassInfo_CDC_Device_t TerminalHandle = {
         .DataINEndpoint = {
             .Address = CDC_TX_EPADDR,
             .Size = CDC_TXRX_EPSIZE,
-            .Banks = 1,
+            .Banks = CDC_TXRX_BANKS,
         }, .DataOUTEndpoint = {
             .Address = CDC_RX_EPADDR,
             .Size = CDC_TXRX_EPSIZE,
-            .Banks = 1,
+            .Banks = CDC_TXRX_BANKS,
         }, .NotificationEndpoint = {
             .Address = CDC_NOTIFICATION_EPADDR,
             .Size = CDC_NOTIFICATION_EPSIZE,
@@ -96,7 +97,9 @@ static void SenseVBus(void) {
 
         case TERMINAL_INITIALIZED:
             if (!(TERMINAL_VBUS_PORT.IN & TERMINAL_VBUS_MASK)) {
-                /* Initialized and VBUS sense low */
+                /* Initialized and VBUS sense low. Without a battery this is
+                 * the last chance to write back the memory cache. */
+                MemoryCacheFlush();
                 TerminalInitDelay = INIT_DELAY;
                 TerminalState = TERMINAL_UNITIALIZING;
             }
@@ -1,8 +1,11 @@
 #include "XModem.h"
 #include "Terminal.h"
+#include <util/crc16.h>
 
 #define BYTE_NAK        0x15
 #define BYTE_SOH        0x01
+#define BYTE_STX        0x02
+#define BYTE_CRC        'C'
 #define BYTE_ACK        0x06
 #define BYTE_CAN        0x18
 #define BYTE_EOF        0x1A
@@ -11,12 +14,19 @@
 
 #define XMODEM_BLOCK_SIZE   128
 
+/* XModem-1K frames are streamed from the callback in chunks through the
+ * terminal buffer, which is smaller than a frame */
+#define XMODEM_1K_BLOCK_SIZE    1024
+#define XMODEM_1K_CHUNK_SIZE    256
+#define XMODEM_1K_PAD_VALUE     0x00
+
 #define RECV_INIT_TIMEOUT   5  /* #Ticks between sending of NAKs to the sender */
 #define RECV_INIT_COUNT     60 /* #Timeouts until receive failure */
 #define SEND_INIT_TIMEOUT   300 /* #Ticks waiting for NAKs from the receiver before failure */
 
 #define FIRST_FRAME_NUMBER  1
 #define CHECKSUM_INIT_VALUE 0
+#define CRC_INIT_VALUE      0
 
 static enum {
     STATE_OFF,
@@ -38,6 +48,7 @@ static uint8_t RetryCount;
 static uint16_t RetryTimeout;
 static uint16_t BufferIdx;
 static uint32_t BlockAddress;
+static bool Use1K;
 
 static XModemCallbackType CallbackFunc;
 
@@ -52,6 +63,54 @@ static uint8_t CalcChecksum(const void *Buffer, uint16_t ByteCount) {
     return Checksum;
 }
 
+static uint16_t CalcCRC(uint16_t Crc16, const void *Buffer, uint16_t ByteCount) {
+    uint8_t *DataPtr = (uint8_t *) Buffer;
+
+    while (ByteCount--) {
+        Crc16 = _crc_xmodem_update(Crc16, *DataPtr++);
+    }
+
+    return Crc16;
+}
+
+static void SendFrame(void) {
+    TerminalSendByte(BYTE_SOH);
+    TerminalSendByte(CurrentFrameNumber);
+    TerminalSendByte(255 - CurrentFrameNumber);
+    TerminalSendBlock(TerminalBuffer, XMODEM_BLOCK_SIZE);
+    TerminalSendByte(CalcChecksum(TerminalBuffer, XMODEM_BLOCK_SIZE));
+}
+
+static bool SendFrame1K(uint32_t FrameAddress) {
+    /* Streams one XModem-1K frame with CRC16 straight from the callback to the
+     * terminal. Retransmissions simply read the data again. Returns false if
+     * there is no data left at FrameAddress. */
+    uint16_t Crc16 = CRC_INIT_VALUE;
+
+    if (!CallbackFunc(TerminalBuffer, FrameAddress, XMODEM_1K_CHUNK_SIZE)) {
+        return false;
+    }
+
+    TerminalSendByte(BYTE_STX);
+    TerminalSendByte(CurrentFrameNumber);
+    TerminalSendByte(255 - CurrentFrameNumber);
+
+    for (uint16_t Offset = 0; Offset < XMODEM_1K_BLOCK_SIZE; Offset += XMODEM_1K_CHUNK_SIZE) {
+        if ((Offset > 0) && !CallbackFunc(TerminalBuffer, FrameAddress + Offset, XMODEM_1K_CHUNK_SIZE)) {
+            /* Data ends within this frame. Pad it like LogMemLoadBlock does */
+            memset(TerminalBuffer, XMODEM_1K_PAD_VALUE, XMODEM_1K_CHUNK_SIZE);
+        }
+
+        Crc16 = CalcCRC(Crc16, TerminalBuffer, XMODEM_1K_CHUNK_SIZE);
+        TerminalSendBlock(TerminalBuffer, XMODEM_1K_CHUNK_SIZE);
+    }
+
+    TerminalSendByte((Crc16 >> 8) & 0xFF);
+    TerminalSendByte((Crc16 >> 0) & 0xFF);
+
+    return true;
+}
+
 void XModemReceive(XModemCallbackType TheCallbackFunc) {
     State = STATE_RECEIVE_INIT;
     CurrentFrameNumber = FIRST_FRAME_NUMBER;
@@ -157,9 +216,11 @@ bool XModemProcessByte(uint8_t Byte) {
             break;
 
         case STATE_SEND_INIT:
-            /* Start sending on NAK */
-            if (Byte == BYTE_NAK) {
+            /* Start sending on NAK, or on 'C' for XModem-1K with CRC16 */
+            if ((Byte == BYTE_NAK) || (Byte == BYTE_CRC)) {
                 CurrentFrameNumber = FIRST_FRAME_NUMBER - 1;
+                Use1K = (Byte == BYTE_CRC);
+                State = STATE_SEND_WAIT;
                 Byte = BYTE_ACK;
             } else if (Byte == BYTE_ESC) {
                 State = STATE_OFF;
@@ -172,17 +233,21 @@ bool XModemProcessByte(uint8_t Byte) {
                 /* Cancel */
                 TerminalSendByte(BYTE_ACK);
                 State = STATE_OFF;
+            } else if (Byte == BYTE_ESC) {
+                State = STATE_OFF;
             } else if (Byte == BYTE_ACK) {
                 /* Acknowledge. Proceed to next frame, get data and calc checksum */
                 CurrentFrameNumber++;
 
-                if (CallbackFunc(TerminalBuffer, BlockAddress, XMODEM_BLOCK_SIZE)) {
-                    TerminalSendByte(BYTE_SOH);
-                    TerminalSendByte(CurrentFrameNumber);
-                    TerminalSendByte(255 - CurrentFrameNumber);
-                    TerminalSendBlock(TerminalBuffer, XMODEM_BLOCK_SIZE);
-                    TerminalSendByte(CalcChecksum(TerminalBuffer, XMODEM_BLOCK_SIZE));
-
+                if (Use1K) {
+                    if (SendFrame1K(BlockAddress)) {
+                        BlockAddress += XMODEM_1K_BLOCK_SIZE;
+                    } else {
+                        TerminalSendByte(BYTE_EOT);
+                        State = STATE_SEND_EOT;
+                    }
+                } else if (CallbackFunc(TerminalBuffer, BlockAddress, XMODEM_BLOCK_SIZE)) {
+                    SendFrame();
                     BlockAddress += XMODEM_BLOCK_SIZE;
                 } else {
                     TerminalSendByte(BYTE_EOT);
@@ -190,11 +255,11 @@ bool XModemProcessByte(uint8_t Byte) {
                 }
             } else if (Byte == BYTE_NAK) {
                 /* Resend frame */
-                TerminalSendByte(BYTE_SOH);
-                TerminalSendByte(CurrentFrameNumber);
-                TerminalSendByte(255 - CurrentFrameNumber);
-                TerminalSendBlock(TerminalBuffer, XMODEM_BLOCK_SIZE);
-                TerminalSendByte(CalcChecksum(TerminalBuffer, XMODEM_BLOCK_SIZE));
+                if (Use1K) {
+                    SendFrame1K(BlockAddress - XMODEM_1K_BLOCK_SIZE);
+                } else {
+                    SendFrame();
+                }
             } else {
                 /* Ignore other chars */
             }
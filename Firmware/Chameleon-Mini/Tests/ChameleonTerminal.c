@@ -1,8 +1,9 @@
 /* ChameleonTerminal.c */
 
+#include "ChameleonTerminal.h"
+
 #ifdef ENABLE_RUNTESTS_TERMINAL_COMMAND
 
-#include "ChameleonTerminal.h"
 #include "CryptoTests.h"
 
 CommandStatusIdType CommandRunTests(char *OutParam) {
@@ -18,6 +19,10 @@ CommandStatusIdType CommandRunTests(char *OutParam) {
 #ifdef ENABLE_CRYPTO_AES_TESTS
         &CryptoAESTestCase1,
         &CryptoAESTestCase2,
+        &CryptoAESTestCase3,
+#endif
+#ifdef ENABLE_CRYPTO1_TESTS
+        &Crypto1TestCase1,
 #endif
 #endif
     };
@@ -47,3 +52,30 @@ CommandStatusIdType CommandRunTests(char *OutParam) {
 }
 
 #endif /* ENABLE_RUNTESTS_TERMINAL_COMMAND */
+
+#ifdef ENABLE_FDT_BENCHMARK
+
+#include "FDTBenchmark.h"
+
+/* FDTBENCH runs all traces, FDTBENCH=<TRACE> prints the cycles of every
+ * command of one trace and FDTBENCH=? lists the available traces. */
+CommandStatusIdType CommandExecFDTBenchmark(char *OutParam) {
+    FDTBenchmarkReportAll(OutParam, TERMINAL_BUFFER_SIZE);
+    return COMMAND_INFO_OK_WITH_TEXT_ID;
+}
+
+CommandStatusIdType CommandSetFDTBenchmark(char *OutParam, const char *InParam) {
+    uint8_t TraceIdx;
+
+    if (COMMAND_IS_SUGGEST_STRING(InParam)) {
+        FDTBenchmarkListTraces(OutParam, TERMINAL_BUFFER_SIZE);
+        return COMMAND_INFO_OK_WITH_TEXT_ID;
+    } else if (FDTBenchmarkFindTrace(InParam, &TraceIdx)) {
+        FDTBenchmarkReportTrace(TraceIdx, OutParam, TERMINAL_BUFFER_SIZE);
+        return COMMAND_INFO_OK_WITH_TEXT_ID;
+    } else {
+        return COMMAND_ERR_INVALID_PARAM_ID;
+    }
+}
+
+#endif /* ENABLE_FDT_BENCHMARK */
@@ -9,7 +9,15 @@
 
 typedef bool (*ChameleonTestType)(char *, uint16_t);
 
+#ifdef ENABLE_RUNTESTS_TERMINAL_COMMAND
 #define COMMAND_RUNTESTS                 "RUNTESTS"
 CommandStatusIdType CommandRunTests(char *OutParam);
+#endif
+
+#ifdef ENABLE_FDT_BENCHMARK
+#define COMMAND_FDTBENCH                 "FDTBENCH"
+CommandStatusIdType CommandExecFDTBenchmark(char *OutParam);
+CommandStatusIdType CommandSetFDTBenchmark(char *OutParam, const char *InParam);
+#endif
 
 #endif
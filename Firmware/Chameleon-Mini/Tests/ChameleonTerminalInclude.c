@@ -2,6 +2,7 @@
 
 #ifndef __TESTS_CHAMELEON_TERMINAL_INCLUDE_C__
 #define __TESTS_CHAMELEON_TERMINAL_INCLUDE_C__
+#ifdef ENABLE_RUNTESTS_TERMINAL_COMMAND
 {
     .Command        = COMMAND_RUNTESTS,
     .ExecFunc       = CommandRunTests,
@@ -10,3 +11,13 @@
     .GetFunc        = NO_FUNCTION
 },
 #endif
+#ifdef ENABLE_FDT_BENCHMARK
+{
+    .Command        = COMMAND_FDTBENCH,
+    .ExecFunc       = CommandExecFDTBenchmark,
+    .ExecParamFunc  = NO_FUNCTION,
+    .SetFunc        = CommandSetFDTBenchmark,
+    .GetFunc        = NO_FUNCTION
+},
+#endif
+#endif
@@ -158,15 +158,18 @@ bool CryptoAESTestCase2(char *OutParam, uint16_t MaxOutputLength) {
         0x76, 0x49, 0xAB, 0xAC, 0x81, 0x19, 0xB2, 0x46,
         0xCE, 0xE9, 0x8E, 0x9B, 0x12, 0xE9, 0x19, 0x7D
     };
-    const uint8_t IV[CRYPTO_AES_BLOCK_SIZE] = {
+    const uint8_t IVData[CRYPTO_AES_BLOCK_SIZE] = {
         0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
         0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
     };
+    // The CBC functions leave the chaining value in the IV:
+    uint8_t IV[CRYPTO_AES_BLOCK_SIZE];
     uint8_t tempBlock[CRYPTO_AES_BLOCK_SIZE];
     CryptoAESConfig_t aesContext;
     CryptoAESGetConfigDefaults(&aesContext);
     aesContext.OpMode = CRYPTO_AES_CBC_MODE;
     CryptoAESInitContext(&aesContext);
+    memcpy(IV, IVData, CRYPTO_AES_BLOCK_SIZE);
     CryptoAESEncryptBuffer(CRYPTO_AES_BLOCK_SIZE, PlainText, tempBlock, IV, KeyData);
     if (memcmp(tempBlock, CipherText, CRYPTO_AES_BLOCK_SIZE)) {
         strcat_P(OutParam, PSTR("> ENC: "));
@@ -175,6 +178,7 @@ bool CryptoAESTestCase2(char *OutParam, uint16_t MaxOutputLength) {
         strcat_P(OutParam, PSTR("\r\n"));
         return false;
     }
+    memcpy(IV, IVData, CRYPTO_AES_BLOCK_SIZE);
     CryptoAESDecryptBuffer(CRYPTO_AES_BLOCK_SIZE, tempBlock, CipherText, IV, KeyData);
     if (memcmp(tempBlock, PlainText, CRYPTO_AES_BLOCK_SIZE)) {
         strcat_P(OutParam, PSTR("> DEC: "));
@@ -185,6 +189,134 @@ bool CryptoAESTestCase2(char *OutParam, uint16_t MaxOutputLength) {
     }
     return true;
 }
+
+bool CryptoAESTestCase3(char *OutParam, uint16_t MaxOutputLength) {
+    // Example data taken from NIST SP 800-38A, F.2.1 CBC-AES128.Encrypt
+    const uint8_t KeyData[CRYPTO_AES_KEY_SIZE] = {
+        0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+        0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+    };
+    const uint8_t PlainText[4 * CRYPTO_AES_BLOCK_SIZE] = {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96,
+        0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C,
+        0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11,
+        0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17,
+        0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+    const uint8_t CipherText[4 * CRYPTO_AES_BLOCK_SIZE] = {
+        0x76, 0x49, 0xAB, 0xAC, 0x81, 0x19, 0xB2, 0x46,
+        0xCE, 0xE9, 0x8E, 0x9B, 0x12, 0xE9, 0x19, 0x7D,
+        0x50, 0x86, 0xCB, 0x9B, 0x50, 0x72, 0x19, 0xEE,
+        0x95, 0xDB, 0x11, 0x3A, 0x91, 0x76, 0x78, 0xB2,
+        0x73, 0xBE, 0xD6, 0xB8, 0xE3, 0xC1, 0x74, 0x3B,
+        0x71, 0x16, 0xE6, 0x9E, 0x22, 0x22, 0x95, 0x16,
+        0x3F, 0xF1, 0xCA, 0xA1, 0x68, 0x1F, 0xAC, 0x09,
+        0x12, 0x0E, 0xCA, 0x30, 0x75, 0x86, 0xE1, 0xA7
+    };
+    const uint8_t IVData[CRYPTO_AES_BLOCK_SIZE] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+    };
+    uint8_t IV[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t tempBuffer[4 * CRYPTO_AES_BLOCK_SIZE], paddedBuffer[2 * CRYPTO_AES_BLOCK_SIZE];
+    CryptoAESConfig_t aesContext;
+    CryptoAESGetConfigDefaults(&aesContext);
+    aesContext.OpMode = CRYPTO_AES_CBC_MODE;
+    CryptoAESInitContext(&aesContext);
+    memcpy(IV, IVData, CRYPTO_AES_BLOCK_SIZE);
+    if (CryptoAESEncryptBuffer(sizeof(PlainText), PlainText, tempBuffer, IV, KeyData) != CRYPTO_AES_EXIT_SUCCESS ||
+            memcmp(tempBuffer, CipherText, sizeof(CipherText))) {
+        strcat_P(OutParam, PSTR("> ENC: "));
+        OutParam += 7;
+        BufferToHexString(OutParam, MaxOutputLength - 7, tempBuffer, sizeof(tempBuffer));
+        strcat_P(OutParam, PSTR("\r\n"));
+        return false;
+    }
+    memcpy(IV, IVData, CRYPTO_AES_BLOCK_SIZE);
+    CryptoAESDecryptBuffer(sizeof(CipherText), tempBuffer, CipherText, IV, KeyData);
+    if (memcmp(tempBuffer, PlainText, sizeof(PlainText))) {
+        strcat_P(OutParam, PSTR("> DEC: "));
+        OutParam += 7;
+        BufferToHexString(OutParam, MaxOutputLength - 7, tempBuffer, sizeof(tempBuffer));
+        strcat_P(OutParam, PSTR("\r\n"));
+        return false;
+    }
+    // An uneven last block is encrypted as if it were padded with zeros:
+    memset(paddedBuffer, 0x00, sizeof(paddedBuffer));
+    memcpy(paddedBuffer, PlainText, CRYPTO_AES_BLOCK_SIZE + 4);
+    memcpy(IV, IVData, CRYPTO_AES_BLOCK_SIZE);
+    CryptoAESEncryptBuffer(sizeof(paddedBuffer), paddedBuffer, paddedBuffer, IV, KeyData);
+    memcpy(IV, IVData, CRYPTO_AES_BLOCK_SIZE);
+    if (CryptoAESEncryptBuffer(CRYPTO_AES_BLOCK_SIZE + 4, PlainText, tempBuffer, IV, KeyData) != CRYPTO_AES_EXIT_UNEVEN_BLOCKS ||
+            memcmp(tempBuffer, paddedBuffer, sizeof(paddedBuffer))) {
+        strcat_P(OutParam, PSTR("> PAD: "));
+        OutParam += 7;
+        BufferToHexString(OutParam, MaxOutputLength - 7, tempBuffer, sizeof(paddedBuffer));
+        strcat_P(OutParam, PSTR("\r\n"));
+        return false;
+    }
+    return true;
+}
+#endif
+
+#ifdef ENABLE_CRYPTO1_TESTS
+#include "../Codec/ISO14443-2A.h"
+
+// Expected results generated with the bitwise engine:
+bool Crypto1TestCase1(char *OutParam, uint16_t MaxOutputLength) {
+    uint8_t Key[6] = {
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5
+    };
+    uint8_t Uid[4] = {
+        0xDE, 0xAD, 0xBE, 0xEF
+    };
+    uint8_t ReaderNonce[4] = {
+        0x12, 0x34, 0x56, 0x78
+    };
+    const uint8_t CardNonce[4] = {
+        0x01, 0x20, 0x01, 0x45
+    };
+    const uint8_t EncryptedCardNonce[8] = {
+        0x3B, 0xCD, 0x5B, 0xE6, 0x01, 0x00, 0x01, 0x01
+    };
+    const uint8_t PlainAnswer[4] = {
+        0x55, 0xAA, 0x00, 0xFF
+    };
+    const uint8_t EncryptedAnswer[8] = {
+        0xD8, 0x12, 0x80, 0x1A, 0x01, 0x01, 0x00, 0x01
+    };
+    uint8_t Nonce[8];
+    uint8_t Buffer[ISO14443A_BUFFER_PARITY_OFFSET + sizeof(PlainAnswer)];
+    uint8_t Result[8];
+
+    memcpy(Nonce, CardNonce, sizeof(CardNonce));
+    Crypto1Setup(Key, Uid, Nonce);
+    Crypto1Auth(ReaderNonce);
+    memcpy(Buffer, PlainAnswer, sizeof(PlainAnswer));
+    Crypto1ByteArrayWithParity(Buffer, sizeof(PlainAnswer));
+    memcpy(Result, Buffer, sizeof(PlainAnswer));
+    memcpy(&Result[sizeof(PlainAnswer)], &Buffer[ISO14443A_BUFFER_PARITY_OFFSET], sizeof(PlainAnswer));
+    if (memcmp(Nonce, EncryptedCardNonce, sizeof(CardNonce)) || memcmp(Result, EncryptedAnswer, sizeof(Result))) {
+        strcat_P(OutParam, PSTR("> AUTH: "));
+        OutParam += 8;
+        BufferToHexString(OutParam, MaxOutputLength - 8, Result, sizeof(Result));
+        strcat_P(OutParam, PSTR("\r\n"));
+        return false;
+    }
+    memcpy(Nonce, CardNonce, sizeof(CardNonce));
+    Crypto1SetupNested(Key, Uid, Nonce, false);
+    if (memcmp(Nonce, EncryptedCardNonce, sizeof(EncryptedCardNonce))) {
+        strcat_P(OutParam, PSTR("> NESTED: "));
+        OutParam += 10;
+        BufferToHexString(OutParam, MaxOutputLength - 10, Nonce, sizeof(Nonce));
+        strcat_P(OutParam, PSTR("\r\n"));
+        return false;
+    }
+    return true;
+}
 #endif
 
 #endif /* ENABLE_CRYPTO_TESTS */
@@ -9,6 +9,7 @@
 #include "../Terminal/Terminal.h"
 #include "../Application/CryptoTDEA.h"
 #include "../Application/CryptoAES128.h"
+#include "../Application/Crypto1.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -40,6 +41,19 @@ bool CryptoAESTestCase1(char *OutParam, uint16_t MaxOutputLength);
  * Adapted from: https://github.com/eewiki/asf/blob/master/xmega/drivers/aes/example2/aes_example2.c
  */
 bool CryptoAESTestCase2(char *OutParam, uint16_t MaxOutputLength);
+
+/* Test AES-128 encrypt/decrypt for a four-block buffer (CBC mode, with an IV), and that an
+ * uneven last block is padded with zeros and reported as CRYPTO_AES_EXIT_UNEVEN_BLOCKS:
+ */
+bool CryptoAESTestCase3(char *OutParam, uint16_t MaxOutputLength);
+#endif
+
+/* Crypto1 test cases: */
+
+#ifdef ENABLE_CRYPTO1_TESTS
+/* Test Crypto1 (tag side) authentication, encrypted answer with parity bits and nested
+ * authentication, i.e., the functions of the engine selected by CRYPTO1_TABLE_ENGINE: */
+bool Crypto1TestCase1(char *OutParam, uint16_t MaxOutputLength);
 #endif
 
 #endif /* __CRYPTO_TESTS_H__ */
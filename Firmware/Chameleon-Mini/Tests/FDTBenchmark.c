@@ -0,0 +1,418 @@
+/* FDTBenchmark.c */
+
+#ifdef ENABLE_FDT_BENCHMARK
+
+#include "FDTBenchmark.h"
+#include "../Memory.h"
+#include "../Settings.h"
+#include "../Application/Application.h"
+#include "../Application/ISO14443-3A.h"
+
+#if defined(CONFIG_MF_CLASSIC_1K_SUPPORT) || defined(CONFIG_MF_CLASSIC_4K_SUPPORT)
+#include "../Application/Crypto1.h"
+#define FDT_BENCHMARK_MF_CLASSIC
+#endif
+
+#ifdef CONFIG_MF_DESFIRE_SUPPORT
+#include "../Application/DESFire/DESFireApplicationDirectory.h"
+#include "../Application/DESFire/DESFireCrypto.h"
+#include "../Application/DESFire/DESFireFile.h"
+#endif
+
+#ifdef HOST_BUILD
+#include "../Host/HostHardware.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <util/atomic.h>
+
+/* Low and high word of the cycle counter. Both timers are only used by the
+ * reader and the ISO15693 sniffer codecs, none of which are benchmarked. */
+#define FDT_BENCHMARK_TIMER_LOW         CODEC_TIMER_TIMESTAMPS
+#define FDT_BENCHMARK_TIMER_HIGH        CODEC_READER_TIMER
+#define FDT_BENCHMARK_TIMER_EVMUX       EVSYS_CHMUX_TCD1_OVF_gc
+#define FDT_BENCHMARK_TIMER_CLKSEL      TC_CLKSEL_EVCH7_gc
+
+/* All traces use this UID, or its first 4 bytes for single size UIDs:
+ * Single:  04 01 02 03, BCC 04
+ * Double:  CL1 88 04 01 02, BCC 8F / CL2 03 05 06 07, BCC 07 */
+static const uint8_t PROGMEM FDTBenchmarkUid[] = { 0x04, 0x01, 0x02, 0x03, 0x05, 0x06, 0x07 };
+
+#define FDT_BENCHMARK_STEP(_Name, _Flags, ...) { \
+    .Name = _Name, \
+    .Flags = _Flags, \
+    .BitCount = sizeof((uint8_t[]) { __VA_ARGS__ }) * BITS_PER_BYTE, \
+    .Data = { __VA_ARGS__ } \
+}
+
+#define FDT_BENCHMARK_STEP_SHORT(_Name, _Command) { \
+    .Name = _Name, \
+    .Flags = 0, \
+    .BitCount = 7, \
+    .Data = { _Command } \
+}
+
+#define FDT_BENCHMARK_TRACE(_Name, _Configuration, _Setup, _Steps) { \
+    .Name = _Name, \
+    .Configuration = _Configuration, \
+    .Setup = _Setup, \
+    .Steps = _Steps, \
+    .StepCount = ARRAY_COUNT(_Steps) \
+}
+
+#define FDT_BENCHMARK_ACTIVATE_SINGLE \
+    FDT_BENCHMARK_STEP_SHORT("REQA", 0x26), \
+    FDT_BENCHMARK_STEP("ANTICL1", 0, 0x93, 0x20), \
+    FDT_BENCHMARK_STEP("SELECT1", FDT_BENCHMARK_CRC, 0x93, 0x70, 0x04, 0x01, 0x02, 0x03, 0x04)
+
+#define FDT_BENCHMARK_ACTIVATE_DOUBLE \
+    FDT_BENCHMARK_STEP_SHORT("REQA", 0x26), \
+    FDT_BENCHMARK_STEP("ANTICL1", 0, 0x93, 0x20), \
+    FDT_BENCHMARK_STEP("SELECT1", FDT_BENCHMARK_CRC, 0x93, 0x70, 0x88, 0x04, 0x01, 0x02, 0x8F), \
+    FDT_BENCHMARK_STEP("ANTICL2", 0, 0x95, 0x20), \
+    FDT_BENCHMARK_STEP("SELECT2", FDT_BENCHMARK_CRC, 0x95, 0x70, 0x03, 0x05, 0x06, 0x07, 0x07)
+
+/* The reader side of the MIFARE Classic session does not need the key: the
+ * frames are encrypted with the Crypto1 state of the card, which is restored
+ * before the card decrypts them. With a reader nonce of 0, the encrypted
+ * reader nonce is plain keystream like any other encrypted frame. */
+#define FDT_BENCHMARK_MF_CLASSIC_SESSION(_Trailer, _Block) \
+    FDT_BENCHMARK_STEP("AUTH1", FDT_BENCHMARK_CRC, 0x60, _Trailer), \
+    FDT_BENCHMARK_STEP("AUTH2", FDT_BENCHMARK_MF_CLASSIC_ANSWER | FDT_BENCHMARK_ENCRYPT, \
+                       0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), \
+    FDT_BENCHMARK_STEP("READ", FDT_BENCHMARK_CRC | FDT_BENCHMARK_ENCRYPT, 0x30, _Block), \
+    FDT_BENCHMARK_STEP("WRITE1", FDT_BENCHMARK_CRC | FDT_BENCHMARK_ENCRYPT, 0xA0, _Block), \
+    FDT_BENCHMARK_STEP("WRITE2", FDT_BENCHMARK_CRC | FDT_BENCHMARK_ENCRYPT, \
+                       0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF), \
+    FDT_BENCHMARK_STEP("READ", FDT_BENCHMARK_CRC | FDT_BENCHMARK_ENCRYPT, 0x30, _Block), \
+    FDT_BENCHMARK_STEP("HALT", FDT_BENCHMARK_CRC | FDT_BENCHMARK_ENCRYPT | FDT_BENCHMARK_SILENT, 0x50, 0x00)
+
+#ifdef CONFIG_MF_CLASSIC_1K_SUPPORT
+/* Sector 1 */
+static const FDTBenchmarkStepType PROGMEM FDTBenchmarkMifareClassic1K[] = {
+    FDT_BENCHMARK_ACTIVATE_SINGLE,
+    FDT_BENCHMARK_MF_CLASSIC_SESSION(0x07, 0x05),
+};
+#endif
+
+#ifdef CONFIG_MF_CLASSIC_4K_SUPPORT
+/* Sector 39, the last of the 16 block sectors */
+static const FDTBenchmarkStepType PROGMEM FDTBenchmarkMifareClassic4K[] = {
+    FDT_BENCHMARK_ACTIVATE_SINGLE,
+    FDT_BENCHMARK_MF_CLASSIC_SESSION(0xFF, 0xF5),
+};
+#endif
+
+#ifdef CONFIG_MF_ULTRALIGHT_SUPPORT
+/* The memory of a freshly configured Ultralight C is blank, so AUTH0 protects
+ * every page and READ is answered with a NAK after the access check. The
+ * second authentication step fails the RndB check after both decryptions. */
+static const FDTBenchmarkStepType PROGMEM FDTBenchmarkMifareUltralightC[] = {
+    FDT_BENCHMARK_ACTIVATE_DOUBLE,
+    FDT_BENCHMARK_STEP("READ", FDT_BENCHMARK_CRC, 0x30, 0x00),
+    FDT_BENCHMARK_STEP("WRITE", FDT_BENCHMARK_CRC, 0xA2, 0x04, 0xDE, 0xAD, 0xBE, 0xEF),
+    FDT_BENCHMARK_STEP("AUTH1", FDT_BENCHMARK_CRC, 0x1A, 0x00),
+    FDT_BENCHMARK_STEP("AUTH2", FDT_BENCHMARK_CRC, 0xAF,
+                       0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                       0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF),
+};
+#endif
+
+#ifdef CONFIG_NTAG215_SUPPORT
+static const FDTBenchmarkStepType PROGMEM FDTBenchmarkNTAG215[] = {
+    FDT_BENCHMARK_ACTIVATE_DOUBLE,
+    FDT_BENCHMARK_STEP("GETVER", FDT_BENCHMARK_CRC, 0x60),
+    FDT_BENCHMARK_STEP("READ", FDT_BENCHMARK_CRC, 0x30, 0x00),
+    FDT_BENCHMARK_STEP("FASTRD", FDT_BENCHMARK_CRC, 0x3A, 0x00, 0x0F),
+    FDT_BENCHMARK_STEP("PWDAUTH", FDT_BENCHMARK_CRC, 0x1B, 0xFF, 0xFF, 0xFF, 0xFF),
+    FDT_BENCHMARK_STEP("WRITE", FDT_BENCHMARK_CRC, 0xA2, 0x10, 0xDE, 0xAD, 0xBE, 0xEF),
+};
+#endif
+
+#ifdef CONFIG_MF_DESFIRE_SUPPORT
+/* Native commands wrapped in ISO 7816-4 APDUs within I-blocks. The
+ * application and its file are created by FDTBenchmarkSetupDESFire(),
+ * since doing so through the trace would require the PICC master key. */
+static const FDTBenchmarkStepType PROGMEM FDTBenchmarkDESFire[] = {
+    FDT_BENCHMARK_ACTIVATE_DOUBLE,
+    FDT_BENCHMARK_STEP("RATS", FDT_BENCHMARK_CRC, 0xE0, 0x80),
+    FDT_BENCHMARK_STEP("AESAUTH", FDT_BENCHMARK_CRC | FDT_BENCHMARK_LAYER4,
+                       0x02, 0x90, 0xAA, 0x00, 0x00, 0x01, 0x00, 0x00),
+    /* Wrong response to the challenge, answered with an authentication error */
+    FDT_BENCHMARK_STEP("AESRESP", FDT_BENCHMARK_CRC | FDT_BENCHMARK_LAYER4,
+                       0x03, 0x90, 0xAF, 0x00, 0x00, 0x20,
+                       0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF,
+                       0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF,
+                       0x00),
+    FDT_BENCHMARK_STEP("SELAPP", FDT_BENCHMARK_CRC | FDT_BENCHMARK_LAYER4,
+                       0x02, 0x90, 0x5A, 0x00, 0x00, 0x03, 0x11, 0x22, 0x33, 0x00),
+    FDT_BENCHMARK_STEP("RDDATA", FDT_BENCHMARK_CRC | FDT_BENCHMARK_LAYER4,
+                       0x03, 0x90, 0xBD, 0x00, 0x00, 0x07, 0x01, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00),
+    FDT_BENCHMARK_STEP("FILEIDS", FDT_BENCHMARK_CRC | FDT_BENCHMARK_LAYER4,
+                       0x02, 0x90, 0x6F, 0x00, 0x00, 0x00),
+};
+
+static void FDTBenchmarkSetupDESFire(void) {
+    const DESFireAidType Aid = { 0x11, 0x22, 0x33 };
+
+    CreateApp(Aid, 1, 0x0F);
+    SelectApp(Aid);
+    CreateStandardFile(0x01, DESFIRE_COMMS_PLAINTEXT, 0xEEEE, 32);
+    SelectPiccApp();
+}
+#endif
+
+static const FDTBenchmarkTraceType PROGMEM FDTBenchmarkTraces[] = {
+#ifdef CONFIG_MF_CLASSIC_1K_SUPPORT
+    FDT_BENCHMARK_TRACE("MF_CLASSIC_1K", CONFIG_MF_CLASSIC_1K, NULL, FDTBenchmarkMifareClassic1K),
+#endif
+#ifdef CONFIG_MF_CLASSIC_4K_SUPPORT
+    FDT_BENCHMARK_TRACE("MF_CLASSIC_4K", CONFIG_MF_CLASSIC_4K, NULL, FDTBenchmarkMifareClassic4K),
+#endif
+#ifdef CONFIG_MF_ULTRALIGHT_SUPPORT
+    FDT_BENCHMARK_TRACE("MF_ULTRALIGHT_C", CONFIG_MF_ULTRALIGHT_C, NULL, FDTBenchmarkMifareUltralightC),
+#endif
+#ifdef CONFIG_NTAG215_SUPPORT
+    FDT_BENCHMARK_TRACE("NTAG215", CONFIG_NTAG215, NULL, FDTBenchmarkNTAG215),
+#endif
+#ifdef CONFIG_MF_DESFIRE_SUPPORT
+    FDT_BENCHMARK_TRACE("MF_DESFIRE", CONFIG_MF_DESFIRE, FDTBenchmarkSetupDESFire, FDTBenchmarkDESFire),
+#endif
+};
+
+#ifdef HOST_BUILD
+static uint64_t FDTBenchmarkStartTime;
+
+INLINE void FDTBenchmarkTimerStart(void) {
+    FDTBenchmarkStartTime = HostGetNanoseconds();
+}
+
+INLINE uint32_t FDTBenchmarkTimerStop(void) {
+    return (HostGetNanoseconds() - FDTBenchmarkStartTime) * (F_CPU / 1000000UL) / 1000;
+}
+#else
+INLINE void FDTBenchmarkTimerStart(void) {
+    FDT_BENCHMARK_TIMER_LOW.CTRLA = TC_CLKSEL_OFF_gc;
+    FDT_BENCHMARK_TIMER_HIGH.CTRLA = TC_CLKSEL_OFF_gc;
+    FDT_BENCHMARK_TIMER_LOW.PER = 0xFFFF;
+    FDT_BENCHMARK_TIMER_HIGH.PER = 0xFFFF;
+    FDT_BENCHMARK_TIMER_LOW.CNT = 0;
+    FDT_BENCHMARK_TIMER_HIGH.CNT = 0;
+
+    /* The high word counts the overflows of the low word */
+    EVSYS.CH7MUX = FDT_BENCHMARK_TIMER_EVMUX;
+    FDT_BENCHMARK_TIMER_HIGH.CTRLA = FDT_BENCHMARK_TIMER_CLKSEL;
+    FDT_BENCHMARK_TIMER_LOW.CTRLA = TC_CLKSEL_DIV1_gc;
+}
+
+INLINE uint32_t FDTBenchmarkTimerStop(void) {
+    FDT_BENCHMARK_TIMER_LOW.CTRLA = TC_CLKSEL_OFF_gc;
+
+    uint32_t Cycles = ((uint32_t) FDT_BENCHMARK_TIMER_HIGH.CNT << 16) | FDT_BENCHMARK_TIMER_LOW.CNT;
+
+    FDT_BENCHMARK_TIMER_HIGH.CTRLA = TC_CLKSEL_OFF_gc;
+    EVSYS.CH7MUX = EVSYS_CHMUX_OFF_gc;
+
+    return Cycles;
+}
+#endif
+
+static uint32_t FDTBenchmarkTimerOverhead(void) {
+    FDTBenchmarkTimerStart();
+    return FDTBenchmarkTimerStop();
+}
+
+uint8_t FDTBenchmarkGetTraceCount(void) {
+    return ARRAY_COUNT(FDTBenchmarkTraces);
+}
+
+bool FDTBenchmarkFindTrace(const char *Name, uint8_t *TraceIdx) {
+    for (uint8_t i = 0; i < ARRAY_COUNT(FDTBenchmarkTraces); i++) {
+        if (strcmp_P(Name, FDTBenchmarkTraces[i].Name) == 0) {
+            *TraceIdx = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FDTBenchmarkRunTrace(uint8_t TraceIdx, FDTBenchmarkResultType *Results, uint8_t *StepCount) {
+    FDTBenchmarkTraceType Trace;
+    FDTBenchmarkStepType Step;
+    ConfigurationUidType Uid;
+    ConfigurationEnum SavedConfiguration = GlobalSettings.ActiveSettingPtr->Configuration;
+#ifdef FDT_BENCHMARK_MF_CLASSIC
+    uint8_t CardNonce[4];
+#endif
+    bool Passed = true;
+
+    memcpy_P(&Trace, &FDTBenchmarkTraces[TraceIdx], sizeof(Trace));
+
+    /* The trace takes over the active setting, keep its memory like
+     * SettingsSetActiveById() does before switching to another setting */
+    MemoryStore();
+
+    /* Start from a freshly initialized card without a running codec */
+    ConfigurationSetById(Trace.Configuration, true);
+    CodecDeInit();
+
+    memcpy_P(Uid, FDTBenchmarkUid, ActiveConfiguration.UidSize);
+    ApplicationSetUid(Uid);
+
+    if (Trace.Setup != NULL) {
+        Trace.Setup();
+    }
+
+    ApplicationReset();
+
+    uint32_t Overhead = FDTBenchmarkTimerOverhead();
+
+    for (uint8_t i = 0; i < Trace.StepCount && i < FDT_BENCHMARK_STEPS_MAX; i++) {
+        uint16_t BitCount;
+        uint16_t AnswerBitCount;
+        uint32_t Cycles;
+
+        memcpy_P(&Step, &Trace.Steps[i], sizeof(Step));
+        memcpy(CodecBuffer, Step.Data, (Step.BitCount + 7) / 8);
+        BitCount = Step.BitCount;
+
+#ifdef FDT_BENCHMARK_MF_CLASSIC
+        if (Step.Flags & FDT_BENCHMARK_MF_CLASSIC_ANSWER) {
+            /* The card nonce is the plain answer of the previous step */
+            memcpy(&CodecBuffer[4], CardNonce, sizeof(CardNonce));
+            Crypto1PRNG(&CodecBuffer[4], 64);
+        }
+#endif
+
+        if (Step.Flags & FDT_BENCHMARK_CRC) {
+            ISO14443AAppendCRCA(CodecBuffer, BitCount / BITS_PER_BYTE);
+            BitCount += ISO14443A_CRCA_SIZE * BITS_PER_BYTE;
+        }
+
+#ifdef FDT_BENCHMARK_MF_CLASSIC
+        if (Step.Flags & FDT_BENCHMARK_ENCRYPT) {
+            uint8_t Even[3], Odd[3];
+
+            Crypto1GetState(Even, Odd);
+            Crypto1ByteArray(CodecBuffer, BitCount / BITS_PER_BYTE);
+            Crypto1SetState(Even, Odd);
+        }
+#endif
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            FDTBenchmarkTimerStart();
+            AnswerBitCount = ApplicationProcess(CodecBuffer, BitCount);
+            Cycles = FDTBenchmarkTimerStop();
+        }
+
+        AnswerBitCount &= ~ISO14443A_APP_CUSTOM_PARITY;
+#ifdef FDT_BENCHMARK_MF_CLASSIC
+        memcpy(CardNonce, CodecBuffer, sizeof(CardNonce));
+#endif
+
+        Results[i].Cycles = (Cycles > Overhead) ? Cycles - Overhead : 0;
+        Results[i].Budget = (Step.Flags & FDT_BENCHMARK_LAYER4) ? FDT_BENCHMARK_BUDGET_FWT : FDT_BENCHMARK_BUDGET_FDT;
+        Results[i].AnswerOk = (AnswerBitCount == ISO14443A_APP_NO_RESPONSE) == !!(Step.Flags & FDT_BENCHMARK_SILENT);
+
+        if (!Results[i].AnswerOk || Results[i].Cycles > Results[i].Budget) {
+            Passed = false;
+        }
+
+        *StepCount = i + 1;
+    }
+
+    /* Same as when switching to the active setting */
+    MemoryRecall();
+    ConfigurationSetById(SavedConfiguration, false);
+
+    return Passed;
+}
+
+void FDTBenchmarkListTraces(char *OutParam, uint16_t MaxOutputLength) {
+    char Name[CONFIGURATION_NAME_LENGTH_MAX];
+    uint16_t CharCount = 0;
+
+    OutParam[0] = '\0';
+
+    for (uint8_t i = 0; i < ARRAY_COUNT(FDTBenchmarkTraces) && CharCount < MaxOutputLength; i++) {
+        strncpy_P(Name, FDTBenchmarkTraces[i].Name, sizeof(Name));
+        CharCount += snprintf_P(&OutParam[CharCount], MaxOutputLength - CharCount,
+                                (i == 0) ? PSTR("%s") : PSTR(",%s"), Name);
+    }
+}
+
+bool FDTBenchmarkReportTrace(uint8_t TraceIdx, char *OutParam, uint16_t MaxOutputLength) {
+    FDTBenchmarkResultType Results[FDT_BENCHMARK_STEPS_MAX];
+    FDTBenchmarkStepType Step;
+    FDTBenchmarkTraceType Trace;
+    uint8_t StepCount = 0;
+    uint16_t CharCount;
+    bool Passed = FDTBenchmarkRunTrace(TraceIdx, Results, &StepCount);
+
+    memcpy_P(&Trace, &FDTBenchmarkTraces[TraceIdx], sizeof(Trace));
+
+    /* One line per command: name, cycles, budget (F)DT or (W)FT and the
+     * result, where '!' marks a missed deadline and '?' an unexpected answer */
+    CharCount = snprintf_P(OutParam, MaxOutputLength, PSTR("FDT %lu FWT %lu\r\n"),
+                           (unsigned long) FDT_BENCHMARK_BUDGET_FDT, (unsigned long) FDT_BENCHMARK_BUDGET_FWT);
+
+    for (uint8_t i = 0; i < StepCount && CharCount < MaxOutputLength; i++) {
+        memcpy_P(&Step, &Trace.Steps[i], sizeof(Step));
+        CharCount += snprintf_P(&OutParam[CharCount], MaxOutputLength - CharCount, PSTR("%-8s%8lu %c%c\r\n"),
+                                Step.Name, (unsigned long) Results[i].Cycles,
+                                (Step.Flags & FDT_BENCHMARK_LAYER4) ? 'W' : 'F',
+                                !Results[i].AnswerOk ? '?' : (Results[i].Cycles > Results[i].Budget) ? '!' : ' ');
+    }
+
+    if (CharCount < MaxOutputLength) {
+        snprintf_P(&OutParam[CharCount], MaxOutputLength - CharCount, Passed ? PSTR("PASSED") : PSTR("FAILED"));
+    }
+
+    return Passed;
+}
+
+bool FDTBenchmarkReportAll(char *OutParam, uint16_t MaxOutputLength) {
+    FDTBenchmarkResultType Results[FDT_BENCHMARK_STEPS_MAX];
+    char Name[CONFIGURATION_NAME_LENGTH_MAX];
+    uint16_t CharCount = 0;
+    uint8_t FailedCount = 0;
+
+    /* One line per trace with the slowest command that has to meet the FDT */
+    for (uint8_t t = 0; t < ARRAY_COUNT(FDTBenchmarkTraces); t++) {
+        uint8_t StepCount = 0;
+        uint32_t MaxCycles = 0;
+        bool Passed = FDTBenchmarkRunTrace(t, Results, &StepCount);
+
+        for (uint8_t i = 0; i < StepCount; i++) {
+            if (Results[i].Budget == FDT_BENCHMARK_BUDGET_FDT && Results[i].Cycles > MaxCycles) {
+                MaxCycles = Results[i].Cycles;
+            }
+        }
+
+        if (!Passed) {
+            FailedCount++;
+        }
+
+        if (CharCount < MaxOutputLength) {
+            strncpy_P(Name, FDTBenchmarkTraces[t].Name, sizeof(Name));
+            CharCount += snprintf_P(&OutParam[CharCount], MaxOutputLength - CharCount, PSTR("%-16s%6lu %s\r\n"),
+                                    Name, (unsigned long) MaxCycles, Passed ? "OK" : "FAIL");
+        }
+    }
+
+    if (CharCount < MaxOutputLength) {
+        if (FailedCount == 0) {
+            snprintf_P(&OutParam[CharCount], MaxOutputLength - CharCount, PSTR("All traces passed: %d / %d."),
+                       (int) ARRAY_COUNT(FDTBenchmarkTraces), (int) ARRAY_COUNT(FDTBenchmarkTraces));
+        } else {
+            snprintf_P(&OutParam[CharCount], MaxOutputLength - CharCount, PSTR("Traces failed: %d / %d."),
+                       FailedCount, (int) ARRAY_COUNT(FDTBenchmarkTraces));
+        }
+    }
+
+    return FailedCount == 0;
+}
+
+#endif /* ENABLE_FDT_BENCHMARK */
@@ -0,0 +1,89 @@
+/* FDTBenchmark.h */
+
+#ifdef ENABLE_FDT_BENCHMARK
+
+#ifndef __FDT_BENCHMARK_H__
+#define __FDT_BENCHMARK_H__
+
+#include "../Common.h"
+#include "../Configuration.h"
+#include "../Codec/Codec.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Replays canned reader traces against the applications and measures the
+ * CPU cycles spent in ApplicationProcess() for every reader command. The
+ * result is checked against the time the ISO14443A codec leaves to the
+ * application before it has to start the load modulation:
+ *
+ * - The answer is due ISO14443A_FRAME_DELAY_PREV0 carrier cycles after the
+ *   last pause of the reader. The codec detects the end of the frame three
+ *   half-bit samples (1.5 bit durations) after that pause and compensates
+ *   40 carrier cycles for its ISR prolog, which leaves the rest to the
+ *   application (FDT budget).
+ * - ISO14443-4 blocks only have to be answered within the frame waiting
+ *   time announced by the ATS (FWT budget).
+ *
+ * On the device, the cycles are counted exactly by cascading two timers
+ * that are clocked by the CPU clock. The host build estimates them from
+ * the elapsed time at F_CPU.
+ */
+
+#define FDT_BENCHMARK_CYCLES_PER_CARRIER    (F_CPU / 13560000UL)
+#define FDT_BENCHMARK_EOC_LATENCY           192 /* Carrier cycles, 1.5 bit durations */
+#define FDT_BENCHMARK_ISR_PROLOG            40  /* Carrier cycles, as compensated by the codec */
+#define FDT_BENCHMARK_BUDGET_FDT            ((uint32_t) (ISO14443A_FRAME_DELAY_PREV0 - FDT_BENCHMARK_ISR_PROLOG - FDT_BENCHMARK_EOC_LATENCY) \
+                                             * FDT_BENCHMARK_CYCLES_PER_CARRIER)
+#define FDT_BENCHMARK_FWI                   8   /* As announced in the TB byte of the DESFire ATS */
+#define FDT_BENCHMARK_BUDGET_FWT            (((uint32_t) 256 * 16 << FDT_BENCHMARK_FWI) * FDT_BENCHMARK_CYCLES_PER_CARRIER)
+
+#define FDT_BENCHMARK_NAME_LENGTH           8   /* Including the terminating '\0' */
+#define FDT_BENCHMARK_FRAME_SIZE            40  /* Bytes, without CRC */
+#define FDT_BENCHMARK_STEPS_MAX             12
+
+/* Flags of a benchmark step */
+#define FDT_BENCHMARK_CRC                   0x01 /* Append CRC_A to the frame */
+#define FDT_BENCHMARK_SILENT                0x02 /* The application is expected not to answer */
+#define FDT_BENCHMARK_LAYER4                0x04 /* ISO14443-4 block, checked against the FWT budget */
+#define FDT_BENCHMARK_ENCRYPT               0x08 /* Encrypt the frame with the Crypto1 session of the card */
+#define FDT_BENCHMARK_MF_CLASSIC_ANSWER     0x10 /* Reader nonce 0 and the answer to the card nonce of the previous step */
+
+typedef struct {
+    char Name[FDT_BENCHMARK_NAME_LENGTH];
+    uint8_t Flags;
+    uint16_t BitCount;
+    uint8_t Data[FDT_BENCHMARK_FRAME_SIZE];
+} FDTBenchmarkStepType;
+
+typedef struct {
+    char Name[CONFIGURATION_NAME_LENGTH_MAX];
+    ConfigurationEnum Configuration;
+    void (*Setup)(void);
+    const FDTBenchmarkStepType *Steps;
+    uint8_t StepCount;
+} FDTBenchmarkTraceType;
+
+typedef struct {
+    uint32_t Cycles;
+    uint32_t Budget;
+    bool AnswerOk;
+} FDTBenchmarkResultType;
+
+uint8_t FDTBenchmarkGetTraceCount(void);
+bool FDTBenchmarkFindTrace(const char *Name, uint8_t *TraceIdx);
+
+/* Runs a trace and fills in one result per step. The memory of the active
+ * setting is stored to flash before, like when switching to another setting,
+ * and recalled afterwards.
+ * Returns true if every command was answered as expected within its budget. */
+bool FDTBenchmarkRunTrace(uint8_t TraceIdx, FDTBenchmarkResultType *Results, uint8_t *StepCount);
+
+/* Helpers for the terminal command, see Tests/ChameleonTerminal.c */
+void FDTBenchmarkListTraces(char *OutParam, uint16_t MaxOutputLength);
+bool FDTBenchmarkReportTrace(uint8_t TraceIdx, char *OutParam, uint16_t MaxOutputLength);
+bool FDTBenchmarkReportAll(char *OutParam, uint16_t MaxOutputLength);
+
+#endif /* __FDT_BENCHMARK_H__ */
+
+#endif /* ENABLE_FDT_BENCHMARK */
@@ -16,6 +16,8 @@ class Device:
     COMMAND_GETUID = "GETUID"
     COMMAND_IDENTIFY = "IDENTIFY"
     COMMAND_DUMPMFU = "DUMP_MFU"
+    COMMAND_DUMPMFC = "DUMP_MFC"
+    COMMAND_SEND_BATCH = "SEND_BATCH"
     COMMAND_CONFIG = "CONFIG"
     COMMAND_LOG_DOWNLOAD = "LOGDOWNLOAD"
     COMMAND_LOG_CLEAR = "LOGCLEAR"
@@ -119,6 +121,11 @@ class Device:
     def isConnected(self):
         return self.serial.isOpen()
 
+    def openStream(self):
+        # Blocking reads for the endless log stream of the LIVE and SNIFF log modes
+        self.serial.timeout = None
+        return self.serial
+
     def read(self, size=1024, timeout=0.01):
         self.serial.timeout = timeout
         data = self.serial.read(size)
@@ -231,6 +238,14 @@ class Device:
     def cmdDumpMFU(self):
         return self.returnCmd(self.COMMAND_DUMPMFU)
 
+    def cmdDumpMFC(self):
+        return self.returnCmd(self.COMMAND_DUMPMFC)
+
+    def cmdSendBatch(self, script):
+        # Runs a frame script (bytes) in reader mode, the response holds
+        # the result records of all frames as one hex string
+        return self.execCmd(self.COMMAND_SEND_BATCH, script.hex().upper())
+
     def cmdConfig(self, newConfig = None):
         if (newConfig == self.SUGGEST_CHAR):
             return self.getCmdSuggestions(self.COMMAND_CONFIG)
@@ -5,6 +5,10 @@ import binascii
 import math
 import Chameleon.ISO14443 as iso14443_3
 
+# The codec timestamps count the cycles of the reader's carrier
+CARRIER_FREQUENCY = 13560000
+CARRIER_CYCLES_MAX = 1 << 32
+
 def checkParityBit(data):
     byteCount = len(data)
     # Short frame, no parityBit
@@ -54,8 +58,17 @@ def binaryParityDecoder(data):
     else:
         return binascii.hexlify(checkedData).decode()+"!"
 
+def carrierTimestampDecoder(data):
+    if (len(data) != 4):
+        return binaryDecoder(data)
+    cycles = struct.unpack('>I', data)[0]
+    return "{} ({:.1f} us)".format(cycles, cycles * 1000000.0 / CARRIER_FREQUENCY)
+
 eventTypes = {
     0x00: { 'name': 'EMPTY',          'decoder': noDecoder },
+    0x01: { 'name': 'TIMESTAMP SYNC', 'decoder': binaryDecoder },
+    0x02: { 'name': 'COMPACT BEGIN',  'decoder': noDecoder },
+    0x03: { 'name': 'COMPACT END',    'decoder': noDecoder },
     0x10: { 'name': 'GENERIC',        'decoder': textDecoder },
     0x11: { 'name': 'CONFIG SET',     'decoder': textDecoder },
     0x12: { 'name': 'SETTING SET',    'decoder': textDecoder },
@@ -72,6 +85,8 @@ eventTypes = {
     0x46: { 'name': 'CODEC RX SNI CARD',                    'decoder': binaryDecoder },
     0x47: { 'name': 'CODEC RX SNI CARD W/PARITY',           'decoder': binaryParityDecoder },
     0x48: { 'name': 'CODEC RX SNI READER FIELD DETECTED',   'decoder': noDecoder },
+    0x49: { 'name': 'CODEC RX TIMESTAMP',                   'decoder': carrierTimestampDecoder },
+    0x4A: { 'name': 'CODEC TX TIMESTAMP',                   'decoder': carrierTimestampDecoder },
    
     0x53: { 'name': 'ISO14443A (DESFIRE) STATE',       'decoder': binaryDecoder },
     0x54: { 'name': 'ISO144443-4 (DESFIRE) STATE',     'decoder': binaryDecoder },
@@ -122,46 +137,137 @@ eventTypes = {
 }
 
 TIMESTAMP_MAX = 65536
+EVENT_TIMESTAMP_SYNC = 0x01
+EVENT_COMPACT_BEGIN = 0x02
+EVENT_COMPACT_END = 0x03
+EVENT_CODEC_RX_TIMESTAMP = 0x49
+EVENT_CODEC_TX_TIMESTAMP = 0x4A
 eventTypes = { i : ({'name': f'UNKNOWN {hex(i)}', 'decoder': binaryDecoder} if i not in eventTypes.keys() else eventTypes[i]) for i in range(256) }
 
+def readVarInt(binaryStream):
+    # Little endian base 128, as written by the COMPACT log mode
+    value = 0
+    shift = 0
+
+    while True:
+        byte = binaryStream.read(1)
+
+        if (byte is None or len(byte) < 1):
+            return None
+
+        value |= (byte[0] & 0x7F) << shift
+        shift += 7
+
+        if (not byte[0] & 0x80):
+            return value
+
+def readRegularHeader(binaryStream, event=None):
+    # Entry type (unless already read), data length and absolute timestamp
+    if (event is None):
+        header = binaryStream.read(struct.calcsize('<BBH'))
+
+        if (header is None or len(header) < struct.calcsize('<BBH')):
+            return None
+
+        return struct.unpack_from('>BBH', header)
+
+    header = binaryStream.read(struct.calcsize('<BH'))
+
+    if (header is None or len(header) < struct.calcsize('<BH')):
+        return None
+
+    return (event,) + struct.unpack_from('>BH', header)
+
+def readCompactHeader(binaryStream):
+    # Entry type, delta timestamp and data length
+    event = binaryStream.read(1)
+
+    if (event is None or len(event) < 1):
+        return None
+
+    event = event[0]
+
+    if (event == EVENT_COMPACT_BEGIN):
+        # Always written in the regular format
+        header = readRegularHeader(binaryStream, event)
+        return None if header is None else header + (False,)
+
+    if (eventTypes[event]['name'] == 'EMPTY'):
+        return (event, 0, 0, True)
+
+    deltaTimestamp = readVarInt(binaryStream)
+    dataLength = readVarInt(binaryStream)
+
+    if (deltaTimestamp is None or dataLength is None):
+        return None
+
+    return (event, dataLength, deltaTimestamp, True)
+
 def parseBinary(binaryStream, decoder=None):
-    log = []
-    
-    # Completely read file contents and process them byte by byte
+    return list(iterBinary(binaryStream, decoder))
+
+def carrierCycleNote(text, cycles, lastCycles):
+    # Carrier cycles between two codec timestamps, respecting the 32 bit overflow
+    if (lastCycles is None):
+        return ""
+    delta = (cycles - lastCycles) % CARRIER_CYCLES_MAX
+    return "{} {} cycles ({:.1f} us)".format(text, delta, delta * 1000000.0 / CARRIER_FREQUENCY)
+
+def iterBinary(binaryStream, decoder=None):
+    # Yields the entries as they are read, which also works on the
+    # endless stream of the LIVE and SNIFF log modes
     # logFile = fileHandle.read()
     # fileIdx = 0
     lastTimestamp = 0
+    lastRxCycles = None
+    compact = False
     
     while True:
-        # Read log entry header from file
-        header = binaryStream.read(struct.calcsize('<BBH'))
+        # Read log entry header from file, which is either in the regular or
+        # (between COMPACT BEGIN and COMPACT END) in the compact format
+        header = readCompactHeader(binaryStream) if compact else readRegularHeader(binaryStream)
 
         if (header is None):
             # No more data available
             break
 
-        if (len(header) < struct.calcsize('<BBH')):
-            # No more data available
-            break
-        
-        (event, dataLength, timestamp) = struct.unpack_from('>BBH', header)
-    
+        if (compact):
+            (event, dataLength, value, isDelta) = header
+        else:
+            (event, dataLength, value) = header
+            isDelta = False
+
         # Break if there are no more events
         if (eventTypes[event]['name'] == 'EMPTY'):
             break
 
         # Read data from file
-        logData = binaryStream.read(dataLength)
+        rawData = binaryStream.read(dataLength)
 
         # Decode data
-        logData = eventTypes[event]['decoder'](logData)
+        logData = eventTypes[event]['decoder'](rawData)
         
-        # Calculate delta timestamp respecting 16 bit overflow
-        deltaTimestamp = timestamp - lastTimestamp
+        if (isDelta):
+            # Compact entries carry the systicks since the previous entry
+            deltaTimestamp = value
+            timestamp = (lastTimestamp + deltaTimestamp) % TIMESTAMP_MAX
+
+            if (event == EVENT_TIMESTAMP_SYNC and len(rawData) == 2):
+                timestamp = (rawData[0] << 8) | rawData[1]
+        else:
+            # Calculate delta timestamp respecting 16 bit overflow
+            timestamp = value
+            deltaTimestamp = timestamp - lastTimestamp
+
+            if (deltaTimestamp < 0):
+                deltaTimestamp += TIMESTAMP_MAX
+
         lastTimestamp = timestamp
-        
-        if (deltaTimestamp < 0):
-            deltaTimestamp += TIMESTAMP_MAX
+
+        if (event == EVENT_COMPACT_BEGIN):
+            compact = True
+        elif (event == EVENT_COMPACT_END):
+            compact = False
 
         note = ""
         # If we need to decode the data and paritybit check success
@@ -172,8 +278,20 @@ def parseBinary(binaryStream, decoder=None):
             elif (event == 0x46 or event == 0x47):
                 note = iso14443_3.parseCard(binascii.a2b_hex(logData), decoder)
 
-        # Create log entry as dict and append it to event list
+        carrierCycles = None
+        if ((event == EVENT_CODEC_RX_TIMESTAMP or event == EVENT_CODEC_TX_TIMESTAMP) and len(rawData) == 4):
+            # Period of the reader's frames and frame delay time of the responses
+            carrierCycles = struct.unpack('>I', rawData)[0]
+
+            if (event == EVENT_CODEC_RX_TIMESTAMP):
+                note = carrierCycleNote("since RX", carrierCycles, lastRxCycles)
+                lastRxCycles = carrierCycles
+            else:
+                note = carrierCycleNote("FDT", carrierCycles, lastRxCycles)
+
+        # Create log entry as dict and hand it out
         logEntry = {
+            'event': event,
             'eventName': eventTypes[event]['name'],
             'dataLength': dataLength,
             'timestamp': timestamp,
@@ -181,10 +299,11 @@ def parseBinary(binaryStream, decoder=None):
             'data': logData,
             'note': note
         }
-        
-        log.append(logEntry)
 
-    return log
+        if (carrierCycles is not None):
+            logEntry['carrierCycles'] = carrierCycles
+        
+        yield logEntry
 
 
         
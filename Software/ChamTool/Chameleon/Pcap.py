@@ -0,0 +1,66 @@
+#!/usr/bin/python
+#
+# Writes the frames of a Chameleon log as a pcap capture, which Wireshark
+# decodes with its ISO 14443 dissector (LINKTYPE_ISO_14443). Every packet
+# starts with the pseudo header of that link type: version, event and the
+# big endian length of the frame.
+
+import struct
+import binascii
+import time
+
+LINKTYPE_USER0 = 147
+LINKTYPE_ISO_14443 = 264
+
+PSEUDO_HEADER_VERSION = 0x00
+EVENT_PICC_TO_PCD = 0xFF
+EVENT_PCD_TO_PICC = 0xFE
+EVENT_FIELD_ON = 0xFC
+
+# Log entry type to direction of the frame
+frameEvents = {
+    0x40: EVENT_PCD_TO_PICC,    # CODEC RX
+    0x41: EVENT_PICC_TO_PCD,    # CODEC TX
+    0x42: EVENT_PCD_TO_PICC,    # CODEC RX W/PARITY
+    0x43: EVENT_PICC_TO_PCD,    # CODEC TX W/PARITY
+    0x44: EVENT_PCD_TO_PICC,    # CODEC RX SNI READER
+    0x45: EVENT_PCD_TO_PICC,    # CODEC RX SNI READER W/PARITY
+    0x46: EVENT_PICC_TO_PCD,    # CODEC RX SNI CARD
+    0x47: EVENT_PICC_TO_PCD,    # CODEC RX SNI CARD W/PARITY
+    0x48: EVENT_FIELD_ON,       # CODEC RX SNI READER FIELD DETECTED
+}
+
+class PcapWriter:
+    SNAPLEN = 65535
+
+    def __init__(self, fileHandle, linkType = LINKTYPE_ISO_14443, startTime = None):
+        self.fileHandle = fileHandle
+        # The log only has relative timestamps in systicks (about a millisecond)
+        self.startTime = time.time() if startTime is None else startTime
+        self.elapsed = 0
+        self.packetCount = 0
+
+        self.fileHandle.write(struct.pack('<IHHiIII', 0xA1B2C3D4, 2, 4, 0, 0, self.SNAPLEN, linkType))
+
+    def writeEntry(self, logEntry):
+        # Returns whether the entry has been written as a packet
+        self.elapsed += logEntry['deltaTimestamp']
+
+        if (logEntry['event'] not in frameEvents):
+            return False
+
+        # Hex of the data without parity bits, '!' marks a parity error
+        # in which case the raw bits are kept
+        frame = binascii.a2b_hex(logEntry['data'].rstrip('!'))
+        packet = struct.pack('>BBH', PSEUDO_HEADER_VERSION, frameEvents[logEntry['event']], len(frame)) + frame
+
+        timestamp = self.startTime + self.elapsed / 1000.0
+        seconds = int(timestamp)
+        microseconds = int((timestamp - seconds) * 1000000)
+
+        self.fileHandle.write(struct.pack('<IIII', seconds, microseconds, len(packet), len(packet)))
+        self.fileHandle.write(packet)
+        self.fileHandle.flush()
+        self.packetCount += 1
+
+        return True
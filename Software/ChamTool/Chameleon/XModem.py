@@ -3,16 +3,26 @@
 # Very lightweight implementation of XModem for Chameleon purposes
 # Because the Chameleon uses a CDC over USB, we don't expect any
 # retransmissions at all and thus don't implement it
+#
+# Downloads request XModem-1K with CRC16 by sending 'C', which cuts the
+# number of ACK round trips by a factor of eight. Firmware without support
+# for it does not answer, in which case we fall back to plain XModem.
 
 import io
 import time
+import binascii
 
 class XModem:
     BYTE_SOH = b'\x01'
+    BYTE_STX = b'\x02'
     BYTE_NAK = b'\x15'
     BYTE_ACK = b'\x06'
     BYTE_EOT = b'\x04'
-    
+    BYTE_CRC = b'C'
+
+    CRC_REQUEST_TIMEOUT = 1.0
+    CRC_REQUEST_RETRIES = 3
+
     def __init__(self, ioStream, verboseFunc = None):
         self.ioStream = ioStream
         self.verboseFunc = verboseFunc
@@ -20,39 +30,69 @@ class XModem:
     def verboseLog(self, text):
         if (self.verboseFunc):
             self.verboseFunc(text)
-            
-    def recvData(self, dataStream):
+
+    def startReception(self, useCRC):
+        # Returns the first packet id and whether CRC mode has been accepted
+        if (not useCRC or not hasattr(self.ioStream, 'timeout')):
+            self.ioStream.write(self.BYTE_NAK)
+            return self.ioStream.read(1), False
+
+        oldTimeout = self.ioStream.timeout
+        self.ioStream.timeout = self.CRC_REQUEST_TIMEOUT
+
+        try:
+            for i in range(self.CRC_REQUEST_RETRIES):
+                self.ioStream.write(self.BYTE_CRC)
+                pktId = self.ioStream.read(1)
+
+                if (len(pktId) > 0):
+                    return pktId, True
+        finally:
+            self.ioStream.timeout = oldTimeout
+
+        self.verboseLog("No answer to CRC request, falling back to checksum mode")
+        self.ioStream.write(self.BYTE_NAK)
+        return self.ioStream.read(1), False
+
+    def recvData(self, dataStream, useCRC = True):
         packetCounter = 1
         bytesReceived = 0
         startTime = time.time()
-        
+
         self.verboseLog("Starting XMODEM Reception")
-            
-        # Start transmission by issuing a NAK
-        self.ioStream.write(self.BYTE_NAK)
-        
-        while True:
-            pktId = self.ioStream.read(1)
 
-            if (pktId == self.BYTE_SOH):
+        # Start transmission by issuing a 'C' (XModem-1K with CRC) or a NAK
+        pktId, crcMode = self.startReception(useCRC)
+
+        while True:
+            if (pktId == self.BYTE_SOH or pktId == self.BYTE_STX):
+                blockSize = 1024 if (pktId == self.BYTE_STX) else 128
                 currentPacket = self.ioStream.read(2)
+                dataBlock = self.ioStream.read(blockSize)
+
+                if (crcMode):
+                    checksum = self.ioStream.read(2)
+                    valid = (len(checksum) == 2) and (binascii.crc_hqx(dataBlock, 0) == (checksum[0] << 8 | checksum[1]))
+                else:
+                    checksum = self.ioStream.read(1)
+                    valid = (len(checksum) == 1) and (int(checksum[0]) == (sum(dataBlock) % 256))
 
-                if (currentPacket[0] == (255 - currentPacket[1])):
+                if (len(currentPacket) == 2 and currentPacket[0] == (255 - currentPacket[1])):
                     #frame number intact
                     if (currentPacket[0] == packetCounter):
                         #In order packet
-                        dataBlock = self.ioStream.read(128)
-                        checksum = self.ioStream.read(1)
-                        
-                        if (int(checksum[0]) == (sum(dataBlock) % 256)):
+                        if (valid and len(dataBlock) == blockSize):
                             # checksum correct
                             dataStream.write(dataBlock)
                             dataStream.flush()
                             packetCounter = (packetCounter + 1) % 256
-                            bytesReceived += 128
+                            bytesReceived += blockSize
                             self.ioStream.write(self.BYTE_ACK)
                         else:
                             self.ioStream.write(self.BYTE_NAK)
+                    elif (currentPacket[0] == (packetCounter - 1) % 256):
+                        # Retransmission of a packet we already have
+                        self.ioStream.write(self.BYTE_ACK)
             elif (pktId == self.BYTE_EOT):
                 # Transmission done
                 self.ioStream.write(self.BYTE_ACK)
@@ -61,9 +101,11 @@ class XModem:
                 # Unknown pktId
                 break
 
+            pktId = self.ioStream.read(1)
+
         deltaTime = time.time() - startTime
         self.verboseLog("{} Bytes received in {:.2f} sec. ({:.0f} B/s)".format(bytesReceived, deltaTime, bytesReceived/deltaTime))
-                
+
         return bytesReceived
        
     def sendData(self, dataStream):
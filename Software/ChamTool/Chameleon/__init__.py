@@ -1,5 +1,6 @@
 # Import modules
 import Chameleon.Log
+import Chameleon.Pcap
 
 # Import classes
 from Chameleon.Device import Device
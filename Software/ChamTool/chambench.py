@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+#
+# Command line tool to measure the throughput of the Chameleon's USB link
+# through the transfers that depend on it: command round trips, dump and
+# log downloads and, optionally, dump uploads. The upload writes back the
+# dump just downloaded, so that the card memory is left unchanged.
+
+import argparse
+import Chameleon
+import sys
+import io
+import time
+import datetime
+import statistics
+
+def verboseLog(text):
+    formatString = "[{}] {}"
+    timeString = datetime.datetime.utcnow()
+    print(formatString.format(timeString, text), file=sys.stderr)
+
+def measure(func, rounds):
+    # Returns the number of bytes per round and the time of each round
+    byteCount = None
+    times = []
+
+    for i in range(rounds):
+        startTime = time.perf_counter()
+        result = func()
+        times.append(time.perf_counter() - startTime)
+
+        if (result is None):
+            return None, times
+
+        byteCount = result
+
+    return byteCount, times
+
+def formatResult(name, byteCount, times):
+    median = statistics.median(times)
+    best = min(times)
+
+    if (byteCount is None):
+        return "{:<16} failed".format(name)
+    elif (byteCount == 0):
+        return "{:<16} {:>8.2f} ms/cmd (best {:.2f} ms)".format(name, median * 1000, best * 1000)
+    else:
+        return "{:<16} {:>8} bytes {:>10.0f} B/s (best {:.0f} B/s)".format(name, byteCount, byteCount / median, byteCount / best)
+
+def main():
+    argParser = argparse.ArgumentParser(description="Measures the throughput of the Chameleon's USB link")
+    argParser.add_argument("-p", "--port", dest="port", metavar="COMPORT", required=True, help="specify device's comport")
+    argParser.add_argument("-n", "--rounds", dest="rounds", type=int, default=5, help="number of rounds per transfer")
+    argParser.add_argument("-u", "--upload", dest="upload", action="store_true", help="also measure dump uploads by writing back the downloaded dump")
+    argParser.add_argument("-v", "--verbose", dest="verbose", action="store_true", default=0)
+
+    args = argParser.parse_args()
+
+    if (args.verbose):
+        verboseFunc = verboseLog
+    else:
+        verboseFunc = None
+
+    chameleon = Chameleon.Device(verboseFunc)
+
+    if (not chameleon.connect(args.port)):
+        print("Unable to establish communication on {}".format(args.port))
+        sys.exit(2)
+
+    print("{}".format(chameleon.versionString))
+
+    # Command round trips, a few bytes in each direction
+    def roundTrip():
+        result = chameleon.cmdVersion()
+        return 0 if (result is not None) else None
+
+    byteCount, times = measure(roundTrip, 10 * args.rounds)
+    print(formatResult("VERSION?", byteCount, times))
+
+    dump = io.BytesIO()
+
+    def download():
+        dump.seek(0)
+        dump.truncate()
+        return chameleon.cmdDownloadDump(dump)
+
+    byteCount, times = measure(download, args.rounds)
+    print(formatResult("DOWNLOAD", byteCount, times))
+
+    def downloadLog():
+        return chameleon.cmdDownloadLog(io.BytesIO())
+
+    byteCount, times = measure(downloadLog, args.rounds)
+    print(formatResult("LOGDOWNLOAD", byteCount, times))
+
+    if (args.upload and len(dump.getvalue()) > 0):
+        def upload():
+            dump.seek(0)
+            return chameleon.cmdUploadDump(dump)
+
+        byteCount, times = measure(upload, args.rounds)
+        print(formatResult("UPLOAD", byteCount, times))
+
+    chameleon.disconnect()
+    sys.exit(0)
+
+if __name__ == "__main__":
+    main()
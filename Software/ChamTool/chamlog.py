@@ -35,6 +35,21 @@ def formatJSON(log):
     
     return text
 
+def streamLog(chameleon, logMode, args, formatFunc, pcap):
+    # LIVE and SNIFF send the log entries as an endless stream
+    chameleon.cmdLogMode("OFF")
+    chameleon.cmdLogMode(logMode)
+    stream = chameleon.openStream()
+
+    try:
+        for logEntry in Chameleon.Log.iterBinary(stream, args.decode):
+            if (pcap is not None):
+                pcap.writeEntry(logEntry)
+            if (pcap is None or args.pcap != '-'):
+                print(formatFunc([logEntry]), end='', flush=True)
+    except KeyboardInterrupt:
+        pass
+
 def main():
     outputTypes = {
         'text': formatText,
@@ -51,6 +66,10 @@ def main():
                             help="specifies output type")
     argParser.add_argument("-d", "--decode", dest="decode", choices=CardTypesMap.keys(), default=None, help="Decode the sniffed traffic and application data with a decoder")
     argParser.add_argument("-l", "--live", dest="live", action='store_true', help="Use live logging capabilities of Chameleon")
+    argParser.add_argument("-s", "--sniff", dest="sniff", action='store_true', help="Stream the sniffed frames using the SNIFF log mode of Chameleon")
+    argParser.add_argument("-w", "--pcap", dest="pcap", metavar="PCAPFILE", help="Write the frames to a pcap file, '-' for stdout")
+    argParser.add_argument("--linktype", dest="linktype", choices=['iso14443', 'user0'], default='iso14443',
+                            help="pcap link type, user0 for frames that are not ISO14443 (e.g. ISO15693)")
     argParser.add_argument("-c", "--clear", dest="clear", action='store_true', help="Clear Chameleon's log memory when using -p")
     argParser.add_argument("-m", "--mode", dest="mode", metavar="LOGMODE", help="Additionally set Chameleon's log mode after reading it's memory")
     argParser.add_argument("-v", "--verbose", dest="verbose", action='store_true', default=0)
@@ -62,20 +81,21 @@ def main():
     else:
         verboseFunc = None
 
-    print("\nNote: If parityBit check failed, '!' is appended to the decoded data and raw data with parity bit is displayed.\n")
-    if (args.live):
-        # Live logging mode
+    pcap = None
+    if (args.pcap is not None):
+        linkType = Chameleon.Pcap.LINKTYPE_ISO_14443 if (args.linktype == 'iso14443') else Chameleon.Pcap.LINKTYPE_USER0
+        pcapHandle = sys.stdout.buffer if (args.pcap == '-') else open(args.pcap, "wb")
+        pcap = Chameleon.Pcap.PcapWriter(pcapHandle, linkType)
+    else:
+        print("\nNote: If parityBit check failed, '!' is appended to the decoded data and raw data with parity bit is displayed.\n")
+
+    if (args.live or args.sniff):
+        # Live logging or sniff streaming mode
         if (args.port is not None):
             chameleon = Chameleon.Device(verboseFunc)
 
             if (chameleon.connect(args.port)):
-                chameleon.cmdLogMode("LIVE")
-
-                while True:
-                    stream = io.BytesIO(chameleon.read())
-                    log = Chameleon.Log.parseBinary(stream, args.decode)
-                    if (len(log) > 0):
-                        print(outputTypes[args.type](log))
+                streamLog(chameleon, "SNIFF" if args.sniff else "LIVE", args, outputTypes[args.type], pcap)
       
     else:
         if (args.logfile is not None):
@@ -101,8 +121,15 @@ def main():
         # Parse actual logfile
         log = Chameleon.Log.parseBinary(handle, args.decode)
 
-        # Print to console using chosen output type
-        print(outputTypes[args.type](log))
+        if (pcap is not None):
+            for logEntry in log:
+                pcap.writeEntry(logEntry)
+        else:
+            # Print to console using chosen output type
+            print(outputTypes[args.type](log))
+
+    if (pcap is not None):
+        print("{} frames written to {}".format(pcap.packetCount, args.pcap), file=sys.stderr)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,412 @@
+/* HostTransport.c
+ *
+ * Implements the libnfc functions declared in HostTransport/nfc/nfc.h on
+ * top of the host build of the firmware (Firmware/Chameleon-Mini/Host), so
+ * that the tests run without a reader. With NP_AUTO_ISO14443_4 set the
+ * card is activated on the first exchange and the bytes are sent as an
+ * APDU in ISO14443-4 blocks, otherwise as raw frames.
+ *
+ * The processing time of the firmware is recorded per exchange, the report
+ * printed by nfc_exit() has the command rate, the latency percentiles and
+ * the ReadData/WriteData throughput per communication mode of the file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nfc/nfc.h"
+#include "HostReader.h"
+
+#define HOST_CONFIGURATION          "MF_DESFIRE"
+#define HOST_FRAME_SIZE             (256)
+#define HOST_CARRIER_FREQUENCY      (13560000ULL)
+
+#define DESFIRE_NATIVE_CLA          (0x90)
+#define DESFIRE_INS_CONTINUE        (0xAF)
+#define DESFIRE_INS_READ_DATA       (0xBD)
+#define DESFIRE_INS_WRITE_DATA      (0x3D)
+#define DESFIRE_INS_GET_FILE_SETTINGS   (0xF5)
+#define DESFIRE_INS_SELECT_APPLICATION  (0x5A)
+#define DESFIRE_INS_FORMAT_PICC     (0xFC)
+#define DESFIRE_SW1                 (0x91)
+#define DESFIRE_COMM_MODES          (4)
+#define DESFIRE_MAX_TRACKED_FILES   (64)
+
+struct nfc_context {
+    int Devices;
+};
+
+struct nfc_device {
+    bool HandleCRC;
+    bool AutoISO14443_4;
+    bool Activated;
+    const char *LastError;
+};
+
+typedef struct {
+    uint8_t Aid[3];
+    uint8_t FileNo;
+    uint8_t CommSettings;
+} TrackedFileType;
+
+typedef struct {
+    uint32_t Commands;
+    uint64_t Bytes;
+    uint64_t Nanoseconds;
+} ThroughputType;
+
+static struct nfc_device Device;
+static bool FirmwareInitialized = false;
+
+static uint64_t *Latencies = NULL;
+static size_t LatencyCount = 0;
+static size_t LatencyCapacity = 0;
+static uint64_t TotalNanoseconds = 0;
+static uint32_t StatusErrors = 0;
+
+static uint8_t SelectedAid[3] = { 0x00, 0x00, 0x00 };
+static TrackedFileType TrackedFiles[DESFIRE_MAX_TRACKED_FILES];
+static size_t TrackedFileCount = 0;
+static uint8_t PendingIns = 0x00;
+static uint8_t PendingCommSettings = 0x00;
+static ThroughputType ReadThroughput[DESFIRE_COMM_MODES];
+static ThroughputType WriteThroughput[DESFIRE_COMM_MODES];
+
+static const char *CommModeNames[DESFIRE_COMM_MODES] = {
+    "plain", "MACed", "plain", "enciphered"
+};
+
+static void RecordLatency(uint64_t Nanoseconds) {
+    if (LatencyCount == LatencyCapacity) {
+        size_t Capacity = LatencyCapacity ? 2 * LatencyCapacity : 256;
+        uint64_t *Resized = realloc(Latencies, Capacity * sizeof(uint64_t));
+        if (Resized == NULL) {
+            return;
+        }
+        Latencies = Resized;
+        LatencyCapacity = Capacity;
+    }
+    Latencies[LatencyCount++] = Nanoseconds;
+    TotalNanoseconds += Nanoseconds;
+}
+
+static TrackedFileType *LookupTrackedFile(uint8_t FileNo) {
+    for (size_t i = 0; i < TrackedFileCount; i++) {
+        if (TrackedFiles[i].FileNo == FileNo && !memcmp(TrackedFiles[i].Aid, SelectedAid, 3)) {
+            return &TrackedFiles[i];
+        }
+    }
+    return NULL;
+}
+
+static void TrackFile(uint8_t FileNo, uint8_t CommSettings) {
+    TrackedFileType *File = LookupTrackedFile(FileNo);
+    if (File == NULL) {
+        if (TrackedFileCount == DESFIRE_MAX_TRACKED_FILES) {
+            return;
+        }
+        File = &TrackedFiles[TrackedFileCount++];
+        memcpy(File->Aid, SelectedAid, 3);
+        File->FileNo = FileNo;
+    }
+    File->CommSettings = CommSettings & 0x03;
+}
+
+static uint8_t FileCommSettings(uint8_t FileNo) {
+    TrackedFileType *File = LookupTrackedFile(FileNo);
+    return (File != NULL) ? File->CommSettings : 0x00;
+}
+
+static void AddThroughput(ThroughputType *Throughput, size_t Bytes, uint64_t Nanoseconds) {
+    Throughput->Commands++;
+    Throughput->Bytes += Bytes;
+    Throughput->Nanoseconds += Nanoseconds;
+}
+
+/* Follows the native DESFire commands (90 INS 00 00 Lc Data 00) to know
+ * the communication mode of the files read and written */
+static void AccountExchange(const uint8_t *Apdu, size_t ApduSize,
+                            const uint8_t *Answer, size_t AnswerSize, uint64_t Nanoseconds) {
+    if (ApduSize < 5 || Apdu[0] != DESFIRE_NATIVE_CLA || AnswerSize < 2 ||
+            Answer[AnswerSize - 2] != DESFIRE_SW1) {
+        PendingIns = 0x00;
+        return;
+    }
+    uint8_t Ins = Apdu[1];
+    uint8_t Status = Answer[AnswerSize - 1];
+    const uint8_t *Data = &Apdu[5];
+    size_t DataSize = ApduSize > 6 ? ApduSize - 6 : 0;
+    size_t AnswerData = AnswerSize - 2;
+    bool Success = Status == 0x00 || Status == DESFIRE_INS_CONTINUE;
+
+    if (!Success) {
+        StatusErrors++;
+    }
+    if (Ins == DESFIRE_INS_CONTINUE) {
+        if (PendingIns == DESFIRE_INS_READ_DATA && Success) {
+            AddThroughput(&ReadThroughput[PendingCommSettings], AnswerData, Nanoseconds);
+        }
+        if (Status != DESFIRE_INS_CONTINUE) {
+            PendingIns = 0x00;
+        }
+        return;
+    }
+    PendingIns = (Status == DESFIRE_INS_CONTINUE) ? Ins : 0x00;
+
+    switch (Ins) {
+        case DESFIRE_INS_SELECT_APPLICATION:
+            if (Success && DataSize >= 3) {
+                memcpy(SelectedAid, Data, 3);
+            }
+            break;
+        case DESFIRE_INS_FORMAT_PICC:
+            if (Success) {
+                TrackedFileCount = 0;
+            }
+            break;
+        case 0xCD: /* CreateStdDataFile */
+        case 0xCB: /* CreateBackupDataFile */
+        case 0xCC: /* CreateValueFile */
+        case 0xC1: /* CreateLinearRecordFile */
+        case 0xC0: /* CreateCyclicRecordFile */
+            if (Success && DataSize >= 2) {
+                TrackFile(Data[0], Data[1]);
+            }
+            break;
+        case DESFIRE_INS_GET_FILE_SETTINGS:
+            if (Success && DataSize >= 1 && AnswerData >= 2) {
+                TrackFile(Data[0], Answer[1]);
+            }
+            break;
+        case DESFIRE_INS_READ_DATA:
+            if (Success && DataSize >= 1) {
+                PendingCommSettings = FileCommSettings(Data[0]);
+                AddThroughput(&ReadThroughput[PendingCommSettings], AnswerData, Nanoseconds);
+            }
+            break;
+        case DESFIRE_INS_WRITE_DATA:
+            if (Success && DataSize >= 7) {
+                AddThroughput(&WriteThroughput[FileCommSettings(Data[0])], DataSize - 7, Nanoseconds);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static int CompareLatencies(const void *A, const void *B) {
+    uint64_t LatencyA = *(const uint64_t *) A;
+    uint64_t LatencyB = *(const uint64_t *) B;
+    return (LatencyA > LatencyB) - (LatencyA < LatencyB);
+}
+
+static double Percentile(unsigned Percent) {
+    /* Nearest rank */
+    size_t Rank = (Percent * LatencyCount + 99) / 100;
+    return Latencies[Rank > 0 ? Rank - 1 : 0] / 1000.0;
+}
+
+static void PrintThroughput(const char *Command, ThroughputType *Throughput) {
+    for (unsigned Mode = 0; Mode < DESFIRE_COMM_MODES; Mode++) {
+        ThroughputType *Entry = &Throughput[Mode];
+        if (Entry->Commands == 0) {
+            continue;
+        }
+        printf("==   %-9s %-10s %6u frames, %8llu bytes, %10.0f bytes/s\n", Command, CommModeNames[Mode],
+               Entry->Commands, (unsigned long long) Entry->Bytes,
+               Entry->Nanoseconds ? Entry->Bytes * 1e9 / Entry->Nanoseconds : 0.0);
+    }
+}
+
+static void PrintReport(void) {
+    if (LatencyCount == 0) {
+        return;
+    }
+    qsort(Latencies, LatencyCount, sizeof(uint64_t), CompareLatencies);
+    printf("== Host transport: %zu exchanges, %.3f ms in the firmware, %.0f commands/s, %u error status words\n",
+           LatencyCount, TotalNanoseconds / 1e6, LatencyCount * 1e9 / (TotalNanoseconds ? TotalNanoseconds : 1),
+           StatusErrors);
+    printf("==   latency p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+           Percentile(50), Percentile(90), Percentile(99), Latencies[LatencyCount - 1] / 1000.0);
+    PrintThroughput("ReadData", ReadThroughput);
+    PrintThroughput("WriteData", WriteThroughput);
+}
+
+void nfc_init(nfc_context **context) {
+    *context = calloc(1, sizeof(nfc_context));
+}
+
+void nfc_exit(nfc_context *context) {
+    PrintReport();
+    free(context);
+}
+
+nfc_device *nfc_open(nfc_context *context, const char *connstring) {
+    (void) connstring;
+    if (context == NULL || context->Devices > 0) {
+        return NULL;
+    }
+    if (!FirmwareInitialized) {
+        if (!HostReaderInit(HOST_CONFIGURATION)) {
+            return NULL;
+        }
+        FirmwareInitialized = true;
+    }
+    memset(&Device, 0, sizeof(Device));
+    Device.HandleCRC = true;
+    Device.LastError = "Success";
+    context->Devices++;
+    return &Device;
+}
+
+void nfc_close(nfc_device *pnd) {
+    (void) pnd;
+}
+
+const char *nfc_device_get_name(nfc_device *pnd) {
+    (void) pnd;
+    return "Chameleon host build (" HOST_CONFIGURATION ")";
+}
+
+int nfc_initiator_init(nfc_device *pnd) {
+    HostReaderReset();
+    pnd->Activated = false;
+    return NFC_SUCCESS;
+}
+
+int nfc_device_set_property_bool(nfc_device *pnd, const nfc_property property, const bool bEnable) {
+    switch (property) {
+        case NP_HANDLE_CRC:
+            pnd->HandleCRC = bEnable;
+            break;
+        case NP_AUTO_ISO14443_4:
+            pnd->AutoISO14443_4 = bEnable;
+            break;
+        case NP_ACTIVATE_FIELD:
+            /* Field off and on */
+            HostReaderReset();
+            pnd->Activated = false;
+            break;
+        default:
+            break;
+    }
+    return NFC_SUCCESS;
+}
+
+int nfc_device_set_property_int(nfc_device *pnd, const nfc_property property, const int value) {
+    (void) pnd;
+    (void) property;
+    (void) value;
+    return NFC_SUCCESS;
+}
+
+static int TransceiveBits(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTxBits,
+                          uint8_t *pbtRx, const size_t szRx, uint64_t *Nanoseconds) {
+    if (szTxBits > HOST_FRAME_SIZE * 8) {
+        pnd->LastError = "Invalid argument(s)";
+        return NFC_EINVARG;
+    }
+    int Bits = HostReaderTransceiveBits(pbtTx, szTxBits, pnd->HandleCRC, pbtRx, szRx * 8, Nanoseconds);
+    if (Bits == HOST_READER_NO_ANSWER) {
+        pnd->LastError = "Timeout";
+        return NFC_ETIMEOUT;
+    }
+    return Bits;
+}
+
+int nfc_initiator_transceive_bytes(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTx,
+                                   uint8_t *pbtRx, const size_t szRx, int timeout) {
+    uint64_t Nanoseconds = 0;
+    (void) timeout;
+
+    if (!pnd->AutoISO14443_4) {
+        int Bits = TransceiveBits(pnd, pbtTx, szTx * 8, pbtRx, szRx, &Nanoseconds);
+        return (Bits < 0) ? Bits : (Bits + 7) / 8;
+    }
+    if (!pnd->Activated) {
+        uint8_t Uid[10];
+        if (HostReaderActivate(Uid) == 0) {
+            pnd->LastError = "RF Transmission Error";
+            return NFC_ERFTRANS;
+        }
+        pnd->Activated = true;
+    }
+    if (szTx > HOST_FRAME_SIZE) {
+        pnd->LastError = "Invalid argument(s)";
+        return NFC_EINVARG;
+    }
+    int Bytes = HostReaderExchangeAPDU(pbtTx, szTx, pbtRx, szRx, &Nanoseconds);
+    if (Bytes == HOST_READER_NO_ANSWER) {
+        pnd->LastError = "Timeout";
+        return NFC_ETIMEOUT;
+    }
+    RecordLatency(Nanoseconds);
+    AccountExchange(pbtTx, szTx, pbtRx, Bytes, Nanoseconds);
+    return Bytes;
+}
+
+int nfc_initiator_transceive_bits(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTxBits,
+                                  const uint8_t *pbtTxPar, uint8_t *pbtRx, const size_t szRx,
+                                  uint8_t *pbtRxPar) {
+    (void) pbtTxPar;
+    (void) pbtRxPar;
+    return TransceiveBits(pnd, pbtTx, szTxBits, pbtRx, szRx, NULL);
+}
+
+int nfc_initiator_transceive_bytes_timed(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTx,
+                                         uint8_t *pbtRx, const size_t szRx, uint32_t *cycles) {
+    uint64_t Nanoseconds = 0;
+    int Bits = TransceiveBits(pnd, pbtTx, szTx * 8, pbtRx, szRx, &Nanoseconds);
+    *cycles = Nanoseconds * HOST_CARRIER_FREQUENCY / 1000000000ULL;
+    return (Bits < 0) ? Bits : (Bits + 7) / 8;
+}
+
+int nfc_initiator_transceive_bits_timed(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTxBits,
+                                        const uint8_t *pbtTxPar, uint8_t *pbtRx, const size_t szRx,
+                                        uint8_t *pbtRxPar, uint32_t *cycles) {
+    uint64_t Nanoseconds = 0;
+    (void) pbtTxPar;
+    (void) pbtRxPar;
+    int Bits = TransceiveBits(pnd, pbtTx, szTxBits, pbtRx, szRx, &Nanoseconds);
+    *cycles = Nanoseconds * HOST_CARRIER_FREQUENCY / 1000000000ULL;
+    return Bits;
+}
+
+const char *nfc_strerror(const nfc_device *pnd) {
+    return pnd->LastError;
+}
+
+void nfc_perror(const nfc_device *pnd, const char *s) {
+    fprintf(stderr, "%s: %s\n", s, nfc_strerror(pnd));
+}
+
+int str_nfc_target(char **buf, const nfc_target *pnt, bool verbose) {
+    (void) verbose;
+    *buf = malloc(3 * sizeof(pnt->abtUid) + 8);
+    if (*buf == NULL) {
+        return NFC_EIO;
+    }
+    char *Position = *buf + sprintf(*buf, "UID:");
+    for (size_t i = 0; i < pnt->szUidLen && i < sizeof(pnt->abtUid); i++) {
+        Position += sprintf(Position, " %02x", pnt->abtUid[i]);
+    }
+    strcpy(Position, "\n");
+    return Position + 1 - *buf;
+}
+
+void nfc_free(void *p) {
+    free(p);
+}
+
+void iso14443a_crc_append(uint8_t *pbtData, size_t szLen) {
+    uint32_t Crc = 0x6363;
+    for (size_t i = 0; i < szLen; i++) {
+        uint8_t Byte = pbtData[i];
+        Byte ^= (uint8_t)(Crc & 0x00FF);
+        Byte ^= Byte << 4;
+        Crc = (Crc >> 8) ^ ((uint32_t) Byte << 8) ^ ((uint32_t) Byte << 3) ^ ((uint32_t) Byte >> 4);
+    }
+    pbtData[szLen] = (uint8_t)(Crc & 0xFF);
+    pbtData[szLen + 1] = (uint8_t)((Crc >> 8) & 0xFF);
+}
@@ -0,0 +1,77 @@
+/* nfc.h
+ *
+ * Stand-in for the parts of the libnfc API used by the tests. It is put
+ * in front of the include path of the host build (make host), the
+ * functions are implemented in HostTransport.c on top of the host build
+ * of the firmware instead of a reader.
+ */
+
+#ifndef __HOST_TRANSPORT_NFC_H__
+#define __HOST_TRANSPORT_NFC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NFC_SUCCESS         (0)
+#define NFC_EIO             (-1)
+#define NFC_EINVARG         (-2)
+#define NFC_ETIMEOUT        (-6)
+#define NFC_EOVFLOW         (-7)
+#define NFC_ERFTRANS        (-20)
+
+typedef struct nfc_context nfc_context;
+typedef struct nfc_device nfc_device;
+
+typedef struct {
+    uint8_t abtUid[10];
+    size_t  szUidLen;
+} nfc_target;
+
+typedef enum {
+    NP_TIMEOUT_COMMAND,
+    NP_TIMEOUT_ATR,
+    NP_TIMEOUT_COM,
+    NP_HANDLE_CRC,
+    NP_HANDLE_PARITY,
+    NP_ACTIVATE_FIELD,
+    NP_ACTIVATE_CRYPTO1,
+    NP_INFINITE_SELECT,
+    NP_ACCEPT_INVALID_FRAMES,
+    NP_ACCEPT_MULTIPLE_FRAMES,
+    NP_AUTO_ISO14443_4,
+    NP_EASY_FRAMING,
+    NP_FORCE_ISO14443_A,
+    NP_FORCE_ISO14443_B,
+    NP_FORCE_SPEED_106,
+} nfc_property;
+
+void nfc_init(nfc_context **context);
+void nfc_exit(nfc_context *context);
+nfc_device *nfc_open(nfc_context *context, const char *connstring);
+void nfc_close(nfc_device *pnd);
+const char *nfc_device_get_name(nfc_device *pnd);
+
+int nfc_initiator_init(nfc_device *pnd);
+int nfc_device_set_property_bool(nfc_device *pnd, const nfc_property property, const bool bEnable);
+int nfc_device_set_property_int(nfc_device *pnd, const nfc_property property, const int value);
+
+int nfc_initiator_transceive_bytes(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTx,
+                                   uint8_t *pbtRx, const size_t szRx, int timeout);
+int nfc_initiator_transceive_bits(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTxBits,
+                                  const uint8_t *pbtTxPar, uint8_t *pbtRx, const size_t szRx,
+                                  uint8_t *pbtRxPar);
+int nfc_initiator_transceive_bytes_timed(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTx,
+                                         uint8_t *pbtRx, const size_t szRx, uint32_t *cycles);
+int nfc_initiator_transceive_bits_timed(nfc_device *pnd, const uint8_t *pbtTx, const size_t szTxBits,
+                                        const uint8_t *pbtTxPar, uint8_t *pbtRx, const size_t szRx,
+                                        uint8_t *pbtRxPar, uint32_t *cycles);
+
+const char *nfc_strerror(const nfc_device *pnd);
+void nfc_perror(const nfc_device *pnd, const char *s);
+int str_nfc_target(char **buf, const nfc_target *pnt, bool verbose);
+void nfc_free(void *p);
+
+void iso14443a_crc_append(uint8_t *pbtData, size_t szLen);
+
+#endif
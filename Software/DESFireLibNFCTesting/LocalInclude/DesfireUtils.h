@@ -30,9 +30,9 @@ static inline int AuthenticateISO(nfc_device *nfcConnDev, uint8_t keyIndex, cons
     if (nfcConnDev == NULL || keyData == NULL) {
         InvalidateAuthenticationStatus();
         return INVALID_PARAMS_ERROR;
-    } else if (!AUTHENTICATED) {
-        InvalidateAuthenticationStatus();
     }
+    /* The PICC starts every authentication from a zero IV */
+    InvalidateAuthenticationStatus();
 
     // Start 3K3DES authentication (default key, blank setting of all zeros):
     uint8_t *IVBuf = ActiveCryptoIVBuffer;
@@ -158,9 +158,9 @@ static inline int AuthenticateLegacy(nfc_device *nfcConnDev, uint8_t keyIndex, c
     if (nfcConnDev == NULL || keyData == NULL) {
         InvalidateAuthenticationStatus();
         return INVALID_PARAMS_ERROR;
-    } else if (!AUTHENTICATED) {
-        InvalidateAuthenticationStatus();
     }
+    /* The PICC starts every authentication from a zero IV */
+    InvalidateAuthenticationStatus();
 
     // Start 3K3DES authentication (default key, blank setting of all zeros):
     uint8_t *IVBuf = ActiveCryptoIVBuffer;
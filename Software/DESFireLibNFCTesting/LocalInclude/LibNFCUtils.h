@@ -196,6 +196,7 @@ static inline RxData_t *InitRxDataStruct(size_t bufSize) {
         return NULL;
     }
     rxData->maxRxDataSize = bufSize;
+    return rxData;
 }
 
 static inline void FreeRxDataStruct(RxData_t *rxData, bool freeInputPtr) {
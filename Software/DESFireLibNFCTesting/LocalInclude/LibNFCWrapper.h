@@ -29,14 +29,14 @@ static inline nfc_device *GetNFCDeviceDriver(nfc_context **context) {
     nfc_device *pnd = nfc_open(*context, NULL);
     if (pnd == NULL) {
         ERR("Error opening NFC reader");
-        nfc_exit(context);
+        nfc_exit(*context);
         *context = NULL;
         return NULL;
     }
     if (nfc_initiator_init(pnd) < 0) {
         nfc_perror(pnd, "nfc_initiator_init");
         nfc_close(pnd);
-        nfc_exit(context);
+        nfc_exit(*context);
         *context = NULL;
         return NULL;
     }
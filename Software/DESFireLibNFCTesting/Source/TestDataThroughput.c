@@ -0,0 +1,82 @@
+/* TestDataThroughput.c */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <nfc/nfc.h>
+
+#include "LibNFCUtils.h"
+#include "LibNFCWrapper.h"
+#include "DesfireUtils.h"
+#include "CryptoUtils.h"
+
+#define THROUGHPUT_ROUNDS          (64)
+#define THROUGHPUT_TRANSFER_SIZE   (32)
+
+int main(int argc, char **argv) {
+
+    nfc_context *nfcCtxt;
+    nfc_device  *nfcPnd = GetNFCDeviceDriver(&nfcCtxt);
+    if (nfcPnd == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    if (Authenticate(nfcPnd, DESFIRE_CRYPTO_AUTHTYPE_ISODES, MASTER_KEY_INDEX, ZERO_KEY)) {
+        fprintf(stdout, "    -- !! Error authenticating !!\n");
+        return EXIT_FAILURE;
+    }
+
+    uint8_t aidToCreate[] = { 0x7a, 0x5b, 0x01 };
+    if (CreateApplication(nfcPnd, aidToCreate, 0x0f, 1)) {
+        fprintf(stdout, "    -- !! Error creating new AID !!\n");
+        return EXIT_FAILURE;
+    } else if (SelectApplication(nfcPnd, aidToCreate, APPLICATION_AID_LENGTH)) {
+        fprintf(stdout, "    -- !! Error selecting new AID by default !!\n");
+        return EXIT_FAILURE;
+    } else if (Authenticate(nfcPnd, DESFIRE_CRYPTO_AUTHTYPE_ISODES, MASTER_KEY_INDEX, ZERO_KEY)) {
+        fprintf(stdout, "    -- !! Error authenticating !!\n");
+        return EXIT_FAILURE;
+    }
+
+    /* One file per communication mode, all access rights on key 0 so the
+     * mode is not downgraded to plain text */
+    if (CreateStandardDataFile(nfcPnd, 0x00, 0x00, 0x0000, 2 * THROUGHPUT_TRANSFER_SIZE)) {
+        fprintf(stdout, "    -- !! Error creating plain standard data file !!\n");
+        return EXIT_FAILURE;
+    } else if (CreateStandardDataFile(nfcPnd, 0x01, 0x01, 0x0000, 2 * THROUGHPUT_TRANSFER_SIZE)) {
+        fprintf(stdout, "    -- !! Error creating MACed standard data file !!\n");
+        return EXIT_FAILURE;
+    } else if (CreateStandardDataFile(nfcPnd, 0x02, 0x03, 0x0000, 2 * THROUGHPUT_TRANSFER_SIZE)) {
+        fprintf(stdout, "    -- !! Error creating enciphered standard data file !!\n");
+        return EXIT_FAILURE;
+    }
+
+    uint8_t dataBuf[THROUGHPUT_TRANSFER_SIZE];
+    for (int i = 0; i < THROUGHPUT_TRANSFER_SIZE; i++) {
+        dataBuf[i] = (uint8_t) i;
+    }
+
+    /* The enciphered file is only read: the card expects writes to it
+     * encrypted with an AES session key */
+    PRINT_STATUS_EXCHANGE_MESSAGES = false;
+    for (int round = 0; round < THROUGHPUT_ROUNDS; round++) {
+        uint16_t offset = (round % 2) * THROUGHPUT_TRANSFER_SIZE;
+        if (WriteDataCommand(nfcPnd, 0x00, offset, THROUGHPUT_TRANSFER_SIZE, dataBuf) ||
+                WriteDataCommand(nfcPnd, 0x01, offset, THROUGHPUT_TRANSFER_SIZE, dataBuf)) {
+            fprintf(stdout, "    -- !! Error write data command !!\n");
+            return EXIT_FAILURE;
+        } else if (ReadDataCommand(nfcPnd, 0x00, offset, THROUGHPUT_TRANSFER_SIZE) ||
+                   ReadDataCommand(nfcPnd, 0x01, offset, THROUGHPUT_TRANSFER_SIZE) ||
+                   ReadDataCommand(nfcPnd, 0x02, offset, THROUGHPUT_TRANSFER_SIZE)) {
+            fprintf(stdout, "    -- !! Error read data command !!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    PRINT_STATUS_EXCHANGE_MESSAGES = true;
+    fprintf(stdout, ">>> %d rounds of %d byte reads and writes done\n",
+            THROUGHPUT_ROUNDS, THROUGHPUT_TRANSFER_SIZE);
+
+    FreeNFCDeviceDriver(&nfcCtxt, &nfcPnd);
+    return EXIT_SUCCESS;
+
+}